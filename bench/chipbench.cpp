@@ -0,0 +1,511 @@
+/*
+ * chipbench: renders a list of files with the chip-core engines on a pool of
+ * threads and reports how fast each engine is, as one JSON object per line.
+ *
+ *   chipbench [options] file...
+ *
+ * Lines of "type":"file" come in the order the files finish, followed by one
+ * "type":"engine" line per engine and a closing "type":"total" line. The
+ * realtime factor is seconds of audio rendered per second of CPU time of the
+ * rendering thread; open_ms is the time the engine takes to load a file that
+ * is already in memory. Peak RSS is that of the whole process, so with more
+ * than one thread a file's rss_peak_kb also includes the files rendered
+ * alongside it.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/resource.h>
+#include <time.h>
+
+#include "chipplayer.h"
+
+namespace {
+
+struct Options
+{
+    int threads = 0;
+    int sampleRate = 44100;
+    int blockFrames = 2048;
+    double maxSeconds = 300.0;
+    std::string wavDir;
+    std::string soundFont;
+};
+
+Options g_options;
+
+// chipplayer opens one file at a time; this keeps the time a job waits for
+// the others out of its open_ms. The n64 engine is a single global
+// instance, so its files also render one at a time.
+std::mutex g_openMutex;
+std::mutex g_n64Mutex;
+std::mutex g_outputMutex;
+
+double wallSeconds()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+double threadCpuSeconds()
+{
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+long peakRssKb()
+{
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return usage.ru_maxrss / 1024;
+#else
+    return usage.ru_maxrss;
+#endif
+}
+
+std::string lowerExtension(const std::string &path)
+{
+    size_t slash = path.find_last_of("/\\");
+    size_t dot = path.rfind('.');
+    if(dot == std::string::npos || (slash != std::string::npos && dot < slash))
+        return std::string();
+    std::string ext = path.substr(dot + 1);
+    for(char &c : ext)
+        c = (char)tolower((unsigned char)c);
+    return ext;
+}
+
+std::string baseName(const std::string &path)
+{
+    size_t slash = path.find_last_of("/\\");
+    return slash == std::string::npos ? path : path.substr(slash + 1);
+}
+
+std::string jsonString(const std::string &s)
+{
+    std::string out = "\"";
+    for(unsigned char c : s)
+    {
+        if(c == '"' || c == '\\')
+        {
+            out += '\\';
+            out += (char)c;
+        }
+        else if(c < 0x20)
+        {
+            char esc[8];
+            snprintf(esc, sizeof(esc), "\\u%04x", c);
+            out += esc;
+        }
+        else
+            out += (char)c;
+    }
+    return out + "\"";
+}
+
+bool readFile(const std::string &path, std::vector<uint8_t> &data)
+{
+    FILE *f = fopen(path.c_str(), "rb");
+    if(!f)
+        return false;
+    data.clear();
+    uint8_t chunk[65536];
+    size_t got;
+    while((got = fread(chunk, 1, sizeof(chunk), f)) > 0)
+        data.insert(data.end(), chunk, chunk + got);
+    bool ok = !ferror(f);
+    fclose(f);
+    return ok;
+}
+
+// ---- Engines ----
+
+// The engines a file is rendered with, by its extension or contents
+std::vector<int> enginesFor(const std::string &path, const std::vector<uint8_t> &data)
+{
+    int engine = cp_identify(path.c_str(), data.data(), (int)data.size());
+    std::vector<int> engines(1, engine);
+    if(engine == CP_ENGINE_ADLMIDI && !g_options.soundFont.empty())
+        engines.push_back(CP_ENGINE_FLUIDLITE);
+    return engines;
+}
+
+// ---- WAV output ----
+
+class WavWriter
+{
+    FILE *m_file = nullptr;
+    uint32_t m_frames = 0;
+    std::vector<int16_t> m_pcm;
+
+    void put32(uint32_t v)
+    {
+        uint8_t b[4] = {(uint8_t)v, (uint8_t)(v >> 8), (uint8_t)(v >> 16), (uint8_t)(v >> 24)};
+        fwrite(b, 1, 4, m_file);
+    }
+    void put16(uint16_t v)
+    {
+        uint8_t b[2] = {(uint8_t)v, (uint8_t)(v >> 8)};
+        fwrite(b, 1, 2, m_file);
+    }
+    void header()
+    {
+        fwrite("RIFF", 1, 4, m_file);
+        put32(36 + m_frames * 4);
+        fwrite("WAVEfmt ", 1, 8, m_file);
+        put32(16);
+        put16(1);
+        put16(2);
+        put32(g_options.sampleRate);
+        put32(g_options.sampleRate * 4);
+        put16(4);
+        put16(16);
+        fwrite("data", 1, 4, m_file);
+        put32(m_frames * 4);
+    }
+
+public:
+    ~WavWriter() { close(); }
+
+    bool open(const std::string &path)
+    {
+        m_file = fopen(path.c_str(), "wb");
+        if(!m_file)
+            return false;
+        header();
+        return true;
+    }
+
+    void write(const float *in, int frames)
+    {
+        m_pcm.resize(frames * 2);
+        for(int i = 0; i < frames * 2; ++i)
+        {
+            float s = in[i] * 32768.0f;
+            s = s < -32768.0f ? -32768.0f : (s > 32767.0f ? 32767.0f : s);
+            m_pcm[i] = (int16_t)s;
+        }
+        fwrite(m_pcm.data(), sizeof(int16_t), m_pcm.size(), m_file);
+        m_frames += frames;
+    }
+
+    void close()
+    {
+        if(!m_file)
+            return;
+        fseek(m_file, 0, SEEK_SET);
+        header();
+        fclose(m_file);
+        m_file = nullptr;
+    }
+};
+
+// ---- Jobs ----
+
+struct Job
+{
+    std::string path;
+    int engineId;
+    const char *engine;
+    size_t index;
+};
+
+struct Result
+{
+    bool ok = false;
+    std::string error;
+    double openMs = 0.0;
+    double audioSeconds = 0.0;
+    double cpuSeconds = 0.0;
+    double wallSeconds = 0.0;
+    long rssPeakKb = 0;
+};
+
+Result runJob(const Job &job)
+{
+    Result r;
+    std::vector<uint8_t> data;
+    try
+    {
+        if(!readFile(job.path, data))
+            throw std::runtime_error(std::string("can't read the file: ") + strerror(errno));
+
+        std::unique_lock<std::mutex> n64Lock(g_n64Mutex, std::defer_lock);
+        if(job.engineId == CP_ENGINE_N64)
+            n64Lock.lock();
+        // Renders straight into the buffer, on this thread
+        std::unique_ptr<ChipPlayer, void (*)(ChipPlayer *)> player(cp_create(g_options.sampleRate, 0), cp_destroy);
+        cp_load_soundfont(player.get(), g_options.soundFont.c_str());
+        {
+            std::lock_guard<std::mutex> lock(g_openMutex);
+            double t = wallSeconds();
+            int err = cp_open(player.get(), job.path.c_str(), data.data(), (int)data.size(), job.engineId);
+            r.openMs = (wallSeconds() - t) * 1000.0;
+            if(err)
+                throw std::runtime_error(cp_get_error(player.get()));
+        }
+
+        WavWriter wav;
+        if(!g_options.wavDir.empty())
+        {
+            char prefix[32];
+            snprintf(prefix, sizeof(prefix), "%04u-", (unsigned)job.index);
+            std::string wavPath = g_options.wavDir + "/" + prefix + baseName(job.path) + "." + job.engine + ".wav";
+            if(!wav.open(wavPath))
+                throw std::runtime_error("can't create " + wavPath);
+        }
+
+        std::vector<float> buffer(g_options.blockFrames * 2);
+        const uint64_t maxFrames = (uint64_t)(g_options.maxSeconds * g_options.sampleRate);
+        uint64_t frames = 0;
+        double wall = wallSeconds(), cpu = threadCpuSeconds();
+        while(frames < maxFrames)
+        {
+            int want = (int)std::min<uint64_t>(g_options.blockFrames, maxFrames - frames);
+            int got = cp_render(player.get(), buffer.data(), want);
+            if(!g_options.wavDir.empty())
+                wav.write(buffer.data(), got);
+            frames += got;
+            if(got < want)
+                break;
+        }
+        r.cpuSeconds = threadCpuSeconds() - cpu;
+        r.wallSeconds = wallSeconds() - wall;
+        r.audioSeconds = (double)frames / g_options.sampleRate;
+        r.ok = true;
+    }
+    catch(const std::exception &e)
+    {
+        r.error = e.what();
+    }
+    catch(...)
+    {
+        r.error = "unknown error";
+    }
+    r.rssPeakKb = peakRssKb();
+    return r;
+}
+
+double ratio(double a, double b)
+{
+    return b > 0.0 ? a / b : 0.0;
+}
+
+void printResult(const Job &job, const Result &r)
+{
+    std::lock_guard<std::mutex> lock(g_outputMutex);
+    if(r.ok)
+    {
+        printf("{\"type\":\"file\",\"index\":%u,\"path\":%s,\"engine\":\"%s\",\"ok\":true,"
+               "\"open_ms\":%.3f,\"audio_s\":%.3f,\"cpu_s\":%.3f,\"wall_s\":%.3f,"
+               "\"rtf\":%.2f,\"rss_peak_kb\":%ld}\n",
+               (unsigned)job.index, jsonString(job.path).c_str(), job.engine,
+               r.openMs, r.audioSeconds, r.cpuSeconds, r.wallSeconds,
+               ratio(r.audioSeconds, r.cpuSeconds), r.rssPeakKb);
+    }
+    else
+    {
+        printf("{\"type\":\"file\",\"index\":%u,\"path\":%s,\"engine\":\"%s\",\"ok\":false,"
+               "\"error\":%s,\"rss_peak_kb\":%ld}\n",
+               (unsigned)job.index, jsonString(job.path).c_str(), job.engine,
+               jsonString(r.error).c_str(), r.rssPeakKb);
+    }
+    fflush(stdout);
+}
+
+struct EngineTotals
+{
+    unsigned files = 0, failed = 0;
+    double audioSeconds = 0.0, cpuSeconds = 0.0;
+    double openMsSum = 0.0, openMsMax = 0.0;
+    double minRtf = 0.0;
+};
+
+void usage()
+{
+    fprintf(stderr,
+        "Usage: chipbench [options] file...\n"
+        "Renders every file with the chip-core engines and prints JSON lines with\n"
+        "per-file, per-engine and total speed figures.\n"
+        "\n"
+        "  -j N        render N files at a time (default: number of CPUs)\n"
+        "  -r RATE     sample rate (default: 44100)\n"
+        "  -b FRAMES   frames per render call (default: 2048)\n"
+        "  -t SECONDS  stop each file after this much audio (default: 300)\n"
+        "  -o DIR      write a 16-bit WAV file per rendering to DIR\n"
+        "  -s SF2      SoundFont for fluidlite; MIDI files are then rendered with\n"
+        "              fluidlite as well as with libADLMIDI\n"
+        "  -l LIST     read more file names from LIST, one per line\n");
+}
+
+bool readList(const char *path, std::vector<std::string> &files)
+{
+    FILE *f = fopen(path, "r");
+    if(!f)
+        return false;
+    char line[4096];
+    while(fgets(line, sizeof(line), f))
+    {
+        size_t n = strlen(line);
+        while(n > 0 && (line[n - 1] == '\n' || line[n - 1] == '\r'))
+            line[--n] = 0;
+        if(n > 0)
+            files.push_back(line);
+    }
+    fclose(f);
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    std::vector<std::string> files;
+    for(int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if(arg.size() == 2 && arg[0] == '-' && std::strchr("jrbtosl", arg[1]))
+        {
+            if(i + 1 >= argc)
+            {
+                usage();
+                return 2;
+            }
+            const char *value = argv[++i];
+            switch(arg[1])
+            {
+            case 'j': g_options.threads = atoi(value); break;
+            case 'r': g_options.sampleRate = atoi(value); break;
+            case 'b': g_options.blockFrames = atoi(value); break;
+            case 't': g_options.maxSeconds = atof(value); break;
+            case 'o': g_options.wavDir = value; break;
+            case 's': g_options.soundFont = value; break;
+            case 'l':
+                if(!readList(value, files))
+                {
+                    fprintf(stderr, "chipbench: can't read %s\n", value);
+                    return 2;
+                }
+                break;
+            }
+        }
+        else if(arg == "-h" || arg == "--help")
+        {
+            usage();
+            return 0;
+        }
+        else if(!arg.empty() && arg[0] == '-')
+        {
+            usage();
+            return 2;
+        }
+        else
+            files.push_back(arg);
+    }
+
+    if(files.empty() || g_options.sampleRate <= 0 || g_options.blockFrames <= 0 || g_options.maxSeconds <= 0.0)
+    {
+        usage();
+        return 2;
+    }
+    if(g_options.threads <= 0)
+        g_options.threads = std::max(1u, std::thread::hardware_concurrency());
+
+    // Sniffing needs the data, but only its first bytes
+    std::vector<Job> jobs;
+    for(const std::string &path : files)
+    {
+        std::vector<uint8_t> head;
+        if(FILE *f = fopen(path.c_str(), "rb"))
+        {
+            head.resize(16);
+            head.resize(fread(head.data(), 1, head.size(), f));
+            fclose(f);
+        }
+        for(int engine : enginesFor(path, head))
+        {
+            Job job;
+            job.path = path;
+            job.engineId = engine;
+            job.engine = cp_engine_name(engine);
+            job.index = jobs.size();
+            jobs.push_back(job);
+        }
+    }
+
+    std::vector<Result> results(jobs.size());
+    std::atomic<size_t> next(0);
+    double wall = wallSeconds();
+    std::vector<std::thread> pool;
+    for(int t = 0; t < g_options.threads; ++t)
+    {
+        pool.emplace_back([&]() {
+            size_t i;
+            while((i = next++) < jobs.size())
+            {
+                results[i] = runJob(jobs[i]);
+                printResult(jobs[i], results[i]);
+            }
+        });
+    }
+    for(std::thread &t : pool)
+        t.join();
+    wall = wallSeconds() - wall;
+
+    std::map<std::string, EngineTotals> engines;
+    double audioSeconds = 0.0;
+    unsigned failed = 0;
+    for(size_t i = 0; i < jobs.size(); ++i)
+    {
+        const Result &r = results[i];
+        EngineTotals &e = engines[jobs[i].engine];
+        e.files++;
+        if(!r.ok)
+        {
+            e.failed++;
+            failed++;
+            continue;
+        }
+        double rtf = ratio(r.audioSeconds, r.cpuSeconds);
+        e.minRtf = (e.files - e.failed == 1) ? rtf : std::min(e.minRtf, rtf);
+        e.audioSeconds += r.audioSeconds;
+        e.cpuSeconds += r.cpuSeconds;
+        e.openMsSum += r.openMs;
+        e.openMsMax = std::max(e.openMsMax, r.openMs);
+        audioSeconds += r.audioSeconds;
+    }
+
+    for(const auto &it : engines)
+    {
+        const EngineTotals &e = it.second;
+        unsigned ok = e.files - e.failed;
+        printf("{\"type\":\"engine\",\"engine\":\"%s\",\"files\":%u,\"failed\":%u,"
+               "\"audio_s\":%.3f,\"cpu_s\":%.3f,\"rtf\":%.2f,\"rtf_min\":%.2f,"
+               "\"open_ms_mean\":%.3f,\"open_ms_max\":%.3f}\n",
+               it.first.c_str(), e.files, e.failed, e.audioSeconds, e.cpuSeconds,
+               ratio(e.audioSeconds, e.cpuSeconds), e.minRtf,
+               ok ? e.openMsSum / ok : 0.0, e.openMsMax);
+    }
+    // streams: how many realtime streams the pool kept up with on average
+    printf("{\"type\":\"total\",\"threads\":%d,\"sample_rate\":%d,\"files\":%u,\"failed\":%u,"
+           "\"audio_s\":%.3f,\"wall_s\":%.3f,\"streams\":%.2f,\"rss_peak_kb\":%ld}\n",
+           g_options.threads, g_options.sampleRate, (unsigned)jobs.size(), failed,
+           audioSeconds, wall, ratio(audioSeconds, wall), peakRssKb());
+
+    return failed ? 1 : 0;
+}
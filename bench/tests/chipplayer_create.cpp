@@ -0,0 +1,104 @@
+/*
+ * chipplayer_create: checks that players created on several threads at once
+ * play the same frames as one created afterwards.
+ *
+ *   chipplayer_create soundfont.sf2 file.mid
+ *
+ * cp_open() creates the engine outside of its lock, and the first fluidlite
+ * synth a process creates sets up fluidlite's global tables. So all threads
+ * are released together into their first cp_open(), each plays the MIDI file
+ * on fluidlite, and their frames are compared with the frames of a player
+ * opened once they are done. A synth that ran before the tables were ready
+ * plays differently; it is a race, so build with -fsanitize=thread to catch
+ * it every time.
+ */
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "chipplayer.h"
+
+namespace {
+
+const int SAMPLE_RATE = 44100;
+const int THREADS = 8;
+const int RENDER_FRAMES = 1024;
+const int RENDER_CALLS = 200;
+
+std::vector<char> readFile(const char *path) {
+  std::vector<char> data;
+  FILE *f = fopen(path, "rb");
+  if (!f) return data;
+  char buf[65536];
+  size_t n;
+  while ((n = fread(buf, 1, sizeof(buf), f)) > 0) data.insert(data.end(), buf, buf + n);
+  fclose(f);
+  return data;
+}
+
+// Plays the file on fluidlite and returns every rendered frame, or nothing on failure
+std::vector<float> play(const char *soundFont, const char *path, const std::vector<char> &data) {
+  std::vector<float> out(RENDER_CALLS * RENDER_FRAMES * 2);
+  ChipPlayer *cp = cp_create(SAMPLE_RATE, 0);
+  cp_load_soundfont(cp, soundFont);
+  if (cp_open(cp, path, data.data(), (int)data.size(), CP_ENGINE_FLUIDLITE) != 0) {
+    fprintf(stderr, "%s: %s\n", path, cp_get_error(cp));
+    cp_destroy(cp);
+    return std::vector<float>();
+  }
+
+  for (int call = 0; call < RENDER_CALLS; call++)
+    cp_render(cp, &out[call * RENDER_FRAMES * 2], RENDER_FRAMES);
+
+  cp_destroy(cp);
+  return out;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  if (argc != 3) {
+    fprintf(stderr, "usage: %s soundfont.sf2 file.mid\n", argv[0]);
+    return 2;
+  }
+  std::vector<char> data = readFile(argv[2]);
+  if (data.empty()) {
+    fprintf(stderr, "%s: can't read\n", argv[2]);
+    return 2;
+  }
+
+  std::atomic<int> waiting(THREADS);
+  std::vector<std::vector<float> > outs(THREADS);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < THREADS; t++) {
+    threads.push_back(std::thread([&, t] {
+      waiting--;
+      while (waiting > 0) std::this_thread::yield();
+      outs[t] = play(argv[1], argv[2], data);
+    }));
+  }
+  for (int t = 0; t < THREADS; t++) threads[t].join();
+
+  std::vector<float> expected = play(argv[1], argv[2], data);
+  if (expected.empty()) return 1;
+  double energy = 0;
+  for (size_t i = 0; i < expected.size(); i++) energy += expected[i] * expected[i];
+  if (energy == 0) {
+    fprintf(stderr, "%s: silent\n", argv[2]);
+    return 1;
+  }
+
+  int failures = 0;
+  for (int t = 0; t < THREADS; t++) {
+    if (outs[t].size() != expected.size() ||
+        memcmp(&outs[t][0], &expected[0], expected.size() * sizeof(float))) {
+      fprintf(stderr, "thread %d: the frames differ\n", t);
+      failures++;
+    }
+  }
+  printf("%d players created at once, %d differ\n", THREADS, failures);
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,112 @@
+/*
+ * chipplayer_ring: checks that a player with a ring plays the same frames as
+ * one that renders straight into cp_render()'s buffer.
+ *
+ *   chipplayer_ring file...
+ *
+ * Each file is played once straight through and once with seeks forward and
+ * back, by both players. The ring is topped up with cp_fill() before every
+ * cp_render() and seek, so a seek finds it full and the frames after the seek
+ * have to be queued by cp_seek_ms() itself. The ring's engine is ahead when
+ * it seeks, so the files need an engine whose seeks don't depend on where it
+ * was, such as gme's.
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "chipplayer.h"
+
+namespace {
+
+const int SAMPLE_RATE = 44100;
+const int RING_FRAMES = 8192;
+const int RENDER_FRAMES = 1024;
+const int RENDER_CALLS = 400;
+
+struct Seek {
+  int call, ms;
+};
+
+std::vector<char> readFile(const char *path) {
+  std::vector<char> data;
+  FILE *f = fopen(path, "rb");
+  if (!f) return data;
+  char buf[65536];
+  size_t n;
+  while ((n = fread(buf, 1, sizeof(buf), f)) > 0) data.insert(data.end(), buf, buf + n);
+  fclose(f);
+  return data;
+}
+
+// Plays the file and returns every rendered frame, or nothing on failure
+std::vector<float> play(const char *path, const std::vector<char> &data, int ringFrames,
+                        const std::vector<Seek> &seeks, unsigned int *underruns) {
+  std::vector<float> out(RENDER_CALLS * RENDER_FRAMES * 2);
+  ChipPlayer *cp = cp_create(SAMPLE_RATE, ringFrames);
+  if (cp_open(cp, path, data.data(), (int)data.size(), CP_ENGINE_AUTO) != 0) {
+    fprintf(stderr, "%s: %s\n", path, cp_get_error(cp));
+    cp_destroy(cp);
+    return std::vector<float>();
+  }
+
+  size_t next = 0;
+  for (int call = 0; call < RENDER_CALLS; call++) {
+    cp_fill(cp);
+    if (next < seeks.size() && seeks[next].call == call) cp_seek_ms(cp, seeks[next++].ms);
+    cp_render(cp, &out[call * RENDER_FRAMES * 2], RENDER_FRAMES);
+  }
+
+  *underruns = cp_get_underruns(cp);
+  cp_destroy(cp);
+  return out;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  const std::vector<Seek> noSeeks;
+  const Seek seekList[] = {{100, 0}, {150, 6000}, {151, 1000}, {250, 3000}, {320, 500}};
+  const std::vector<Seek> seeks(seekList, seekList + sizeof(seekList) / sizeof(seekList[0]));
+  int failures = 0;
+
+  if (argc < 2) {
+    fprintf(stderr, "usage: %s file...\n", argv[0]);
+    return 2;
+  }
+
+  for (int i = 1; i < argc; i++) {
+    std::vector<char> data = readFile(argv[i]);
+    if (data.empty()) {
+      fprintf(stderr, "%s: can't read file\n", argv[i]);
+      return 2;
+    }
+
+    for (int withSeeks = 0; withSeeks < 2; withSeeks++) {
+      const std::vector<Seek> &list = withSeeks ? seeks : noSeeks;
+      unsigned int directUnderruns, ringUnderruns;
+      std::vector<float> direct = play(argv[i], data, 0, list, &directUnderruns);
+      std::vector<float> ring = play(argv[i], data, RING_FRAMES, list, &ringUnderruns);
+      if (direct.empty() || ring.empty()) return 2;
+
+      const char *what = withSeeks ? "with seeks" : "without seeks";
+      if (ringUnderruns != 0) {
+        fprintf(stderr, "%s %s: %u underruns\n", argv[i], what, ringUnderruns);
+        failures++;
+      }
+      for (size_t j = 0; j < direct.size(); j++) {
+        if (direct[j] != ring[j]) {
+          fprintf(stderr, "%s %s: ring differs from direct output at frame %zu\n",
+                  argv[i], what, j / 2);
+          failures++;
+          break;
+        }
+      }
+    }
+  }
+
+  if (failures) return 1;
+  printf("chipplayer_ring: OK\n");
+  return 0;
+}
@@ -0,0 +1,182 @@
+/*
+ * fluid_steal: checks that fluidlite's steal heap picks the same voice to
+ * kill as the linear search it replaced, and times both.
+ *
+ *   fluid_steal soundfont.sf2
+ *
+ * Random note-ons, note-offs, sustain pedal changes and rendered blocks keep
+ * the polyphony full. Every few events, the voice the linear search would
+ * kill is compared with the one fluid_synth_free_voice_by_kill() returns.
+ * Then both are timed with the polyphony full, for a few polyphony limits.
+ */
+
+#include "fluid_synth.h"
+
+#include <stdio.h>
+#include <time.h>
+
+#define CHECKS 2000
+#define TIMED_STEALS 4000
+
+fluid_voice_t* fluid_synth_free_voice_by_kill(fluid_synth_t* synth);
+
+static unsigned int seed = 12345;
+
+static int random_below(int n)
+{
+	seed = seed * 1103515245u + 12345u;
+	return (seed >> 16) % n;
+}
+
+static double now_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/* The search fluid_synth_free_voice_by_kill() did before the heap, without
+ * killing the voice. NULL if a voice is available. */
+static fluid_voice_t* linear_search(fluid_synth_t* synth)
+{
+	fluid_real_t best_prio = 999999.;
+	fluid_voice_t* best = NULL;
+	int i;
+
+	for (i = 0; i < synth->polyphony; i++)
+	{
+		fluid_voice_t* voice = synth->voice[i];
+		fluid_real_t prio = 10000.;
+
+		if (_AVAILABLE(voice))
+			return NULL;
+		if (voice->chan == 9)
+			prio += 4000;
+		else if (_RELEASED(voice))
+			prio -= 2000.;
+		if (_SUSTAINED(voice))
+			prio -= 1000;
+		prio -= (synth->noteid - fluid_voice_get_id(voice));
+		if (voice->volenv_section != FLUID_VOICE_ENVATTACK)
+			prio += voice->volenv_val * 1000.;
+		if (prio < best_prio)
+		{
+			best = voice;
+			best_prio = prio;
+		}
+	}
+	return best;
+}
+
+static void random_event(fluid_synth_t* synth, float* buffer)
+{
+	int chan = random_below(16);
+	switch (random_below(8))
+	{
+	case 0:
+		fluid_synth_noteoff(synth, chan, 36 + random_below(48));
+		break;
+	case 1:
+		fluid_synth_cc(synth, chan, 64, random_below(2) * 127);
+		break;
+	case 2:
+		fluid_synth_write_float(synth, 64, buffer, 0, 2, buffer, 1, 2);
+		break;
+	default:
+		fluid_synth_noteon(synth, chan, 36 + random_below(48), 1 + random_below(127));
+		break;
+	}
+}
+
+static fluid_synth_t* create_synth(fluid_settings_t* settings, const char* soundfont, int polyphony)
+{
+	fluid_synth_t* synth;
+	int chan;
+
+	fluid_settings_setint(settings, "synth.polyphony", polyphony);
+	synth = new_fluid_synth(settings);
+	if (!synth || fluid_synth_sfload(synth, soundfont, 1) < 0)
+		return NULL;
+	for (chan = 0; chan < 16; chan++)
+		fluid_synth_program_change(synth, chan, chan == 9 ? 0 : chan * 7 % 128);
+	return synth;
+}
+
+int main(int argc, char** argv)
+{
+	static const int polyphonies[] = { 64, 256, 1024 };
+	static float buffer[64 * 2];
+	fluid_settings_t* settings;
+	fluid_synth_t* synth;
+	int checks = 0, failures = 0, i, p;
+
+	if (argc != 2)
+	{
+		fprintf(stderr, "usage: %s soundfont.sf2\n", argv[0]);
+		return 2;
+	}
+	settings = new_fluid_settings();
+	synth = create_synth(settings, argv[1], 64);
+	if (!synth)
+	{
+		fprintf(stderr, "%s: can't load %s\n", argv[0], argv[1]);
+		return 2;
+	}
+
+	while (checks < CHECKS)
+	{
+		fluid_voice_t *expected, *actual;
+
+		for (i = random_below(8); i >= 0; i--)
+			random_event(synth, buffer);
+
+		expected = linear_search(synth);
+		if (!expected)
+			continue;
+		actual = fluid_synth_free_voice_by_kill(synth);
+		if (actual != expected)
+		{
+			fprintf(stderr, "check %d: the heap killed voice %u, the linear search voice %u\n",
+				checks, actual ? fluid_voice_get_id(actual) : 0, fluid_voice_get_id(expected));
+			failures++;
+		}
+		checks++;
+	}
+	printf("%d victims compared, %d differ\n", checks, failures);
+	delete_fluid_synth(synth);
+
+	for (p = 0; p < (int)(sizeof(polyphonies) / sizeof(polyphonies[0])); p++)
+	{
+		double linear_ns = 0, heap_ns = 0, start;
+		int steals = 0;
+
+		synth = create_synth(settings, argv[1], polyphonies[p]);
+		if (!synth)
+			return 2;
+		while (steals < TIMED_STEALS)
+		{
+			fluid_voice_t* voice;
+
+			fluid_synth_noteon(synth, random_below(16), 36 + random_below(48), 1 + random_below(127));
+			if (random_below(16) == 0)
+				fluid_synth_write_float(synth, 64, buffer, 0, 2, buffer, 1, 2);
+
+			start = now_ns();
+			voice = linear_search(synth);
+			if (!voice)
+				continue;
+			linear_ns += now_ns() - start;
+
+			start = now_ns();
+			fluid_synth_free_voice_by_kill(synth);
+			heap_ns += now_ns() - start;
+			steals++;
+		}
+		printf("polyphony %4d: linear search %7.0f ns, heap %5.0f ns per steal\n",
+			polyphonies[p], linear_ns / steals, heap_ns / steals);
+		delete_fluid_synth(synth);
+	}
+
+	delete_fluid_settings(settings);
+	return failures ? 1 : 0;
+}
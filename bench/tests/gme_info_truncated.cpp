@@ -0,0 +1,163 @@
+/*
+ * gme_info_truncated: checks that gme_open_info_data() and gme_track_info()
+ * only read the bytes they are given.
+ *
+ *   gme_info_truncated [file...]
+ *
+ * Every prefix of the files, and of a header made up for each type that has
+ * no file in the tree, is opened for info. gme_open_info_data() parses the
+ * data in place, so each prefix is copied to the end of a page that is
+ * followed by an inaccessible one, where reading past it faults.
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include "gme.h"
+
+namespace {
+
+struct Sample {
+  std::string name;
+  std::vector<unsigned char> data;
+};
+
+std::vector<unsigned char> readFile(const char *path) {
+  std::vector<unsigned char> data;
+  FILE *f = fopen(path, "rb");
+  if (!f) return data;
+  unsigned char buf[65536];
+  size_t n;
+  while ((n = fread(buf, 1, sizeof(buf), f)) > 0) data.insert(data.end(), buf, buf + n);
+  fclose(f);
+  return data;
+}
+
+Sample header(const char *name, const char *tag, size_t size) {
+  Sample s;
+  s.name = name;
+  s.data.assign(size, 0);
+  memcpy(&s.data[0], tag, strlen(tag));
+  return s;
+}
+
+// Headers just big enough for the info loaders to accept them
+std::vector<Sample> madeUpHeaders() {
+  std::vector<Sample> samples;
+
+  Sample gbs = header("GBS header", "GBS\x01", 0x80);
+  gbs.data[4] = 3; // track count
+  gbs.data[5] = 1; // first track
+  memcpy(&gbs.data[0x10], "game", 4);
+  samples.push_back(gbs);
+
+  Sample kss = header("KSSX header", "KSSX", 0x30);
+  kss.data[0x0E] = 0x10; // extra header
+  kss.data[0x1A] = 4;    // last track
+  samples.push_back(kss);
+
+  samples.push_back(header("KSCC header", "KSCC", 0x20));
+
+  Sample hes = header("HES header", "HESM", 0x400);
+  const char *fields[] = {"game", "author", "copyright"};
+  for (int i = 0; i < 3; i++) memcpy(&hes.data[0x40 + i * 0x20], fields[i], strlen(fields[i]));
+  samples.push_back(hes);
+
+  return samples;
+}
+
+// A buffer whose last byte is the last readable one
+class GuardedBuffer {
+ public:
+  explicit GuardedBuffer(size_t capacity) {
+#ifndef _WIN32
+    page_ = (size_t)sysconf(_SC_PAGESIZE);
+    size_ = (capacity + page_ - 1) / page_ * page_ + page_;
+    void *p = mmap(NULL, size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    base_ = p == MAP_FAILED ? NULL : (unsigned char *)p;
+    if (base_) mprotect(base_ + size_ - page_, page_, PROT_NONE);
+#else
+    size_ = capacity;
+    base_ = new unsigned char[capacity ? capacity : 1];
+#endif
+  }
+  ~GuardedBuffer() {
+#ifndef _WIN32
+    if (base_) munmap(base_, size_);
+#else
+    delete[] base_;
+#endif
+  }
+  bool ok() const { return base_ != NULL; }
+
+  const unsigned char *place(const unsigned char *data, size_t length) {
+#ifndef _WIN32
+    unsigned char *end = base_ + size_ - page_;
+#else
+    unsigned char *end = base_ + size_;
+#endif
+    memcpy(end - length, data, length);
+    return end - length;
+  }
+
+ private:
+  unsigned char *base_;
+  size_t size_;
+  size_t page_;
+};
+
+int openCount(const unsigned char *data, long length) {
+  gme_t *emu;
+  if (gme_open_info_data(data, length, &emu)) return 0;
+  for (int i = 0; i < gme_track_count(emu); i++) {
+    gme_info_t *info;
+    if (!gme_track_info(emu, &info, i)) gme_free_info(info);
+  }
+  gme_delete(emu);
+  return 1;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  std::vector<Sample> samples = madeUpHeaders();
+  for (int i = 1; i < argc; i++) {
+    Sample s;
+    s.name = argv[i];
+    s.data = readFile(argv[i]);
+    if (s.data.empty()) {
+      fprintf(stderr, "%s: can't read\n", argv[i]);
+      return 1;
+    }
+    samples.push_back(s);
+  }
+
+  int failures = 0;
+  for (size_t i = 0; i < samples.size(); i++) {
+    const Sample &s = samples[i];
+    GuardedBuffer buffer(s.data.size());
+    if (!buffer.ok()) {
+      fprintf(stderr, "%s: out of memory\n", s.name.c_str());
+      return 1;
+    }
+
+    if (!openCount(buffer.place(&s.data[0], s.data.size()), (long)s.data.size())) {
+      fprintf(stderr, "%s: whole file doesn't open\n", s.name.c_str());
+      failures++;
+      continue;
+    }
+
+    int opened = 0;
+    for (size_t length = 0; length < s.data.size(); length++)
+      opened += openCount(buffer.place(&s.data[0], length), (long)length);
+    printf("%s: %zu bytes, %d of the shorter prefixes open\n", s.name.c_str(), s.data.size(), opened);
+  }
+  return failures ? 1 : 0;
+}
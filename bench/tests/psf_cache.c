@@ -0,0 +1,147 @@
+/*
+ * psf_cache: checks that psflib's library cache notices a library whose
+ * reserved section changed on disk.
+ *
+ *   psf_cache directory
+ *
+ * Writes a track and a library to the directory, the way USF sets are made:
+ * all of the data is in the reserved sections and the exe sections are empty.
+ * The track is loaded twice, which has to use the cached library the second
+ * time, then the library is written again with other data of the same size,
+ * which the next load has to pass on instead of the cached data.
+ */
+
+#include "psflib.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define LIB_RESERVED_SIZE 100000
+
+static void* stdio_fopen(void* context, const char* path)
+{
+	return fopen(path, "rb");
+}
+
+static size_t stdio_fread(void* buffer, size_t size, size_t count, void* handle)
+{
+	return fread(buffer, size, count, (FILE*)handle);
+}
+
+static int stdio_fseek(void* handle, int64_t offset, int whence)
+{
+	return fseek((FILE*)handle, (long)offset, whence);
+}
+
+static int stdio_fclose(void* handle)
+{
+	return fclose((FILE*)handle);
+}
+
+static long stdio_ftell(void* handle)
+{
+	return ftell((FILE*)handle);
+}
+
+static const psf_file_callbacks stdio_callbacks = {
+	"\\/", NULL, stdio_fopen, stdio_fread, stdio_fseek, stdio_fclose, stdio_ftell
+};
+
+/* What the last load passed for the library */
+struct loaded {
+	int files;
+	const uint8_t* lib_reserved;
+	uint8_t lib_first, lib_last;
+};
+
+static int load_target(void* context, const uint8_t* exe, size_t exe_size,
+	const uint8_t* reserved, size_t reserved_size)
+{
+	struct loaded* loaded = (struct loaded*)context;
+	if (loaded->files++ == 0 && reserved_size == LIB_RESERVED_SIZE)
+	{
+		loaded->lib_reserved = reserved;
+		loaded->lib_first = reserved[0];
+		loaded->lib_last = reserved[reserved_size - 1];
+	}
+	return 0;
+}
+
+static int write_psf(const char* path, const uint8_t* reserved, uint32_t reserved_size, const char* tags)
+{
+	uint8_t header[16] = { 'P', 'S', 'F', 0x21 };
+	FILE* f = fopen(path, "wb");
+	int i;
+
+	if (!f)
+		return -1;
+	for (i = 0; i < 4; i++)
+		header[4 + i] = (uint8_t)(reserved_size >> (i * 8));
+	fwrite(header, 1, 16, f);
+	fwrite(reserved, 1, reserved_size, f);
+	if (tags)
+		fprintf(f, "[TAG]%s", tags);
+	return fclose(f);
+}
+
+static int load(const char* track, struct loaded* loaded)
+{
+	memset(loaded, 0, sizeof(*loaded));
+	return psf_load(track, &stdio_callbacks, 0x21, load_target, loaded, NULL, NULL, 0, NULL, NULL);
+}
+
+int main(int argc, char** argv)
+{
+	static uint8_t lib_reserved[LIB_RESERVED_SIZE];
+	static const uint8_t track_reserved[16];
+	char lib_path[4096], track_path[4096];
+	struct loaded first, second, third;
+	int failures = 0;
+
+	if (argc != 2)
+	{
+		fprintf(stderr, "usage: %s directory\n", argv[0]);
+		return 2;
+	}
+	snprintf(lib_path, sizeof(lib_path), "%s/psf_cache.usflib", argv[1]);
+	snprintf(track_path, sizeof(track_path), "%s/psf_cache.miniusf", argv[1]);
+
+	memset(lib_reserved, 1, sizeof(lib_reserved));
+	if (write_psf(lib_path, lib_reserved, sizeof(lib_reserved), NULL) ||
+		write_psf(track_path, track_reserved, sizeof(track_reserved), "\n_lib=psf_cache.usflib\n"))
+	{
+		fprintf(stderr, "%s: can't write the files\n", argv[1]);
+		return 2;
+	}
+
+	if (load(track_path, &first) < 0 || load(track_path, &second) < 0)
+	{
+		fprintf(stderr, "%s: can't load\n", track_path);
+		return 1;
+	}
+	if (second.lib_reserved != first.lib_reserved)
+	{
+		fprintf(stderr, "the unchanged library was read again\n");
+		failures++;
+	}
+
+	memset(lib_reserved, 2, sizeof(lib_reserved));
+	write_psf(lib_path, lib_reserved, sizeof(lib_reserved), NULL);
+	if (load(track_path, &third) < 0)
+	{
+		fprintf(stderr, "%s: can't load\n", track_path);
+		return 1;
+	}
+	if (third.lib_first != 2 || third.lib_last != 2)
+	{
+		fprintf(stderr, "the changed library came from the cache\n");
+		failures++;
+	}
+
+	psf_cache_clear();
+	remove(lib_path);
+	remove(track_path);
+	printf("%d of 2 checks failed\n", failures);
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,75 @@
+/*
+ * tsf_threads: checks that TinySoundFont renders the same samples on several
+ * threads as on one.
+ *
+ *   tsf_threads soundfont.sf2
+ *
+ * Every preset plays a chord, rendered in a single long call so that one-shot
+ * voices finish partway through it, and the output of one thread has to match
+ * that of four threads bit for bit, in each output mode.
+ */
+
+#define TSF_IMPLEMENTATION
+#define TSF_THREADS
+#include "tsf.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define SAMPLE_RATE 44100
+#define RENDER_SAMPLES (8 * SAMPLE_RATE)
+
+static float single[RENDER_SAMPLES * 2], threaded[RENDER_SAMPLES * 2];
+
+static void render(tsf* f, int preset, enum TSFOutputMode mode, float* out)
+{
+	tsf_reset(f);
+	tsf_set_output(f, mode, SAMPLE_RATE, 0);
+	tsf_note_on(f, preset, 60, 1.0f);
+	tsf_note_on(f, preset, 64, 1.0f);
+	tsf_note_on(f, preset, 67, 1.0f);
+	tsf_render_float(f, out, RENDER_SAMPLES, 0);
+}
+
+int main(int argc, char** argv)
+{
+	static const enum TSFOutputMode modes[] = { TSF_STEREO_INTERLEAVED, TSF_STEREO_UNWEAVED, TSF_MONO };
+	tsf *one, *four;
+	int preset, mode, failures = 0;
+
+	if (argc != 2)
+	{
+		fprintf(stderr, "usage: %s soundfont.sf2\n", argv[0]);
+		return 2;
+	}
+	one = tsf_load_filename(argv[1]);
+	four = tsf_load_filename(argv[1]);
+	if (!one || !four)
+	{
+		fprintf(stderr, "%s: can't load %s\n", argv[0], argv[1]);
+		return 2;
+	}
+	tsf_set_threads(four, 4);
+
+	for (preset = 0; preset != tsf_get_presetcount(one); preset++)
+	{
+		for (mode = 0; mode != 3; mode++)
+		{
+			int size = (modes[mode] == TSF_MONO ? 1 : 2) * RENDER_SAMPLES * sizeof(float);
+			render(one, preset, modes[mode], single);
+			render(four, preset, modes[mode], threaded);
+			if (memcmp(single, threaded, size) != 0)
+			{
+				fprintf(stderr, "preset %d (%s), output mode %d: 4 threads differ from 1\n",
+					preset, tsf_get_presetname(one, preset), mode);
+				failures++;
+			}
+		}
+	}
+
+	tsf_close(one);
+	tsf_close(four);
+	if (failures) return 1;
+	printf("tsf_threads: OK\n");
+	return 0;
+}
@@ -0,0 +1,147 @@
+/*
+ * v2_threads: checks that the V2 synth renders the same samples with its
+ * voices on a worker pool as without.
+ *
+ *   v2_threads
+ *
+ * There are no V2M files in the tree, so the synth gets a patch map made from
+ * v2initsnd with a few variations, and random notes and program changes on
+ * channels 0 to 14. Channel 15 is left out, it goes to Ronan, which needs
+ * lyrics. Some of the patches read the AuxA bus, so their channels stay in
+ * the serial pass, next to channels rendered by the workers. The output has
+ * to match the serial synth's bit for bit, for each number of threads.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "sounddef.h"
+#include "synth.h"
+
+namespace {
+
+const int SAMPLE_RATE = 44100;
+const int BLOCK_FRAMES = 1024;
+const int BLOCKS = 300;
+const int CHANNELS = 15;
+
+// Offsets into a patch, in the order of v2parms
+enum {
+  OSC1_MODE = 2, OSC2_MODE = 8, OSC3_MODE = 14, OSC3_VOLUME = 19,
+  VCF1_MODE = 20, VCF2_MODE = 23, ROUTING = 26, VOICE_DIST = 28,
+  AUXA_SEND = 62, REVERB = 64, DELAY = 65, CHAN_DIST = 68,
+  CHORUS_AMOUNT = 72, COMPRESSOR = 79, MAXPOLY = 88
+};
+
+unsigned int g_seed = 12345;
+
+int nextRandom(int n) {
+  g_seed = g_seed * 1103515245u + 12345u;
+  return (g_seed >> 16) % n;
+}
+
+std::vector<unsigned char> makePatchMap() {
+  static const struct {
+    int param, value;
+  } variations[][4] = {
+    {{MAXPOLY, 4}},
+    {{OSC1_MODE, 2}, {OSC2_MODE, 5}, {VCF1_MODE, 2}, {VOICE_DIST, 1}},
+    {{OSC1_MODE, 4}, {OSC3_MODE, 3}, {ROUTING, 1}, {VCF2_MODE, 3}},
+    {{OSC2_MODE, 6}, {OSC3_MODE, 3}, {OSC3_VOLUME, 100}, {MAXPOLY, 3}},  // reads AuxA
+    {{OSC1_MODE, 3}, {AUXA_SEND, 90}, {REVERB, 64}, {DELAY, 64}},
+    {{CHAN_DIST, 2}, {CHORUS_AMOUNT, 100}, {COMPRESSOR, 1}, {MAXPOLY, 6}},
+  };
+  const int count = sizeof(variations) / sizeof(variations[0]);
+
+  std::vector<unsigned char> map(128 * 4);
+  for (int pgm = 0; pgm < 128; pgm++) {
+    unsigned int offset = (unsigned int)map.size();
+    for (int i = 0; i < 4; i++) map[pgm * 4 + i] = (unsigned char)(offset >> (i * 8));
+
+    std::vector<unsigned char> patch(v2initsnd, v2initsnd + v2soundsize);
+    for (int i = 0; i < 4; i++) {
+      int param = variations[pgm % count][i].param;
+      if (param) patch[param] = (unsigned char)variations[pgm % count][i].value;
+    }
+    map.insert(map.end(), patch.begin(), patch.end());
+  }
+  return map;
+}
+
+void *createSynth(const std::vector<unsigned char> &patchMap, int threads) {
+  void *synth = calloc(1, synthGetSize());
+  if (!synth) return NULL;
+  synthInit(synth, &patchMap[0], SAMPLE_RATE);
+  synthSetGlobals(synth, v2initglobs);
+  synthSetThreads(synth, threads);
+  return synth;
+}
+
+std::vector<unsigned char> randomEvents() {
+  std::vector<unsigned char> midi;
+  for (int chan = 0; chan < CHANNELS; chan++) {
+    if (nextRandom(8) == 0) {
+      midi.push_back((unsigned char)(0xC0 | chan));
+      midi.push_back((unsigned char)nextRandom(128));
+    }
+    for (int i = nextRandom(3); i > 0; i--) {
+      midi.push_back((unsigned char)(0x90 | chan));
+      midi.push_back((unsigned char)(36 + nextRandom(48)));
+      midi.push_back((unsigned char)(nextRandom(3) ? 1 + nextRandom(126) : 0));
+    }
+  }
+  midi.push_back(0xfd);
+  return midi;
+}
+
+}  // namespace
+
+int main() {
+  static const int threadCounts[] = {2, 4, 16};
+  if (v2nparms != MAXPOLY + 1) {
+    fprintf(stderr, "the patch offsets don't match v2parms\n");
+    return 1;
+  }
+  std::vector<unsigned char> patchMap = makePatchMap();
+  int failures = 0;
+
+  for (size_t t = 0; t < sizeof(threadCounts) / sizeof(threadCounts[0]); t++) {
+    void *serial = createSynth(patchMap, 0);
+    void *threaded = createSynth(patchMap, threadCounts[t]);
+    if (!serial || !threaded) {
+      fprintf(stderr, "out of memory\n");
+      return 1;
+    }
+
+    g_seed = 12345;
+    std::vector<float> expected(BLOCK_FRAMES * 2), actual(BLOCK_FRAMES * 2);
+    double energy = 0;
+    int block = 0;
+    for (; block < BLOCKS; block++) {
+      std::vector<unsigned char> midi = randomEvents();
+      synthProcessMIDI(serial, &midi[0]);
+      synthProcessMIDI(threaded, &midi[0]);
+      synthRender(serial, &expected[0], BLOCK_FRAMES);
+      synthRender(threaded, &actual[0], BLOCK_FRAMES);
+
+      if (memcmp(&expected[0], &actual[0], expected.size() * sizeof(float))) break;
+      for (size_t i = 0; i < expected.size(); i++) energy += expected[i] * expected[i];
+    }
+
+    if (block < BLOCKS) {
+      fprintf(stderr, "%d threads: block %d differs\n", threadCounts[t], block);
+      failures++;
+    } else if (energy == 0) {
+      fprintf(stderr, "%d threads: silent\n", threadCounts[t]);
+      failures++;
+    } else {
+      printf("%d threads: %d blocks match\n", threadCounts[t], BLOCKS);
+    }
+
+    free(serial);
+    free(threaded);
+  }
+  return failures ? 1 : 0;
+}
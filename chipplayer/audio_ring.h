@@ -0,0 +1,98 @@
+/*
+ * Single producer, single consumer ring of interleaved stereo float frames.
+ *
+ * One thread writes and one thread reads, without locks. Positions count
+ * frames since the ring was made and wrap around with size_t, so the
+ * difference of two positions is right as long as they are less than
+ * 2^31 frames apart, which the capacity ensures.
+ */
+
+#ifndef AUDIO_RING_H
+#define AUDIO_RING_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <vector>
+
+class AudioRing {
+public:
+  static const int CHANNELS = 2;
+
+  // The capacity is rounded up to a power of two
+  explicit AudioRing(size_t frames) : m_read(0), m_write(0) {
+    size_t capacity = 1;
+    while (capacity < frames)
+      capacity <<= 1;
+    m_mask = capacity - 1;
+    m_data.resize(capacity * CHANNELS);
+  }
+
+  size_t capacity() const { return m_mask + 1; }
+
+  // ---- Producer side ----
+
+  size_t writePos() const { return m_write.load(std::memory_order_relaxed); }
+
+  size_t writable() const {
+    return capacity() - (writePos() - m_read.load(std::memory_order_acquire));
+  }
+
+  // The free frames that follow each other in memory from the write
+  // position, at most the whole free space
+  size_t writeRegion(float **frames) {
+    size_t pos = writePos() & m_mask;
+    size_t n = capacity() - pos;
+    size_t space = writable();
+    *frames = &m_data[pos * CHANNELS];
+    return n < space ? n : space;
+  }
+
+  // Publishes frames written to the region
+  void commitWrite(size_t frames) {
+    m_write.store(writePos() + frames, std::memory_order_release);
+  }
+
+  // ---- Consumer side ----
+
+  size_t readPos() const { return m_read.load(std::memory_order_relaxed); }
+
+  size_t readable() const {
+    return m_write.load(std::memory_order_acquire) - readPos();
+  }
+
+  // Copies up to 'frames' frames to 'out' and returns how many
+  size_t read(float *out, size_t frames) {
+    size_t available = readable();
+    if (frames > available)
+      frames = available;
+    size_t pos = readPos() & m_mask;
+    size_t first = capacity() - pos;
+    if (first > frames)
+      first = frames;
+    std::memcpy(out, &m_data[pos * CHANNELS], first * CHANNELS * sizeof(float));
+    std::memcpy(out + first * CHANNELS, &m_data[0], (frames - first) * CHANNELS * sizeof(float));
+    m_read.store(readPos() + frames, std::memory_order_release);
+    return frames;
+  }
+
+  // Drops the frames before 'pos', a position the producer has reached
+  void skipTo(size_t pos) {
+    if ((std::ptrdiff_t)(pos - readPos()) > 0)
+      m_read.store(pos, std::memory_order_release);
+  }
+
+private:
+  AudioRing(const AudioRing &);
+  AudioRing &operator=(const AudioRing &);
+
+  size_t m_mask;
+  std::vector<float> m_data;
+  // Each side's position on its own cache line
+  char m_pad0[64];
+  std::atomic<size_t> m_read;
+  char m_pad1[64];
+  std::atomic<size_t> m_write;
+};
+
+#endif // AUDIO_RING_H
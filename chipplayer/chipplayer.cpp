@@ -0,0 +1,598 @@
+//
+// One streaming interface over the chip-core engines, see chipplayer.h.
+//
+
+#include "chipplayer.h"
+#include "audio_ring.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#ifdef CHIPPLAYER_THREADS
+#include <chrono>
+#include <condition_variable>
+#include <thread>
+#endif
+
+#include "gme.h"
+#include "xmp.h"
+
+extern "C" {
+// tinysoundfont/tinyplayer.c
+struct TinyPlayer;
+TinyPlayer *tp_create(int sampleRate);
+void tp_destroy(TinyPlayer *tp);
+void tp_ctx_open(TinyPlayer *tp, const void *data, int length);
+int tp_ctx_write_audio(TinyPlayer *tp, float *buffer, int bufferSize);
+unsigned int tp_ctx_get_duration_ms(TinyPlayer *tp);
+double tp_ctx_get_position_ms(TinyPlayer *tp);
+void tp_ctx_seek(TinyPlayer *tp, int ms);
+int tp_ctx_load_soundfont(TinyPlayer *tp, const char *filename);
+int tp_ctx_set_synth_engine(TinyPlayer *tp, int synthId);
+
+// farbrausch-v2m/v2mwrapper.cpp
+struct V2MContext;
+V2MContext *v2m_create();
+void v2m_destroy(V2MContext *ctx);
+int v2m_ctx_open(V2MContext *ctx, uint8_t *data, int length, int sample_rate);
+int v2m_ctx_write_audio(V2MContext *ctx, float *buffer, int buffer_size);
+float v2m_ctx_get_position_ms(V2MContext *ctx);
+float v2m_ctx_get_duration_ms(V2MContext *ctx);
+void v2m_ctx_seek_ms(V2MContext *ctx, int position_ms);
+
+// lazyusf2/_wothke/n64plug.cpp
+int32_t n64_load_file(const char *uri, int16_t *output_buffer, uint16_t outSize, int32_t samp_rate);
+int32_t n64_get_duration_ms();
+int32_t n64_get_position_ms();
+int32_t n64_render_audio(int16_t *output_buffer, uint16_t outSize);
+void n64_seek_ms(int msec);
+void n64_shutdown();
+}
+
+namespace {
+
+// Most frames an engine renders per call when filling the ring
+const int BLOCK_FRAMES = 1024;
+// Keeps ring positions well apart from wrapping, see audio_ring.h
+const int MAX_RING_FRAMES = 1 << 22;
+// Fade out after the play length of gme tracks, as GMEPlayer.js does
+const int GME_FADE_MS = 4000;
+
+// Engines keep some tables in globals which they set up on first use
+std::mutex g_open_mutex;
+// n64plug.cpp is a single global instance
+std::atomic<bool> g_n64_in_use(false);
+
+// One open file. render() writes up to 'frames' interleaved stereo frames
+// and returns how many it wrote; 0 means the track has ended. open() returns
+// an error message, or NULL on success.
+class Engine {
+public:
+  virtual ~Engine() {}
+  virtual const char *open(const char *path, const void *data, int length) = 0;
+  virtual int render(float *out, int frames) = 0;
+  virtual void seek(int ms) = 0;
+  virtual int positionMs() = 0;
+  virtual int durationMs() = 0;
+};
+
+class GmeEngine : public Engine {
+  gme_t *m_emu;
+  int m_sampleRate;
+  int m_playLength;
+  std::vector<float> m_left, m_right;
+
+public:
+  explicit GmeEngine(int sampleRate) : m_emu(NULL), m_sampleRate(sampleRate), m_playLength(0) {}
+  ~GmeEngine() { gme_delete(m_emu); }
+
+  const char *open(const char *, const void *data, int length) {
+    gme_err_t err = gme_open_data(data, length, &m_emu, m_sampleRate);
+    if (!err) err = gme_start_track(m_emu, 0);
+    if (err) return err;
+    gme_info_t *info;
+    if (!gme_track_info(m_emu, &info, 0)) {
+      m_playLength = info->play_length;
+      gme_free_info(info);
+    }
+    gme_set_fade(m_emu, m_playLength, GME_FADE_MS);
+    return NULL;
+  }
+
+  int render(float *out, int frames) {
+    if (gme_track_ended(m_emu)) return 0;
+    m_left.resize(frames);
+    m_right.resize(frames);
+    if (gme_play_float_planar(m_emu, frames, &m_left[0], &m_right[0])) return 0;
+    for (int i = 0; i < frames; i++) {
+      out[2 * i] = m_left[i];
+      out[2 * i + 1] = m_right[i];
+    }
+    return frames;
+  }
+
+  void seek(int ms) {
+    gme_seek_scaled(m_emu, ms);
+    // Seeking backward restarts the track, which clears the fade
+    gme_set_fade(m_emu, m_playLength, GME_FADE_MS);
+  }
+
+  int positionMs() { return gme_tell_scaled(m_emu); }
+  int durationMs() { return m_playLength; }
+};
+
+class XmpEngine : public Engine {
+  xmp_context m_ctx;
+  int m_sampleRate;
+  bool m_loaded, m_playing;
+  std::vector<int16_t> m_pcm;
+
+public:
+  explicit XmpEngine(int sampleRate)
+      : m_ctx(xmp_create_context()), m_sampleRate(sampleRate), m_loaded(false), m_playing(false) {}
+  ~XmpEngine() {
+    if (m_playing) xmp_end_player(m_ctx);
+    if (m_loaded) xmp_release_module(m_ctx);
+    xmp_free_context(m_ctx);
+  }
+
+  const char *open(const char *, const void *data, int length) {
+    if (xmp_load_module_from_memory(m_ctx, const_cast<void *>(data), length) != 0)
+      return "libxmp can't load this module";
+    m_loaded = true;
+    if (xmp_start_player(m_ctx, m_sampleRate, 0) != 0)
+      return "libxmp can't start the player";
+    m_playing = true;
+    return NULL;
+  }
+
+  int render(float *out, int frames) {
+    m_pcm.resize(frames * 2);
+    // Plays the module once, as XMPPlayer.js does
+    if (xmp_play_buffer(m_ctx, &m_pcm[0], frames * 4, 1) != 0) return 0;
+    for (int i = 0; i < frames * 2; i++)
+      out[i] = m_pcm[i] * (1.0f / 32768.0f);
+    return frames;
+  }
+
+  void seek(int ms) { xmp_seek_time(m_ctx, ms); }
+
+  int positionMs() {
+    xmp_frame_info info;
+    xmp_get_frame_info(m_ctx, &info);
+    return info.time;
+  }
+
+  int durationMs() {
+    xmp_frame_info info;
+    xmp_get_frame_info(m_ctx, &info);
+    return info.total_time;
+  }
+};
+
+class MidiEngine : public Engine {
+  TinyPlayer *m_tp;
+  int m_synthId;
+  std::string m_soundFont;
+
+public:
+  // synthId as in tinyplayer: 0 for fluidlite, 1 for libADLMIDI
+  MidiEngine(int sampleRate, int synthId, const std::string &soundFont)
+      : m_tp(tp_create(sampleRate)), m_synthId(synthId), m_soundFont(soundFont) {}
+  ~MidiEngine() { tp_destroy(m_tp); }
+
+  const char *open(const char *, const void *data, int length) {
+    if (m_synthId == 0 && (m_soundFont.empty() || tp_ctx_load_soundfont(m_tp, m_soundFont.c_str()) < 0))
+      return "fluidlite can't load the SoundFont";
+    tp_ctx_set_synth_engine(m_tp, m_synthId);
+    tp_ctx_open(m_tp, data, length);
+    if (tp_ctx_get_duration_ms(m_tp) == 0) return "not a MIDI file";
+    return NULL;
+  }
+
+  int render(float *out, int frames) { return tp_ctx_write_audio(m_tp, out, frames) / 2; }
+  void seek(int ms) { tp_ctx_seek(m_tp, ms); }
+  int positionMs() { return (int)tp_ctx_get_position_ms(m_tp); }
+  int durationMs() { return (int)tp_ctx_get_duration_ms(m_tp); }
+};
+
+class V2mEngine : public Engine {
+  V2MContext *m_ctx;
+  int m_sampleRate;
+
+public:
+  explicit V2mEngine(int sampleRate) : m_ctx(v2m_create()), m_sampleRate(sampleRate) {}
+  ~V2mEngine() { v2m_destroy(m_ctx); }
+
+  const char *open(const char *, const void *data, int length) {
+    if (v2m_ctx_open(m_ctx, (uint8_t *)data, length, m_sampleRate) != 0) return "not a V2M file";
+    return NULL;
+  }
+
+  int render(float *out, int frames) { return v2m_ctx_write_audio(m_ctx, out, frames); }
+  void seek(int ms) { v2m_ctx_seek_ms(m_ctx, ms); }
+  int positionMs() { return (int)v2m_ctx_get_position_ms(m_ctx); }
+  int durationMs() { return (int)v2m_ctx_get_duration_ms(m_ctx); }
+};
+
+class N64Engine : public Engine {
+  int m_sampleRate;
+  bool m_owner, m_loaded;
+  std::vector<int16_t> m_pcm;
+
+public:
+  explicit N64Engine(int sampleRate) : m_sampleRate(sampleRate), m_owner(false), m_loaded(false) {}
+  ~N64Engine() {
+    if (m_loaded) n64_shutdown();
+    if (m_owner) g_n64_in_use = false;
+  }
+
+  const char *open(const char *path, const void *, int) {
+    if (g_n64_in_use.exchange(true)) return "the n64 engine is playing another file";
+    m_owner = true;
+    m_pcm.resize(BLOCK_FRAMES * 2);
+    // The _lib files are read from the directory of the file
+    if (!path || n64_load_file(path, &m_pcm[0], BLOCK_FRAMES, m_sampleRate) != 0)
+      return "lazyusf2 can't load this file";
+    m_loaded = true;
+    return NULL;
+  }
+
+  int render(float *out, int frames) {
+    frames = std::min(frames, 0xFFFF);
+    m_pcm.resize(frames * 2);
+    int got = n64_render_audio(&m_pcm[0], (uint16_t)frames);
+    if (got <= 0) return 0;
+    for (int i = 0; i < got * 2; i++)
+      out[i] = m_pcm[i] * (1.0f / 32768.0f);
+    return got;
+  }
+
+  void seek(int ms) { n64_seek_ms(ms); }
+  int positionMs() { return n64_get_position_ms(); }
+  int durationMs() { return n64_get_duration_ms(); }
+};
+
+Engine *createEngine(int engine, int sampleRate, const std::string &soundFont) {
+  switch (engine) {
+    case CP_ENGINE_GME: return new GmeEngine(sampleRate);
+    case CP_ENGINE_XMP: return new XmpEngine(sampleRate);
+    case CP_ENGINE_FLUIDLITE: return new MidiEngine(sampleRate, 0, soundFont);
+    case CP_ENGINE_ADLMIDI: return new MidiEngine(sampleRate, 1, soundFont);
+    case CP_ENGINE_V2M: return new V2mEngine(sampleRate);
+    case CP_ENGINE_N64: return new N64Engine(sampleRate);
+    default: return NULL;
+  }
+}
+
+std::string lowerExtension(const char *path) {
+  const char *dot = strrchr(path, '.');
+  if (!dot || strchr(dot, '/') || strchr(dot, '\\')) return std::string();
+  std::string ext(dot + 1);
+  for (size_t i = 0; i < ext.size(); i++)
+    ext[i] = (char)tolower((unsigned char)ext[i]);
+  return ext;
+}
+
+} // namespace
+
+struct ChipPlayer {
+  int sampleRate;
+  int ringFrames;
+  std::string soundFont;
+  std::string error;
+  int engineId;
+  std::unique_ptr<Engine> engine;
+  std::unique_ptr<AudioRing> ring;
+
+  // Guards the engine. Whoever renders holds it for one block at a time;
+  // 'waiting' tells the producer to step aside for cp_seek_ms() and the like.
+  std::mutex mutex;
+  std::atomic<int> waiting;
+  std::atomic<bool> ended;
+  std::atomic<int> positionMs;
+  std::atomic<unsigned int> underruns;
+
+  // A seek hands the ring position it happened at over to the consumer,
+  // which drops the frames before it
+  std::atomic<bool> seekPending;
+  std::atomic<size_t> seekRingPos;
+  std::atomic<int> seekBaseMs;
+
+  // Consumer side: cp_render() returns the frame at 'pos' at baseMs plus the
+  // frames between originPos and pos. Without a ring, pos is renderedPos.
+  size_t originPos;
+  size_t renderedPos;
+  int baseMs;
+
+#ifdef CHIPPLAYER_THREADS
+  std::thread producer;
+  std::condition_variable wake;
+  bool quit;
+#endif
+};
+
+namespace {
+
+// Takes the engine from the producer
+class EngineLock {
+  ChipPlayer *m_cp;
+  std::unique_lock<std::mutex> m_lock;
+
+public:
+  explicit EngineLock(ChipPlayer *cp) : m_cp(cp), m_lock(cp->mutex, std::defer_lock) {
+    ++cp->waiting;
+    m_lock.lock();
+  }
+  ~EngineLock() {
+    m_lock.unlock();
+    --m_cp->waiting;
+#ifdef CHIPPLAYER_THREADS
+    m_cp->wake.notify_one();
+#endif
+  }
+};
+
+// Frames in the ring that cp_render() hasn't taken yet
+size_t ringFill(ChipPlayer *cp) {
+  return cp->ring->capacity() - cp->ring->writable();
+}
+
+// Renders one block into the ring, unless 'ahead' frames, counted from where
+// playback will continue, are already ringFrames or more. Called with the
+// engine locked.
+int produceBlock(ChipPlayer *cp, size_t ahead) {
+  if (!cp->engine || cp->ended || ahead >= (size_t)cp->ringFrames) return 0;
+  float *frames;
+  size_t n = cp->ring->writeRegion(&frames);
+  n = std::min(n, std::min<size_t>(cp->ringFrames - ahead, BLOCK_FRAMES));
+  if (n == 0) return 0;
+  int got = cp->engine->render(frames, (int)n);
+  if (got <= 0) {
+    cp->ended = true;
+    return 0;
+  }
+  cp->ring->commitWrite(got);
+  return got;
+}
+
+#ifdef CHIPPLAYER_THREADS
+void producerMain(ChipPlayer *cp) {
+  // Sleep for half a block when there's nothing to do
+  const std::chrono::microseconds idle(BLOCK_FRAMES * 500000LL / cp->sampleRate);
+  std::unique_lock<std::mutex> lock(cp->mutex);
+  while (!cp->quit) {
+    if (cp->waiting == 0 && produceBlock(cp, ringFill(cp)) > 0) {
+      lock.unlock();
+      lock.lock();
+    } else {
+      cp->wake.wait_for(lock, idle);
+    }
+  }
+}
+
+void stopProducer(ChipPlayer *cp) {
+  if (!cp->producer.joinable()) return;
+  {
+    std::lock_guard<std::mutex> lock(cp->mutex);
+    cp->quit = true;
+  }
+  cp->wake.notify_one();
+  cp->producer.join();
+}
+#endif
+
+// Catches up with seeks made since the last cp_render()
+void applySeek(ChipPlayer *cp) {
+  if (!cp->seekPending.exchange(false, std::memory_order_acq_rel)) return;
+  size_t pos = cp->seekRingPos.load(std::memory_order_acquire);
+  cp->baseMs = cp->seekBaseMs.load(std::memory_order_acquire);
+  cp->ring->skipTo(pos);
+  cp->originPos = pos;
+}
+
+void updatePosition(ChipPlayer *cp, size_t pos) {
+  int64_t frames = (int64_t)(std::ptrdiff_t)(pos - cp->originPos);
+  cp->positionMs = cp->baseMs + (int)(frames * 1000 / cp->sampleRate);
+}
+
+} // namespace
+
+extern "C" {
+
+ChipPlayer *cp_create(int sample_rate, int ring_frames) {
+  ChipPlayer *cp = new ChipPlayer();
+  cp->sampleRate = sample_rate;
+  cp->ringFrames = std::min(std::max(ring_frames, 0), MAX_RING_FRAMES);
+  cp->engineId = CP_ENGINE_AUTO;
+  cp->waiting = 0;
+  cp->ended = true;
+  cp->positionMs = 0;
+  cp->underruns = 0;
+  cp->seekPending = false;
+  cp->seekRingPos = 0;
+  cp->seekBaseMs = 0;
+  cp->originPos = cp->renderedPos = 0;
+  cp->baseMs = 0;
+#ifdef CHIPPLAYER_THREADS
+  cp->quit = false;
+#endif
+  return cp;
+}
+
+void cp_destroy(ChipPlayer *cp) {
+  if (!cp) return;
+  cp_close(cp);
+  delete cp;
+}
+
+int cp_identify(const char *path, const void *data, int length) {
+  std::string ext = lowerExtension(path ? path : "");
+  if (ext == "mid" || ext == "midi" || ext == "rmi" || ext == "smf") return CP_ENGINE_ADLMIDI;
+  if (ext == "v2m") return CP_ENGINE_V2M;
+  if (ext == "usf" || ext == "miniusf") return CP_ENGINE_N64;
+  if (path && gme_identify_extension(path)) return CP_ENGINE_GME;
+  if (data && length >= 4 && *gme_identify_header(data)) return CP_ENGINE_GME;
+  return CP_ENGINE_XMP;
+}
+
+const char *cp_engine_name(int engine) {
+  static const char *const names[CP_NUM_ENGINES] = {
+      "auto", "gme", "libxmp", "fluidlite", "libADLMIDI", "v2m", "n64"};
+  return engine >= 0 && engine < CP_NUM_ENGINES ? names[engine] : "unknown";
+}
+
+int cp_load_soundfont(ChipPlayer *cp, const char *filename) {
+  cp->soundFont = filename ? filename : "";
+  return 0;
+}
+
+int cp_open(ChipPlayer *cp, const char *path, const void *data, int length, int engine) {
+  cp_close(cp);
+  if (engine == CP_ENGINE_AUTO) engine = cp_identify(path, data, length);
+
+  std::unique_ptr<Engine> e(createEngine(engine, cp->sampleRate, cp->soundFont));
+  if (!e) {
+    cp->error = "unknown engine";
+    return -1;
+  }
+  const char *err;
+  {
+    std::lock_guard<std::mutex> lock(g_open_mutex);
+    err = e->open(path, data, length);
+  }
+  if (err) {
+    cp->error = err;
+    return -1;
+  }
+
+  cp->error.clear();
+  cp->engineId = engine;
+  cp->engine.swap(e);
+  cp->ended = false;
+  cp->underruns = 0;
+  cp->seekPending = false;
+  cp->originPos = cp->renderedPos = 0;
+  cp->baseMs = cp->engine->positionMs();
+  cp->positionMs = cp->baseMs;
+  if (cp->ringFrames > 0) {
+    // Start with a full ring so the first cp_render() calls don't underrun.
+    // Twice the size leaves room for a seek to do the same, see cp_seek_ms().
+    cp->ring.reset(new AudioRing(cp->ringFrames * 2));
+    while (produceBlock(cp, ringFill(cp)) > 0) {}
+#ifdef CHIPPLAYER_THREADS
+    cp->quit = false;
+    cp->producer = std::thread(producerMain, cp);
+#endif
+  }
+  return 0;
+}
+
+void cp_close(ChipPlayer *cp) {
+#ifdef CHIPPLAYER_THREADS
+  stopProducer(cp);
+#endif
+  cp->engine.reset();
+  cp->ring.reset();
+  cp->engineId = CP_ENGINE_AUTO;
+  cp->ended = true;
+}
+
+const char *cp_get_error(ChipPlayer *cp) {
+  return cp->error.c_str();
+}
+
+int cp_get_engine(ChipPlayer *cp) {
+  return cp->engineId;
+}
+
+int cp_render(ChipPlayer *cp, float *buffer, int frames) {
+  int got = 0;
+  if (cp->engine && !cp->ring) {
+    EngineLock lock(cp);
+    while (got < frames && !cp->ended) {
+      int n = cp->engine->render(buffer + got * 2, frames - got);
+      if (n <= 0) cp->ended = true;
+      else got += n;
+    }
+    cp->renderedPos += got;
+    updatePosition(cp, cp->renderedPos);
+  } else if (cp->engine) {
+    applySeek(cp);
+    if (cp->ring->readable() < (size_t)frames && !cp->ended) {
+      cp->underruns++;
+#ifndef CHIPPLAYER_THREADS
+      EngineLock lock(cp);
+      while (cp->ring->readable() < (size_t)frames && produceBlock(cp, ringFill(cp)) > 0) {}
+#endif
+    }
+    got = (int)cp->ring->read(buffer, frames);
+    updatePosition(cp, cp->ring->readPos());
+  }
+  memset(buffer + got * 2, 0, (frames - got) * 2 * sizeof(float));
+  return got;
+}
+
+int cp_fill(ChipPlayer *cp) {
+  if (!cp->ring) return 0;
+  int total = 0;
+  for (;;) {
+    EngineLock lock(cp);
+    int got = produceBlock(cp, ringFill(cp));
+    if (got <= 0) break;
+    total += got;
+  }
+  return total;
+}
+
+int cp_seek_ms(ChipPlayer *cp, int position_ms) {
+  if (!cp->engine) return -1;
+  EngineLock lock(cp);
+  cp->engine->seek(position_ms);
+  int base = cp->engine->positionMs();
+  cp->ended = false;
+  if (cp->ring) {
+    // The consumer drops everything before pos, which would leave it with an
+    // empty ring, so queue ringFrames frames after pos right away. The frames
+    // before it still take up to ringFrames, hence the ring's spare half. A
+    // second seek before cp_render() has caught up with this one finds less
+    // room and may still underrun.
+    size_t pos = cp->ring->writePos();
+    while (produceBlock(cp, cp->ring->writePos() - pos) > 0) {}
+    cp->seekBaseMs.store(base, std::memory_order_release);
+    cp->seekRingPos.store(pos, std::memory_order_release);
+    cp->seekPending.store(true, std::memory_order_release);
+  } else {
+    cp->baseMs = base;
+    cp->originPos = cp->renderedPos;
+  }
+  cp->positionMs = base;
+  return 0;
+}
+
+int cp_get_position_ms(ChipPlayer *cp) {
+  return cp->positionMs;
+}
+
+int cp_get_duration_ms(ChipPlayer *cp) {
+  if (!cp->engine) return 0;
+  EngineLock lock(cp);
+  return cp->engine->durationMs();
+}
+
+int cp_track_ended(ChipPlayer *cp) {
+  if (!cp->ended) return 0;
+  return !cp->ring || (cp->ring->readable() == 0 && !cp->seekPending);
+}
+
+unsigned int cp_get_underruns(ChipPlayer *cp) {
+  return cp->underruns;
+}
+
+} // extern "C"
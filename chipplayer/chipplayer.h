@@ -0,0 +1,87 @@
+/*
+ * chipplayer: one streaming interface over the chip-core engines.
+ *
+ * Every engine is opened, rendered, seeked and queried the same way, and
+ * renders interleaved stereo floats. A player made with a ring renders ahead
+ * into a single producer, single consumer ring, so that cp_render() only has
+ * to copy frames out of it. Who fills the ring depends on the build:
+ *
+ * - With CHIPPLAYER_THREADS defined, a producer thread per player keeps the
+ *   ring full. A slow block of the engine then only shortens what's ahead in
+ *   the ring instead of making cp_render() late. If the ring runs dry,
+ *   cp_render() pads with silence and counts an underrun.
+ * - Without it, as in the emscripten build, call cp_fill() outside of the
+ *   audio callback, e.g. from a timer. If the ring runs dry, cp_render()
+ *   renders the missing frames itself and counts an underrun.
+ *
+ * cp_seek_ms() and the getters may be called from any thread, cp_render()
+ * from one consumer thread. cp_open(), cp_close() and cp_destroy() must not
+ * run at the same time as cp_render().
+ */
+
+#ifndef CHIPPLAYER_H
+#define CHIPPLAYER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct ChipPlayer ChipPlayer;
+
+enum ChipPlayerEngine {
+  CP_ENGINE_AUTO = 0,  // pick the engine with cp_identify()
+  CP_ENGINE_GME,
+  CP_ENGINE_XMP,
+  CP_ENGINE_FLUIDLITE, // MIDI files, needs cp_load_soundfont()
+  CP_ENGINE_ADLMIDI,   // MIDI files
+  CP_ENGINE_V2M,
+  CP_ENGINE_N64,       // a single global instance: one open player at a time
+  CP_NUM_ENGINES
+};
+
+// ring_frames is how far the ring renders ahead, in frames; 0 renders straight
+// into the buffers of cp_render(), with no ring and no producer thread. The
+// ring takes twice that much memory, so that cp_seek_ms() can render ahead
+// from the new position while the frames from before it are still queued.
+ChipPlayer *cp_create(int sample_rate, int ring_frames);
+void cp_destroy(ChipPlayer *cp);
+
+// The engine for a file, by the extension of path or the first bytes of data.
+// MIDI files get libADLMIDI, other unknown files libxmp.
+int cp_identify(const char *path, const void *data, int length);
+const char *cp_engine_name(int engine);
+
+// The SoundFont used by CP_ENGINE_FLUIDLITE from the next cp_open() on
+int cp_load_soundfont(ChipPlayer *cp, const char *filename);
+
+// Opens a file that is in memory; the data is only read during the call. The
+// n64 engine reads the file and its _lib files from path instead. Returns 0
+// on success and -1 on failure, see cp_get_error().
+int cp_open(ChipPlayer *cp, const char *path, const void *data, int length, int engine);
+void cp_close(ChipPlayer *cp);
+const char *cp_get_error(ChipPlayer *cp);
+int cp_get_engine(ChipPlayer *cp);
+
+// Writes 'frames' stereo frames to buffer. Returns the number of frames of
+// music, after which the buffer is padded with silence. Fewer frames than
+// asked for mean the track has ended, or an underrun with CHIPPLAYER_THREADS;
+// cp_track_ended() tells them apart.
+int cp_render(ChipPlayer *cp, float *buffer, int frames);
+
+// Renders until ring_frames frames are ahead. Returns the number of frames added.
+int cp_fill(ChipPlayer *cp);
+
+// With a ring, renders ring_frames frames from the new position before
+// returning, like cp_open() does.
+int cp_seek_ms(ChipPlayer *cp, int position_ms);
+// The position of the last frame returned by cp_render()
+int cp_get_position_ms(ChipPlayer *cp);
+int cp_get_duration_ms(ChipPlayer *cp);
+int cp_track_ended(ChipPlayer *cp);
+unsigned int cp_get_underruns(ChipPlayer *cp);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CHIPPLAYER_H
@@ -90,6 +90,18 @@ extern "C"
   //        buffer instead of replacing its contents
   void synthRender(void *pthis, void *buf, int smp, void *buf2 = 0, int add = 0);
 
+  // runs the synth like synthRender but throws the output away. use this to get
+  // voices, envelopes and effect tails right when jumping into a song
+  // pthis: pointer to work mem
+  // smp  : number of samples to skip
+  void synthSkip(void *pthis, int smp);
+
+  // sets how many threads render voices, the calling one included. only has an
+  // effect if the synth was built with V2_THREADS; output is the same either way
+  // pthis  : pointer to work mem
+  // threads: <= 1 renders serially, which is the default after synthInit
+  void synthSetThreads(void *pthis, int threads);
+
   // pipes a stream of MIDI commands to the synthesizer
   // pthis: pointer to work mem
   // ptr  : pointer to buffer with MIDI data to process.
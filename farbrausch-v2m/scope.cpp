@@ -1,5 +1,7 @@
 #include "scope.h"
 
+#include <stddef.h>
+#include <string.h>
 #include <vector>
 
 /**
@@ -141,14 +141,20 @@ void sdInit()
 
 void sdClose()
 {
-    delete soundmem;
-    delete v2vsizes;
-    delete v2topics2;
-    delete v2gtopics2;
+#ifdef EMSCRIPTEN
+    delete[] (long*)soundmem;
+#else
+    delete[] soundmem;
+#endif
+    delete[] v2vsizes;
+    delete[] v2gsizes;
+    delete[] v2topics2;
+    delete[] v2gtopics2;
 	
 #ifdef EMSCRIPTEN
     soundmem= NULL;
     v2vsizes= NULL;
+    v2gsizes= NULL;
     v2topics2= NULL;
     v2gtopics2= NULL;
 #endif	
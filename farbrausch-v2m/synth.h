@@ -10,8 +10,18 @@ extern "C"
 
     extern void synthInit(void *pthis, const void *patchmap, int samplerate=44100);
     extern void synthRender(void *pthis, void *buf, int smp, void *buf2=0, int add=0);
+
+    // runs the synth for smp samples and throws the output away, so that
+    // voices, envelopes and effect tails are where rendering would have left them
+    extern void synthSkip(void *pthis, int smp);
+
     extern void synthProcessMIDI(void *pthis, const void *ptr);
     extern void synthSetGlobals(void *pthis, const void *ptr);
+
+    // renders the voices of different channels on up to 'threads' threads, the
+    // calling one included, if built with V2_THREADS. <= 1 renders serially,
+    // which is what synthInit sets. output is the same either way.
+    extern void synthSetThreads(void *pthis, int threads);
 //  extern void synthSetSampler(void *pthis, const void *bankinfo, const void *samples);
     extern void synthGetPoly(void *pthis, void *dest);
     extern void synthGetPgm(void *pthis, void *dest);
@@ -9,9 +9,34 @@
 // TODO:
 // - VU meters?
 
+#if V2_THREADS
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#endif
+
 // Ye olde original V2 bugs you can turn on and off :)
 #define BUG_V2_FM_RANGE 0     // Broken sine range reduction for FM oscis
 
+// SIMD kernels for the stateless parts (sine oscis, overdrive/clip, voice
+// mixing): 1 uses SSE2 or wasm SIMD128, whichever the compiler targets,
+// 0 forces the scalar code. Output is the same either way.
+#ifndef V2_SIMD
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__wasm_simd128__)
+#define V2_SIMD 1
+#else
+#define V2_SIMD 0
+#endif
+#endif
+
+#if V2_SIMD
+#ifdef __wasm_simd128__
+#include <wasm_simd128.h>
+#else
+#include <emmintrin.h>
+#endif
+#endif
+
 // Debugging tools
 #define DEBUGSCOPES 0
 #define COVERAGE    0
@@ -108,6 +133,17 @@ static float bits2float(uint32_t u)
 }
 
 // Fast arctangent
+// we have two rational approximations: one for |x| < 1.0 and one for
+// |x| >= 1.0, both of the general form
+//   r(x) = (cx1*x + cx3*x^3) / (cxm0 + cxm2*x^2 + cxm4*x^4) + bias
+// original V2 code uses doubles here but frankly the coefficients
+// just aren't accurate enough to warrant it :)
+static const float fcatan[2][6] = {
+    //          cx1          cx3         cxm0         cxm2         cxm4         bias
+    {          1.0f, 0.43157974f,        1.0f, 0.05831938f, 0.76443945f,        0.0f },
+    { -0.431597974f,       -1.0f, 0.05831938f,        1.0f, 0.76443945f, 1.57079633f },
+};
+
 static float fastatan(float x)
 {
     // extract sign
@@ -118,17 +154,7 @@ static float fastatan(float x)
         x = -x;
     }
 
-    // we have two rational approximations: one for |x| < 1.0 and one for
-    // |x| >= 1.0, both of the general form
-    //   r(x) = (cx1*x + cx3*x^3) / (cxm0 + cxm2*x^2 + cxm4*x^4) + bias
-    // original V2 code uses doubles here but frankly the coefficients
-    // just aren't accurate enough to warrant it :)
-    static const float coeffs[2][6] = {
-        //          cx1          cx3         cxm0         cxm2         cxm4         bias
-        {          1.0f, 0.43157974f,        1.0f, 0.05831938f, 0.76443945f,        0.0f },
-        { -0.431597974f,       -1.0f, 0.05831938f,        1.0f, 0.76443945f, 1.57079633f },
-    };
-    const float *c = coeffs[x >= 1.0f]; // interestingly enough, V2 code does this test wrong (cmovge instead of cmovae)
+    const float *c = fcatan[x >= 1.0f]; // interestingly enough, V2 code does this test wrong (cmovge instead of cmovae)
     float x2 = x*x;
     float r = (c[1]*x2 + c[0])*x / ((c[4]*x2 + c[3])*x2 + c[2]) + c[5];
     return r * sign;
@@ -241,6 +267,104 @@ static inline float lerp(float a, float b, float t)
     return a + t * (b-a);
 }
 
+// --------------------------------------------------------------------------
+// SIMD helpers
+// --------------------------------------------------------------------------
+
+// Just enough of a 4-wide float/int vector to write the kernels once for
+// SSE2 and wasm SIMD128. The kernels do the exact same operations in the
+// same order as the scalar code, so results are bit-identical.
+#if V2_SIMD
+#ifdef __wasm_simd128__
+typedef v128_t V2Vec;
+typedef v128_t V2VecI;
+
+static inline V2Vec v4load(const float *p)          { return wasm_v128_load(p); }
+static inline void v4store(float *p, V2Vec a)       { wasm_v128_store(p, a); }
+static inline V2Vec v4set(float x)                  { return wasm_f32x4_splat(x); }
+static inline V2Vec v4set(float a, float b, float c, float d) { return wasm_f32x4_make(a, b, c, d); }
+static inline V2Vec v4add(V2Vec a, V2Vec b)         { return wasm_f32x4_add(a, b); }
+static inline V2Vec v4sub(V2Vec a, V2Vec b)         { return wasm_f32x4_sub(a, b); }
+static inline V2Vec v4mul(V2Vec a, V2Vec b)         { return wasm_f32x4_mul(a, b); }
+static inline V2Vec v4div(V2Vec a, V2Vec b)         { return wasm_f32x4_div(a, b); }
+static inline V2Vec v4min(V2Vec a, V2Vec b)         { return wasm_f32x4_min(a, b); }
+static inline V2Vec v4max(V2Vec a, V2Vec b)         { return wasm_f32x4_max(a, b); }
+static inline V2Vec v4and(V2Vec a, V2Vec b)         { return wasm_v128_and(a, b); }
+static inline V2Vec v4xor(V2Vec a, V2Vec b)         { return wasm_v128_xor(a, b); }
+static inline V2Vec v4lt(V2Vec a, V2Vec b)          { return wasm_f32x4_lt(a, b); }
+static inline V2Vec v4ge(V2Vec a, V2Vec b)          { return wasm_f32x4_ge(a, b); }
+static inline V2Vec v4select(V2Vec m, V2Vec a, V2Vec b) { return wasm_v128_bitselect(a, b, m); }
+static inline V2Vec v4duplo(V2Vec a)                { return wasm_i32x4_shuffle(a, a, 0, 0, 1, 1); }
+static inline V2Vec v4duphi(V2Vec a)                { return wasm_i32x4_shuffle(a, a, 2, 2, 3, 3); }
+
+static inline V2VecI v4iset(uint32_t x)             { return wasm_i32x4_splat(x); }
+static inline V2VecI v4iset(uint32_t a, uint32_t b, uint32_t c, uint32_t d) { return wasm_i32x4_make(a, b, c, d); }
+static inline V2VecI v4iadd(V2VecI a, V2VecI b)     { return wasm_i32x4_add(a, b); }
+static inline V2VecI v4ior(V2VecI a, V2VecI b)      { return wasm_v128_or(a, b); }
+static inline V2VecI v4ixor(V2VecI a, V2VecI b)     { return wasm_v128_xor(a, b); }
+static inline V2VecI v4isrl(V2VecI a, int n)        { return wasm_u32x4_shr(a, n); }
+static inline V2VecI v4isra(V2VecI a, int n)        { return wasm_i32x4_shr(a, n); }
+static inline V2Vec v4bits2float(V2VecI a)          { return a; }
+#else
+typedef __m128 V2Vec;
+typedef __m128i V2VecI;
+
+static inline V2Vec v4load(const float *p)          { return _mm_loadu_ps(p); }
+static inline void v4store(float *p, V2Vec a)       { _mm_storeu_ps(p, a); }
+static inline V2Vec v4set(float x)                  { return _mm_set1_ps(x); }
+static inline V2Vec v4set(float a, float b, float c, float d) { return _mm_setr_ps(a, b, c, d); }
+static inline V2Vec v4add(V2Vec a, V2Vec b)         { return _mm_add_ps(a, b); }
+static inline V2Vec v4sub(V2Vec a, V2Vec b)         { return _mm_sub_ps(a, b); }
+static inline V2Vec v4mul(V2Vec a, V2Vec b)         { return _mm_mul_ps(a, b); }
+static inline V2Vec v4div(V2Vec a, V2Vec b)         { return _mm_div_ps(a, b); }
+static inline V2Vec v4min(V2Vec a, V2Vec b)         { return _mm_min_ps(a, b); }
+static inline V2Vec v4max(V2Vec a, V2Vec b)         { return _mm_max_ps(a, b); }
+static inline V2Vec v4and(V2Vec a, V2Vec b)         { return _mm_and_ps(a, b); }
+static inline V2Vec v4xor(V2Vec a, V2Vec b)         { return _mm_xor_ps(a, b); }
+static inline V2Vec v4lt(V2Vec a, V2Vec b)          { return _mm_cmplt_ps(a, b); }
+static inline V2Vec v4ge(V2Vec a, V2Vec b)          { return _mm_cmpge_ps(a, b); }
+static inline V2Vec v4select(V2Vec m, V2Vec a, V2Vec b) { return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b)); }
+static inline V2Vec v4duplo(V2Vec a)                { return _mm_unpacklo_ps(a, a); }
+static inline V2Vec v4duphi(V2Vec a)                { return _mm_unpackhi_ps(a, a); }
+
+static inline V2VecI v4iset(uint32_t x)             { return _mm_set1_epi32((int)x); }
+static inline V2VecI v4iset(uint32_t a, uint32_t b, uint32_t c, uint32_t d) { return _mm_setr_epi32((int)a, (int)b, (int)c, (int)d); }
+static inline V2VecI v4iadd(V2VecI a, V2VecI b)     { return _mm_add_epi32(a, b); }
+static inline V2VecI v4ior(V2VecI a, V2VecI b)      { return _mm_or_si128(a, b); }
+static inline V2VecI v4ixor(V2VecI a, V2VecI b)     { return _mm_xor_si128(a, b); }
+static inline V2VecI v4isrl(V2VecI a, int n)        { return _mm_srli_epi32(a, n); }
+static inline V2VecI v4isra(V2VecI a, int n)        { return _mm_srai_epi32(a, n); }
+static inline V2Vec v4bits2float(V2VecI a)          { return _mm_castsi128_ps(a); }
+#endif
+
+static inline V2Vec v4fastsin(V2Vec x)
+{
+    V2Vec x2 = v4mul(x, x);
+    V2Vec r = v4add(v4mul(v4set(-0.00018542f), x2), v4set(0.0083143f));
+    r = v4sub(v4mul(r, x2), v4set(0.16666f));
+    r = v4add(v4mul(r, x2), v4set(1.0f));
+    return v4mul(r, x);
+}
+
+static inline V2Vec v4fastatan(V2Vec x)
+{
+    // sign flip for x < 0 only, like fastatan (which keeps -0.0 as is)
+    V2Vec sign = v4and(v4lt(x, v4set(0.0f)), v4set(-0.0f));
+    x = v4xor(x, sign);
+
+    V2Vec big = v4ge(x, v4set(1.0f));
+    V2Vec c[6];
+    for (int i = 0; i < 6; i++)
+        c[i] = v4select(big, v4set(fcatan[1][i]), v4set(fcatan[0][i]));
+
+    V2Vec x2 = v4mul(x, x);
+    V2Vec num = v4mul(v4add(v4mul(c[1], x2), c[0]), x);
+    V2Vec den = v4add(v4mul(v4add(v4mul(c[4], x2), c[3]), x2), c[2]);
+    V2Vec r = v4add(v4div(num, den), c[5]);
+    return v4xor(r, sign);
+}
+#endif
+
 // DEBUG
 #include <stdarg.h>
 #include <stdio.h>
@@ -568,6 +692,16 @@ private:
             *dest += x;
     }
 
+#if V2_SIMD
+    inline void output4(float *dest, V2Vec x)
+    {
+        if (ring)
+            v4store(dest, v4mul(v4load(dest), x));
+        else
+            v4store(dest, v4add(v4load(dest), x));
+    }
+#endif
+
     // Oscillator state machine (read description of renderTriSaw for context)
     //
     // We keep track of whether the current sample is in the up or down phase,
@@ -809,7 +943,26 @@ private:
 
         // Sine is already a perfectly bandlimited waveform, so we needn't
         // worry about aliasing here.
-        for (int i=0; i < nsamples; i++)
+        int i = 0;
+
+#if V2_SIMD
+        // same as below, four samples at a time
+        V2VecI phase4 = v4iset(cnt + 0x40000000, cnt + 0x40000000 + freq,
+            cnt + 0x40000000 + 2*freq, cnt + 0x40000000 + 3*freq);
+        V2VecI step4 = v4iset(4u*freq);
+        V2Vec gain4 = v4set(gain);
+        for (; i + 4 <= nsamples; i += 4)
+        {
+            V2VecI phase = v4ixor(phase4, v4isra(phase4, 31));
+            V2Vec t = v4bits2float(v4ior(v4isrl(phase, 8), v4iset(0x3f800000)));
+            t = v4sub(v4mul(t, v4set(fcpi)), v4set(fc1p5pi));
+            output4(dest + i, v4mul(gain4, v4fastsin(t)));
+            phase4 = v4iadd(phase4, step4);
+        }
+        cnt += (uint32_t)i * freq;
+#endif
+
+        for (; i < nsamples; i++)
         {
             // Brace yourselves: The name is a lie! It's actually a cosine wave!
             uint32_t phase = cnt + 0x40000000; // quarter-turn (pi/2) phase offset
@@ -1429,13 +1582,13 @@ struct V2Dist
 
         case OVERDRIVE:
             COVER("DIST overdrive");
-            for (int i=0; i < nsamples; i++)
+            for (int i=simdOverdrive(dest, src, nsamples); i < nsamples; i++)
                 dest[i] = overdrive(src[i]);
             break;
 
         case CLIP:
             COVER("DIST clip");
-            for (int i=0; i < nsamples; i++)
+            for (int i=simdClip(dest, src, nsamples); i < nsamples; i++)
                 dest[i] = clip(src[i]);
             break;
 
@@ -1509,6 +1662,33 @@ private:
         return gain2 * clamp(in * gain1 + offs, -1.0f, 1.0f);
     }
 
+    // these do the first multiple of 4 samples and return how many that was
+    int simdOverdrive(float *dest, const float *src, int nsamples)
+    {
+        int i = 0;
+#if V2_SIMD
+        V2Vec g1 = v4set(gain1), g2 = v4set(gain2), o = v4set(offs);
+        for (; i + 4 <= nsamples; i += 4)
+            v4store(dest + i, v4mul(g2, v4fastatan(v4add(v4mul(v4load(src + i), g1), o))));
+#endif
+        return i;
+    }
+
+    int simdClip(float *dest, const float *src, int nsamples)
+    {
+        int i = 0;
+#if V2_SIMD
+        V2Vec g1 = v4set(gain1), g2 = v4set(gain2), o = v4set(offs);
+        V2Vec lo = v4set(-1.0f), hi = v4set(1.0f);
+        for (; i + 4 <= nsamples; i += 4)
+        {
+            V2Vec x = v4add(v4mul(v4load(src + i), g1), o);
+            v4store(dest + i, v4mul(g2, v4min(v4max(x, lo), hi)));
+        }
+#endif
+        return i;
+    }
+
     inline float bitcrusher(float in)
     {
         int t = (int)(in * crush1);
@@ -1666,13 +1846,12 @@ struct V2Voice
         DEBUG_PLOT_VAL(&curvol, curvol);
     }
 
-    void render(StereoSample *dest, int nsamples)
+    // voice and voice2 are scratch buffers of nsamples each
+    void render(StereoSample *dest, int nsamples, float *voice, float *voice2)
     {
         assert(nsamples <= V2Instance::MAX_FRAME_SIZE);
 
         // clear voice buffer
-        float *voice = inst->vcebuf;
-        float *voice2 = inst->vcebuf2;
         memset(voice, 0, nsamples * sizeof(*voice));
 
         // oscillators -> voice buffer
@@ -1698,8 +1877,16 @@ struct V2Voice
             COVER("VOICE filter parallel");
             vcf[1].render(voice2, voice, nsamples);
             vcf[0].render(voice, voice, nsamples);
-            for (int i=0; i < nsamples; i++)
-                voice[i] = voice[i]*f1gain + voice2[i]*f2gain;
+            {
+                int i = 0;
+#if V2_SIMD
+                V2Vec g1 = v4set(f1gain), g2 = v4set(f2gain);
+                for (; i + 4 <= nsamples; i += 4)
+                    v4store(voice + i, v4add(v4mul(v4load(voice + i), g1), v4mul(v4load(voice2 + i), g2)));
+#endif
+                for (; i < nsamples; i++)
+                    voice[i] = voice[i]*f1gain + voice2[i]*f2gain;
+            }
             break;
         }
 
@@ -1714,7 +1901,30 @@ struct V2Voice
         // voice buffer (mono) -> +=output buffer (stereo)
         // original ASM code has chan buffer hardwired as output here
         float cv = curvol;
-        for (int i=0; i < nsamples; i++)
+        int i = 0;
+
+#if V2_SIMD
+        // the volume ramp is a running sum, so it stays scalar (in voice2,
+        // which is free by now); the rest goes four samples at a time
+        for (i = 0; i < nsamples; i++)
+        {
+            voice2[i] = cv;
+            cv += volramp;
+        }
+
+        V2Vec vol = v4set(lvol, rvol, lvol, rvol);
+        V2Vec dc = v4set(fcdcoffset);
+        float *d = &dest[0].l;
+        for (i = 0; i + 4 <= nsamples; i += 4)
+        {
+            V2Vec out = v4mul(v4load(voice + i), v4load(voice2 + i));
+            v4store(d + 2*i,     v4add(v4load(d + 2*i),     v4add(v4mul(vol, v4duplo(out)), dc)));
+            v4store(d + 2*i + 4, v4add(v4load(d + 2*i + 4), v4add(v4mul(vol, v4duphi(out)), dc)));
+        }
+        cv = i < nsamples ? voice2[i] : cv;
+#endif
+
+        for (; i < nsamples; i++)
         {
             float out = voice[i] * cv;
             cv += volramp;
@@ -1726,6 +1936,16 @@ struct V2Voice
         curvol = cv;
     }
 
+    // true if an oscillator reads the AuxA/B buses, which the channels
+    // before ours fill during the same frame
+    bool readsAux() const
+    {
+        for (int i=0; i < syVV2::NOSC; i++)
+            if ((osc[i].mode & 7) >= V2Osc::OSC_AUXA)
+                return true;
+        return false;
+    }
+
     void set(const syVV2 *para)
     {
         xpose = para->transp - 64.0f;
@@ -2476,9 +2696,8 @@ struct V2Chan
         boost.set(&para->boost);
     }
 
-    void process(int nsamples)
+    void process(StereoSample *chan, int nsamples)
     {
-        StereoSample *chan = inst->chanbuf;
 
         // AuxA/B receive (stereo)
         accumulate(chan, inst->auxabuf, nsamples, aarcv);
@@ -2606,6 +2825,11 @@ extern "C" void synthSetLyrics(void *, const char **) {}
 // --------------------------------------------------------------------------
 #ifdef EMSCRIPTEN
 extern uint32_t readUintAt(const uint8_t *buf, int idx);
+#else
+static inline uint32_t readUintAt(const uint8_t *buf, int idx)
+{
+    return ((const uint32_t *)buf)[idx];
+}
 #endif
 
 struct V2ChanInfo
@@ -2614,6 +2838,121 @@ struct V2ChanInfo
     uint8_t ctl[7]; // controllers
 };
 
+#if V2_THREADS
+
+// The EMSCRIPTEN scopes only watch the channels, which are processed in
+// order. Voices rendered on the workers just look up scopes that are
+// never opened for them.
+#if DEBUGSCOPES
+#error "debug scopes are not thread safe, disable them to use V2_THREADS"
+#endif
+
+// Worker threads shared by all synth instances. run() hands out njobs jobs
+// to the calling thread and up to nthreads-1 workers, and returns once all
+// of them are done. Batches from different synths run one after the other.
+class V2WorkerPool
+{
+public:
+    typedef void (*JobFunc)(void *ctx, int job);
+
+    V2WorkerPool() : nworkers(0), active(0), generation(0), quit(false),
+        jobfunc(0), jobctx(0), jobcount(0), nextjob(0), pending(0) {}
+
+    ~V2WorkerPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            quit = true;
+        }
+        wake.notify_all();
+        for (int i = 0; i < nworkers; i++)
+            workers[i].join();
+    }
+
+    void run(JobFunc func, void *ctx, int njobs, int nthreads)
+    {
+        std::lock_guard<std::mutex> batch(batchmutex);
+        std::unique_lock<std::mutex> lock(mutex);
+
+        if (nthreads > MAX_THREADS)
+            nthreads = MAX_THREADS;
+        for (; nworkers < nthreads - 1; nworkers++)
+            workers[nworkers] = std::thread(workerMain, this, nworkers);
+
+        jobfunc = func;
+        jobctx = ctx;
+        jobcount = njobs;
+        nextjob = 0;
+        pending = njobs;
+        active = nthreads - 1;
+        generation++;
+        lock.unlock();
+        wake.notify_all();
+
+        work();
+
+        lock.lock();
+        done.wait(lock, [this] { return pending == 0; });
+    }
+
+private:
+    static const int MAX_THREADS = 16;
+
+    std::thread workers[MAX_THREADS];
+    int nworkers;
+    int active;          // workers taking part in the current batch
+    unsigned generation; // bumped for every batch
+    bool quit;
+
+    JobFunc jobfunc;
+    void *jobctx;
+    int jobcount;
+    int nextjob;
+    int pending;         // jobs not finished yet
+
+    std::mutex batchmutex;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+
+    void work()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (nextjob < jobcount)
+        {
+            int job = nextjob++;
+            lock.unlock();
+            jobfunc(jobctx, job);
+            lock.lock();
+            if (--pending == 0)
+                done.notify_all();
+        }
+    }
+
+    static void workerMain(V2WorkerPool *pool, int index)
+    {
+        std::unique_lock<std::mutex> lock(pool->mutex);
+        unsigned seen = pool->generation;
+        for (;;)
+        {
+            pool->wake.wait(lock, [&] { return pool->quit || pool->generation != seen; });
+            if (pool->quit)
+                return;
+            seen = pool->generation;
+            if (index >= pool->active)
+                continue;
+
+            lock.unlock();
+            pool->work();
+            lock.lock();
+        }
+    }
+};
+
+static V2WorkerPool workerpool;
+
+#endif
+
 // V2Synth holds a V2Instance.
 // In the original code these are one and the same struct (SYN) but that
 // would turn out fairly awkward in this C++ version, hence the split.
@@ -2630,6 +2969,7 @@ struct V2Synth
     uint32_t allocpos[POLY];
     int voicemap[CHANS]; // chan -> choice
     int tickd;           // number of finished samples left in mix buffer
+    int threads;         // threads rendering voices, <= 1: serial (see synthSetThreads)
 
     V2ChanInfo chans[CHANS];
     syVV2 voicesv[POLY];
@@ -2665,6 +3005,14 @@ struct V2Synth
 
     V2Instance instance;
 
+#if V2_THREADS
+    // channels whose voices were rendered up front, into their own buffers
+    int jobchans[CHANS];
+    bool chanjob[CHANS];
+    StereoSample chanbufs[CHANS][V2Instance::MAX_FRAME_SIZE];
+    float chanvcebufs[CHANS][2][V2Instance::MAX_FRAME_SIZE];
+#endif
+
     syWRonan ronan;
 
     void init(const void *patchmap, int samplerate)
@@ -2809,6 +3157,20 @@ struct V2Synth
         DEBUG_PLOT_UPDATE();
     }
 
+    // advances by nsamples like render, without copying out the mix
+    void skip(int nsamples)
+    {
+        while (nsamples)
+        {
+            if (!tickd)
+                tick();
+
+            int nread = min(nsamples, tickd);
+            nsamples -= nread;
+            tickd    -= nread;
+        }
+    }
+
     void processMIDI(const uint8_t *cmd)
     {
         while (*cmd != 0xfd) // until end of stream
@@ -3215,6 +3577,10 @@ private:
         memset(instance.auxabuf, 0, nsamples * sizeof(StereoSample));
         memset(instance.auxbbuf, 0, nsamples * sizeof(StereoSample));
 
+#if V2_THREADS
+        renderVoicesThreaded();
+#endif
+
         // process all channels
         for (int chan = 0; chan < CHANS; chan++)
         {
@@ -3226,23 +3592,20 @@ private:
             if (voice == POLY)
                 continue;
 
-            // clear channel buffer
-            memset(instance.chanbuf, 0, nsamples * sizeof(StereoSample));
-
             // render all voices on this channel
-            for (; voice < POLY; voice++)
-            {
-                if (chanmap[voice] != chan)
-                    continue;
-
-                voicesw[voice].render(instance.chanbuf, nsamples);
-            }
+            StereoSample *chanbuf = instance.chanbuf;
+#if V2_THREADS
+            if (chanjob[chan])
+                chanbuf = chanbufs[chan];
+            else
+#endif
+            renderChanVoices(chan, chanbuf, instance.vcebuf, instance.vcebuf2, nsamples);
 
             // channel 15 -> Ronan
             if (chan == CHANS - 1)
-                ronanCBProcess(&ronan, &instance.chanbuf[0].l, nsamples);
+                ronanCBProcess(&ronan, &chanbuf[0].l, nsamples);
 
-            chansw[chan].process(nsamples);
+            chansw[chan].process(chanbuf, nsamples);
         }
 
         // global filters
@@ -3277,6 +3640,66 @@ private:
 
         DEBUG_PLOT_STEREO(mix, mix, nsamples);
     }
+
+    void renderChanVoices(int chan, StereoSample *dest, float *vcebuf, float *vcebuf2, int nsamples)
+    {
+        // clear channel buffer
+        memset(dest, 0, nsamples * sizeof(StereoSample));
+
+        for (int voice = 0; voice < POLY; voice++)
+        {
+            if (chanmap[voice] == chan)
+                voicesw[voice].render(dest, nsamples, vcebuf, vcebuf2);
+        }
+    }
+
+#if V2_THREADS
+    // Voices only depend on their own state, except for oscillators reading
+    // the AuxA/B buses which earlier channels fill during the frame. Channels
+    // without such voices get their voices rendered on the worker pool; the
+    // channel effects, and everything else, still run in order afterwards.
+    void renderVoicesThreaded()
+    {
+        memset(chanjob, 0, sizeof(chanjob));
+        if (threads <= 1)
+            return;
+
+        bool active[CHANS] = { false };
+        bool aux[CHANS] = { false };
+        for (int i = 0; i < POLY; i++)
+        {
+            int chan = chanmap[i];
+            if (chan < 0)
+                continue;
+
+            active[chan] = true;
+            if (voicesw[i].readsAux())
+                aux[chan] = true;
+        }
+
+        int njobs = 0;
+        for (int chan = 0; chan < CHANS; chan++)
+        {
+            if (active[chan] && !aux[chan])
+                jobchans[njobs++] = chan;
+        }
+
+        if (njobs < 2)
+            return;
+
+        workerpool.run(renderChanJob, this, njobs, threads);
+        for (int i = 0; i < njobs; i++)
+            chanjob[jobchans[i]] = true;
+    }
+
+    static void renderChanJob(void *ctx, int job)
+    {
+        V2Synth *synth = (V2Synth *)ctx;
+        int chan = synth->jobchans[job];
+        synth->renderChanVoices(chan, synth->chanbufs[chan],
+            synth->chanvcebufs[chan][0], synth->chanvcebufs[chan][1], synth->instance.SRcFrameSize);
+    }
+#endif
 };
 
 // --------------------------------------------------------------------------
@@ -3305,6 +3728,11 @@ void synthRender(void *pthis, void *buf, int smp, void *buf2, int add)
     ((V2Synth *)pthis)->render((float *)buf, smp, (float *)buf2, add != 0);
 }
 
+void synthSkip(void *pthis, int smp)
+{
+    ((V2Synth *)pthis)->skip(smp);
+}
+
 void synthProcessMIDI(void *pthis, const void *ptr)
 {
     ((V2Synth *)pthis)->processMIDI((const uint8_t *)ptr);
@@ -3315,6 +3743,11 @@ void synthSetGlobals(void *pthis, const void *ptr)
     ((V2Synth *)pthis)->setGlobals((const uint8_t *)ptr);
 }
 
+void synthSetThreads(void *pthis, int threads)
+{
+    ((V2Synth *)pthis)->threads = threads;
+}
+
 void synthGetPoly(void *pthis, void *dest)
 {
     ((V2Synth *)pthis)->getPoly((int*)dest);
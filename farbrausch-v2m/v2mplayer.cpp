@@ -13,7 +13,9 @@
 
 #include "v2mplayer.h"
 #include "libv2.h"
+#ifdef __EMSCRIPTEN__
 #include <emscripten.h> // TODO: Remove
+#endif
 
 #define GETDELTA(p, w) ((p)[0] + ((p)[w] << 8) + ((p)[2*w] << 16))
 #define UPDATENT(n, v, p, w)  if ((n) < (w)) { (v) = m_state.time + GETDELTA((p), (w)); if ((v) < m_state.nexttime) m_state.nexttime = (v); }
@@ -180,6 +182,7 @@ void V2MPlayer::Reset()
         synthInit(m_synth, (void*)m_base.patchmap, m_samplerate);
         synthSetGlobals(m_synth, (void*)m_base.globals);
         synthSetLyrics(m_synth, m_base.speechptrs);
+        synthSetThreads(m_synth, m_threads);
     }
 }
 
@@ -330,6 +333,12 @@ void V2MPlayer::Play(uint32_t a_time)
         destsmpl = ((uint64_t)a_time * m_samplerate) / 1000; // m_tpc;
     }
 
+    // events before warmsmpl only go to the synth, from there on it runs
+    // silently up to every event and then to destsmpl
+    uint32_t warmup   = ((uint64_t)m_warmup * m_samplerate) / 1000;
+    uint32_t warmsmpl = destsmpl > warmup ? destsmpl - warmup : 0;
+    uint32_t synthsmpl = warmsmpl;
+
 //    EM_ASM_({ console.log('V2MPlayer::Play a_time: %s destsmpl: %s', $0, $1); }, a_time, destsmpl);
 
     m_state.state = PlayerState::PLAYING;
@@ -341,6 +350,11 @@ void V2MPlayer::Play(uint32_t a_time)
 //      EM_ASM_({ console.log('-- cursmpl: %s m_state.time: %s m_state.nexttime: %s', $0, $1, $2); }, cursmpl, m_state.time, m_state.nexttime);
 
         cursmpl += m_state.smpl_delta;
+        if (cursmpl > synthsmpl)
+        {
+            synthSkip(m_synth, cursmpl - synthsmpl);
+            synthsmpl = cursmpl;
+        }
         Tick();
         if (m_state.state == PlayerState::PLAYING)
         {
@@ -354,6 +368,8 @@ void V2MPlayer::Play(uint32_t a_time)
         } else
             m_state.smpl_delta = -1;
     }
+    if (destsmpl > synthsmpl)
+        synthSkip(m_synth, destsmpl - synthsmpl);
     m_state.smpl_cur = cursmpl;
     m_state.smpl_delta = m_state.smpl_delta - (destsmpl - cursmpl);
 //    EM_ASM_({ console.log('V2MPlayer::Play m_state.smpl_delta: %s m_state.smpl_cur: %s destsmpl: %s', $0, $1, $2); }, m_state.smpl_delta, m_state.smpl_cur, destsmpl);
@@ -465,6 +481,15 @@ void V2MPlayer::SetSpeed(float speed) {
   m_base.speed = speed;
 }
 
+void V2MPlayer::SetSeekWarmup(uint32_t a_warmup) {
+  m_warmup = a_warmup;
+}
+
+void V2MPlayer::SetThreads(int a_threads) {
+  m_threads = a_threads;
+  synthSetThreads(m_synth, a_threads);
+}
+
 float V2MPlayer::GetTime() {
   return 1000.0 * m_state.smpl_cur / m_samplerate;
 }
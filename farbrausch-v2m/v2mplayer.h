@@ -30,6 +30,8 @@ public:
     // call this instead of a constructor
     void Init(uint32_t a_tickspersec = 1000) {
       m_tpc = a_tickspersec;
+      m_threads = 0;
+      m_warmup = 3000;
       /* m_base.valid = 0; */
       memset(&m_base, 0, sizeof(V2MBase));
     }
@@ -54,9 +56,18 @@ public:
     // starts playing
     //
     // a_time   : time offset from song start in msecs
+    //            the synth runs silently through the last part of the song
+    //            before a_time (see SetSeekWarmup), earlier events are only
+    //            fed to it, so the cost of seeking doesn't grow with a_time
     //
     void Play(uint32_t a_time=0);
 
+    // sets how much of the song before the Play() offset is run through
+    // the synth, in msecs (default 3000). longer catches longer tails,
+    // 0 gives the old behaviour of only replaying the events
+    //
+    void SetSeekWarmup(uint32_t a_warmup);
+
     // stops playing
     //
     // a_fadetime : optional fade out time in msecs
@@ -85,6 +96,9 @@ public:
 
     void SetSpeed(float speed);
 
+    // renders synth channels on up to a_threads threads (see synthSetThreads)
+    void SetThreads(int a_threads);
+
     float GetTime();
 
     bool NoEnd();
@@ -220,6 +234,8 @@ private:
     V2MBase      m_base;
     PlayerState  m_state;
     uint32_t     m_samplerate;
+    int          m_threads;
+    uint32_t     m_warmup;
     uint8_t      m_midibuf[4096];
     float        m_fadeval;
     float        m_fadedelta;
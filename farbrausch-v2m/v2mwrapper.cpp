@@ -5,76 +5,143 @@
 #include "sounddef.h"
 #include "v2mplayer.h"
 #include "v2mconv.h"
+#include <mutex>
+#ifdef __EMSCRIPTEN__
 #include <emscripten.h> // TODO: Remove
+#endif
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-static V2MPlayer v2m;
 const int g_num_channels = 2;
 const int g_ticks_per_sec = 1000;
-long g_sample_time = 0;
-int g_sample_rate = 44100;
-unsigned char * g_converted_data = nullptr;
+
+// One V2M stream. Contexts are independent, so several of them can render on
+// different threads; only the V2M conversion below shares global tables.
+typedef struct V2MContext {
+  V2MPlayer player;
+  long sample_time;
+  int sample_rate;
+  unsigned char *converted_data;
+} V2MContext;
+
+// sounddef and v2mconv keep their tables in globals
+static std::mutex g_convert_mutex;
+
+static V2MContext *g_v2m = nullptr; // context used by the context-free API
 
 void v2m_convert_data(const uint8_t *data, size_t length, uint8_t **out_data) {
+  std::lock_guard<std::mutex> lock(g_convert_mutex);
+
+  sdInit();
   int version = CheckV2MVersion(data, length);
   if (version < 0) {
+#ifdef __EMSCRIPTEN__
     EM_ASM_({ console.log('Error during V2M conversion.', $0); }, version);
+#endif
+    sdClose();
     return; // fatal error
   }
 
   int converted_length;
   ConvertV2M((const uint8_t *)data, length, out_data, &converted_length);
+  sdClose();
 }
 
-int v2m_open(uint8_t *data, int length, int sample_rate) {
-  sdInit();
-  v2m.Init(g_ticks_per_sec);
+V2MContext *v2m_create() {
+  V2MContext *ctx = new V2MContext();
+  ctx->sample_time = 0;
+  ctx->sample_rate = 44100;
+  ctx->converted_data = nullptr;
+  return ctx;
+}
+
+void v2m_ctx_close(V2MContext *ctx) {
+  ctx->player.Close();
+
+  if (ctx->converted_data) {
+    delete[] ctx->converted_data;
+    ctx->converted_data = nullptr;
+  }
+}
+
+void v2m_destroy(V2MContext *ctx) {
+  if (!ctx) return;
+  v2m_ctx_close(ctx);
+  if (g_v2m == ctx) g_v2m = nullptr;
+  delete ctx;
+}
+
+int v2m_ctx_open(V2MContext *ctx, uint8_t *data, int length, int sample_rate) {
+  v2m_ctx_close(ctx);
+  ctx->player.Init(g_ticks_per_sec);
 
-  v2m_convert_data(data, length, &g_converted_data);
-  if (v2m.Open(g_converted_data, sample_rate)) {
-    v2m.Play();
-    g_sample_time = 0;
-    g_sample_rate = sample_rate;
+  v2m_convert_data(data, length, &ctx->converted_data);
+  if (ctx->converted_data && ctx->player.Open(ctx->converted_data, sample_rate)) {
+    ctx->player.Play();
+    ctx->sample_time = 0;
+    ctx->sample_rate = sample_rate;
     return 0;
   }
 
   return 1;
 }
 
+int v2m_ctx_write_audio(V2MContext *ctx, float *buffer, int buffer_size) {
+  ctx->sample_time += buffer_size;
+  return ctx->player.Render(buffer, buffer_size);
+}
+
+float v2m_ctx_get_position_ms(V2MContext *ctx) {
+  return ctx->player.GetTime();
+}
+
+float v2m_ctx_get_duration_ms(V2MContext *ctx) {
+  return 1000 * ctx->player.Length();
+}
+
+void v2m_ctx_seek_ms(V2MContext *ctx, int position_ms) {
+  // works with milliseconds because ticks per sec = 1000
+  ctx->player.Play(position_ms);
+  ctx->sample_time = (position_ms / 1000) * ctx->sample_rate;
+}
+
+void v2m_ctx_set_speed(V2MContext *ctx, float speed) {
+  ctx->player.SetSpeed(speed);
+}
+
+int v2m_open(uint8_t *data, int length, int sample_rate) {
+  if (!g_v2m) g_v2m = v2m_create();
+  return v2m_ctx_open(g_v2m, data, length, sample_rate);
+}
+
+// Before v2m_open() there is nothing to play
 int v2m_write_audio(float *buffer, int buffer_size) {
-  g_sample_time += buffer_size;
-  return v2m.Render(buffer, buffer_size);
+  if (!g_v2m) return 0;
+  return v2m_ctx_write_audio(g_v2m, buffer, buffer_size);
 }
 
 float v2m_get_position_ms() {
-  return v2m.GetTime();
+  if (!g_v2m) return 0;
+  return v2m_ctx_get_position_ms(g_v2m);
 }
 
 float v2m_get_duration_ms() {
-  return 1000 * v2m.Length();
+  if (!g_v2m) return 0;
+  return v2m_ctx_get_duration_ms(g_v2m);
 }
 
 void v2m_seek_ms(int position_ms) {
-  // works with milliseconds because ticks per sec = 1000
-  v2m.Play(position_ms);
-  g_sample_time = (position_ms / 1000) * g_sample_rate;
+  if (g_v2m) v2m_ctx_seek_ms(g_v2m, position_ms);
 }
 
 void v2m_set_speed(float speed) {
-  v2m.SetSpeed(speed);
+  if (g_v2m) v2m_ctx_set_speed(g_v2m, speed);
 }
 
 void v2m_close() {
-  v2m.Close();
-  sdClose();
-
-  if (g_converted_data) {
-    delete g_converted_data;
-    g_converted_data = nullptr;
-  }
+  if (g_v2m) v2m_ctx_close(g_v2m);
 }
 
 #ifdef __cplusplus
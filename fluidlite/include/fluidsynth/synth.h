@@ -390,6 +390,14 @@ FLUIDSYNTH_API int fluid_synth_set_polyphony(fluid_synth_t* synth, int polyphony
   /** Get the polyphony limit (FluidSynth >= 1.0.6) */
 FLUIDSYNTH_API int fluid_synth_get_polyphony(fluid_synth_t* synth);
 
+  /** Get the number of voices allocated for notes since the synth was
+      created */
+FLUIDSYNTH_API unsigned int fluid_synth_get_voices_allocated(fluid_synth_t* synth);
+
+  /** Get how many of those allocations had to stop a playing voice
+      because the polyphony limit was reached */
+FLUIDSYNTH_API unsigned int fluid_synth_get_voices_stolen(fluid_synth_t* synth);
+
   /** Get the internal buffer size. The internal buffer size if not the
       same thing as the buffer size specified in the
       settings. Internally, the synth *always* uses a specific buffer
@@ -67,6 +67,7 @@
 
 #include "fluid_chorus.h"
 #include "fluid_sys.h"
+#include "fluid_simd.h"
 
 #define MAX_CHORUS	99
 #define MAX_DELAY	100
@@ -102,6 +103,18 @@
 */
 #define INTERPOLATION_SAMPLES 5
 
+/* With SIMD, the samples at pos_samples-4..pos_samples-1 are read as one
+   vector. The first CHORUSBUF_GUARD samples of the delay line are copied
+   after its end so that the read never has to wrap around. */
+#ifdef FLUID_SIMD
+#if INTERPOLATION_SAMPLES != 5
+#error "The SIMD chorus interpolation expects INTERPOLATION_SAMPLES == 5"
+#endif
+#define CHORUSBUF_GUARD 4
+#else
+#define CHORUSBUF_GUARD 0
+#endif
+
 /* Private data for SKEL file */
 struct _fluid_chorus_t {
   /* Store the values between fluid_chorus_set_xxx and fluid_chorus_update
@@ -132,6 +145,10 @@ struct _fluid_chorus_t {
 
   /* sinc lookup table */
   fluid_real_t sinc_table[INTERPOLATION_SAMPLES][INTERPOLATION_SUBSAMPLES];
+#ifdef FLUID_SIMD
+  /* sinc_table[4..1][subsample], in the order of the samples they weigh */
+  fluid_real_t sinc_table_v4[INTERPOLATION_SUBSAMPLES][4];
+#endif
 };
 
 void fluid_chorus_triangle(int *buf, int len, int depth);
@@ -176,6 +193,14 @@ new_fluid_chorus(fluid_real_t sample_rate)
     };
   };
 
+#ifdef FLUID_SIMD
+  for (ii = 0; ii < INTERPOLATION_SUBSAMPLES; ii++) {
+    for (i = 0; i < 4; i++) {
+      chorus->sinc_table_v4[ii][i] = chorus->sinc_table[INTERPOLATION_SAMPLES - 1 - i][ii];
+    }
+  }
+#endif
+
   /* allocate lookup tables */
   chorus->lookup_tab = FLUID_ARRAY(int, (int) (chorus->sample_rate / MIN_SPEED_HZ));
   if (chorus->lookup_tab == NULL) {
@@ -183,9 +208,10 @@ new_fluid_chorus(fluid_real_t sample_rate)
     goto error_recovery;
   }
 
-  /* allocate sample buffer */
+  /* allocate sample buffer, with a copy of the first
+   * CHORUSBUF_GUARD samples after the end */
 
-  chorus->chorusbuf = FLUID_ARRAY(fluid_real_t, MAX_SAMPLES);
+  chorus->chorusbuf = FLUID_ARRAY(fluid_real_t, MAX_SAMPLES + CHORUSBUF_GUARD);
   if (chorus->chorusbuf == NULL) {
     fluid_log(FLUID_PANIC, "chorus: Out of memory");
     goto error_recovery;
@@ -208,7 +234,7 @@ fluid_chorus_init(fluid_chorus_t* chorus)
 {
   int i;
 
-  for (i = 0; i < MAX_SAMPLES; i++) {
+  for (i = 0; i < MAX_SAMPLES + CHORUSBUF_GUARD; i++) {
     chorus->chorusbuf[i] = 0.0;
   }
 
@@ -423,14 +449,18 @@ fluid_chorus_update(fluid_chorus_t* chorus)
 }
 
 
-void fluid_chorus_processmix(fluid_chorus_t* chorus, fluid_real_t *in,
-			    fluid_real_t *left_out, fluid_real_t *right_out)
+static void
+fluid_chorus_processblock(fluid_chorus_t* chorus, fluid_real_t *in,
+			  fluid_real_t *left_out, fluid_real_t *right_out, int mix)
 {
   int sample_index;
   int i;
   fluid_real_t d_in, d_out;
 
   for (sample_index = 0; sample_index < FLUID_BUFSIZE; sample_index++) {
+#ifdef FLUID_SIMD
+    fluid_v4 v_out = fluid_v4_set1(0);
+#endif
 
     d_in = in[sample_index];
     d_out = 0.0f;
@@ -443,9 +473,11 @@ void fluid_chorus_processmix(fluid_chorus_t* chorus, fluid_real_t *in,
 
     /* Write the current sample into the circular buffer */
     chorus->chorusbuf[chorus->counter] = d_in;
+    if (chorus->counter < CHORUSBUF_GUARD) {
+      chorus->chorusbuf[MAX_SAMPLES + chorus->counter] = d_in;
+    }
 
     for (i = 0; i < chorus->number_blocks; i++) {
-      int ii;
       /* Calculate the delay in subsamples for the delay line of chorus block nr. */
 
       /* The value in the lookup table is so, that this expression
@@ -460,102 +492,69 @@ void fluid_chorus_processmix(fluid_chorus_t* chorus, fluid_real_t *in,
       /* modulo divide by INTERPOLATION_SUBSAMPLES */
       pos_subsamples &= INTERPOLATION_SUBSAMPLES_ANDMASK;
 
-      for (ii = 0; ii < INTERPOLATION_SAMPLES; ii++){
-	/* Add the delayed signal to the chorus sum d_out Note: The
-	 * delay in the delay line moves backwards for increasing
-	 * delay!*/
-
-	/* The & in chorusbuf[...] is equivalent to a division modulo
-	   MAX_SAMPLES, only faster. */
-	d_out += chorus->chorusbuf[pos_samples & MAX_SAMPLES_ANDMASK]
-	  * chorus->sinc_table[ii][pos_subsamples];
-
-	pos_samples--;
-      };
+#ifdef FLUID_SIMD
+      /* The four oldest of the interpolated samples are contiguous in
+       * chorusbuf thanks to the guard copy, they go through a single
+       * vector multiply. */
+      v_out = fluid_v4_add(v_out,
+	fluid_v4_mul(fluid_v4_load(&chorus->chorusbuf[(pos_samples - 4) & MAX_SAMPLES_ANDMASK]),
+		     fluid_v4_load(chorus->sinc_table_v4[pos_subsamples])));
+      d_out += chorus->chorusbuf[pos_samples & MAX_SAMPLES_ANDMASK]
+	* chorus->sinc_table[0][pos_subsamples];
+#else
+      {
+	int ii;
+	for (ii = 0; ii < INTERPOLATION_SAMPLES; ii++){
+	  /* Add the delayed signal to the chorus sum d_out Note: The
+	   * delay in the delay line moves backwards for increasing
+	   * delay!*/
+
+	  /* The & in chorusbuf[...] is equivalent to a division modulo
+	     MAX_SAMPLES, only faster. */
+	  d_out += chorus->chorusbuf[pos_samples & MAX_SAMPLES_ANDMASK]
+	    * chorus->sinc_table[ii][pos_subsamples];
+
+	  pos_samples--;
+	};
+      }
+#endif
       /* Cycle the phase of the modulating LFO */
-      chorus->phase[i]++;
-      chorus->phase[i] %= (chorus->modulation_period_samples);
+      if (++chorus->phase[i] >= chorus->modulation_period_samples) {
+	chorus->phase[i] %= chorus->modulation_period_samples;
+      }
     } /* foreach chorus block */
 
+#ifdef FLUID_SIMD
+    d_out += fluid_v4_hsum(v_out);
+#endif
     d_out *= chorus->level;
 
-    /* Add the chorus sum d_out to output */
-    left_out[sample_index] += d_out;
-    right_out[sample_index] += d_out;
+    if (mix) {
+      /* Add the chorus sum d_out to output */
+      left_out[sample_index] += d_out;
+      right_out[sample_index] += d_out;
+    } else {
+      /* Store the chorus sum d_out to output */
+      left_out[sample_index] = d_out;
+      right_out[sample_index] = d_out;
+    }
 
     /* Move forward in circular buffer */
-    chorus->counter++;
-    chorus->counter %= MAX_SAMPLES;
+    chorus->counter = (chorus->counter + 1) & MAX_SAMPLES_ANDMASK;
 
   } /* foreach sample */
 }
 
-/* Duplication of code ... (replaces sample data instead of mixing) */
+void fluid_chorus_processmix(fluid_chorus_t* chorus, fluid_real_t *in,
+			    fluid_real_t *left_out, fluid_real_t *right_out)
+{
+  fluid_chorus_processblock(chorus, in, left_out, right_out, 1);
+}
+
 void fluid_chorus_processreplace(fluid_chorus_t* chorus, fluid_real_t *in,
 				fluid_real_t *left_out, fluid_real_t *right_out)
 {
-  int sample_index;
-  int i;
-  fluid_real_t d_in, d_out;
-
-  for (sample_index = 0; sample_index < FLUID_BUFSIZE; sample_index++) {
-
-    d_in = in[sample_index];
-    d_out = 0.0f;
-
-# if 0
-    /* Debug: Listen to the chorus signal only */
-    left_out[sample_index]=0;
-    right_out[sample_index]=0;
-#endif
-
-    /* Write the current sample into the circular buffer */
-    chorus->chorusbuf[chorus->counter] = d_in;
-
-    for (i = 0; i < chorus->number_blocks; i++) {
-      int ii;
-      /* Calculate the delay in subsamples for the delay line of chorus block nr. */
-
-      /* The value in the lookup table is so, that this expression
-       * will always be positive.  It will always include a number of
-       * full periods of MAX_SAMPLES*INTERPOLATION_SUBSAMPLES to
-       * remain positive at all times. */
-      int pos_subsamples = (INTERPOLATION_SUBSAMPLES * chorus->counter
-			    - chorus->lookup_tab[chorus->phase[i]]);
-
-      int pos_samples = pos_subsamples / INTERPOLATION_SUBSAMPLES;
-
-      /* modulo divide by INTERPOLATION_SUBSAMPLES */
-      pos_subsamples &= INTERPOLATION_SUBSAMPLES_ANDMASK;
-
-      for (ii = 0; ii < INTERPOLATION_SAMPLES; ii++){
-	/* Add the delayed signal to the chorus sum d_out Note: The
-	 * delay in the delay line moves backwards for increasing
-	 * delay!*/
-
-	/* The & in chorusbuf[...] is equivalent to a division modulo
-	   MAX_SAMPLES, only faster. */
-	d_out += chorus->chorusbuf[pos_samples & MAX_SAMPLES_ANDMASK]
-	  * chorus->sinc_table[ii][pos_subsamples];
-
-	pos_samples--;
-      };
-      /* Cycle the phase of the modulating LFO */
-      chorus->phase[i]++;
-      chorus->phase[i] %= (chorus->modulation_period_samples);
-    } /* foreach chorus block */
-
-    d_out *= chorus->level;
-
-    /* Store the chorus sum d_out to output */
-    left_out[sample_index] = d_out;
-    right_out[sample_index] = d_out;
-
-    /* Move forward in circular buffer */
-    chorus->counter++;
-    chorus->counter %= MAX_SAMPLES;
-
-  } /* foreach sample */
+  fluid_chorus_processblock(chorus, in, left_out, right_out, 0);
 }
 
 /* Purpose:
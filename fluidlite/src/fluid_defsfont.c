@@ -627,6 +627,134 @@ int fluid_defsfont_iteration_next(fluid_defsfont_t* sfont, fluid_preset_t* prese
   return 1;
 }
 
+/***************************************************************
+ *
+ *                           ZONE INDEX
+ */
+
+/* Marks where the cells of one dimension start: at 0 and at the
+ * lower and upper+1 boundaries of every zone. Returns the number of
+ * cells, first[c] is the first value of cell c. */
+static int
+fluid_zone_index_cells(unsigned char* cell, int* first, int* range, int count)
+{
+  char edge[128];
+  int i, n = 0;
+
+  FLUID_MEMSET(edge, 0, sizeof(edge));
+  edge[0] = 1;
+  for (i = 0; i < count; i++) {
+    int lo = range[4 * i], hi = range[4 * i + 1];
+    if ((lo > 0) && (lo < 128)) {
+      edge[lo] = 1;
+    }
+    if ((hi >= 0) && (hi < 127)) {
+      edge[hi + 1] = 1;
+    }
+  }
+  for (i = 0; i < 128; i++) {
+    if (edge[i]) {
+      first[n++] = i;
+    }
+    cell[i] = (unsigned char) (n - 1);
+  }
+  return n;
+}
+
+/*
+ * fluid_zone_index_build
+ *
+ * Builds the index of 'count' zones. range holds keylo, keyhi, vello
+ * and velhi of each zone. Keys and velocities outside 0..127 match no
+ * zone.
+ */
+int
+fluid_zone_index_build(fluid_zone_index_t* index, void** zone, int* range, int count)
+{
+  int key_first[128], vel_first[128];
+  int key_cells, c, i, k, n;
+
+  fluid_zone_index_free(index);
+
+  key_cells = fluid_zone_index_cells(index->key_cell, key_first, range, count);
+  index->vel_cells = fluid_zone_index_cells(index->vel_cell, vel_first, range + 2, count);
+
+  /* Every zone either covers a cell completely or not at all, so
+   * checking the first key and velocity of the cell is enough. The
+   * first pass counts, the second one fills in. */
+  index->cell = FLUID_ARRAY(int, key_cells * index->vel_cells + 1);
+  if (index->cell == NULL) {
+    FLUID_LOG(FLUID_ERR, "Out of memory");
+    return FLUID_FAILED;
+  }
+
+  for (k = 0; k < 2; k++) {
+    n = 0;
+    for (c = 0; c < key_cells * index->vel_cells; c++) {
+      int key = key_first[c / index->vel_cells];
+      int vel = vel_first[c % index->vel_cells];
+      index->cell[c] = n;
+      for (i = 0; i < count; i++) {
+	if ((range[4 * i] <= key) && (range[4 * i + 1] >= key)
+	    && (range[4 * i + 2] <= vel) && (range[4 * i + 3] >= vel)) {
+	  if (k == 1) {
+	    index->zone[n] = zone[i];
+	  }
+	  n++;
+	}
+      }
+    }
+    index->cell[c] = n;
+
+    if (k == 0) {
+      index->zone = FLUID_ARRAY(void*, n + 1);
+      if (index->zone == NULL) {
+	FLUID_LOG(FLUID_ERR, "Out of memory");
+	fluid_zone_index_free(index);
+	return FLUID_FAILED;
+      }
+    }
+  }
+  return FLUID_OK;
+}
+
+/*
+ * fluid_zone_index_free
+ */
+void
+fluid_zone_index_free(fluid_zone_index_t* index)
+{
+  if (index->cell != NULL) {
+    FLUID_FREE(index->cell);
+    index->cell = NULL;
+  }
+  if (index->zone != NULL) {
+    FLUID_FREE(index->zone);
+    index->zone = NULL;
+  }
+}
+
+/*
+ * fluid_zone_index_lookup
+ *
+ * Returns the zones that key and vel fall into, in zone list order.
+ */
+void**
+fluid_zone_index_lookup(fluid_zone_index_t* index, int key, int vel, int* count)
+{
+  int c;
+
+  if ((index->cell == NULL) || (key < 0) || (key > 127) || (vel < 0) || (vel > 127)) {
+    *count = 0;
+    return NULL;
+  }
+  c = index->key_cell[key] * index->vel_cells + index->vel_cell[vel];
+  *count = index->cell[c + 1] - index->cell[c];
+  return index->zone + index->cell[c];
+}
+
+
+
 /***************************************************************
  *
  *                           PRESET
@@ -650,6 +778,7 @@ new_fluid_defpreset(fluid_defsfont_t* sfont)
   preset->num = 0;
   preset->global_zone = NULL;
   preset->zone = NULL;
+  FLUID_MEMSET(&preset->zone_index, 0, sizeof(fluid_zone_index_t));
   return preset;
 }
 
@@ -675,6 +804,7 @@ delete_fluid_defpreset(fluid_defpreset_t* preset)
     }
     zone = preset->zone;
   }
+  fluid_zone_index_free(&preset->zone_index);
   FLUID_FREE(preset);
   return err;
 }
@@ -722,214 +852,204 @@ fluid_defpreset_noteon(fluid_defpreset_t* preset, fluid_synth_t* synth, int chan
   fluid_mod_t * mod_list[FLUID_NUM_MOD]; /* list for 'sorting' preset modulators */
   int mod_list_count;
   int i;
+  void** preset_zones, ** inst_zones;
+  int preset_zone_count, inst_zone_count, pz, iz;
 
   global_preset_zone = fluid_defpreset_get_global_zone(preset);
 
-  /* run thru all the zones of this preset */
-  preset_zone = fluid_defpreset_get_zone(preset);
-  while (preset_zone != NULL) {
-
-    /* check if the note falls into the key and velocity range of this
-       preset */
-    if (fluid_preset_zone_inside_range(preset_zone, key, vel)) {
-
-      inst = fluid_preset_zone_get_inst(preset_zone);
-      global_inst_zone = fluid_inst_get_global_zone(inst);
-
-      /* run thru all the zones of this instrument */
-      inst_zone = fluid_inst_get_zone(inst);
-	  while (inst_zone != NULL) {
-
-	/* make sure this instrument zone has a valid sample */
-	sample = fluid_inst_zone_get_sample(inst_zone);
-	if (fluid_sample_in_rom(sample) || (sample == NULL)) {
-	  inst_zone = fluid_inst_zone_next(inst_zone);
-	  continue;
-	}
-
-	/* check if the note falls into the key and velocity range of this
-	   instrument */
-
-	if (fluid_inst_zone_inside_range(inst_zone, key, vel) && (sample != NULL)) {
-
-	  /* this is a good zone. allocate a new synthesis process and
-             initialize it */
-
-	  voice = fluid_synth_alloc_voice(synth, sample, chan, key, vel);
-	  if (voice == NULL) {
-	    return FLUID_FAILED;
-	  }
+  /* run thru all the zones of this preset that the note falls into */
+  preset_zones = fluid_zone_index_lookup(&preset->zone_index, key, vel, &preset_zone_count);
+  for (pz = 0; pz < preset_zone_count; pz++) {
+    preset_zone = (fluid_preset_zone_t*) preset_zones[pz];
 
+    inst = fluid_preset_zone_get_inst(preset_zone);
+    global_inst_zone = fluid_inst_get_global_zone(inst);
 
-	  z = inst_zone;
+    /* run thru all the zones of this instrument that the note
+       falls into */
+    inst_zones = fluid_zone_index_lookup(&inst->zone_index, key, vel, &inst_zone_count);
+    for (iz = 0; iz < inst_zone_count; iz++) {
+      inst_zone = (fluid_inst_zone_t*) inst_zones[iz];
 
-	  /* Instrument level, generators */
+      /* make sure this instrument zone has a valid sample */
+      sample = fluid_inst_zone_get_sample(inst_zone);
+      if (fluid_sample_in_rom(sample) || (sample == NULL)) {
+	continue;
+      }
 
-	  for (i = 0; i < GEN_LAST; i++) {
+      /* this is a good zone. allocate a new synthesis process and
+	 initialize it */
 
-	    /* SF 2.01 section 9.4 'bullet' 4:
-	     *
-	     * A generator in a local instrument zone supersedes a
-	     * global instrument zone generator.  Both cases supersede
-	     * the default generator -> voice_gen_set */
+      voice = fluid_synth_alloc_voice(synth, sample, chan, key, vel);
+      if (voice == NULL) {
+	return FLUID_FAILED;
+      }
 
-	    if (inst_zone->gen[i].flags){
-	      fluid_voice_gen_set(voice, i, inst_zone->gen[i].val);
 
-	    } else if ((global_inst_zone != NULL) && (global_inst_zone->gen[i].flags)) {
-	      fluid_voice_gen_set(voice, i, global_inst_zone->gen[i].val);
+      z = inst_zone;
 
-	    } else {
-	      /* The generator has not been defined in this instrument.
-	       * Do nothing, leave it at the default.
-	       */
-	    }
+      /* Instrument level, generators */
 
-	  } /* for all generators */
+      for (i = 0; i < GEN_LAST; i++) {
 
-	  /* global instrument zone, modulators: Put them all into a
-	   * list. */
+	/* SF 2.01 section 9.4 'bullet' 4:
+	 *
+	 * A generator in a local instrument zone supersedes a
+	 * global instrument zone generator.  Both cases supersede
+	 * the default generator -> voice_gen_set */
 
-	  mod_list_count = 0;
+	if (inst_zone->gen[i].flags){
+	  fluid_voice_gen_set(voice, i, inst_zone->gen[i].val);
 
-	  if (global_inst_zone){
-	    mod = global_inst_zone->mod;
-	    while (mod){
-	      mod_list[mod_list_count++] = mod;
-	      mod = mod->next;
-	    }
-	  }
+	} else if ((global_inst_zone != NULL) && (global_inst_zone->gen[i].flags)) {
+	  fluid_voice_gen_set(voice, i, global_inst_zone->gen[i].val);
 
-	  /* local instrument zone, modulators.
-	   * Replace modulators with the same definition in the list:
-	   * SF 2.01 page 69, 'bullet' 8
+	} else {
+	  /* The generator has not been defined in this instrument.
+	   * Do nothing, leave it at the default.
 	   */
-	  mod = inst_zone->mod;
+	}
 
-	  while (mod){
+      } /* for all generators */
 
-	    /* 'Identical' modulators will be deleted by setting their
-	     *  list entry to NULL.  The list length is known, NULL
-	     *  entries will be ignored later.  SF2.01 section 9.5.1
-	     *  page 69, 'bullet' 3 defines 'identical'.  */
+      /* global instrument zone, modulators: Put them all into a
+       * list. */
 
-	    for (i = 0; i < mod_list_count; i++){
-	      if (mod_list[i] && fluid_mod_test_identity(mod,mod_list[i])){
-		mod_list[i] = NULL;
-	      }
-	    }
+      mod_list_count = 0;
 
-	    /* Finally add the new modulator to to the list. */
-	    mod_list[mod_list_count++] = mod;
-	    mod = mod->next;
-	  }
+      if (global_inst_zone){
+	mod = global_inst_zone->mod;
+	while (mod){
+	  mod_list[mod_list_count++] = mod;
+	  mod = mod->next;
+	}
+      }
 
-	  /* Add instrument modulators (global / local) to the voice. */
-	  for (i = 0; i < mod_list_count; i++){
+      /* local instrument zone, modulators.
+       * Replace modulators with the same definition in the list:
+       * SF 2.01 page 69, 'bullet' 8
+       */
+      mod = inst_zone->mod;
 
-	    mod = mod_list[i];
+      while (mod){
 
-	    if (mod != NULL){ /* disabled modulators CANNOT be skipped. */
+	/* 'Identical' modulators will be deleted by setting their
+	 *  list entry to NULL.  The list length is known, NULL
+	 *  entries will be ignored later.  SF2.01 section 9.5.1
+	 *  page 69, 'bullet' 3 defines 'identical'.  */
 
-	      /* Instrument modulators -supersede- existing (default)
-	       * modulators.  SF 2.01 page 69, 'bullet' 6 */
-	      fluid_voice_add_mod(voice, mod, FLUID_VOICE_OVERWRITE);
-	    }
+	for (i = 0; i < mod_list_count; i++){
+	  if (mod_list[i] && fluid_mod_test_identity(mod,mod_list[i])){
+	    mod_list[i] = NULL;
 	  }
+	}
 
-	  /* Preset level, generators */
-
-	  for (i = 0; i < GEN_LAST; i++) {
-
-	    /* SF 2.01 section 8.5 page 58: If some generators are
-	     * encountered at preset level, they should be ignored */
-	    if ((i != GEN_STARTADDROFS)
-		&& (i != GEN_ENDADDROFS)
-		&& (i != GEN_STARTLOOPADDROFS)
-		&& (i != GEN_ENDLOOPADDROFS)
-		&& (i != GEN_STARTADDRCOARSEOFS)
-		&& (i != GEN_ENDADDRCOARSEOFS)
-		&& (i != GEN_STARTLOOPADDRCOARSEOFS)
-		&& (i != GEN_KEYNUM)
-		&& (i != GEN_VELOCITY)
-		&& (i != GEN_ENDLOOPADDRCOARSEOFS)
-		&& (i != GEN_SAMPLEMODE)
-		&& (i != GEN_EXCLUSIVECLASS)
-		&& (i != GEN_OVERRIDEROOTKEY)) {
-
-	      /* SF 2.01 section 9.4 'bullet' 9: A generator in a
-	       * local preset zone supersedes a global preset zone
-	       * generator.  The effect is -added- to the destination
-	       * summing node -> voice_gen_incr */
-
-	      if (preset_zone->gen[i].flags) {
-		fluid_voice_gen_incr(voice, i, preset_zone->gen[i].val);
-	      } else if ((global_preset_zone != NULL) && global_preset_zone->gen[i].flags) {
-		fluid_voice_gen_incr(voice, i, global_preset_zone->gen[i].val);
-	      } else {
-		/* The generator has not been defined in this preset
-		 * Do nothing, leave it unchanged.
-		 */
-	      }
-	    } /* if available at preset level */
-	  } /* for all generators */
-
-
-	  /* Global preset zone, modulators: put them all into a
-	   * list. */
-	  mod_list_count = 0;
-	  if (global_preset_zone){
-	    mod = global_preset_zone->mod;
-	    while (mod){
-	      mod_list[mod_list_count++] = mod;
-	      mod = mod->next;
-	    }
-	  }
+	/* Finally add the new modulator to to the list. */
+	mod_list[mod_list_count++] = mod;
+	mod = mod->next;
+      }
 
-	  /* Process the modulators of the local preset zone.  Kick
-	   * out all identical modulators from the global preset zone
-	   * (SF 2.01 page 69, second-last bullet) */
+      /* Add instrument modulators (global / local) to the voice. */
+      for (i = 0; i < mod_list_count; i++){
 
-	  mod = preset_zone->mod;
-	  while (mod){
-	    for (i = 0; i < mod_list_count; i++){
-	      if (mod_list[i] && fluid_mod_test_identity(mod,mod_list[i])){
-		mod_list[i] = NULL;
-	      }
-	    }
+	mod = mod_list[i];
 
-	    /* Finally add the new modulator to the list. */
-	    mod_list[mod_list_count++] = mod;
-	    mod = mod->next;
-	  }
+	if (mod != NULL){ /* disabled modulators CANNOT be skipped. */
 
-	  /* Add preset modulators (global / local) to the voice. */
-	  for (i = 0; i < mod_list_count; i++){
-	    mod = mod_list[i];
-	    if ((mod != NULL) && (mod->amount != 0)) { /* disabled modulators can be skipped. */
+	  /* Instrument modulators -supersede- existing (default)
+	   * modulators.  SF 2.01 page 69, 'bullet' 6 */
+	  fluid_voice_add_mod(voice, mod, FLUID_VOICE_OVERWRITE);
+	}
+      }
 
-	      /* Preset modulators -add- to existing instrument /
-	       * default modulators.  SF2.01 page 70 first bullet on
-	       * page */
-	      fluid_voice_add_mod(voice, mod, FLUID_VOICE_ADD);
-	    }
+      /* Preset level, generators */
+
+      for (i = 0; i < GEN_LAST; i++) {
+
+	/* SF 2.01 section 8.5 page 58: If some generators are
+	 * encountered at preset level, they should be ignored */
+	if ((i != GEN_STARTADDROFS)
+	    && (i != GEN_ENDADDROFS)
+	    && (i != GEN_STARTLOOPADDROFS)
+	    && (i != GEN_ENDLOOPADDROFS)
+	    && (i != GEN_STARTADDRCOARSEOFS)
+	    && (i != GEN_ENDADDRCOARSEOFS)
+	    && (i != GEN_STARTLOOPADDRCOARSEOFS)
+	    && (i != GEN_KEYNUM)
+	    && (i != GEN_VELOCITY)
+	    && (i != GEN_ENDLOOPADDRCOARSEOFS)
+	    && (i != GEN_SAMPLEMODE)
+	    && (i != GEN_EXCLUSIVECLASS)
+	    && (i != GEN_OVERRIDEROOTKEY)) {
+
+	  /* SF 2.01 section 9.4 'bullet' 9: A generator in a
+	   * local preset zone supersedes a global preset zone
+	   * generator.  The effect is -added- to the destination
+	   * summing node -> voice_gen_incr */
+
+	  if (preset_zone->gen[i].flags) {
+	    fluid_voice_gen_incr(voice, i, preset_zone->gen[i].val);
+	  } else if ((global_preset_zone != NULL) && global_preset_zone->gen[i].flags) {
+	    fluid_voice_gen_incr(voice, i, global_preset_zone->gen[i].val);
+	  } else {
+	    /* The generator has not been defined in this preset
+	     * Do nothing, leave it unchanged.
+	     */
 	  }
+	} /* if available at preset level */
+      } /* for all generators */
+
+
+      /* Global preset zone, modulators: put them all into a
+       * list. */
+      mod_list_count = 0;
+      if (global_preset_zone){
+	mod = global_preset_zone->mod;
+	while (mod){
+	  mod_list[mod_list_count++] = mod;
+	  mod = mod->next;
+	}
+      }
 
-	  /* add the synthesis process to the synthesis loop. */
-	  fluid_synth_start_voice(synth, voice);
+      /* Process the modulators of the local preset zone.  Kick
+       * out all identical modulators from the global preset zone
+       * (SF 2.01 page 69, second-last bullet) */
 
-	  /* Store the ID of the first voice that was created by this noteon event.
-	   * Exclusive class may only terminate older voices.
-	   * That avoids killing voices, which have just been created.
-	   * (a noteon event can create several voice processes with the same exclusive
-	   * class - for example when using stereo samples)
-	   */
+      mod = preset_zone->mod;
+      while (mod){
+	for (i = 0; i < mod_list_count; i++){
+	  if (mod_list[i] && fluid_mod_test_identity(mod,mod_list[i])){
+	    mod_list[i] = NULL;
+	  }
 	}
 
-	inst_zone = fluid_inst_zone_next(inst_zone);
+	/* Finally add the new modulator to the list. */
+	mod_list[mod_list_count++] = mod;
+	mod = mod->next;
       }
+
+      /* Add preset modulators (global / local) to the voice. */
+      for (i = 0; i < mod_list_count; i++){
+	mod = mod_list[i];
+	if ((mod != NULL) && (mod->amount != 0)) { /* disabled modulators can be skipped. */
+
+	  /* Preset modulators -add- to existing instrument /
+	   * default modulators.  SF2.01 page 70 first bullet on
+	   * page */
+	  fluid_voice_add_mod(voice, mod, FLUID_VOICE_ADD);
 	}
-    preset_zone = fluid_preset_zone_next(preset_zone);
+      }
+
+      /* add the synthesis process to the synthesis loop. */
+      fluid_synth_start_voice(synth, voice);
+
+      /* Store the ID of the first voice that was created by this noteon event.
+       * Exclusive class may only terminate older voices.
+       * That avoids killing voices, which have just been created.
+       * (a noteon event can create several voice processes with the same exclusive
+       * class - for example when using stereo samples)
+       */
+    }
   }
 
   return FLUID_OK;
@@ -945,6 +1065,46 @@ fluid_defpreset_set_global_zone(fluid_defpreset_t* preset, fluid_preset_zone_t*
   return FLUID_OK;
 }
 
+/*
+ * fluid_defpreset_index_zones
+ */
+static int
+fluid_defpreset_index_zones(fluid_defpreset_t* preset)
+{
+  fluid_preset_zone_t* zone;
+  void** zones;
+  int* range;
+  int count = 0, err;
+
+  for (zone = preset->zone; zone != NULL; zone = zone->next) {
+    count++;
+  }
+  zones = FLUID_ARRAY(void*, count + 1);
+  range = FLUID_ARRAY(int, 4 * count + 4);
+  if ((zones == NULL) || (range == NULL)) {
+    FLUID_LOG(FLUID_ERR, "Out of memory");
+    err = FLUID_FAILED;
+  } else {
+    count = 0;
+    for (zone = preset->zone; zone != NULL; zone = zone->next) {
+      zones[count] = zone;
+      range[4 * count] = zone->keylo;
+      range[4 * count + 1] = zone->keyhi;
+      range[4 * count + 2] = zone->vello;
+      range[4 * count + 3] = zone->velhi;
+      count++;
+    }
+    err = fluid_zone_index_build(&preset->zone_index, zones, range, count);
+  }
+  if (zones != NULL) {
+    FLUID_FREE(zones);
+  }
+  if (range != NULL) {
+    FLUID_FREE(range);
+  }
+  return err;
+}
+
 /*
  * fluid_defpreset_import_sfont
  */
@@ -985,7 +1145,7 @@ fluid_defpreset_import_sfont(fluid_defpreset_t* preset,
     p = fluid_list_next(p);
     count++;
   }
-  return FLUID_OK;
+  return fluid_defpreset_index_zones(preset);
 }
 
 /*
@@ -1306,6 +1466,7 @@ new_fluid_inst()
   inst->name[0] = 0;
   inst->global_zone = NULL;
   inst->zone = NULL;
+  FLUID_MEMSET(&inst->zone_index, 0, sizeof(fluid_zone_index_t));
   return inst;
 }
 
@@ -1331,6 +1492,7 @@ delete_fluid_inst(fluid_inst_t* inst)
     }
     zone = inst->zone;
   }
+  fluid_zone_index_free(&inst->zone_index);
   FLUID_FREE(inst);
   return err;
 }
@@ -1345,6 +1507,46 @@ fluid_inst_set_global_zone(fluid_inst_t* inst, fluid_inst_zone_t* zone)
   return FLUID_OK;
 }
 
+/*
+ * fluid_inst_index_zones
+ */
+static int
+fluid_inst_index_zones(fluid_inst_t* inst)
+{
+  fluid_inst_zone_t* zone;
+  void** zones;
+  int* range;
+  int count = 0, err;
+
+  for (zone = inst->zone; zone != NULL; zone = zone->next) {
+    count++;
+  }
+  zones = FLUID_ARRAY(void*, count + 1);
+  range = FLUID_ARRAY(int, 4 * count + 4);
+  if ((zones == NULL) || (range == NULL)) {
+    FLUID_LOG(FLUID_ERR, "Out of memory");
+    err = FLUID_FAILED;
+  } else {
+    count = 0;
+    for (zone = inst->zone; zone != NULL; zone = zone->next) {
+      zones[count] = zone;
+      range[4 * count] = zone->keylo;
+      range[4 * count + 1] = zone->keyhi;
+      range[4 * count + 2] = zone->vello;
+      range[4 * count + 3] = zone->velhi;
+      count++;
+    }
+    err = fluid_zone_index_build(&inst->zone_index, zones, range, count);
+  }
+  if (zones != NULL) {
+    FLUID_FREE(zones);
+  }
+  if (range != NULL) {
+    FLUID_FREE(range);
+  }
+  return err;
+}
+
 /*
  * fluid_inst_import_sfont
  */
@@ -1389,7 +1591,7 @@ fluid_inst_import_sfont(fluid_inst_t* inst, SFInst *sfinst, fluid_defsfont_t* sf
     p = fluid_list_next(p);
     count++;
   }
-  return FLUID_OK;
+  return fluid_inst_index_zones(inst);
 }
 
 /*
@@ -504,6 +504,28 @@ int fluid_defsfont_add_preset(fluid_defsfont_t* sfont, fluid_defpreset_t* preset
 fluid_sample_t* fluid_defsfont_get_sample(fluid_defsfont_t* sfont, char *s);
 
 
+/*
+ * fluid_zone_index_t
+ *
+ * Finds the zones of a preset or instrument that a key and velocity
+ * fall into without walking the zone list.  The zone boundaries split
+ * the key and velocity ranges into cells, and every cell lists its
+ * zones in the order of the zone list.  Built once at load time.
+ */
+typedef struct _fluid_zone_index_t
+{
+  unsigned char key_cell[128];          /* key -> key cell */
+  unsigned char vel_cell[128];          /* velocity -> velocity cell */
+  int vel_cells;                        /* number of velocity cells */
+  int* cell;                            /* zones of cell c: zone[cell[c]] .. zone[cell[c + 1] - 1] */
+  void** zone;
+} fluid_zone_index_t;
+
+int fluid_zone_index_build(fluid_zone_index_t* index, void** zone, int* range, int count);
+void fluid_zone_index_free(fluid_zone_index_t* index);
+void** fluid_zone_index_lookup(fluid_zone_index_t* index, int key, int vel, int* count);
+
+
 /*
  * fluid_preset_t
  */
@@ -516,6 +538,7 @@ struct _fluid_defpreset_t
   unsigned int num;                     /* the preset number */
   fluid_preset_zone_t* global_zone;        /* the global zone of the preset */
   fluid_preset_zone_t* zone;               /* the chained list of preset zones */
+  fluid_zone_index_t zone_index;           /* key/velocity lookup of 'zone' */
 };
 
 fluid_defpreset_t* new_fluid_defpreset(fluid_defsfont_t* sfont);
@@ -562,6 +585,7 @@ struct _fluid_inst_t
   char name[21];
   fluid_inst_zone_t* global_zone;
   fluid_inst_zone_t* zone;
+  fluid_zone_index_t zone_index;           /* key/velocity lookup of 'zone' */
 };
 
 fluid_inst_t* new_fluid_inst(void);
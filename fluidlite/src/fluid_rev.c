@@ -10,6 +10,7 @@
 */
 
 #include "fluid_rev.h"
+#include "fluid_simd.h"
 
 /***************************************************************
  *
@@ -402,6 +403,185 @@ fluid_revmodel_reset(fluid_revmodel_t* rev)
   fluid_revmodel_init(rev);
 }
 
+#ifdef FLUID_SIMD
+
+/* Every comb and allpass delay is longer than a block, so all samples a
+ * filter reads during a block were written before the block started.
+ * That lets the delay lines be read and written a block at a time. */
+#if FLUID_BUFSIZE > allpasstuningL4 || FLUID_BUFSIZE % 4 || numcombs % 4
+#error "FLUID_BUFSIZE must fit the shortest delay line, blocks and combs must be multiples of 4"
+#endif
+
+/* Copies the next FLUID_BUFSIZE samples of a delay line starting at
+ * bufidx into block, or back from block into the delay line. */
+static void
+fluid_rev_readblock(fluid_real_t *buffer, int bufsize, int bufidx, fluid_real_t *block)
+{
+  int n = bufsize - bufidx < FLUID_BUFSIZE ? bufsize - bufidx : FLUID_BUFSIZE;
+  FLUID_MEMCPY(block, buffer + bufidx, n * sizeof(fluid_real_t));
+  FLUID_MEMCPY(block + n, buffer, (FLUID_BUFSIZE - n) * sizeof(fluid_real_t));
+}
+
+static void
+fluid_rev_writeblock(fluid_real_t *buffer, int bufsize, int bufidx, fluid_real_t *block)
+{
+  int n = bufsize - bufidx < FLUID_BUFSIZE ? bufsize - bufidx : FLUID_BUFSIZE;
+  FLUID_MEMCPY(buffer + bufidx, block, n * sizeof(fluid_real_t));
+  FLUID_MEMCPY(buffer, block + n, (FLUID_BUFSIZE - n) * sizeof(fluid_real_t));
+}
+
+/* Same as fluid_comb_process for a block of samples on all numcombs
+ * combs of one side, with the sum of their outputs stored in out. Only
+ * the damping filter depends on the previous sample, it runs on four
+ * combs at once. */
+static void
+fluid_comb_processblock(fluid_comb* combs, fluid_real_t *input, fluid_real_t *out)
+{
+  fluid_real_t taps[numcombs][FLUID_BUFSIZE];
+  int i, k;
+
+  for (i = 0; i < numcombs; i++) {
+    fluid_rev_readblock(combs[i].buffer, combs[i].bufsize, combs[i].bufidx, taps[i]);
+  }
+
+  for (k = 0; k < FLUID_BUFSIZE; k += 4) {
+    fluid_v4 sum = fluid_v4_set1(0);
+    for (i = 0; i < numcombs; i++) {
+      sum = fluid_v4_add(sum, fluid_v4_load(&taps[i][k]));
+    }
+    fluid_v4_store(&out[k], sum);
+  }
+
+  /* The lanes hold four combs, the tap blocks get transposed to match */
+  for (i = 0; i < numcombs; i += 4) {
+    fluid_real_t lanes[4][4];
+    fluid_v4 filterstore, damp1, damp2, feedback;
+    int c;
+    for (c = 0; c < 4; c++) {
+      lanes[0][c] = combs[i + c].filterstore;
+      lanes[1][c] = combs[i + c].damp1;
+      lanes[2][c] = combs[i + c].damp2;
+      lanes[3][c] = combs[i + c].feedback;
+    }
+    filterstore = fluid_v4_load(lanes[0]);
+    damp1 = fluid_v4_load(lanes[1]);
+    damp2 = fluid_v4_load(lanes[2]);
+    feedback = fluid_v4_load(lanes[3]);
+
+    for (k = 0; k < FLUID_BUFSIZE; k += 4) {
+      fluid_v4 t0 = fluid_v4_load(&taps[i][k]), t1 = fluid_v4_load(&taps[i + 1][k]);
+      fluid_v4 t2 = fluid_v4_load(&taps[i + 2][k]), t3 = fluid_v4_load(&taps[i + 3][k]);
+      FLUID_V4_TRANSPOSE(t0, t1, t2, t3);
+      filterstore = fluid_v4_add(fluid_v4_mul(t0, damp2), fluid_v4_mul(filterstore, damp1));
+      t0 = fluid_v4_add(fluid_v4_set1(input[k]), fluid_v4_mul(filterstore, feedback));
+      filterstore = fluid_v4_add(fluid_v4_mul(t1, damp2), fluid_v4_mul(filterstore, damp1));
+      t1 = fluid_v4_add(fluid_v4_set1(input[k + 1]), fluid_v4_mul(filterstore, feedback));
+      filterstore = fluid_v4_add(fluid_v4_mul(t2, damp2), fluid_v4_mul(filterstore, damp1));
+      t2 = fluid_v4_add(fluid_v4_set1(input[k + 2]), fluid_v4_mul(filterstore, feedback));
+      filterstore = fluid_v4_add(fluid_v4_mul(t3, damp2), fluid_v4_mul(filterstore, damp1));
+      t3 = fluid_v4_add(fluid_v4_set1(input[k + 3]), fluid_v4_mul(filterstore, feedback));
+      FLUID_V4_TRANSPOSE(t0, t1, t2, t3);
+      fluid_v4_store(&taps[i][k], t0);
+      fluid_v4_store(&taps[i + 1][k], t1);
+      fluid_v4_store(&taps[i + 2][k], t2);
+      fluid_v4_store(&taps[i + 3][k], t3);
+    }
+
+    fluid_v4_store(lanes[0], filterstore);
+    for (c = 0; c < 4; c++) {
+      combs[i + c].filterstore = lanes[0][c];
+    }
+  }
+
+  for (i = 0; i < numcombs; i++) {
+    fluid_rev_writeblock(combs[i].buffer, combs[i].bufsize, combs[i].bufidx, taps[i]);
+    combs[i].bufidx += FLUID_BUFSIZE;
+    if (combs[i].bufidx >= combs[i].bufsize) {
+      combs[i].bufidx -= combs[i].bufsize;
+    }
+  }
+}
+
+/* Same as fluid_allpass_process for a block of samples, in place */
+static void
+fluid_allpass_processblock(fluid_allpass* allpass, fluid_real_t *inout)
+{
+  fluid_real_t buf[FLUID_BUFSIZE];
+  fluid_v4 feedback = fluid_v4_set1(allpass->feedback);
+  int k;
+
+  fluid_rev_readblock(allpass->buffer, allpass->bufsize, allpass->bufidx, buf);
+  for (k = 0; k < FLUID_BUFSIZE; k += 4) {
+    fluid_v4 bufout = fluid_v4_load(&buf[k]), input = fluid_v4_load(&inout[k]);
+    fluid_v4_store(&buf[k], fluid_v4_add(input, fluid_v4_mul(bufout, feedback)));
+    fluid_v4_store(&inout[k], fluid_v4_sub(bufout, input));
+  }
+  fluid_rev_writeblock(allpass->buffer, allpass->bufsize, allpass->bufidx, buf);
+
+  allpass->bufidx += FLUID_BUFSIZE;
+  if (allpass->bufidx >= allpass->bufsize) {
+    allpass->bufidx -= allpass->bufsize;
+  }
+}
+
+static void
+fluid_revmodel_processblock(fluid_revmodel_t* rev, fluid_real_t *in,
+			    fluid_real_t *left_out, fluid_real_t *right_out, int mix)
+{
+  int i, k;
+  fluid_real_t outL[FLUID_BUFSIZE], outR[FLUID_BUFSIZE], input[FLUID_BUFSIZE];
+
+  /* The original Freeverb code expects a stereo signal and 'input'
+   * is set to the sum of the left and right input sample. Since
+   * this code works on a mono signal, 'input' is set to twice the
+   * input sample. */
+  for (k = 0; k < FLUID_BUFSIZE; k++) {
+    input[k] = (2 * in[k] + DC_OFFSET) * rev->gain;
+  }
+
+  /* Accumulate comb filters in parallel */
+  fluid_comb_processblock(rev->combL, input, outL);
+  fluid_comb_processblock(rev->combR, input, outR);
+
+  /* Feed through allpasses in series */
+  for (i = 0; i < numallpasses; i++) {
+    fluid_allpass_processblock(&rev->allpassL[i], outL);
+    fluid_allpass_processblock(&rev->allpassR[i], outR);
+  }
+
+  for (k = 0; k < FLUID_BUFSIZE; k++) {
+    /* Remove the DC offset */
+    fluid_real_t L = outL[k] - DC_OFFSET;
+    fluid_real_t R = outR[k] - DC_OFFSET;
+
+    if (mix) {
+      /* Calculate output MIXING with anything already there */
+      left_out[k] += L * rev->wet1 + R * rev->wet2;
+      right_out[k] += R * rev->wet1 + L * rev->wet2;
+    } else {
+      /* Calculate output REPLACING anything already there */
+      left_out[k] = L * rev->wet1 + R * rev->wet2;
+      right_out[k] = R * rev->wet1 + L * rev->wet2;
+    }
+  }
+}
+
+void
+fluid_revmodel_processreplace(fluid_revmodel_t* rev, fluid_real_t *in,
+			     fluid_real_t *left_out, fluid_real_t *right_out)
+{
+  fluid_revmodel_processblock(rev, in, left_out, right_out, 0);
+}
+
+void
+fluid_revmodel_processmix(fluid_revmodel_t* rev, fluid_real_t *in,
+			 fluid_real_t *left_out, fluid_real_t *right_out)
+{
+  fluid_revmodel_processblock(rev, in, left_out, right_out, 1);
+}
+
+#else /* !FLUID_SIMD */
+
 void
 fluid_revmodel_processreplace(fluid_revmodel_t* rev, fluid_real_t *in,
 			     fluid_real_t *left_out, fluid_real_t *right_out)
@@ -478,6 +658,8 @@ fluid_revmodel_processmix(fluid_revmodel_t* rev, fluid_real_t *in,
   }
 }
 
+#endif /* FLUID_SIMD */
+
 void
 fluid_revmodel_update(fluid_revmodel_t* rev)
 {
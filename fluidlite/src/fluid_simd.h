@@ -0,0 +1,106 @@
+/* FluidSynth - A Software Synthesizer
+ *
+ * Copyright (C) 2003  Peter Hanappe and others.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public License
+ * as published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the Free
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ * 02111-1307, USA
+ */
+
+
+#ifndef _FLUID_SIMD_H
+#define _FLUID_SIMD_H
+
+#include "fluidsynth_priv.h"
+
+/*
+ * Four lane float vectors for the effects, on SSE, NEON or WebAssembly
+ * SIMD. FLUID_SIMD is only defined if fluid_real_t is float and one of
+ * them is available. Define FLUID_NO_SIMD to always use the plain C
+ * code.
+ *
+ * The loads and stores don't need aligned pointers. fluid_v4_hsum
+ * adds the lanes in the same order everywhere: (0 + 2) + (1 + 3).
+ */
+
+#if defined(WITH_FLOAT) && !defined(FLUID_NO_SIMD)
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define FLUID_SIMD 1
+typedef __m128 fluid_v4;
+#define fluid_v4_load(_p)        _mm_loadu_ps(_p)
+#define fluid_v4_store(_p,_v)    _mm_storeu_ps(_p,_v)
+#define fluid_v4_set1(_x)        _mm_set1_ps(_x)
+#define fluid_v4_add(_a,_b)      _mm_add_ps(_a,_b)
+#define fluid_v4_sub(_a,_b)      _mm_sub_ps(_a,_b)
+#define fluid_v4_mul(_a,_b)      _mm_mul_ps(_a,_b)
+#define FLUID_V4_TRANSPOSE(_a,_b,_c,_d) _MM_TRANSPOSE4_PS(_a,_b,_c,_d)
+static __inline float fluid_v4_hsum(fluid_v4 v)
+{
+  v = _mm_add_ps(v, _mm_movehl_ps(v, v));
+  return _mm_cvtss_f32(_mm_add_ss(v, _mm_shuffle_ps(v, v, 1)));
+}
+
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define FLUID_SIMD 1
+typedef float32x4_t fluid_v4;
+#define fluid_v4_load(_p)        vld1q_f32(_p)
+#define fluid_v4_store(_p,_v)    vst1q_f32(_p,_v)
+#define fluid_v4_set1(_x)        vdupq_n_f32(_x)
+#define fluid_v4_add(_a,_b)      vaddq_f32(_a,_b)
+#define fluid_v4_sub(_a,_b)      vsubq_f32(_a,_b)
+#define fluid_v4_mul(_a,_b)      vmulq_f32(_a,_b)
+#define FLUID_V4_TRANSPOSE(_a,_b,_c,_d) { \
+  float32x4x2_t _ab = vtrnq_f32(_a, _b), _cd = vtrnq_f32(_c, _d); \
+  _a = vcombine_f32(vget_low_f32(_ab.val[0]), vget_low_f32(_cd.val[0])); \
+  _b = vcombine_f32(vget_low_f32(_ab.val[1]), vget_low_f32(_cd.val[1])); \
+  _c = vcombine_f32(vget_high_f32(_ab.val[0]), vget_high_f32(_cd.val[0])); \
+  _d = vcombine_f32(vget_high_f32(_ab.val[1]), vget_high_f32(_cd.val[1])); \
+}
+static __inline float fluid_v4_hsum(fluid_v4 v)
+{
+  float32x2_t s = vadd_f32(vget_low_f32(v), vget_high_f32(v));
+  return vget_lane_f32(vpadd_f32(s, s), 0);
+}
+
+#elif defined(__wasm_simd128__)
+#include <wasm_simd128.h>
+#define FLUID_SIMD 1
+typedef v128_t fluid_v4;
+#define fluid_v4_load(_p)        wasm_v128_load(_p)
+#define fluid_v4_store(_p,_v)    wasm_v128_store(_p,_v)
+#define fluid_v4_set1(_x)        wasm_f32x4_splat(_x)
+#define fluid_v4_add(_a,_b)      wasm_f32x4_add(_a,_b)
+#define fluid_v4_sub(_a,_b)      wasm_f32x4_sub(_a,_b)
+#define fluid_v4_mul(_a,_b)      wasm_f32x4_mul(_a,_b)
+#define FLUID_V4_TRANSPOSE(_a,_b,_c,_d) { \
+  v128_t _t0 = wasm_i32x4_shuffle(_a, _b, 0, 4, 1, 5), _t1 = wasm_i32x4_shuffle(_a, _b, 2, 6, 3, 7); \
+  v128_t _t2 = wasm_i32x4_shuffle(_c, _d, 0, 4, 1, 5), _t3 = wasm_i32x4_shuffle(_c, _d, 2, 6, 3, 7); \
+  _a = wasm_i32x4_shuffle(_t0, _t2, 0, 1, 4, 5); \
+  _b = wasm_i32x4_shuffle(_t0, _t2, 2, 3, 6, 7); \
+  _c = wasm_i32x4_shuffle(_t1, _t3, 0, 1, 4, 5); \
+  _d = wasm_i32x4_shuffle(_t1, _t3, 2, 3, 6, 7); \
+}
+static __inline float fluid_v4_hsum(fluid_v4 v)
+{
+  return (wasm_f32x4_extract_lane(v, 0) + wasm_f32x4_extract_lane(v, 2))
+    + (wasm_f32x4_extract_lane(v, 1) + wasm_f32x4_extract_lane(v, 3));
+}
+#endif
+
+#endif /* WITH_FLOAT && !FLUID_NO_SIMD */
+
+#endif /* _FLUID_SIMD_H */
@@ -19,6 +19,11 @@
  */
 
 #include <math.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
 
 #include "fluid_synth.h"
 #include "fluid_sys.h"
@@ -55,10 +60,22 @@ int fluid_synth_set_gen2(fluid_synth_t* synth, int chan,
  *                         GLOBAL
  */
 
-/* has the synth module been initialized? */
-static int fluid_synth_initialized = 0;
+/* new_fluid_synth() may be called from several threads at once, the first
+ * call initializes the synth module and the others wait for it */
 static void fluid_synth_init(void);
+#ifdef _WIN32
+static INIT_ONCE fluid_synth_init_once = INIT_ONCE_STATIC_INIT;
+static BOOL CALLBACK fluid_synth_init_callback(PINIT_ONCE once, PVOID param, PVOID* context)
+{
+  fluid_synth_init();
+  return TRUE;
+}
+#else
+static pthread_once_t fluid_synth_init_once = PTHREAD_ONCE_INIT;
+#endif
 static void init_dither(void);
+static void fluid_synth_update_kill_prio(fluid_synth_t* synth, fluid_voice_t* voice);
+static void fluid_synth_update_rendered_prio(fluid_synth_t* synth, fluid_voice_t* voice);
 
 static int fluid_synth_sysex_midi_tuning (fluid_synth_t *synth, const char *data,
                                           int len, char *response,
@@ -83,6 +100,10 @@ fluid_mod_t default_reverb_mod;         /* SF2.01 section 8.4.8  */
 fluid_mod_t default_chorus_mod;         /* SF2.01 section 8.4.9  */
 fluid_mod_t default_pitch_bend_mod;     /* SF2.01 section 8.4.10 */
 
+/* All of the above, in that order, copied into every new voice at once */
+#define FLUID_NUM_DEFAULT_MOD 10
+static fluid_mod_t default_mod[FLUID_NUM_DEFAULT_MOD];
+
 /* reverb presets */
 static fluid_revmodel_presets_t revmodel_preset[] = {
   /* name */    /* roomsize */ /* damp */ /* width */ /* level */
@@ -157,8 +178,6 @@ char* fluid_version_str(void)
 static void
 fluid_synth_init()
 {
-  fluid_synth_initialized++;
-
   fluid_conversion_config();
 
   fluid_dsp_float_config();
@@ -315,6 +334,17 @@ fluid_synth_init()
 		       );
   fluid_mod_set_dest(&default_pitch_bend_mod, GEN_PITCH);                 /* Destination: Initial pitch */
   fluid_mod_set_amount(&default_pitch_bend_mod, 12700.0);                 /* Amount: 12700 cents */
+
+  fluid_mod_clone(&default_mod[0], &default_vel2att_mod);
+  fluid_mod_clone(&default_mod[1], &default_vel2filter_mod);
+  fluid_mod_clone(&default_mod[2], &default_at2viblfo_mod);
+  fluid_mod_clone(&default_mod[3], &default_mod2viblfo_mod);
+  fluid_mod_clone(&default_mod[4], &default_att_mod);
+  fluid_mod_clone(&default_mod[5], &default_pan_mod);
+  fluid_mod_clone(&default_mod[6], &default_expr_mod);
+  fluid_mod_clone(&default_mod[7], &default_reverb_mod);
+  fluid_mod_clone(&default_mod[8], &default_chorus_mod);
+  fluid_mod_clone(&default_mod[9], &default_pitch_bend_mod);
 }
 
 
@@ -339,9 +369,11 @@ new_fluid_synth(fluid_settings_t *settings)
   fluid_sfloader_t* loader;
 
   /* initialize all the conversion tables and other stuff */
-  if (fluid_synth_initialized == 0) {
-    fluid_synth_init();
-  }
+#ifdef _WIN32
+  InitOnceExecuteOnce(&fluid_synth_init_once, fluid_synth_init_callback, NULL, NULL);
+#else
+  pthread_once(&fluid_synth_init_once, fluid_synth_init);
+#endif
 
   fluid_synth_verify_settings(settings);
 
@@ -473,6 +505,14 @@ new_fluid_synth(fluid_settings_t *settings)
       goto error_recovery;
     }
   }
+  synth->free_voice = FLUID_ARRAY(int, synth->nvoice);
+  synth->steal_heap = FLUID_ARRAY(fluid_voice_t*, synth->nvoice);
+  if ((synth->free_voice == NULL) || (synth->steal_heap == NULL)) {
+    goto error_recovery;
+  }
+  synth->free_voice_count = 0;
+  synth->steal_heap_count = 0;
+  synth->steal_heap_dirty = 1;
 
   /* Allocate the sample buffers */
   synth->left_buf = NULL;
@@ -577,6 +617,7 @@ fluid_synth_set_sample_rate(fluid_synth_t* synth, float sample_rate)
       delete_fluid_voice(synth->voice[i]);
       synth->voice[i] = new_fluid_voice(synth->sample_rate);
     }
+    synth->steal_heap_dirty = 1;
 
     delete_fluid_chorus(synth->chorus);
     synth->chorus = new_fluid_chorus(synth->sample_rate);
@@ -653,6 +694,14 @@ delete_fluid_synth(fluid_synth_t* synth)
     FLUID_FREE(synth->voice);
   }
 
+  if (synth->free_voice != NULL) {
+    FLUID_FREE(synth->free_voice);
+  }
+
+  if (synth->steal_heap != NULL) {
+    FLUID_FREE(synth->steal_heap);
+  }
+
   /* free all the sample buffers */
   if (synth->left_buf != NULL) {
     for (i = 0; i < synth->nbuf; i++) {
@@ -810,6 +859,7 @@ fluid_synth_noteoff(fluid_synth_t* synth, int chan, int key)
 		 used_voices);
       } /* if verbose */
       fluid_voice_noteoff(voice);
+      fluid_synth_update_kill_prio(synth, voice);
       status = FLUID_OK;
     } /* if voice on */
   } /* for all voices */
@@ -833,6 +883,7 @@ fluid_synth_damp_voices(fluid_synth_t* synth, int chan)
     if ((voice->chan == chan) && _SUSTAINED(voice)) {
 /*        printf("turned off sustained note: chan=%d, key=%d, vel=%d\n", voice->chan, voice->key, voice->vel); */
       fluid_voice_noteoff(voice);
+      fluid_synth_update_kill_prio(synth, voice);
     }
   }
 
@@ -1182,6 +1233,7 @@ fluid_synth_all_notes_off(fluid_synth_t* synth, int chan)
     voice = synth->voice[i];
     if (_PLAYING(voice) && (voice->chan == chan)) {
       fluid_voice_noteoff(voice);
+      fluid_synth_update_kill_prio(synth, voice);
     }
   }
   return FLUID_OK;
@@ -1773,6 +1825,7 @@ int fluid_synth_set_polyphony(fluid_synth_t* synth, int polyphony)
   }
 
   synth->polyphony = polyphony;
+  synth->steal_heap_dirty = 1;
 
   return FLUID_OK;
 }
@@ -1785,6 +1838,22 @@ int fluid_synth_get_polyphony(fluid_synth_t* synth)
   return synth->polyphony;
 }
 
+/*
+ * fluid_synth_get_voices_allocated
+ */
+unsigned int fluid_synth_get_voices_allocated(fluid_synth_t* synth)
+{
+  return synth->voices_allocated;
+}
+
+/*
+ * fluid_synth_get_voices_stolen
+ */
+unsigned int fluid_synth_get_voices_stolen(fluid_synth_t* synth)
+{
+  return synth->voices_stolen;
+}
+
 /*
  * fluid_synth_get_internal_buffer_size
  */
@@ -2193,6 +2262,11 @@ fluid_synth_one_block(fluid_synth_t* synth, int do_not_mix_fx_to_out)
   reverb_buf = synth->with_reverb ? synth->fx_left_buf[0] : NULL;
   chorus_buf = synth->with_chorus ? synth->fx_left_buf[1] : NULL;
 
+  /* The priorities of all voices are recalculated below */
+  if (!synth->steal_heap_dirty) {
+    synth->steal_noteid = synth->noteid;
+  }
+
   /* call all playing synthesis processes */
   for (i = 0; i < synth->polyphony; i++) {
     voice = synth->voice[i];
@@ -2216,7 +2290,14 @@ fluid_synth_one_block(fluid_synth_t* synth, int do_not_mix_fx_to_out)
       right_buf = synth->right_buf[auchan];
 
       fluid_voice_write(voice, left_buf, right_buf, reverb_buf, chorus_buf);
+
+      /* Voices that finished playing can be reused right away */
+      if (_AVAILABLE(voice) && (synth->free_voice_count < synth->nvoice)) {
+	synth->free_voice[synth->free_voice_count++] = i;
+      }
     }
+
+    fluid_synth_update_rendered_prio(synth, voice);
   }
 
   /* if multi channel output, don't mix the output of the chorus and
@@ -2272,6 +2353,193 @@ fluid_synth_one_block(fluid_synth_t* synth, int do_not_mix_fx_to_out)
 }
 
 
+/*
+ * fluid_synth_kill_prio
+ *
+ * Determines how 'important' a playing voice is, the least important
+ * one gets killed when the polyphony runs out.
+ */
+static fluid_real_t
+fluid_synth_kill_prio(fluid_synth_t* synth, fluid_voice_t* voice)
+{
+  /* Start with an arbitrary number */
+  fluid_real_t this_voice_prio = 10000.;
+
+  /* Is this voice on the drum channel?
+   * Then it is very important.
+   * Also, forget about the released-note condition:
+   * Typically, drum notes are triggered only very briefly, they run most
+   * of the time in release phase.
+   */
+  if (voice->chan == 9){
+    this_voice_prio += 4000;
+
+  } else if (_RELEASED(voice)){
+    /* The key for this voice has been released. Consider it much less important
+     * than a voice, which is still held.
+     */
+    this_voice_prio -= 2000.;
+  }
+
+  if (_SUSTAINED(voice)){
+    /* The sustain pedal is held down on this channel.
+     * Consider it less important than non-sustained channels.
+     * This decision is somehow subjective. But usually the sustain pedal
+     * is used to play 'more-voices-than-fingers', so it shouldn't hurt
+     * if we kill one voice.
+     */
+    this_voice_prio -= 1000;
+  }
+
+  /* We are not enthusiastic about releasing voices, which have just been started.
+   * Otherwise hitting a chord may result in killing notes belonging to that very same
+   * chord.
+   * So subtract the age of the voice from the priority - an older voice is just a little
+   * bit less important than a younger voice.
+   * This is a number between roughly 0 and 100. The age is taken relative to
+   * steal_noteid, so that priorities calculated at different times compare
+   * the same way. Voices started after that are younger than 0. */
+  this_voice_prio -= (int) (synth->steal_noteid - fluid_voice_get_id(voice));
+
+  /* take a rough estimate of loudness into account. Louder voices are more important. */
+  if (voice->volenv_section != FLUID_VOICE_ENVATTACK){
+    this_voice_prio += voice->volenv_val * 1000.;
+  }
+
+  return this_voice_prio;
+}
+
+/* Steal heap helpers. Of voices with the same priority, the one with
+ * the lowest index in synth->voice[] gets killed first. */
+#define FLUID_KILL_BEFORE(_a, _b) (((_a)->kill_prio < (_b)->kill_prio) \
+  || (((_a)->kill_prio == (_b)->kill_prio) && ((_a)->kill_slot < (_b)->kill_slot)))
+
+static void
+fluid_synth_steal_heap_set(fluid_synth_t* synth, int pos, fluid_voice_t* voice)
+{
+  synth->steal_heap[pos] = voice;
+  voice->kill_pos = pos;
+}
+
+static void
+fluid_synth_steal_heap_down(fluid_synth_t* synth, int pos)
+{
+  fluid_voice_t** heap = synth->steal_heap;
+  fluid_voice_t* voice = heap[pos];
+  int child;
+
+  while ((child = 2 * pos + 1) < synth->steal_heap_count) {
+    if ((child + 1 < synth->steal_heap_count) && FLUID_KILL_BEFORE(heap[child + 1], heap[child])) {
+      child++;
+    }
+    if (!FLUID_KILL_BEFORE(heap[child], voice)) {
+      break;
+    }
+    fluid_synth_steal_heap_set(synth, pos, heap[child]);
+    pos = child;
+  }
+  fluid_synth_steal_heap_set(synth, pos, voice);
+}
+
+/* Moves the voice at pos to its place after its priority changed */
+static void
+fluid_synth_steal_heap_sift(fluid_synth_t* synth, int pos)
+{
+  fluid_voice_t** heap = synth->steal_heap;
+  fluid_voice_t* voice = heap[pos];
+
+  while ((pos > 0) && FLUID_KILL_BEFORE(voice, heap[(pos - 1) / 2])) {
+    fluid_synth_steal_heap_set(synth, pos, heap[(pos - 1) / 2]);
+    pos = (pos - 1) / 2;
+  }
+  fluid_synth_steal_heap_set(synth, pos, voice);
+  fluid_synth_steal_heap_down(synth, pos);
+}
+
+static void
+fluid_synth_steal_heap_remove(fluid_synth_t* synth, fluid_voice_t* voice)
+{
+  int pos = voice->kill_pos;
+  fluid_voice_t* last = synth->steal_heap[--synth->steal_heap_count];
+
+  voice->kill_pos = -1;
+  if (last != voice) {
+    fluid_synth_steal_heap_set(synth, pos, last);
+    fluid_synth_steal_heap_sift(synth, pos);
+  }
+}
+
+/*
+ * fluid_synth_steal_heap_rebuild
+ *
+ * Recalculates the priorities of all playing voices. Needed when the
+ * voices or the polyphony changed.
+ */
+static void
+fluid_synth_steal_heap_rebuild(fluid_synth_t* synth)
+{
+  int i;
+
+  synth->steal_noteid = synth->noteid;
+  synth->steal_heap_count = 0;
+  for (i = 0; i < synth->nvoice; i++) {
+    fluid_voice_t* voice = synth->voice[i];
+    voice->kill_pos = -1;
+    voice->kill_slot = i;
+    if ((i < synth->polyphony) && _PLAYING(voice)) {
+      voice->kill_prio = fluid_synth_kill_prio(synth, voice);
+      fluid_synth_steal_heap_set(synth, synth->steal_heap_count++, voice);
+    }
+  }
+  for (i = synth->steal_heap_count / 2 - 1; i >= 0; i--) {
+    fluid_synth_steal_heap_down(synth, i);
+  }
+  synth->steal_heap_dirty = 0;
+}
+
+/*
+ * fluid_synth_update_kill_prio
+ *
+ * Brings the priority of a voice up to date after it was started or
+ * released. Voices that stopped playing are only dropped from the heap
+ * when they come up for killing.
+ */
+static void
+fluid_synth_update_kill_prio(fluid_synth_t* synth, fluid_voice_t* voice)
+{
+  if (synth->steal_heap_dirty || !_PLAYING(voice)) {
+    return;
+  }
+  voice->kill_prio = fluid_synth_kill_prio(synth, voice);
+  if (voice->kill_pos < 0) {
+    synth->steal_heap[synth->steal_heap_count] = voice;
+    voice->kill_pos = synth->steal_heap_count++;
+  }
+  fluid_synth_steal_heap_sift(synth, voice->kill_pos);
+}
+
+/*
+ * fluid_synth_update_rendered_prio
+ *
+ * Rendering changes the volume of a voice, and with it its priority.
+ * Called for every voice right after it was rendered, which keeps the
+ * heap in order in O(log n) per voice. Voices that stopped playing are
+ * taken out of the heap.
+ */
+static void
+fluid_synth_update_rendered_prio(fluid_synth_t* synth, fluid_voice_t* voice)
+{
+  if (synth->steal_heap_dirty || (voice->kill_pos < 0)) {
+    return;
+  }
+  if (!_PLAYING(voice)) {
+    fluid_synth_steal_heap_remove(synth, voice);
+    return;
+  }
+  voice->kill_prio = fluid_synth_kill_prio(synth, voice);
+  fluid_synth_steal_heap_sift(synth, voice->kill_pos);
+}
+
 /*
  * fluid_synth_free_voice_by_kill
  *
@@ -2281,81 +2549,66 @@ fluid_synth_one_block(fluid_synth_t* synth, int do_not_mix_fx_to_out)
 fluid_voice_t*
 fluid_synth_free_voice_by_kill(fluid_synth_t* synth)
 {
-  int i;
-  fluid_real_t best_prio = 999999.;
-  fluid_real_t this_voice_prio;
   fluid_voice_t* voice;
-  int best_voice_index=-1;
 
 /*   fluid_mutex_lock(synth->busy); /\* Don't interfere with the audio thread *\/ */
 /*   fluid_mutex_unlock(synth->busy); */
 
-  for (i = 0; i < synth->polyphony; i++) {
+  if (synth->steal_heap_dirty) {
+    fluid_synth_steal_heap_rebuild(synth);
+  }
 
-    voice = synth->voice[i];
+  while (synth->steal_heap_count > 0) {
+    voice = synth->steal_heap[0];
+    fluid_synth_steal_heap_remove(synth, voice);
 
     /* safeguard against an available voice. */
     if (_AVAILABLE(voice)) {
       return voice;
     }
 
-    /* Determine, how 'important' a voice is.
-     * Start with an arbitrary number */
-    this_voice_prio = 10000.;
-
-    /* Is this voice on the drum channel?
-     * Then it is very important.
-     * Also, forget about the released-note condition:
-     * Typically, drum notes are triggered only very briefly, they run most
-     * of the time in release phase.
-     */
-    if (voice->chan == 9){
-      this_voice_prio += 4000;
-
-    } else if (_RELEASED(voice)){
-      /* The key for this voice has been released. Consider it much less important
-       * than a voice, which is still held.
-       */
-      this_voice_prio -= 2000.;
+    /* voices turned off elsewhere in the meantime are out of the question */
+    if (_PLAYING(voice)) {
+      fluid_voice_off(voice);
+      synth->voices_stolen++;
+      return voice;
     }
+  }
 
-    if (_SUSTAINED(voice)){
-      /* The sustain pedal is held down on this channel.
-       * Consider it less important than non-sustained channels.
-       * This decision is somehow subjective. But usually the sustain pedal
-       * is used to play 'more-voices-than-fingers', so it shouldn't hurt
-       * if we kill one voice.
-       */
-      this_voice_prio -= 1000;
-    }
+  return NULL;
+}
 
-    /* We are not enthusiastic about releasing voices, which have just been started.
-     * Otherwise hitting a chord may result in killing notes belonging to that very same
-     * chord.
-     * So subtract the age of the voice from the priority - an older voice is just a little
-     * bit less important than a younger voice.
-     * This is a number between roughly 0 and 100.*/
-    this_voice_prio -= (synth->noteid - fluid_voice_get_id(voice));
+/*
+ * fluid_synth_pop_free_voice
+ *
+ * Takes an available voice off the free voice stack. Voices go onto
+ * the stack when they finish playing in fluid_synth_one_block. Voices
+ * turned off some other way are picked up by scanning all voices, once
+ * the stack runs empty. A voice on the stack is never playing, since
+ * voices only start after they have been allocated here.
+ */
+static fluid_voice_t*
+fluid_synth_pop_free_voice(fluid_synth_t* synth)
+{
+  int i;
 
-    /* take a rough estimate of loudness into account. Louder voices are more important. */
-    if (voice->volenv_section != FLUID_VOICE_ENVATTACK){
-      this_voice_prio += voice->volenv_val * 1000.;
+  if (synth->free_voice_count == 0) {
+    /* Lowest index on top, like the linear search this replaces */
+    for (i = synth->polyphony - 1; i >= 0; i--) {
+      if (_AVAILABLE(synth->voice[i])) {
+	synth->free_voice[synth->free_voice_count++] = i;
+      }
     }
-
-    /* check if this voice has less priority than the previous candidate. */
-    if (this_voice_prio < best_prio)
-      best_voice_index = i,
-      best_prio = this_voice_prio;
   }
 
-  if (best_voice_index < 0) {
-    return NULL;
+  while (synth->free_voice_count > 0) {
+    i = synth->free_voice[--synth->free_voice_count];
+    /* The polyphony may have been lowered in the meantime */
+    if ((i < synth->polyphony) && _AVAILABLE(synth->voice[i])) {
+      return synth->voice[i];
+    }
   }
-
-  voice = synth->voice[best_voice_index];
-  fluid_voice_off(voice);
-
-  return voice;
+  return NULL;
 }
 
 /*
@@ -2372,12 +2625,7 @@ fluid_synth_alloc_voice(fluid_synth_t* synth, fluid_sample_t* sample, int chan,
 /*   fluid_mutex_unlock(synth->busy); */
 
   /* check if there's an available synthesis process */
-  for (i = 0; i < synth->polyphony; i++) {
-    if (_AVAILABLE(synth->voice[i])) {
-      voice = synth->voice[i];
-      break;
-    }
-  }
+  voice = fluid_synth_pop_free_voice(synth);
 
   /* No success yet? Then stop a running voice. */
   if (voice == NULL) {
@@ -2413,18 +2661,10 @@ fluid_synth_alloc_voice(fluid_synth_t* synth, fluid_sample_t* sample, int chan,
     FLUID_LOG(FLUID_WARN, "Failed to initialize voice");
     return NULL;
   }
+  synth->voices_allocated++;
 
-  /* add the default modulators to the synthesis process. */
-  fluid_voice_add_mod(voice, &default_vel2att_mod, FLUID_VOICE_DEFAULT);    /* SF2.01 $8.4.1  */
-  fluid_voice_add_mod(voice, &default_vel2filter_mod, FLUID_VOICE_DEFAULT); /* SF2.01 $8.4.2  */
-  fluid_voice_add_mod(voice, &default_at2viblfo_mod, FLUID_VOICE_DEFAULT);  /* SF2.01 $8.4.3  */
-  fluid_voice_add_mod(voice, &default_mod2viblfo_mod, FLUID_VOICE_DEFAULT); /* SF2.01 $8.4.4  */
-  fluid_voice_add_mod(voice, &default_att_mod, FLUID_VOICE_DEFAULT);        /* SF2.01 $8.4.5  */
-  fluid_voice_add_mod(voice, &default_pan_mod, FLUID_VOICE_DEFAULT);        /* SF2.01 $8.4.6  */
-  fluid_voice_add_mod(voice, &default_expr_mod, FLUID_VOICE_DEFAULT);       /* SF2.01 $8.4.7  */
-  fluid_voice_add_mod(voice, &default_reverb_mod, FLUID_VOICE_DEFAULT);     /* SF2.01 $8.4.8  */
-  fluid_voice_add_mod(voice, &default_chorus_mod, FLUID_VOICE_DEFAULT);     /* SF2.01 $8.4.9  */
-  fluid_voice_add_mod(voice, &default_pitch_bend_mod, FLUID_VOICE_DEFAULT); /* SF2.01 $8.4.10 */
+  /* add the default modulators to the synthesis process. SF2.01 $8.4.1 - $8.4.10 */
+  fluid_voice_set_default_mods(voice, default_mod, FLUID_NUM_DEFAULT_MOD);
 
   return voice;
 }
@@ -2488,6 +2728,7 @@ void fluid_synth_kill_by_exclusive_class(fluid_synth_t* synth, fluid_voice_t* ne
     //     (int)_GEN(existing_voice, GEN_EXCLUSIVECLASS), (int)fluid_voice_get_id(existing_voice));
 
     fluid_voice_kill_excl(existing_voice);
+    fluid_synth_update_kill_prio(synth, existing_voice);
   };
 };
 
@@ -2507,6 +2748,7 @@ void fluid_synth_start_voice(fluid_synth_t* synth, fluid_voice_t* voice)
   /* Start the new voice */
 
   fluid_voice_start(voice);
+  fluid_synth_update_kill_prio(synth, voice);
 }
 
 /*
@@ -2895,6 +3137,7 @@ void fluid_synth_release_voice_on_same_note(fluid_synth_t* synth, int chan, int
 	&& (voice->key == key)
 	&& (fluid_voice_get_id(voice) != synth->noteid)) {
       fluid_voice_noteoff(voice);
+      fluid_synth_update_kill_prio(synth, voice);
     }
   }
 }
@@ -3445,6 +3688,7 @@ int fluid_synth_stop(fluid_synth_t* synth, unsigned int id)
     if (_ON(voice) && (fluid_voice_get_id(voice) == id)) {
 	    count++;
       fluid_voice_noteoff(voice);
+      fluid_synth_update_kill_prio(synth, voice);
       status = FLUID_OK;
     }
   }
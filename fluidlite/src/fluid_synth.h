@@ -114,6 +114,14 @@ struct _fluid_synth_t
   int num_channels;                   /** the number of channels */
   int nvoice;                         /** the length of the synthesis process array */
   fluid_voice_t** voice;              /** the synthesis processes */
+  int* free_voice;                    /** stack of indices of available voices */
+  int free_voice_count;               /** the number of entries on the stack */
+  fluid_voice_t** steal_heap;         /** playing voices, a min heap on their kill_prio */
+  int steal_heap_count;
+  int steal_heap_dirty;               /** the priorities are out of date, rebuild before use */
+  unsigned int steal_noteid;          /** the noteid the priorities were calculated at */
+  unsigned int voices_allocated;      /** number of voices allocated for notes */
+  unsigned int voices_stolen;         /** number of playing voices killed to allocate new ones */
   unsigned int noteid;                /** the id is incremented for every new note. it's used for noteoff's  */
   unsigned int storeid;
   int nbuf;                           /** How many audio buffers are used? (depends on nr of audio channels / groups)*/
@@ -65,6 +65,8 @@ new_fluid_voice(fluid_real_t output_rate)
   }
   voice->status = FLUID_VOICE_CLEAN;
   voice->chan = NO_CHANNEL;
+  voice->kill_pos = -1;
+  voice->kill_slot = 0;
   voice->key = 0;
   voice->vel = 0;
   voice->channel = NULL;
@@ -1698,6 +1700,20 @@ fluid_voice_add_mod(fluid_voice_t* voice, fluid_mod_t* mod, int mode)
   }
 }
 
+/*
+ * fluid_voice_set_default_mods
+ *
+ * Sets the modulators of a freshly initialized voice to a prebuilt
+ * block of default modulators in one copy. The block must only hold
+ * valid modulators, they are not checked like in fluid_voice_add_mod.
+ */
+void
+fluid_voice_set_default_mods(fluid_voice_t* voice, fluid_mod_t* mods, int count)
+{
+  FLUID_MEMCPY(voice->mod, mods, count * sizeof(fluid_mod_t));
+  voice->mod_count = count;
+}
+
 unsigned int fluid_voice_get_id(fluid_voice_t* voice)
 {
   return voice->id;
@@ -75,6 +75,9 @@ struct _fluid_voice_t
 	fluid_gen_t gen[GEN_LAST];
 	fluid_mod_t mod[FLUID_NUM_MOD];
 	int mod_count;
+	fluid_real_t kill_prio;         /* voice stealing priority, the lowest one is killed first */
+	int kill_pos;                   /* position in the synth's steal heap, -1 if not in it */
+	int kill_slot;                  /* index in the synth's voice array, breaks kill_prio ties */
 	int has_looped;                 /* Flag that is set as soon as the first loop is completed. */
 	fluid_sample_t* sample;
 	int check_sample_sanity_flag;   /* Flag that initiates, that sample-related parameters
@@ -225,6 +228,9 @@ int fluid_voice_init(fluid_voice_t* voice, fluid_sample_t* sample,
 		     fluid_channel_t* channel, int key, int vel,
 		     unsigned int id, unsigned int time, fluid_real_t gain);
 
+/** Copy a block of modulators into a voice that has no modulators yet. */
+void fluid_voice_set_default_mods(fluid_voice_t* voice, fluid_mod_t* mods, int count);
+
 int fluid_voice_modulate(fluid_voice_t* voice, int cc, int ctrl);
 int fluid_voice_modulate_all(fluid_voice_t* voice);
 
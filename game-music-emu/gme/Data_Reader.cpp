@@ -24,6 +24,7 @@ Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA */
 #include <zlib.h>
 #include <stdlib.h>
 #include <errno.h>
+#include <limits.h>
 static const unsigned char gz_magic[2] = {0x1f, 0x8b}; /* gzip magic header */
 #endif /* HAVE_ZLIB_H */
 
@@ -157,19 +158,21 @@ Mem_File_Reader::Mem_File_Reader( const void* p, long s ) :
 	if( !m_begin )
 		return;
 
-	if ( gz_decompress() )
-	{
-		debug_printf( "Loaded compressed data\n" );
-		m_ownedPtr = true;
-	}
+	if ( gz_open() )
+		debug_printf( "Reading compressed data\n" );
 #endif /* HAVE_ZLIB_H */
 }
 
 #ifdef HAVE_ZLIB_H
 Mem_File_Reader::~Mem_File_Reader()
 {
+	if ( m_stream )
+	{
+		inflateEnd( m_stream );
+		delete m_stream;
+	}
 	if ( m_ownedPtr )
-		free( const_cast<char*>( m_begin ) ); // see gz_compress for the malloc
+		free( const_cast<char*>( m_begin ) ); // see gz_decompress for the malloc
 }
 #endif
 
@@ -180,6 +183,10 @@ long Mem_File_Reader::read_avail( void* p, long s )
 	long r = remain();
 	if ( s > r || s < 0 )
 		s = r;
+#ifdef HAVE_ZLIB_H
+	if ( m_stream )
+		return gz_read( p, s );
+#endif
 	memcpy( p, m_begin + m_pos, static_cast<size_t>(s) );
 	m_pos += s;
 	return s;
@@ -192,20 +199,75 @@ blargg_err_t Mem_File_Reader::seek( long n )
 	RETURN_VALIDITY_CHECK( n >= 0 );
 	if ( n > m_size )
 		return eof_error;
+#ifdef HAVE_ZLIB_H
+	if ( m_stream )
+	{
+		if ( n < m_pos )
+		{
+			// inflate can only go forward, so start over
+			if ( inflateReset( m_stream ) != Z_OK )
+				return "Corrupt file";
+			m_stream->next_in  = const_cast<Bytef *>( reinterpret_cast<const Bytef *>( m_begin ) );
+			m_stream->avail_in = static_cast<uInt>( m_gz_size );
+			m_pos = 0;
+		}
+		return Data_Reader::skip( n - m_pos );
+	}
+#endif
 	m_pos = n;
 	return 0;
 }
 
 #ifdef HAVE_ZLIB_H
 
-bool Mem_File_Reader::gz_decompress()
+// Sets up streaming decompression if the data is gzip. The uncompressed size is
+// taken from the ISIZE field of the trailer, so readers can allocate the exact
+// amount up front and have the data inflated straight into their buffer.
+bool Mem_File_Reader::gz_open()
 {
-	if ( m_size >= 2 && memcmp(m_begin, gz_magic, 2) != 0 )
+	if ( m_size < 18 || memcmp( m_begin, gz_magic, 2 ) != 0 )
 	{
 		/* Don't try to decompress non-GZ files, just assign input pointer */
 		return false;
 	}
 
+	// Deflate expands by at most 1032:1, so a larger ISIZE comes from a corrupt
+	// trailer or one that belongs to another member of the file. Don't trust
+	// it for allocation; inflate into a buffer that grows as needed instead.
+	const unsigned long inflated_size = get_le32( m_begin + m_size - 4 );
+	if ( inflated_size / 1032 > static_cast<unsigned long>( m_size ) ||
+			inflated_size > static_cast<unsigned long>( LONG_MAX ) )
+		return gz_decompress();
+
+	m_stream = BLARGG_NEW z_stream;
+	if ( !m_stream )
+		return false;
+
+	m_stream->next_in  = const_cast<Bytef *>( reinterpret_cast<const Bytef *>( m_begin ) );
+	m_stream->avail_in = static_cast<uInt>( m_size );
+	m_stream->zalloc   = Z_NULL;
+	m_stream->zfree    = Z_NULL;
+	m_stream->opaque   = Z_NULL;
+
+	// Adding 16 sets bit 4, which enables zlib to auto-detect the
+	// header.
+	if ( inflateInit2( m_stream, (16 + MAX_WBITS) ) != Z_OK )
+	{
+		delete m_stream;
+		m_stream = nullptr;
+		return false;
+	}
+
+	m_gz_size = m_size;
+	m_size    = static_cast<long>( inflated_size );
+
+	return true;
+}
+
+// Inflates all of the data into a malloc'd buffer, growing it by half the
+// input size at a time.
+bool Mem_File_Reader::gz_decompress()
+{
 	using vec_size = size_t;
 	const vec_size full_length = static_cast<vec_size>( m_size );
 	const vec_size half_length = static_cast<vec_size>( m_size / 2 );
@@ -222,11 +284,10 @@ bool Mem_File_Reader::gz_decompress()
 	strm.total_out = 0;
 	strm.zalloc    = Z_NULL;
 	strm.zfree     = Z_NULL;
+	strm.opaque    = Z_NULL;
 
 	bool done = false;
 
-	// Adding 16 sets bit 4, which enables zlib to auto-detect the
-	// header.
 	if ( inflateInit2(&strm, (16 + MAX_WBITS)) != Z_OK )
 	{
 		free( raw_data );
@@ -239,10 +300,14 @@ bool Mem_File_Reader::gz_decompress()
 		if ( strm.total_out >= raw_data_size )
 		{
 			raw_data_size += half_length;
-			raw_data = reinterpret_cast<char *>( realloc( raw_data, raw_data_size ) );
-			if ( !raw_data ) {
+			char *grown = reinterpret_cast<char *>( realloc( raw_data, raw_data_size ) );
+			if ( !grown )
+			{
+				inflateEnd( &strm );
+				free( raw_data );
 				return false;
 			}
+			raw_data = grown;
 		}
 
 		strm.next_out  = reinterpret_cast<Bytef *>( raw_data + strm.total_out );
@@ -262,12 +327,33 @@ bool Mem_File_Reader::gz_decompress()
 		return false;
 	}
 
-	m_begin = raw_data;
-	m_size  = static_cast<long>( strm.total_out );
+	debug_printf( "Loaded compressed data\n" );
+	m_begin    = raw_data;
+	m_size     = static_cast<long>( strm.total_out );
+	m_ownedPtr = true;
 
 	return true;
 }
 
+long Mem_File_Reader::gz_read( void* p, long s )
+{
+	m_stream->next_out  = reinterpret_cast<Bytef *>( p );
+	m_stream->avail_out = static_cast<uInt>( s );
+
+	while ( m_stream->avail_out )
+	{
+		int err = inflate( m_stream, Z_SYNC_FLUSH );
+		if ( err == Z_STREAM_END )
+			break;
+		if ( err != Z_OK )
+			return -1;
+	}
+
+	long n = s - static_cast<long>( m_stream->avail_out );
+	m_pos += n;
+	return n;
+}
+
 #endif /* HAVE_ZLIB_H */
 
 
@@ -75,7 +75,9 @@ private:
 #endif /* HAVE_ZLIB_H */
 };
 
-// Treats range of memory as a file
+// Treats range of memory as a file. Gzip data is inflated on the fly as it is
+// read, and size() reports the uncompressed size from the gzip trailer. If that
+// size can't be right, the data is inflated up front instead.
 class Mem_File_Reader : public File_Reader {
 public:
 	Mem_File_Reader( const void*, long size );
@@ -90,13 +92,17 @@ public:
 	blargg_err_t seek( long );
 private:
 #ifdef HAVE_ZLIB_H
+	bool gz_open();
 	bool gz_decompress();
+	long gz_read( void*, long );
 #endif /* HAVE_ZLIB_H */
 
 	const char* m_begin;
 	long m_size;
 	long m_pos;
 #ifdef HAVE_ZLIB_H
+	z_stream* m_stream = nullptr; // set if m_begin is gzip data, m_size is then the inflated size
+	long m_gz_size = 0;
 	bool m_ownedPtr = false; // set if we must free m_begin
 #endif /* HAVE_ZLIB_H */
 };
@@ -79,6 +79,8 @@ struct Gbs_File : Gme_Info_
 	blargg_err_t load_mem_( byte const begin [], int size )
 	{
 		h = ( Gbs_Emu::header_t * ) begin;
+		if ( size < Gbs_Emu::header_t::size )
+			return blargg_err_file_type;
 
 		set_track_count( h->track_count );
 		if ( !h->valid_tag() )
@@ -212,6 +212,11 @@ void Gym_Emu::set_tempo_( double t )
 	}
 }
 
+blargg_err_t Gym_Emu::set_ym2612_core_( int core )
+{
+	return fm.set_core( core );
+}
+
 void Gym_Emu::mute_voices_( int mask )
 {
 	Music_Emu::mute_voices_( mask );
@@ -53,6 +53,7 @@ protected:
 	virtual blargg_err_t play_( int count, sample_t [] );
 	virtual void mute_voices_( int );
 	virtual void set_tempo_( double );
+	virtual blargg_err_t set_ym2612_core_( int );
 
 private:
 	// Log
@@ -110,6 +110,10 @@ struct Hes_File : Gme_Info_
 	{
 		h = ( header_t const* ) begin;
 		
+		// track_info_() reads all of the text fields
+		if ( size < (int) sizeof *h )
+			return blargg_err_file_type;
+		
 		if ( !h->header.valid_tag() )
 			return blargg_err_file_type;
 		
@@ -123,8 +123,11 @@ struct Kss_File : Gme_Info_
 	blargg_err_t load_mem_( byte const begin [], int size )
 	{
 		header_ = ( Kss_Emu::header_t const* ) begin;
+		if ( size < Kss_Emu::header_t::base_size )
+			return blargg_err_file_type;
 
-		if ( header_->tag [3] == 'X' && header_->extra_header == 0x10 )
+		if ( header_->tag [3] == 'X' && header_->extra_header == 0x10 &&
+				size >= Kss_Emu::header_t::size )
 			set_track_count( get_le16( header_->last_track ) + 1 );
 
 		return check_kss_header( header_ );
@@ -249,6 +249,13 @@ blargg_err_t Music_Emu::play( int out_count, sample_t out [] )
 	return track_filter.play( out_count, out );
 }
 
+blargg_err_t Music_Emu::play_float_planar( int pair_count, float left [], float right [] )
+{
+	require( current_track() >= 0 );
+	
+	return track_filter.play_float_planar( pair_count, left, right );
+}
+
 // Gme_Info_
 
 blargg_err_t Gme_Info_::set_sample_rate_( int )             { return blargg_ok; }
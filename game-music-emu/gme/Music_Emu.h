@@ -30,6 +30,10 @@ public:
 	// errors set warning string, and major errors also end track.
 	typedef short sample_t;
 	blargg_err_t play( int count, sample_t* buf );
+
+	// Generates 'count' stereo sample pairs as floats in -1.0 to 1.0 range, with
+	// left channel into 'left' and right channel into 'right'.
+	blargg_err_t play_float_planar( int count, float* left, float* right );
 	
 // Track information
 	
@@ -80,6 +84,13 @@ public:
 	blargg_err_t set_track_info( const track_info_t* in );
 	blargg_err_t set_track_info( const track_info_t* in, int track_number );
 
+	// Selects SPC emulation engine (gme_spc_engine_*) used from next start_track() on
+	blargg_err_t set_spc_engine( int engine );
+
+	// Selects YM2612 emulation core (gme_ym2612_core_*). The chip restarts from
+	// power-up state, so this should be called before start_track().
+	blargg_err_t set_ym2612_core( int core );
+
 // Voices
 
 	// Number of voices used by currently loaded file
@@ -179,6 +190,12 @@ protected:
 
     // Set track info
     virtual blargg_err_t set_track_info_( const track_info_t*, int ) { return "Not supported by this format"; }
+
+    // Select SPC emulation engine
+    virtual blargg_err_t set_spc_engine_( int ) { return "Not supported by this format"; }
+
+    // Select YM2612 emulation core
+    virtual blargg_err_t set_ym2612_core_( int ) { return "Not supported by this format"; }
     
 // Implementation
 public:
@@ -253,6 +270,16 @@ inline blargg_err_t Music_Emu::set_track_info(const track_info_t *in, int track)
     return set_track_info_( in, track );
 }
 
+inline blargg_err_t Music_Emu::set_spc_engine( int engine )
+{
+    return set_spc_engine_( engine );
+}
+
+inline blargg_err_t Music_Emu::set_ym2612_core( int core )
+{
+    return set_ym2612_core_( core );
+}
+
 inline int Music_Emu::sample_rate() const           { return sample_rate_; }
 inline int Music_Emu::voice_count() const           { return voice_count_; }
 inline int Music_Emu::current_track() const         { return current_track_; }
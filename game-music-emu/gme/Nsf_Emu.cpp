@@ -97,6 +97,8 @@ struct Nsf_File : Gme_Info_
 	blargg_err_t load_mem_( byte const begin [], int size )
 	{
 		h = ( Nsf_Emu::header_t const* ) begin;
+		if ( size < Nsf_Emu::header_t::size )
+			return blargg_err_file_type;
 
 		if ( h->vers != 1 )
 			set_warning( "Unknown file version" );
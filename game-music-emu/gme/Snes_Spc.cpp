@@ -192,6 +192,8 @@ void Snes_Spc::reset_common( int timer_counter_init )
 	for ( i = 0; i < port_count; i++ )
 		REGS_IN [r_cpuio0 + i] = 0;
 	
+	set_port_log( 0, 0, 0 );
+	
 	reset_time_regs();
 }
 
@@ -259,6 +261,14 @@ void Snes_Spc::clear_echo()
 }
 
 
+void Snes_Spc::set_port_log( uint8_t const* begin, uint8_t const* end, uint8_t const* repeat )
+{
+	m.port_log        = begin;
+	m.port_log_end    = end;
+	m.port_log_repeat = repeat;
+}
+
+
 //// Sample output
 
 void Snes_Spc::reset_buf()
@@ -76,6 +76,11 @@ public:
 	
 	// Clears echo region. Useful after loading an SPC as many have garbage in echo.
 	void clear_echo();
+	
+	// Feeds SPC reads of the CPU ports from a log of the values the SNES side wrote,
+	// one value per read, continuing at repeat once end is reached. This is how SFM
+	// files drive music. Cleared by reset().
+	void set_port_log( uint8_t const* begin, uint8_t const* end, uint8_t const* repeat );
 
 	// Plays for count samples and write samples to out. Discards samples if out
 	// is NULL. Count must be a multiple of 2 since output is stereo.
@@ -174,6 +179,10 @@ private:
 		sample_t*   extra_pos;
 		sample_t    extra_buf [extra_size];
 		
+		uint8_t const* port_log;
+		uint8_t const* port_log_end;
+		uint8_t const* port_log_repeat;
+		
 		int         rom_enabled;
 		uint8_t     rom    [rom_size];
 		uint8_t     hi_ram [rom_size];
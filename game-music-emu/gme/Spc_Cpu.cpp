@@ -437,6 +437,18 @@ void Snes_Spc::cpu_write( int data, uint16_t addr, rel_time_t time )
 
 inline int Snes_Spc::cpu_read_smp_reg( int reg, rel_time_t time )
 {
+	// Logged port values (SFM)
+	if ( m.port_log && (unsigned) (reg - r_cpuio0) < port_count )
+	{
+		if ( m.port_log < m.port_log_end )
+		{
+			REGS_IN [reg] = *m.port_log;
+			if ( ++m.port_log == m.port_log_end )
+				m.port_log = m.port_log_repeat;
+		}
+		return REGS_IN [reg];
+	}
+	
 	int result = REGS_IN [reg];
 	reg -= r_dspaddr;
 	// DSP addr and data
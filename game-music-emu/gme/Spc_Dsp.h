@@ -1,8 +1,8 @@
 // Fast SNES SPC-700 DSP emulator (about 3x speed of accurate one)
 
 // Game_Music_Emu https://bitbucket.org/mpyne/game-music-emu/
-#ifndef SPC_DSP_H
-#define SPC_DSP_H
+#ifndef FAST_SPC_DSP_H
+#define FAST_SPC_DSP_H
 
 #include "blargg_common.h"
 
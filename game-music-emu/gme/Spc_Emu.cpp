@@ -23,6 +23,8 @@ Spc_Emu::Spc_Emu()
 {
 	set_type( gme_spc_type );
 	set_gain( 1.4 );
+	engine       = gme_spc_engine_accurate;
+	track_engine = gme_spc_engine_accurate;
 }
 
 Spc_Emu::~Spc_Emu() { }
@@ -272,40 +274,35 @@ static blargg_err_t check_spc_header( void const* header )
 
 struct Spc_File : Gme_Info_
 {
-	Spc_Emu::header_t header;
-	blargg_vector<byte> data;
-	blargg_vector<byte> xid6;
+	// Point into the file data
+	Spc_Emu::header_t const* header;
+	byte const* xid6;
+	int xid6_size;
 	
 	Spc_File() { set_type( gme_spc_type ); }
 	
-	blargg_err_t load_( Data_Reader& in )
+	blargg_err_t load_mem_( byte const begin [], int file_size )
 	{
-		int file_size = in.remain();
 		if ( file_size < 0x10180 )
 			return blargg_err_file_type;
-		RETURN_ERR( in.read( &header, header.size ) );
-		RETURN_ERR( check_spc_header( header.tag ) );
+		header = (Spc_Emu::header_t const*) begin;
+		RETURN_ERR( check_spc_header( header->tag ) );
 		int const xid6_offset = 0x10200;
-		RETURN_ERR( data.resize( blargg_min( xid6_offset - header.size, file_size - header.size ) ) );
-		RETURN_ERR( in.read( data.begin(), data.end() - data.begin() ) );
-		int xid6_size = file_size - xid6_offset;
-		if ( xid6_size > 0 )
-		{
-			RETURN_ERR( xid6.resize( xid6_size ) );
-			RETURN_ERR( in.read( xid6.begin(), xid6.size() ) );
-		}
+		xid6_size = blargg_max( file_size - xid6_offset, 0 );
+		xid6 = xid6_size ? begin + xid6_offset : NULL;
 		return blargg_ok;
 	}
 	
 	blargg_err_t track_info_( track_info_t* out, int ) const
 	{
-		get_spc_info( header, xid6.begin(), xid6.size(), out );
+		get_spc_info( *header, xid6, xid6_size, out );
 		return blargg_ok;
 	}
 
 	blargg_err_t hash_( Hash_Function& out ) const
 	{
-		hash_spc_file( header, data.begin(), data.end() - data.begin(), out );
+		int const data_size = blargg_min( 0x10200 - header->size, file_size() - header->size );
+		hash_spc_file( *header, file_begin() + header->size, data_size, out );
 		return blargg_ok;
 	}
 };
@@ -320,6 +317,7 @@ gme_type_t_ const gme_spc_type [1] = {{ "Super Nintendo", 1, &new_spc_emu, &new_
 blargg_err_t Spc_Emu::set_sample_rate_( int sample_rate )
 {
 	smp.power();
+	RETURN_ERR( apu.init() );
 	if ( sample_rate != native_sample_rate )
 	{
 		RETURN_ERR( resampler.resize_buffer( native_sample_rate / 20 * 2 ) );
@@ -333,6 +331,7 @@ void Spc_Emu::mute_voices_( int m )
 	Music_Emu::mute_voices_( m );
 	for ( int i = 0, j = 1; i < SuperFamicom::SPC_DSP::voice_count; ++i, j <<= 1 )
         smp.dsp.channel_enable( i, !( m & j ) );
+	apu.mute_voices( m );
 }
 
 blargg_err_t Spc_Emu::load_mem_( byte const in [], int size )
@@ -355,6 +354,15 @@ blargg_err_t Spc_Emu::load_mem_( byte const in [], int size )
 void Spc_Emu::set_tempo_( double t )
 {
 	smp.set_tempo( t );
+	apu.set_tempo( (int) (t * Snes_Spc::tempo_unit) );
+}
+
+blargg_err_t Spc_Emu::set_spc_engine_( int e )
+{
+	if ( e != gme_spc_engine_accurate && e != gme_spc_engine_fast )
+		return blargg_err_caller;
+	engine = e;
+	return blargg_ok;
 }
 
 blargg_err_t Spc_Emu::start_track_( int track )
@@ -362,6 +370,15 @@ blargg_err_t Spc_Emu::start_track_( int track )
 	RETURN_ERR( Music_Emu::start_track_( track ) );
 	resampler.clear();
 	filter.clear();
+	track_engine = engine;
+	if ( track_engine == gme_spc_engine_fast )
+	{
+		RETURN_ERR( apu.load_spc( file_begin(), file_size() ) );
+		apu.clear_echo();
+		filter.set_gain( (int) (gain() * Spc_Filter::gain_unit) );
+		return blargg_ok;
+	}
+	
     smp.reset();
     const byte * ptr = file_begin();
     
@@ -403,7 +420,10 @@ blargg_err_t Spc_Emu::start_track_( int track )
 
 blargg_err_t Spc_Emu::play_and_filter( int count, sample_t out [] )
 {
-	smp.render( out, count );
+	if ( track_engine == gme_spc_engine_fast )
+		RETURN_ERR( apu.play( count, out ) );
+	else
+		smp.render( out, count );
 	filter.run( out, count );
 	return blargg_ok;
 }
@@ -420,7 +440,10 @@ blargg_err_t Spc_Emu::skip_( int count )
 	
 	if ( count > 0 )
 	{
-		smp.skip( count );
+		if ( track_engine == gme_spc_engine_fast )
+			RETURN_ERR( apu.skip( count ) );
+		else
+			smp.skip( count );
 		filter.clear();
 	}
 	
@@ -6,6 +6,7 @@
 
 #include "Music_Emu.h"
 #include "higan/smp/smp.hpp"
+#include "Snes_Spc.h"
 #include "Spc_Filter.h"
 
 #if GME_SPC_FAST_RESAMPLER
@@ -23,9 +24,9 @@ public:
 	enum { native_sample_rate = 32000 };
 	
 	// Disables annoying pseudo-surround effect some music uses
-	void disable_surround( bool disable = true )    { smp.dsp.disable_surround( disable ); }
+	void disable_surround( bool disable = true )    { smp.dsp.disable_surround( disable ); apu.disable_surround( disable ); }
 
-	// Enables gaussian, cubic or sinc interpolation
+	// Enables gaussian, cubic or sinc interpolation (accurate engine only)
 	void interpolation_level( int level = 0 )   { smp.dsp.spc_dsp.interpolation_level( level ); }
 
     SuperFamicom::SMP const* get_smp() const;
@@ -76,11 +77,15 @@ protected:
 	virtual blargg_err_t skip_( int );
 	virtual void mute_voices_( int );
 	virtual void set_tempo_( double );
+	virtual blargg_err_t set_spc_engine_( int );
 
 private:
 	Spc_Emu_Resampler resampler;
 	Spc_Filter filter;
     SuperFamicom::SMP smp;
+	Snes_Spc apu;
+	int engine;        // selected with set_spc_engine()
+	int track_engine;  // engine current track was started with
 	
 	byte const* trailer_() const;
 	int trailer_size_() const;
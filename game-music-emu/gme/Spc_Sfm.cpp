@@ -2,6 +2,8 @@
 
 #include "Spc_Sfm.h"
 
+#include "Spc_Emu.h"
+
 #include "blargg_endian.h"
 
 #include <stdio.h>
@@ -27,6 +29,8 @@ Sfm_Emu::Sfm_Emu()
     set_gain( 1.4 );
     set_max_initial_silence( 30 );
 	set_silence_lookahead( 30 ); // Some SFMs may have a lot of initialization code
+    engine       = gme_spc_engine_accurate;
+    track_engine = gme_spc_engine_accurate;
 }
 
 Sfm_Emu::~Sfm_Emu() { }
@@ -170,9 +174,23 @@ gme_type_t_ const gme_sfm_type [1] = {{ "Super Nintendo with log", 1, &new_sfm_e
 
 // Setup
 
+static const byte ipl_rom[0x40] =
+{
+    0xCD, 0xEF, 0xBD, 0xE8, 0x00, 0xC6, 0x1D, 0xD0,
+    0xFC, 0x8F, 0xAA, 0xF4, 0x8F, 0xBB, 0xF5, 0x78,
+    0xCC, 0xF4, 0xD0, 0xFB, 0x2F, 0x19, 0xEB, 0xF4,
+    0xD0, 0xFC, 0x7E, 0xF4, 0xD0, 0x0B, 0xE4, 0xF5,
+    0xCB, 0xF4, 0xD7, 0x00, 0xFC, 0xD0, 0xF3, 0xAB,
+    0x01, 0x10, 0xEF, 0x7E, 0xF4, 0x10, 0xEB, 0xBA,
+    0xF6, 0xDA, 0x00, 0xBA, 0xF4, 0xC4, 0xF4, 0xDD,
+    0x5D, 0xD0, 0xDB, 0x1F, 0x00, 0x00, 0xC0, 0xFF
+};
+
 blargg_err_t Sfm_Emu::set_sample_rate_( int sample_rate )
 {
     smp.power();
+    RETURN_ERR( apu.init() );
+    apu.init_rom( ipl_rom );
     if ( sample_rate != native_sample_rate )
     {
         RETURN_ERR( resampler.resize_buffer( native_sample_rate / 20 * 2 ) );
@@ -186,6 +204,7 @@ void Sfm_Emu::mute_voices_( int m )
     Music_Emu::mute_voices_( m );
     for ( int i = 0, j = 1; i < 8; ++i, j <<= 1 )
         smp.dsp.channel_enable( i, !( m & j ) );
+    apu.mute_voices( m );
 }
 
 blargg_err_t Sfm_Emu::load_mem_( byte const in [], int size )
@@ -215,6 +234,15 @@ blargg_err_t Sfm_Emu::load_mem_( byte const in [], int size )
 void Sfm_Emu::set_tempo_( double t )
 {
     smp.set_tempo( t );
+    apu.set_tempo( (int) (t * Snes_Spc::tempo_unit) );
+}
+
+blargg_err_t Sfm_Emu::set_spc_engine_( int e )
+{
+    if ( e != gme_spc_engine_accurate && e != gme_spc_engine_fast )
+        return blargg_err_caller;
+    engine = e;
+    return blargg_ok;
 }
 
 // (n ? n : 256)
@@ -222,17 +250,45 @@ void Sfm_Emu::set_tempo_( double t )
 
 #define META_ENUM_INT(n,d) (value = metadata.enumValue(n), value ? strtol(value, &end, 10) : (d))
 
-static const byte ipl_rom[0x40] =
+// Gives fast engine the state just loaded into the accurate one, as an SPC file image.
+// Only what an SPC file holds carries over; DSP voices restart from their registers.
+static blargg_err_t load_fast_engine( Snes_Spc& apu, SuperFamicom::SMP const& smp )
 {
-    0xCD, 0xEF, 0xBD, 0xE8, 0x00, 0xC6, 0x1D, 0xD0,
-    0xFC, 0x8F, 0xAA, 0xF4, 0x8F, 0xBB, 0xF5, 0x78,
-    0xCC, 0xF4, 0xD0, 0xFB, 0x2F, 0x19, 0xEB, 0xF4,
-    0xD0, 0xFC, 0x7E, 0xF4, 0xD0, 0x0B, 0xE4, 0xF5,
-    0xCB, 0xF4, 0xD7, 0x00, 0xFC, 0xD0, 0xF3, 0xAB,
-    0x01, 0x10, 0xEF, 0x7E, 0xF4, 0x10, 0xEB, 0xBA,
-    0xF6, 0xDA, 0x00, 0xBA, 0xF4, 0xC4, 0xF4, 0xDD,
-    0x5D, 0xD0, 0xDB, 0x1F, 0x00, 0x00, 0xC0, 0xFF
-};
+    blargg_vector<byte> image;
+    RETURN_ERR( image.resize( Snes_Spc::spc_min_file_size ) );
+    memset( image.begin(), 0, image.size() );
+
+    Spc_Emu::header_t& h = *(Spc_Emu::header_t*) image.begin();
+    memcpy( h.tag, "SNES-SPC700 Sound File Data v0.30\x1A\x1A", sizeof h.tag );
+    h.pc [0] = smp.regs.pc & 0xFF;
+    h.pc [1] = smp.regs.pc >> 8;
+    h.a   = smp.regs.a;
+    h.x   = smp.regs.x;
+    h.y   = smp.regs.y;
+    h.psw = smp.regs.p;
+    h.sp  = smp.regs.s;
+
+    byte* ram = image.begin() + Spc_Emu::header_t::size;
+    memcpy( ram, smp.apuram, 0x10000 );
+    memcpy( ram + 0x10000, smp.dsp.spc_dsp.m.regs, 128 );
+
+    // Snes_Spc takes SMP registers from $F0-$FF
+    ram [0xF0] = (smp.status.clock_speed << 6) | (smp.status.timer_speed << 4) | (smp.status.timers_enable << 3) | (smp.status.ram_disable << 2) | (smp.status.ram_writable << 1) | (smp.status.timers_disable << 0);
+    ram [0xF1] = smp.status.iplrom_enable ? 0x80 : 0;
+    ram [0xF2] = smp.status.dsp_addr;
+    memcpy( &ram [0xF4], smp.sfm_last, 4 );
+    ram [0xF8] = smp.status.ram00f8;
+    ram [0xF9] = smp.status.ram00f9;
+    for (int i = 0; i < 3; ++i)
+    {
+        SuperFamicom::SMP::Timer<192> const& t = (i == 0 ? smp.timer0 : (i == 1 ? smp.timer1 : *(SuperFamicom::SMP::Timer<192>*)&smp.timer2));
+        ram [0xF1] |= t.enable << i;
+        ram [0xFA + i] = t.target;
+        ram [0xFD + i] = t.stage3_ticks & 0x0F;
+    }
+
+    return apu.load_spc( image.begin(), image.size() );
+}
 
 blargg_err_t Sfm_Emu::start_track_( int track )
 {
@@ -446,6 +502,13 @@ blargg_err_t Sfm_Emu::start_track_( int track )
         voice.hidden_env = META_ENUM_INT(name + "envcache", 0);
     }
 
+    track_engine = engine;
+    if ( track_engine == gme_spc_engine_fast )
+    {
+        RETURN_ERR( load_fast_engine( apu, smp ) );
+        apu.set_port_log( log_begin, log_end, log_begin + loop_begin );
+    }
+
     filter.set_gain( (int) (gain() * Spc_Filter::gain_unit) );
     return blargg_ok;
 }
@@ -593,6 +656,9 @@ void Sfm_Emu::create_updated_metadata( Bml_Parser &out ) const
 
 blargg_err_t Sfm_Emu::save_( gme_writer_t writer, void* your_data ) const
 {
+    if ( track_engine == gme_spc_engine_fast )
+        return "Saving requires the accurate SPC engine";
+
     std::string meta_serialized;
     
     Bml_Parser metadata;
@@ -620,7 +686,10 @@ blargg_err_t Sfm_Emu::save_( gme_writer_t writer, void* your_data ) const
 
 blargg_err_t Sfm_Emu::play_and_filter( int count, sample_t out [] )
 {
-    smp.render( out, count );
+    if ( track_engine == gme_spc_engine_fast )
+        RETURN_ERR( apu.play( count, out ) );
+    else
+        smp.render( out, count );
     filter.run( out, count );
     return blargg_ok;
 }
@@ -637,7 +706,10 @@ blargg_err_t Sfm_Emu::skip_( int count )
 
     if ( count > 0 )
     {
-        smp.skip( count );
+        if ( track_engine == gme_spc_engine_fast )
+            RETURN_ERR( apu.skip( count ) );
+        else
+            smp.skip( count );
         filter.clear();
     }
 
@@ -17,6 +17,7 @@ Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA */
 
 int const fade_block_size = 512;
 int const fade_shift = 8; // fade ends with gain at 1.0 / (1 << fade_shift)
+int const fade_gain_shift = 14; // fixed-point precision of fade gain
 int const silence_threshold = 8;
 int const stereo = 2; // number of channels for stereo
 
@@ -154,16 +155,22 @@ static int int_log( int x, int step, int unit )
 	return ((unit - fraction) + (fraction >> 1)) >> shift;
 }
 
+// gain at sample time, in units of 1 << fade_gain_shift
+int Track_Filter::fade_gain( int time )
+{
+	int const unit = 1 << fade_gain_shift;
+	int gain = int_log( (time - fade_start) / fade_block_size, fade_step, unit );
+	if ( gain < (unit >> fade_shift) )
+		track_ended_ = emu_track_ended_ = true;
+	return gain;
+}
+
 void Track_Filter::handle_fade( sample_t out [], int out_count )
 {
 	for ( int i = 0; i < out_count; i += fade_block_size )
 	{
-		int const shift = 14;
-		int const unit = 1 << shift;
-		int gain = int_log( (out_time + i - fade_start) / fade_block_size,
-				fade_step, unit );
-		if ( gain < (unit >> fade_shift) )
-			track_ended_ = emu_track_ended_ = true;
+		int const shift = fade_gain_shift;
+		int gain = fade_gain( out_time + i );
 		
 		sample_t* io = &out [i];
 		for ( int count = min( fade_block_size, out_count - i ); count; --count )
@@ -214,6 +221,74 @@ void Track_Filter::fill_buf()
 	silence_count += buf_size;
 }
 
+void Track_Filter::fill( sample_t out [], int out_count )
+{
+	assert( emu_time >= out_time );
+	
+	// prints nifty graph of how far ahead we are when searching for silence
+	//dprintf( "%*s \n", int ((emu_time - out_time) * 7 / 44100), "*" );
+	
+	// use any remaining silence samples
+	int pos = 0;
+	if ( silence_count )
+	{
+		if ( !silence_ignored_ )
+		{
+			// during a run of silence, run emulator at >=2x speed so it gets ahead
+			int ahead_time = setup_.lookahead * (out_time + out_count - silence_time) +
+					silence_time;
+			while ( emu_time < ahead_time && !(buf_remain | emu_track_ended_) )
+				fill_buf();
+			
+			// end track if sufficient silence has been found
+			if ( emu_time - silence_time > setup_.max_silence )
+			{
+				track_ended_  = emu_track_ended_ = true;
+				silence_count = out_count;
+				buf_remain    = 0;
+			}
+		}
+		
+		// fill from remaining silence
+		pos = min( silence_count, out_count );
+		memset( out, 0, pos * sizeof *out );
+		silence_count -= pos;
+	}
+	
+	// use any remaining samples from buffer
+	if ( buf_remain )
+	{
+		int n = min( buf_remain, (int) (out_count - pos) );
+		memcpy( out + pos, buf.begin() + (buf_size - buf_remain), n * sizeof *out );
+		buf_remain -= n;
+		pos += n;
+	}
+	
+	// generate remaining samples normally
+	int remain = out_count - pos;
+	if ( remain )
+	{
+		emu_play( out + pos, remain );
+		track_ended_ |= emu_track_ended_;
+		
+		if ( silence_ignored_ && !is_fading() )
+		{
+			// if left unupdated, ahead_time could become too large
+			silence_time = emu_time;
+		}
+		else
+		{
+			// check end for a new run of silence
+			int silence = count_silence( out + pos, remain );
+			if ( silence < remain )
+				silence_time = emu_time - silence;
+			
+			if ( emu_time - silence_time >= buf_size )
+				fill_buf(); // cause silence detection on next play()
+		}
+	}
+}
+
 blargg_err_t Track_Filter::play( int out_count, sample_t out [] )
 {
 	emu_error = NULL;
@@ -223,75 +298,56 @@ blargg_err_t Track_Filter::play( int out_count, sample_t out [] )
 	}
 	else
 	{
-		assert( emu_time >= out_time );
+		fill( out, out_count );
 		
-		// prints nifty graph of how far ahead we are when searching for silence
-		//dprintf( "%*s \n", int ((emu_time - out_time) * 7 / 44100), "*" );
+		if ( is_fading() )
+			handle_fade( out, out_count );
+	}
+	out_time += out_count;
+	out_time_scaled_ += int(out_count * tempo_ / stereo);
+	return emu_error;
+}
+
+blargg_err_t Track_Filter::play_float_planar( int pair_count, float left [], float right [] )
+{
+	// one fade block at a time, so a single gain covers each block
+	sample_t in [fade_block_size];
+	blargg_err_t err = blargg_ok;
+	while ( pair_count > 0 )
+	{
+		int const n = min( pair_count, (int) fade_block_size / stereo );
+		pair_count -= n;
 		
-		// use any remaining silence samples
-		int pos = 0;
-		if ( silence_count )
+		emu_error = NULL;
+		float gain = 0.0f;
+		if ( !track_ended_ )
 		{
-			if ( !silence_ignored_ )
-			{
-				// during a run of silence, run emulator at >=2x speed so it gets ahead
-				int ahead_time = setup_.lookahead * (out_time + out_count - silence_time) +
-						silence_time;
-				while ( emu_time < ahead_time && !(buf_remain | emu_track_ended_) )
-					fill_buf();
-				
-				// end track if sufficient silence has been found
-				if ( emu_time - silence_time > setup_.max_silence )
-				{
-					track_ended_  = emu_track_ended_ = true;
-					silence_count = out_count;
-					buf_remain    = 0;
-				}
-			}
-			
-			// fill from remaining silence
-			pos = min( silence_count, out_count );
-			memset( out, 0, pos * sizeof *out );
-			silence_count -= pos;
+			fill( in, n * stereo );
+			gain = 1.0f / 0x8000;
+			if ( is_fading() )
+				gain *= fade_gain( out_time ) * (1.0f / (1 << fade_gain_shift));
 		}
 		
-		// use any remaining samples from buffer
-		if ( buf_remain )
+		if ( gain == 0.0f )
 		{
-			int n = min( buf_remain, (int) (out_count - pos) );
-			memcpy( out + pos, buf.begin() + (buf_size - buf_remain), n * sizeof *out );
-			buf_remain -= n;
-			pos += n;
+			memset( left,  0, n * sizeof *left  );
+			memset( right, 0, n * sizeof *right );
 		}
-		
-		// generate remaining samples normally
-		int remain = out_count - pos;
-		if ( remain )
+		else
 		{
-			emu_play( out + pos, remain );
-			track_ended_ |= emu_track_ended_;
-			
-			if ( silence_ignored_ && !is_fading() )
+			for ( int i = 0; i < n; i++ )
 			{
-				// if left unupdated, ahead_time could become too large
-				silence_time = emu_time;
-			}
-			else
-			{
-				// check end for a new run of silence
-				int silence = count_silence( out + pos, remain );
-				if ( silence < remain )
-					silence_time = emu_time - silence;
-				
-				if ( emu_time - silence_time >= buf_size )
-					fill_buf(); // cause silence detection on next play()
+				left  [i] = in [i * stereo    ] * gain;
+				right [i] = in [i * stereo + 1] * gain;
 			}
 		}
+		left  += n;
+		right += n;
 		
-		if ( is_fading() )
-			handle_fade( out, out_count );
+		out_time += n * stereo;
+		out_time_scaled_ += int(n * tempo_);
+		if ( !err )
+			err = emu_error;
 	}
-	out_time += out_count;
-	out_time_scaled_ += int(out_count * tempo_ / stereo);
-	return emu_error;
+	return err;
 }
@@ -48,6 +48,10 @@ public:
 	// Generates n samples into buf
 	blargg_err_t play( int n, sample_t buf [] );
 
+	// Generates n stereo sample pairs as floats in -1.0 to 1.0 range, into separate
+	// left and right buffers. Fade is applied after conversion.
+	blargg_err_t play_float_planar( int n, float left [], float right [] );
+
 	// Skips n samples
 	blargg_err_t skip( int n );
 
@@ -98,6 +102,7 @@ private:
 	int fade_start;
 	int fade_step;
 	bool is_fading() const;
+	int fade_gain( int time );
 	void handle_fade( sample_t out [], int count );
 	
 	// Silence detection
@@ -108,6 +113,7 @@ private:
 	blargg_vector<sample_t> buf;
 	void fill_buf();
 	void emu_play( sample_t out [], int count );
+	void fill( sample_t out [], int count );
 };
 
 #endif
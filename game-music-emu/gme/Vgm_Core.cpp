@@ -991,6 +991,12 @@ void Vgm_Core::update_fm_rates( int* ym2151_rate, int* ym2413_rate, int* ym2612_
 	}
 }
 
+blargg_err_t Vgm_Core::set_ym2612_core( int core )
+{
+	RETURN_ERR( ym2612[0].set_core( core ) );
+	return ym2612[1].set_core( core );
+}
+
 blargg_err_t Vgm_Core::init_chips( double* rate, bool reinit )
 {
 	int ymz280b_rate = get_le32( header().ymz280b_rate ) & 0xBFFFFFFF;
@@ -1279,10 +1285,9 @@ blargg_err_t Vgm_Core::init_chips( double* rate, bool reinit )
 	if ( okim6295_rate )
 	{
 		// moo
-		Mem_File_Reader rdr( file_begin(), file_size() );
 		Music_Emu * vgm = gme_vgm_type->new_info();
 		track_info_t info;
-		vgm->load( rdr );
+		vgm->load_mem( file_begin(), file_size() );
 		vgm->track_info( &info, 0 );
 		delete vgm;
 
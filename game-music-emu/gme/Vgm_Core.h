@@ -148,6 +148,9 @@ public:
 	// final sampling rate.
 	blargg_err_t init_chips( double* fm_rate, bool reinit = false );
 	
+	// Selects YM2612 emulation core (Ym2612_Emu::core_*)
+	blargg_err_t set_ym2612_core( int core );
+	
 	// True if any FM chips are used by file. Always false until init_fm()
 	// is called.
 	bool uses_fm() const                { return ym2612[0].enabled() || ym2413[0].enabled() || ym2151[0].enabled() || c140.enabled() ||
@@ -224,63 +224,66 @@ static void hash_vgm_file( Vgm_Emu::header_t const& h, byte const* data, int dat
 struct Vgm_File : Gme_Info_
 {
 	Vgm_Emu::header_t h;
-	blargg_vector<byte> data;
-	blargg_vector<byte> gd3;
+	// Point into the file data
+	byte const* data;
+	int data_size;
+	byte const* gd3;
+	int gd3_size;
 	
 	Vgm_File() { set_type( gme_vgm_type ); }
 	
-	blargg_err_t load_( Data_Reader& in )
+	blargg_err_t load_mem_( byte const begin [], int file_size )
 	{
-		int file_size = in.remain();
+		// Gzipped data comes back here inflated, through load_(), unless there's
+		// no zlib to inflate it
+		if ( file_size >= 2 && get_be16( begin ) == BLARGG_2CHAR( 0x1F, 0x8B ) &&
+				begin != file_data.begin() )
+			return Gme_Info_::load_mem_( begin, file_size );
+		
+		data      = NULL;
+		data_size = 0;
+		gd3       = NULL;
+		gd3_size  = 0;
+		
 		if ( file_size <= h.size_min )
 			return blargg_err_file_type;
 		
-		RETURN_ERR( in.read( &h, h.size_min ) );
+		memcpy( &h, begin, h.size_min );
 		if ( !h.valid_tag() )
 			return blargg_err_file_type;
 
 		if ( h.size() > h.size_min )
-			RETURN_ERR( in.read( &h.rf5c68_rate, h.size() - h.size_min ) );
+		{
+			if ( file_size < h.size() )
+				return blargg_err_file_eof;
+			memcpy( &h.rf5c68_rate, begin + h.size_min, h.size() - h.size_min );
+		}
 
 		h.cleanup();
 
 		int data_offset = get_le32( h.data_offset ) + offsetof( Vgm_Core::header_t, data_offset );
-		int data_size = file_size - offsetof( Vgm_Core::header_t, data_offset ) - data_offset;
+		int data_end = file_size - offsetof( Vgm_Core::header_t, data_offset );
 		int gd3_offset = get_le32( h.gd3_offset );
 		if ( gd3_offset > 0 )
 			gd3_offset += offsetof( Vgm_Core::header_t, gd3_offset );
 
-		int amount_to_skip = gd3_offset - h.size();
-
 		if ( gd3_offset > 0 && gd3_offset > data_offset )
-		{
-			data_size = gd3_offset - data_offset;
-			amount_to_skip = 0;
-
-			RETURN_ERR( data.resize( data_size ) );
-			RETURN_ERR( in.skip( data_offset - h.size() ) );
-			RETURN_ERR( in.read( data.begin(), data_size ) );
-		}
+			data_end = gd3_offset;
 
 		int remain = file_size - gd3_offset;
-		byte gd3_h [gd3_header_size];
 		if ( gd3_offset > 0 && remain >= gd3_header_size )
 		{
-			RETURN_ERR( in.skip( amount_to_skip ) );
-			RETURN_ERR( in.read( gd3_h, sizeof gd3_h ) );
-			int gd3_size = check_gd3_header( gd3_h, remain );
-			if ( gd3_size )
-			{
-				RETURN_ERR( gd3.resize( gd3_size ) );
-				RETURN_ERR( in.read( gd3.begin(), gd3.size() ) );
-			}
+			gd3_size = check_gd3_header( begin + gd3_offset, remain );
+			gd3 = begin + gd3_offset + gd3_header_size;
+		}
 
-			if ( data_offset > gd3_offset )
-			{
-				RETURN_ERR( data.resize( data_size ) );
-				RETURN_ERR( in.skip( data_offset - gd3_offset - sizeof gd3_h - gd3.size() ) );
-				RETURN_ERR( in.read( data.begin(), data.end() - data.begin() ) );
-			}
+		// Only hashed, and only if it's before or right after the GD3 tag
+		if ( gd3_offset > 0 && (gd3_offset > data_offset || (remain >= gd3_header_size && data_offset > gd3_offset)) )
+		{
+			if ( data_offset < h.size() || data_end > file_size )
+				return blargg_err_file_eof;
+			data = begin + data_offset;
+			data_size = blargg_max( data_end - data_offset, 0 );
 		}
 
 		return blargg_ok;
@@ -289,14 +292,14 @@ struct Vgm_File : Gme_Info_
 	blargg_err_t track_info_( track_info_t* out, int ) const
 	{
 		get_vgm_length( h, out );
-		if ( gd3.size() )
-			parse_gd3( gd3.begin(), gd3.end(), out );
+		if ( gd3_size )
+			parse_gd3( gd3, gd3 + gd3_size, out );
 		return blargg_ok;
 	}
 
 	blargg_err_t hash_( Hash_Function& out ) const
 	{
-		hash_vgm_file( h, data.begin(), data.end() - data.begin(), out );
+		hash_vgm_file( h, data, data_size, out );
 		return blargg_ok;
 	}
 };
@@ -314,6 +317,11 @@ void Vgm_Emu::set_tempo_( double t )
 	core.set_tempo( t );
 }
 
+blargg_err_t Vgm_Emu::set_ym2612_core_( int c )
+{
+	return core.set_ym2612_core( c );
+}
+
 blargg_err_t Vgm_Emu::set_sample_rate_( int sample_rate )
 {
 	RETURN_ERR( core.stereo_buf[0].set_sample_rate( sample_rate, 1000 / 30 ) );
@@ -50,6 +50,7 @@ protected:
 	blargg_err_t run_clocks( blip_time_t&, int );
 	virtual void set_tempo_( double );
 	virtual void mute_voices_( int mask );
+	virtual blargg_err_t set_ym2612_core_( int );
 	virtual void set_voice( int, Blip_Buffer*, Blip_Buffer*, Blip_Buffer* );
 	virtual void update_eq( blip_eq_t const& );
 	virtual void unload();
@@ -1,7 +1,198 @@
+// Game_Music_Emu $vers. http://www.slack.net/~ant/
+
 #include "Ym2612_Emu.h"
+#include "Ym2612_Nuked.h"
+#include "Ym2612_GENS.h"
+#include "fm.h"
+
+#include <string.h>
+
+#include "blargg_source.h"
+
+// Ym2612_Emu
+
+Ym2612_Emu::Ym2612_Emu()
+{
+	impl         = 0;
+	nuked        = 0;
+	gens         = 0;
+	core         = core_mame;
+	mute_mask    = 0;
+	sample_rate_ = 0;
+	clock_rate_  = 0;
+}
+
+Ym2612_Emu::~Ym2612_Emu()
+{
+	free_cores();
+}
+
+void Ym2612_Emu::free_cores()
+{
+	if ( impl )
+	{
+		ym2612_shutdown( impl );
+		impl = 0;
+	}
+	delete nuked;
+	nuked = 0;
+	delete gens;
+	gens = 0;
+}
+
+const char* Ym2612_Emu::set_core( int new_core )
+{
+	if ( new_core != core_mame && new_core != core_nuked && new_core != core_gens )
+		return blargg_err_caller;
+
+	if ( new_core == core )
+		return 0;
+
+	core = new_core;
+	if ( !sample_rate_ )
+		return 0;
+
+	RETURN_ERR( set_rate( sample_rate_, clock_rate_ ) );
+	reset();
+	return 0;
+}
+
+const char* Ym2612_Emu::set_rate( double sample_rate, double clock_rate )
+{
+	free_cores();
+
+	if ( !clock_rate )
+		clock_rate = sample_rate * 144.;
+
+	sample_rate_ = sample_rate;
+	clock_rate_  = clock_rate;
+
+	switch ( core )
+	{
+	case core_nuked:
+		CHECK_ALLOC( nuked = BLARGG_NEW Ym2612_Nuked_Emu );
+		RETURN_ERR( nuked->set_rate( sample_rate, clock_rate ) );
+		break;
+
+	case core_gens:
+		CHECK_ALLOC( gens = BLARGG_NEW Ym2612_GENS_Emu );
+		RETURN_ERR( gens->set_rate( sample_rate, clock_rate ) );
+		break;
+
+	default:
+		impl = ym2612_init( (long) (clock_rate + 0.5), (long) (sample_rate + 0.5) );
+		if ( !impl )
+			return blargg_err_memory;
+		break;
+	}
+
+	mute_voices( mute_mask );
+	return 0;
+}
+
+void Ym2612_Emu::reset()
+{
+	if ( nuked )
+		nuked->reset();
+	else if ( gens )
+		gens->reset();
+	else
+		ym2612_reset_chip( impl );
+}
+
+static stream_sample_t* DUMMYBUF[0x02] = {(stream_sample_t*)NULL, (stream_sample_t*)NULL};
+
+void Ym2612_Emu::write0( int addr, int data )
+{
+	if ( nuked )
+		return nuked->write0( addr, data );
+	if ( gens )
+		return gens->write0( addr, data );
+
+	ym2612_update_one( impl, DUMMYBUF, 0 );
+	ym2612_write( impl, 0, addr );
+	ym2612_write( impl, 1, data );
+}
+
+void Ym2612_Emu::write1( int addr, int data )
+{
+	if ( nuked )
+		return nuked->write1( addr, data );
+	if ( gens )
+		return gens->write1( addr, data );
+
+	ym2612_update_one( impl, DUMMYBUF, 0 );
+	ym2612_write( impl, 2, addr );
+	ym2612_write( impl, 3, data );
+}
+
+void Ym2612_Emu::mute_voices( int mask )
+{
+	mute_mask = mask;
+	if ( nuked )
+		nuked->mute_voices( mask );
+	else if ( gens )
+		gens->mute_voices( mask );
+	else if ( impl )
+		ym2612_set_mutemask( impl, mask );
+}
+
+// Nuked and GENS generate half the level of the MAME core, which Vgm_Core and Gym_Emu
+// gains are tuned for, and Nuked replaces the buffer contents instead of adding to them
+template<class Emu>
+static void run_scaled( Emu* emu, int pair_count, Ym2612_Emu::sample_t* out )
+{
+	Ym2612_Emu::sample_t buf [1024 * 2];
+
+	while ( pair_count > 0 )
+	{
+		int todo = pair_count;
+		if ( todo > 1024 ) todo = 1024;
+		memset( buf, 0, todo * 2 * sizeof buf [0] );
+		emu->run( todo, buf );
+
+		for ( int i = 0; i < todo * 2; i++ )
+		{
+			int s = out [i] + buf [i] * 2;
+			if ( (short) s != s ) s = 0x7FFF ^ ( s >> 31 );
+			out [i] = s;
+		}
+
+		out += todo * 2;
+		pair_count -= todo;
+	}
+}
+
+void Ym2612_Emu::run( int pair_count, sample_t* out )
+{
+	if ( nuked )
+		return run_scaled( nuked, pair_count, out );
+	if ( gens )
+		return run_scaled( gens, pair_count, out );
+
+	stream_sample_t bufL[ 1024 ];
+	stream_sample_t bufR[ 1024 ];
+	stream_sample_t * buffers[2] = { bufL, bufR };
+
+	while (pair_count > 0)
+	{
+		int todo = pair_count;
+		if (todo > 1024) todo = 1024;
+		ym2612_update_one( impl, buffers, todo );
+
+		for (int i = 0; i < todo; i++)
+		{
+			int output_l = bufL [i];
+			int output_r = bufR [i];
+			output_l += out [0];
+			output_r += out [1];
+			if ( (short)output_l != output_l ) output_l = 0x7FFF ^ ( output_l >> 31 );
+			if ( (short)output_r != output_r ) output_r = 0x7FFF ^ ( output_r >> 31 );
+			out [0] = output_l;
+			out [1] = output_r;
+			out += 2;
+		}
 
-#ifdef USE_GENS
-#include "Ym2612_Emu_Gens.cpp"
-#else
-#include "Ym2612_Emu_MAME.cpp"
-#endif
+		pair_count -= todo;
+	}
+}
@@ -4,37 +4,52 @@
 #ifndef YM2612_EMU_H
 #define YM2612_EMU_H
 
-// Gens is buggy and inaccurate, but faster
-// #define USE_GENS
-#ifdef USE_GENS
-struct Ym2612_Impl;
-#else
+class Ym2612_Nuked_Emu;
+class Ym2612_GENS_Emu;
+
 typedef void Ym2612_Impl;
-#endif
 
 class Ym2612_Emu  {
 	Ym2612_Impl* impl;
+	Ym2612_Nuked_Emu* nuked;
+	Ym2612_GENS_Emu* gens;
+	int core;
+	int mute_mask;
+	double sample_rate_;
+	double clock_rate_;
+
+	void free_cores();
 public:
-	Ym2612_Emu() { impl = 0; }
+	Ym2612_Emu();
 	~Ym2612_Emu();
-	
+
+	// Emulation cores, same values as gme_ym2612_core_* in gme.h.
+	// MAME is the default. Nuked is cycle accurate but several times slower,
+	// GENS is buggy and inaccurate, but fastest.
+	enum { core_mame = 0, core_nuked = 1, core_gens = 2 };
+
+	// Selects emulation core. If rate has already been set, the chip is recreated
+	// in power-up state. Returns non-zero if error.
+	const char* set_core( int core );
+	int get_core() const { return core; }
+
 	// Sets sample rate and chip clock rate, in Hz. Returns non-zero
 	// if error. If clock_rate=0, uses sample_rate*144
 	const char* set_rate( double sample_rate, double clock_rate = 0 );
-	
+
 	// Resets to power-up state
 	void reset();
-	
+
 	// Mutes voice n if bit n (1 << n) of mask is set
 	enum { channel_count = 6 };
 	void mute_voices( int mask );
-	
+
 	// Writes addr to register 0 then data to register 1
 	void write0( int addr, int data );
-	
+
 	// Writes addr to register 2 then data to register 3
 	void write1( int addr, int data );
-	
+
 	// Runs and adds pair_count*2 samples into current output buffer contents
 	typedef short sample_t;
 	enum { out_chan_count = 2 }; // stereo
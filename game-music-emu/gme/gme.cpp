@@ -141,6 +141,30 @@ BLARGG_EXPORT gme_err_t gme_open_data( void const* data, long size, Music_Emu**
 	return err;
 }
 
+BLARGG_EXPORT gme_err_t gme_open_info_data( void const* data, long size, Music_Emu** out )
+{
+	require( (data || !size) && out );
+	*out = NULL;
+	gme_type_t file_type = 0;
+	if ( size >= 4 )
+		file_type = gme_identify_extension( gme_identify_header( data ) );
+	if ( !file_type )
+		return blargg_err_file_type;
+	
+	Music_Emu* emu = gme_new_emu( file_type, gme_info_only );
+	CHECK_ALLOC( emu );
+	
+	// The info-only types parse the data in place
+	gme_err_t err = emu->load_mem( data, size );
+	
+	if ( err )
+		delete emu;
+	else
+		*out = emu;
+
+	return err;
+}
+
 BLARGG_EXPORT gme_err_t gme_open_file( const char path [], Music_Emu** out, int sample_rate )
 {
 	require( path && out );
@@ -350,6 +374,7 @@ BLARGG_EXPORT void      gme_set_user_cleanup(Music_Emu* gme, gme_user_cleanup_t
 
 BLARGG_EXPORT gme_err_t gme_start_track    ( Music_Emu* gme, int index )              { return gme->start_track( index ); }
 BLARGG_EXPORT gme_err_t gme_play           ( Music_Emu* gme, int n, short p [] )      { return gme->play( n, p ); }
+BLARGG_EXPORT gme_err_t gme_play_float_planar( Music_Emu* gme, int n, float l [], float r [] ) { return gme->play_float_planar( n, l, r ); }
 BLARGG_EXPORT void      gme_set_fade       ( Music_Emu* gme, int start_msec, int length_msec ) { gme->set_fade( start_msec, length_msec ); }
 BLARGG_EXPORT gme_bool  gme_track_ended    ( Music_Emu const* gme )                   { return gme->track_ended(); }
 BLARGG_EXPORT int       gme_tell           ( Music_Emu const* gme )                   { return gme->tell(); }
@@ -368,6 +393,8 @@ BLARGG_EXPORT const char* gme_voice_name   ( Music_Emu const* gme, int i )
 BLARGG_EXPORT gme_err_t gme_save           ( Music_Emu const* gme, gme_writer_t writer, void* your_data ) { return gme->save( writer, your_data ); }
 /* this function is no longer needed, apparently, but a stub is kept to avoid ABI breakage.  --Wyatt */
 BLARGG_EXPORT void      gme_enable_accuracy( Music_Emu* gme, int enabled ){return;}
+BLARGG_EXPORT gme_err_t gme_set_spc_engine ( Music_Emu* gme, int engine )         { return gme->set_spc_engine( engine ); }
+BLARGG_EXPORT gme_err_t gme_set_ym2612_core( Music_Emu* gme, int core )           { return gme->set_ym2612_core( core ); }
 
 
 BLARGG_EXPORT void gme_effects( Music_Emu const* gme, gme_effects_t* out )
@@ -36,6 +36,10 @@ gme_err_t gme_start_track( gme_t*, int index );
 must be even. */
 gme_err_t gme_play( gme_t*, int count, short out [] );
 
+/* Generates 'count' stereo sample pairs as floats in -1.0 to 1.0 range, with left
+channel into 'left' and right channel into 'right'. Each buffer must hold 'count' floats. */
+gme_err_t gme_play_float_planar( gme_t*, int count, float left [], float right [] );
+
 /* Closes file and frees memory. OK to pass NULL. */
 void gme_delete( gme_t* );
 
@@ -71,6 +75,13 @@ gme_err_t gme_skip( gme_t*, int samples );
 information from a music file */
 enum { gme_info_only = -1 };
 
+/* Opens music data in memory for track information only. Unlike gme_open_data() with
+gme_info_only, it doesn't copy the data, which must stay valid until gme_delete(), and
+only reads headers and tags; no emulator is created. Files opened this way don't share
+any state, so they can be opened and queried from several threads at once. Use
+gme_track_count(), gme_track_info() and gme_load_m3u_data() with the result. */
+gme_err_t gme_open_info_data( void const* data, long size, gme_t** out );
+
 /* Most recent warning string, or NULL if none. Clears current warning after returning.
 Warning is also cleared when loading a file and starting a track. */
 const char* gme_warning( gme_t* );
@@ -159,6 +170,27 @@ void gme_set_equalizer( gme_t*, gme_equalizer_t const* eq );
 /* stub to avoid ABI breakage, I think --Wyatt */
 void gme_enable_accuracy( gme_t*, int enabled );
 
+/* Super Nintendo emulation engines */
+enum {
+	gme_spc_engine_accurate = 0,/* higan SMP/DSP, cycle accurate (default) */
+	gme_spc_engine_fast     = 1 /* blargg's Snes_Spc, much less CPU per sample */
+};
+
+/* Selects the engine used for SPC and SFM music from the next gme_start_track() on.
+Returns an error for other music types. */
+gme_err_t gme_set_spc_engine( gme_t*, int engine );
+
+/* Sega Genesis YM2612 emulation cores */
+enum {
+	gme_ym2612_core_mame  = 0,/* good accuracy and speed (default) */
+	gme_ym2612_core_nuked = 1,/* cycle accurate, several times slower; for offline renders */
+	gme_ym2612_core_gens  = 2 /* fastest but inaccurate; for seeking and analysis */
+};
+
+/* Selects the YM2612 core used for VGM and GYM music. The chip restarts from power-up
+state, so call this before gme_start_track(). Returns an error for other music types. */
+gme_err_t gme_set_ym2612_core( gme_t*, int core );
+
 /******** Effects processor ********/
 
 /* Adds stereo surround and echo to music that's usually mono or has little
@@ -37,7 +37,9 @@
 #include <codecvt>
 #include <locale>
 
+#ifdef __EMSCRIPTEN__
 #include <emscripten/fetch.h>
+#endif
 #include <psflib.h>
 
 #include "usf/usf.h"
@@ -784,6 +786,15 @@ private:
 
 static input_usf g_input_usf;
 
+static int scan_missing(void *context, const char *file_name, int present) {
+  if (!present) {
+    std::string *missing = static_cast<std::string *>(context);
+    *missing += file_name;
+    *missing += '\n';
+  }
+  return 0;
+}
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -802,6 +813,19 @@ int32_t n64_load_file(const char *uri, int16_t *output_buffer, uint16_t outSize,
   }
 }
 
+// lists the files of the _lib chain of uri which are not in the file system yet, one per
+// line, so that the JavaScript side can fetch them all before calling n64_load_file
+// (broken files yield an empty list and are reported by n64_load_file)
+const char *n64_scan_file(const char *uri) {
+  static std::string missing;
+  missing.clear();
+
+  if (psf_scan(uri, &psf_file_system, 0x21, scan_missing, &missing, 0, NULL) < 0)
+    missing.clear();
+
+  return missing.c_str();
+}
+
 int32_t n64_get_duration_ms() {
   return 1000.0 * g_input_usf.getSamplesToPlay() / g_input_usf.getSamplesRate();
 }
@@ -26,6 +26,7 @@
 #include <string.h>
 
 #include "alist.h"
+#include "alist_simd.h"
 #include "arithmetics.h"
 #include "audio.h"
 #include "hle_external.h"
@@ -95,6 +96,76 @@ static int16_t ramp_step(struct ramp_t* ramp)
     return (int16_t)(ramp->value >> 16);
 }
 
+/* envelope mix count samples of in into n buffers, starting at sample ptr.
+ * When blocks is set, aligned groups of 8 samples get their gains computed
+ * first and are then mixed by the vector kernel. */
+static void alist_envmix_ramps(
+        size_t n, int16_t* const* dst, const int16_t* in,
+        size_t ptr, size_t count,
+        struct ramp_t* ramps, int16_t dry, int16_t wet, bool blocks)
+{
+    while (count != 0) {
+        if (blocks && (ptr & 7) == 0 && count >= 8) {
+            int16_t gains[4][8];
+            int16_t src[8];
+            size_t x, i;
+
+            for (x = 0; x < 8; ++x) {
+                int16_t l_vol = ramp_step(&ramps[0]);
+                int16_t r_vol = ramp_step(&ramps[1]);
+
+                gains[0][x^S] = clamp_s16((l_vol * dry + 0x4000) >> 15);
+                gains[1][x^S] = clamp_s16((r_vol * dry + 0x4000) >> 15);
+                gains[2][x^S] = clamp_s16((l_vol * wet + 0x4000) >> 15);
+                gains[3][x^S] = clamp_s16((r_vol * wet + 0x4000) >> 15);
+            }
+
+            /* in may be one of the outputs */
+            memcpy(src, in + ptr, sizeof(src));
+
+            for (i = 0; i < n; ++i)
+                hle_mix_gains(dst[i] + ptr, src, gains[i], 8);
+
+            ptr += 8;
+            count -= 8;
+        }
+        else {
+            int16_t  gains[4];
+            int16_t* buffers[4];
+            int16_t l_vol = ramp_step(&ramps[0]);
+            int16_t r_vol = ramp_step(&ramps[1]);
+
+            buffers[0] = dst[0] + (ptr^S);
+            buffers[1] = dst[1] + (ptr^S);
+            buffers[2] = dst[2] + (ptr^S);
+            buffers[3] = dst[3] + (ptr^S);
+
+            gains[0] = clamp_s16((l_vol * dry + 0x4000) >> 15);
+            gains[1] = clamp_s16((r_vol * dry + 0x4000) >> 15);
+            gains[2] = clamp_s16((l_vol * wet + 0x4000) >> 15);
+            gains[3] = clamp_s16((r_vol * wet + 0x4000) >> 15);
+
+            alist_envmix_mix(n, buffers, gains, in[ptr^S]);
+            ++ptr;
+            --count;
+        }
+    }
+}
+
+/* block processing keeps the per-sample update order as long as all buffers
+ * are whole 8 samples blocks apart */
+static bool alist_envmix_blocks(size_t n, uint16_t dmemi, const uint16_t* dmem)
+{
+    size_t i;
+
+    for (i = 0; i < n; ++i) {
+        if (((dmem[i] - dmemi) & 0xf) != 0)
+            return false;
+    }
+
+    return true;
+}
+
 /* global functions */
 #ifdef DEBUG_INFO
 void alist_process(struct hle_t* hle, const acmd_callback_t abi[], unsigned int abi_size, const char* abi_names[])
@@ -237,27 +308,7 @@ void alist_interleave(struct hle_t* hle, uint16_t dmemo, uint16_t left, uint16_t
     const uint16_t *srcL = (uint16_t*)(hle->alist_buffer + left);
     const uint16_t *srcR = (uint16_t*)(hle->alist_buffer + right);
 
-    count >>= 2;
-
-    while(count != 0) {
-        uint16_t l1 = *(srcL++);
-        uint16_t l2 = *(srcL++);
-        uint16_t r1 = *(srcR++);
-        uint16_t r2 = *(srcR++);
-
-#if M64P_BIG_ENDIAN
-        *(dst++) = l1;
-        *(dst++) = r1;
-        *(dst++) = l2;
-        *(dst++) = r2;
-#else
-        *(dst++) = r2;
-        *(dst++) = l2;
-        *(dst++) = r1;
-        *(dst++) = l1;
-#endif
-        --count;
-    }
+    hle_interleave(dst, srcL, srcR, count >> 2);
 }
 
 
@@ -281,13 +332,16 @@ void alist_envmix_exp(
     int16_t* const dr = (int16_t*)(hle->alist_buffer + dmem_dr);
     int16_t* const wl = (int16_t*)(hle->alist_buffer + dmem_wl);
     int16_t* const wr = (int16_t*)(hle->alist_buffer + dmem_wr);
+    int16_t* const buffers[4] = { dl, dr, wl, wr };
+    const uint16_t dmem[4] = { dmem_dl, dmem_dr, dmem_wl, dmem_wr };
+    const bool blocks = alist_envmix_blocks(n, dmemi, dmem);
 
     struct ramp_t ramps[2];
     int32_t exp_seq[2];
     int32_t exp_rates[2];
 
     uint32_t ptr = 0;
-    int x, y;
+    int y;
     short save_buffer[40];
 
     memcpy((uint8_t *)save_buffer, (hle->dram + address), sizeof(save_buffer));
@@ -331,25 +385,8 @@ void alist_envmix_exp(
             ramps[1].step = (exp_seq[1] - ramps[1].value) >> 3;
         }
 
-        for (x = 0; x < 8; ++x) {
-            int16_t  gains[4];
-            int16_t* buffers[4];
-            int16_t l_vol = ramp_step(&ramps[0]);
-            int16_t r_vol = ramp_step(&ramps[1]);
-
-            buffers[0] = dl + (ptr^S);
-            buffers[1] = dr + (ptr^S);
-            buffers[2] = wl + (ptr^S);
-            buffers[3] = wr + (ptr^S);
-
-            gains[0] = clamp_s16((l_vol * dry + 0x4000) >> 15);
-            gains[1] = clamp_s16((r_vol * dry + 0x4000) >> 15);
-            gains[2] = clamp_s16((l_vol * wet + 0x4000) >> 15);
-            gains[3] = clamp_s16((r_vol * wet + 0x4000) >> 15);
-
-            alist_envmix_mix(n, buffers, gains, in[ptr^S]);
-            ++ptr;
-        }
+        alist_envmix_ramps(n, buffers, in, ptr, 8, ramps, dry, wet, blocks);
+        ptr += 8;
     }
 
     *(int16_t *)(save_buffer +  0) = wet;               /* 0-1 */
@@ -378,7 +415,6 @@ void alist_envmix_ge(
         const int32_t *rate,
         uint32_t address)
 {
-    unsigned k;
     size_t n = (aux) ? 4 : 2;
 
     const int16_t* const in = (int16_t*)(hle->alist_buffer + dmemi);
@@ -386,6 +422,8 @@ void alist_envmix_ge(
     int16_t* const dr = (int16_t*)(hle->alist_buffer + dmem_dr);
     int16_t* const wl = (int16_t*)(hle->alist_buffer + dmem_wl);
     int16_t* const wr = (int16_t*)(hle->alist_buffer + dmem_wr);
+    int16_t* const buffers[4] = { dl, dr, wl, wr };
+    const uint16_t dmem[4] = { dmem_dl, dmem_dr, dmem_wl, dmem_wr };
 
     struct ramp_t ramps[2];
     short save_buffer[40];
@@ -411,25 +449,8 @@ void alist_envmix_ge(
         ramps[1].value  = *(int32_t *)(save_buffer + 18);   /* 14-15 */
     }
 
-    count >>= 1;
-    for (k = 0; k < count; ++k) {
-        int16_t  gains[4];
-        int16_t* buffers[4];
-        int16_t l_vol = ramp_step(&ramps[0]);
-        int16_t r_vol = ramp_step(&ramps[1]);
-
-        buffers[0] = dl + (k^S);
-        buffers[1] = dr + (k^S);
-        buffers[2] = wl + (k^S);
-        buffers[3] = wr + (k^S);
-
-        gains[0] = clamp_s16((l_vol * dry + 0x4000) >> 15);
-        gains[1] = clamp_s16((r_vol * dry + 0x4000) >> 15);
-        gains[2] = clamp_s16((l_vol * wet + 0x4000) >> 15);
-        gains[3] = clamp_s16((r_vol * wet + 0x4000) >> 15);
-
-        alist_envmix_mix(n, buffers, gains, in[k^S]);
-    }
+    alist_envmix_ramps(n, buffers, in, 0, count >> 1, ramps, dry, wet,
+            alist_envmix_blocks(n, dmemi, dmem));
 
     *(int16_t *)(save_buffer +  0) = wet;               /* 0-1 */
     *(int16_t *)(save_buffer +  2) = dry;               /* 2-3 */
@@ -456,7 +477,6 @@ void alist_envmix_lin(
         const int32_t *rate,
         uint32_t address)
 {
-    size_t k;
     struct ramp_t ramps[2];
     int16_t save_buffer[40];
 
@@ -465,6 +485,8 @@ void alist_envmix_lin(
     int16_t* const dr = (int16_t*)(hle->alist_buffer + dmem_dr);
     int16_t* const wl = (int16_t*)(hle->alist_buffer + dmem_wl);
     int16_t* const wr = (int16_t*)(hle->alist_buffer + dmem_wr);
+    int16_t* const buffers[4] = { dl, dr, wl, wr };
+    const uint16_t dmem[4] = { dmem_dl, dmem_dr, dmem_wl, dmem_wr };
 
     memcpy((uint8_t *)save_buffer, hle->dram + address, 80);
     if (init) {
@@ -486,25 +508,8 @@ void alist_envmix_lin(
         ramps[1].value  = *(int32_t *)(save_buffer + 18); /* 16-17 */
     }
 
-    count >>= 1;
-    for(k = 0; k < count; ++k) {
-        int16_t  gains[4];
-        int16_t* buffers[4];
-        int16_t l_vol = ramp_step(&ramps[0]);
-        int16_t r_vol = ramp_step(&ramps[1]);
-
-        buffers[0] = dl + (k^S);
-        buffers[1] = dr + (k^S);
-        buffers[2] = wl + (k^S);
-        buffers[3] = wr + (k^S);
-
-        gains[0] = clamp_s16((l_vol * dry + 0x4000) >> 15);
-        gains[1] = clamp_s16((r_vol * dry + 0x4000) >> 15);
-        gains[2] = clamp_s16((l_vol * wet + 0x4000) >> 15);
-        gains[3] = clamp_s16((r_vol * wet + 0x4000) >> 15);
-
-        alist_envmix_mix(4, buffers, gains, in[k^S]);
-    }
+    alist_envmix_ramps(4, buffers, in, 0, count >> 1, ramps, dry, wet,
+            alist_envmix_blocks(4, dmemi, dmem));
 
     *(int16_t *)(save_buffer +  0) = wet;            /* 0-1 */
     *(int16_t *)(save_buffer +  2) = dry;            /* 2-3 */
@@ -543,18 +548,7 @@ void alist_envmix_nead(
         swap(&wl, &wr);
 
     while (count != 0) {
-        size_t i;
-        for(i = 0; i < 8; ++i) {
-            int16_t l  = (((int32_t)in[i^S] * (uint32_t)env_values[0]) >> 16) ^ xors[0];
-            int16_t r  = (((int32_t)in[i^S] * (uint32_t)env_values[1]) >> 16) ^ xors[1];
-            int16_t l2 = (((int32_t)l * (uint32_t)env_values[2]) >> 16) ^ xors[2];
-            int16_t r2 = (((int32_t)r * (uint32_t)env_values[2]) >> 16) ^ xors[3];
-
-            dl[i^S] = clamp_s16(dl[i^S] + l);
-            dr[i^S] = clamp_s16(dr[i^S] + r);
-            wl[i^S] = clamp_s16(wl[i^S] + l2);
-            wr[i^S] = clamp_s16(wr[i^S] + r2);
-        }
+        hle_envmix_nead_block(dl, dr, wl, wr, in, env_values, xors);
 
         env_values[0] += env_steps[0];
         env_values[1] += env_steps[1];
@@ -575,29 +569,14 @@ void alist_mix(struct hle_t* hle, uint16_t dmemo, uint16_t dmemi, uint16_t count
     int16_t       *dst = (int16_t*)(hle->alist_buffer + dmemo);
     const int16_t *src = (int16_t*)(hle->alist_buffer + dmemi);
 
-    count >>= 1;
-
-    while(count != 0) {
-        sample_mix(dst, *src, gain);
-
-        ++dst;
-        ++src;
-        --count;
-    }
+    hle_mix(dst, src, count >> 1, gain);
 }
 
 void alist_multQ44(struct hle_t* hle, uint16_t dmem, uint16_t count, int8_t gain)
 {
     int16_t *dst = (int16_t*)(hle->alist_buffer + dmem);
 
-    count >>= 1;
-
-    while(count != 0) {
-        *dst = clamp_s16(*dst * gain >> 4);
-
-        ++dst;
-        --count;
-    }
+    hle_mult_q44(dst, count >> 1, gain);
 }
 
 void alist_add(struct hle_t* hle, uint16_t dmemo, uint16_t dmemi, uint16_t count)
@@ -605,15 +584,7 @@ void alist_add(struct hle_t* hle, uint16_t dmemo, uint16_t dmemi, uint16_t count
     int16_t       *dst = (int16_t*)(hle->alist_buffer + dmemo);
     const int16_t *src = (int16_t*)(hle->alist_buffer + dmemi);
 
-    count >>= 1;
-
-    while(count != 0) {
-        *dst = clamp_s16(*dst + *src);
-
-        ++dst;
-        ++src;
-        --count;
-    }
+    hle_add(dst, src, count >> 1);
 }
 
 static void alist_resample_reset(struct hle_t* hle, uint16_t pos, uint32_t* pitch_accu)
@@ -671,20 +642,7 @@ void alist_resample(
     else
         alist_resample_load(hle, address, ipos, &pitch_accu);
 
-    while (count != 0) {
-        const int16_t* lut = RESAMPLE_LUT + ((pitch_accu & 0xfc00) >> 8);
-
-        *sample(hle, opos++) = clamp_s16( (
-            (*sample(hle, ipos    ) * lut[0]) +
-            (*sample(hle, ipos + 1) * lut[1]) +
-            (*sample(hle, ipos + 2) * lut[2]) +
-            (*sample(hle, ipos + 3) * lut[3]) ) >> 15);
-
-        pitch_accu += pitch;
-        ipos += (pitch_accu >> 16);
-        pitch_accu &= 0xffff;
-        --count;
-    }
+    hle_resample((int16_t*)hle->alist_buffer, &ipos, opos, count, pitch, &pitch_accu);
 
     alist_resample_save(hle, address, ipos, pitch_accu);
 }
@@ -720,13 +678,12 @@ static unsigned int adpcm_predict_frame_4bits(struct hle_t* hle,
 {
     unsigned int i;
     unsigned int rshift = (scale < 12) ? 12 - scale : 0;
+    uint8_t bytes[8];
 
-    for(i = 0; i < 8; ++i) {
-        uint8_t byte = *alist_u8(hle, dmemi++);
+    for(i = 0; i < 8; ++i)
+        bytes[i] = *alist_u8(hle, dmemi++);
 
-        *(dst++) = adpcm_predict_sample(byte, 0xf0,  8, rshift);
-        *(dst++) = adpcm_predict_sample(byte, 0x0f, 12, rshift);
-    }
+    hle_adpcm_unpack_4bits(dst, bytes, rshift);
 
     return 8;
 }
@@ -736,15 +693,12 @@ static unsigned int adpcm_predict_frame_2bits(struct hle_t* hle,
 {
     unsigned int i;
     unsigned int rshift = (scale < 14) ? 14 - scale : 0;
+    uint8_t bytes[8] = { 0 };
 
-    for(i = 0; i < 4; ++i) {
-        uint8_t byte = *alist_u8(hle, dmemi++);
+    for(i = 0; i < 4; ++i)
+        bytes[i] = *alist_u8(hle, dmemi++);
 
-        *(dst++) = adpcm_predict_sample(byte, 0xc0,  8, rshift);
-        *(dst++) = adpcm_predict_sample(byte, 0x30, 10, rshift);
-        *(dst++) = adpcm_predict_sample(byte, 0x0c, 12, rshift);
-        *(dst++) = adpcm_predict_sample(byte, 0x03, 14, rshift);
-    }
+    hle_adpcm_unpack_2bits(dst, bytes, rshift);
 
     return 4;
 }
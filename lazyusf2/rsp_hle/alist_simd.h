@@ -0,0 +1,458 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus-rsp-hle - alist_simd.h                                    *
+ *   Mupen64Plus homepage: http://code.google.com/p/mupen64plus/           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/*
+ * Sample kernels shared by the audio list commands.
+ *
+ * Every kernel comes in two flavours: a *_ref version which is the plain
+ * per-sample loop and the unsuffixed version which uses SSE2 or wasm
+ * SIMD128 when available. Both must produce bit-identical results;
+ * test/alist_golden.c checks this. Define HLE_NO_SIMD to force the
+ * scalar kernels.
+ */
+
+#ifndef ALIST_SIMD_H
+#define ALIST_SIMD_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "arithmetics.h"
+#include "audio.h"
+#include "memory.h"
+
+#if !defined(HLE_NO_SIMD) && !defined(M64P_BIG_ENDIAN)
+#  if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#    define HLE_SIMD_SSE2
+#    include <emmintrin.h>
+#  elif defined(__wasm_simd128__)
+#    define HLE_SIMD_WASM
+#    include <wasm_simd128.h>
+#  endif
+#endif
+
+#if defined(HLE_SIMD_SSE2) || defined(HLE_SIMD_WASM)
+#  define HLE_SIMD
+#endif
+
+/* scalar reference kernels */
+
+/* dst[i] = clamp(dst[i] + src[i] * gain >> 15) */
+static inline void hle_mix_ref(int16_t* dst, const int16_t* src, size_t n, int16_t gain)
+{
+    size_t i;
+
+    for (i = 0; i < n; ++i)
+        dst[i] = clamp_s16(dst[i] + ((src[i] * gain) >> 15));
+}
+
+/* same as mix_ref, with one gain per sample */
+static inline void hle_mix_gains_ref(int16_t* dst, const int16_t* src, const int16_t* gains, size_t n)
+{
+    size_t i;
+
+    for (i = 0; i < n; ++i)
+        dst[i] = clamp_s16(dst[i] + ((src[i] * gains[i]) >> 15));
+}
+
+static inline void hle_add_ref(int16_t* dst, const int16_t* src, size_t n)
+{
+    size_t i;
+
+    for (i = 0; i < n; ++i)
+        dst[i] = clamp_s16(dst[i] + src[i]);
+}
+
+static inline void hle_mult_q44_ref(int16_t* dst, size_t n, int8_t gain)
+{
+    size_t i;
+
+    for (i = 0; i < n; ++i)
+        dst[i] = clamp_s16(dst[i] * gain >> 4);
+}
+
+/* count is the number of L/R sample pairs to process (2 samples per side each) */
+static inline void hle_interleave_ref(uint16_t* dst, const uint16_t* srcL, const uint16_t* srcR, size_t count)
+{
+    while (count != 0) {
+        uint16_t l1 = *(srcL++);
+        uint16_t l2 = *(srcL++);
+        uint16_t r1 = *(srcR++);
+        uint16_t r2 = *(srcR++);
+
+#if M64P_BIG_ENDIAN
+        *(dst++) = l1;
+        *(dst++) = r1;
+        *(dst++) = l2;
+        *(dst++) = r2;
+#else
+        *(dst++) = r2;
+        *(dst++) = l2;
+        *(dst++) = r1;
+        *(dst++) = l1;
+#endif
+        --count;
+    }
+}
+
+/* one 8 samples block of the nead envelope mixer */
+static inline void hle_envmix_nead_block_ref(int16_t* dl, int16_t* dr, int16_t* wl, int16_t* wr,
+        const int16_t* in, const uint16_t* env_values, const int16_t* xors)
+{
+    size_t i;
+
+    for (i = 0; i < 8; ++i) {
+        int16_t l  = (((int32_t)in[i^S] * (uint32_t)env_values[0]) >> 16) ^ xors[0];
+        int16_t r  = (((int32_t)in[i^S] * (uint32_t)env_values[1]) >> 16) ^ xors[1];
+        int16_t l2 = (((int32_t)l * (uint32_t)env_values[2]) >> 16) ^ xors[2];
+        int16_t r2 = (((int32_t)r * (uint32_t)env_values[2]) >> 16) ^ xors[3];
+
+        dl[i^S] = clamp_s16(dl[i^S] + l);
+        dr[i^S] = clamp_s16(dr[i^S] + r);
+        wl[i^S] = clamp_s16(wl[i^S] + l2);
+        wr[i^S] = clamp_s16(wr[i^S] + r2);
+    }
+}
+
+/* 4 taps resampler over sample positions (pos ^ S) of samples */
+static inline void hle_resample_ref(int16_t* samples, uint16_t* ipos, uint16_t opos, uint16_t count,
+        uint32_t pitch, uint32_t* pitch_accu)
+{
+    uint16_t pos = *ipos;
+    uint32_t accu = *pitch_accu;
+
+    while (count != 0) {
+        const int16_t* lut = RESAMPLE_LUT + ((accu & 0xfc00) >> 8);
+
+        samples[(opos++) ^ S] = clamp_s16( (
+            (samples[(pos    ) ^ S] * lut[0]) +
+            (samples[(pos + 1) ^ S] * lut[1]) +
+            (samples[(pos + 2) ^ S] * lut[2]) +
+            (samples[(pos + 3) ^ S] * lut[3]) ) >> 15);
+
+        accu += pitch;
+        pos += (accu >> 16);
+        accu &= 0xffff;
+        --count;
+    }
+
+    *ipos = pos;
+    *pitch_accu = accu;
+}
+
+/* unpack one 4 bits ADPCM frame (8 bytes) into 16 samples */
+static inline void hle_adpcm_unpack_4bits_ref(int16_t* dst, const uint8_t* bytes, unsigned rshift)
+{
+    size_t i;
+
+    for (i = 0; i < 8; ++i) {
+        *(dst++) = adpcm_predict_sample(bytes[i], 0xf0,  8, rshift);
+        *(dst++) = adpcm_predict_sample(bytes[i], 0x0f, 12, rshift);
+    }
+}
+
+/* unpack one 2 bits ADPCM frame (4 bytes, bytes must hold 8) into 16 samples */
+static inline void hle_adpcm_unpack_2bits_ref(int16_t* dst, const uint8_t* bytes, unsigned rshift)
+{
+    size_t i;
+
+    for (i = 0; i < 4; ++i) {
+        *(dst++) = adpcm_predict_sample(bytes[i], 0xc0,  8, rshift);
+        *(dst++) = adpcm_predict_sample(bytes[i], 0x30, 10, rshift);
+        *(dst++) = adpcm_predict_sample(bytes[i], 0x0c, 12, rshift);
+        *(dst++) = adpcm_predict_sample(bytes[i], 0x03, 14, rshift);
+    }
+}
+
+#ifdef HLE_SIMD
+
+/* vector primitives: 8 lanes of int16 */
+#ifdef HLE_SIMD_SSE2
+typedef __m128i v16_t;
+
+static inline v16_t v16_load(const void* p) { return _mm_loadu_si128((const __m128i*)p); }
+static inline void v16_store(void* p, v16_t x) { _mm_storeu_si128((__m128i*)p, x); }
+static inline v16_t v16_splat(int16_t x) { return _mm_set1_epi16(x); }
+static inline v16_t v16_adds(v16_t a, v16_t b) { return _mm_adds_epi16(a, b); }
+static inline v16_t v16_xor(v16_t a, v16_t b) { return _mm_xor_si128(a, b); }
+
+/* clamp(a + (b * c >> shift)) computed on 32 bits products */
+static inline v16_t v16_mac_shr(v16_t a, v16_t b, v16_t c, int shift)
+{
+    __m128i lo = _mm_mullo_epi16(b, c);
+    __m128i hi = _mm_mulhi_epi16(b, c);
+    __m128i p0 = _mm_srai_epi32(_mm_unpacklo_epi16(lo, hi), shift);
+    __m128i p1 = _mm_srai_epi32(_mm_unpackhi_epi16(lo, hi), shift);
+    __m128i a0 = _mm_srai_epi32(_mm_unpacklo_epi16(a, a), 16);
+    __m128i a1 = _mm_srai_epi32(_mm_unpackhi_epi16(a, a), 16);
+
+    return _mm_packs_epi32(_mm_add_epi32(a0, p0), _mm_add_epi32(a1, p1));
+}
+
+/* high half of signed a times unsigned b */
+static inline v16_t v16_mulhi_su(v16_t a, v16_t b)
+{
+    return _mm_add_epi16(_mm_mulhi_epi16(a, b), _mm_and_si128(a, _mm_srai_epi16(b, 15)));
+}
+#else
+typedef v128_t v16_t;
+
+static inline v16_t v16_load(const void* p) { return wasm_v128_load(p); }
+static inline void v16_store(void* p, v16_t x) { wasm_v128_store(p, x); }
+static inline v16_t v16_splat(int16_t x) { return wasm_i16x8_splat(x); }
+static inline v16_t v16_adds(v16_t a, v16_t b) { return wasm_i16x8_add_sat(a, b); }
+static inline v16_t v16_xor(v16_t a, v16_t b) { return wasm_v128_xor(a, b); }
+
+static inline v16_t v16_mac_shr(v16_t a, v16_t b, v16_t c, int shift)
+{
+    v128_t p0 = wasm_i32x4_shr(wasm_i32x4_extmul_low_i16x8(b, c), shift);
+    v128_t p1 = wasm_i32x4_shr(wasm_i32x4_extmul_high_i16x8(b, c), shift);
+    v128_t a0 = wasm_i32x4_extend_low_i16x8(a);
+    v128_t a1 = wasm_i32x4_extend_high_i16x8(a);
+
+    return wasm_i16x8_narrow_i32x4(wasm_i32x4_add(a0, p0), wasm_i32x4_add(a1, p1));
+}
+
+/* the >> 16 of a 16x16 product always fits on 16 bits, so narrowing is exact */
+static inline v16_t v16_mulhi_su(v16_t a, v16_t b)
+{
+    v128_t p0 = wasm_i32x4_mul(wasm_i32x4_extend_low_i16x8(a), wasm_u32x4_extend_low_u16x8(b));
+    v128_t p1 = wasm_i32x4_mul(wasm_i32x4_extend_high_i16x8(a), wasm_u32x4_extend_high_u16x8(b));
+
+    return wasm_i16x8_narrow_i32x4(wasm_i32x4_shr(p0, 16), wasm_i32x4_shr(p1, 16));
+}
+#endif
+
+/* true if writing dst 8 samples at a time never clobbers src samples not yet read */
+static inline int hle_no_vector_hazard(const int16_t* dst, const int16_t* src)
+{
+    return (dst <= src) || (dst >= src + 8);
+}
+
+static inline void hle_mix(int16_t* dst, const int16_t* src, size_t n, int16_t gain)
+{
+    if (hle_no_vector_hazard(dst, src)) {
+        const v16_t g = v16_splat(gain);
+
+        for (; n >= 8; n -= 8, dst += 8, src += 8)
+            v16_store(dst, v16_mac_shr(v16_load(dst), v16_load(src), g, 15));
+    }
+
+    hle_mix_ref(dst, src, n, gain);
+}
+
+static inline void hle_mix_gains(int16_t* dst, const int16_t* src, const int16_t* gains, size_t n)
+{
+    if (hle_no_vector_hazard(dst, src)) {
+        for (; n >= 8; n -= 8, dst += 8, src += 8, gains += 8)
+            v16_store(dst, v16_mac_shr(v16_load(dst), v16_load(src), v16_load(gains), 15));
+    }
+
+    hle_mix_gains_ref(dst, src, gains, n);
+}
+
+static inline void hle_add(int16_t* dst, const int16_t* src, size_t n)
+{
+    if (hle_no_vector_hazard(dst, src)) {
+        for (; n >= 8; n -= 8, dst += 8, src += 8)
+            v16_store(dst, v16_adds(v16_load(dst), v16_load(src)));
+    }
+
+    hle_add_ref(dst, src, n);
+}
+
+static inline void hle_mult_q44(int16_t* dst, size_t n, int8_t gain)
+{
+    const v16_t zero = v16_splat(0);
+    const v16_t g = v16_splat(gain);
+
+    for (; n >= 8; n -= 8, dst += 8)
+        v16_store(dst, v16_mac_shr(zero, v16_load(dst), g, 4));
+
+    hle_mult_q44_ref(dst, n, gain);
+}
+
+static inline void hle_interleave(uint16_t* dst, const uint16_t* srcL, const uint16_t* srcR, size_t count)
+{
+    const size_t n = count * 2;
+
+    /* outputs are written 16 at a time: only take that route for disjoint buffers */
+    if ((dst + 2 * n <= srcL || dst >= srcL + n) && (dst + 2 * n <= srcR || dst >= srcR + n)) {
+        for (; count >= 4; count -= 4, dst += 16, srcL += 8, srcR += 8) {
+            v16_t l = v16_load(srcL);
+            v16_t r = v16_load(srcR);
+#ifdef HLE_SIMD_SSE2
+            v16_t lo = _mm_shuffle_epi32(_mm_unpacklo_epi16(r, l), _MM_SHUFFLE(2, 3, 0, 1));
+            v16_t hi = _mm_shuffle_epi32(_mm_unpackhi_epi16(r, l), _MM_SHUFFLE(2, 3, 0, 1));
+#else
+            v16_t lo = wasm_i16x8_shuffle(r, l, 1, 9, 0, 8, 3, 11, 2, 10);
+            v16_t hi = wasm_i16x8_shuffle(r, l, 5, 13, 4, 12, 7, 15, 6, 14);
+#endif
+            v16_store(dst, lo);
+            v16_store(dst + 8, hi);
+        }
+    }
+
+    hle_interleave_ref(dst, srcL, srcR, count);
+}
+
+static inline void hle_envmix_nead_block(int16_t* dl, int16_t* dr, int16_t* wl, int16_t* wr,
+        const int16_t* in, const uint16_t* env_values, const int16_t* xors)
+{
+    /* an 8 samples block only matches the per-sample order if the buffers
+     * overlap on whole blocks */
+    if (((dl - in) | (dr - in) | (wl - in) | (wr - in)) & 7) {
+        hle_envmix_nead_block_ref(dl, dr, wl, wr, in, env_values, xors);
+    }
+    else {
+        const v16_t x = v16_load(in);
+        const v16_t l = v16_xor(v16_mulhi_su(x, v16_splat((int16_t)env_values[0])), v16_splat(xors[0]));
+        const v16_t r = v16_xor(v16_mulhi_su(x, v16_splat((int16_t)env_values[1])), v16_splat(xors[1]));
+        const v16_t e2 = v16_splat((int16_t)env_values[2]);
+
+        v16_store(dl, v16_adds(v16_load(dl), l));
+        v16_store(dr, v16_adds(v16_load(dr), r));
+        v16_store(wl, v16_adds(v16_load(wl), v16_xor(v16_mulhi_su(l, e2), v16_splat(xors[2]))));
+        v16_store(wr, v16_adds(v16_load(wr), v16_xor(v16_mulhi_su(r, e2), v16_splat(xors[3]))));
+    }
+}
+
+static inline void hle_resample(int16_t* samples, uint16_t* ipos, uint16_t opos, uint16_t count,
+        uint32_t pitch, uint32_t* pitch_accu)
+{
+    /* inputs of 4 outputs are gathered before the outputs get stored, so the
+     * vector route requires the read and written ranges to be disjoint */
+    const uint64_t last = (uint64_t)*ipos + (((uint64_t)*pitch_accu + (uint64_t)pitch * count) >> 16) + 4;
+    const unsigned ilo = *ipos & ~1u;
+    const unsigned olo = opos & ~1u;
+    const unsigned ohi = (opos + count) | 1u;
+
+    if (last < 0x10000 && opos + count <= 0xffff && (ohi < ilo || olo > (last | 1u))) {
+        uint16_t pos = *ipos;
+        uint32_t accu = *pitch_accu;
+
+        for (; count >= 4; count -= 4, opos += 4) {
+            int16_t in[16];
+            int16_t lut[16];
+            int16_t out[8];
+            size_t j, k;
+
+            for (j = 0; j < 4; ++j) {
+                memcpy(lut + 4 * j, RESAMPLE_LUT + ((accu & 0xfc00) >> 8), 4 * sizeof(int16_t));
+                for (k = 0; k < 4; ++k)
+                    in[4 * j + k] = samples[(pos + k) ^ S];
+
+                accu += pitch;
+                pos += (accu >> 16);
+                accu &= 0xffff;
+            }
+
+#ifdef HLE_SIMD_SSE2
+            {
+                __m128i m0 = _mm_shuffle_epi32(_mm_madd_epi16(v16_load(in), v16_load(lut)), _MM_SHUFFLE(3, 1, 2, 0));
+                __m128i m1 = _mm_shuffle_epi32(_mm_madd_epi16(v16_load(in + 8), v16_load(lut + 8)), _MM_SHUFFLE(3, 1, 2, 0));
+                __m128i sum = _mm_add_epi32(_mm_unpacklo_epi64(m0, m1), _mm_unpackhi_epi64(m0, m1));
+                sum = _mm_srai_epi32(sum, 15);
+                v16_store(out, _mm_packs_epi32(sum, sum));
+            }
+#else
+            {
+                v128_t m0 = wasm_i32x4_dot_i16x8(v16_load(in), v16_load(lut));
+                v128_t m1 = wasm_i32x4_dot_i16x8(v16_load(in + 8), v16_load(lut + 8));
+                v128_t sum = wasm_i32x4_add(wasm_i32x4_shuffle(m0, m1, 0, 2, 4, 6),
+                                            wasm_i32x4_shuffle(m0, m1, 1, 3, 5, 7));
+                sum = wasm_i32x4_shr(sum, 15);
+                v16_store(out, wasm_i16x8_narrow_i32x4(sum, sum));
+            }
+#endif
+            for (j = 0; j < 4; ++j)
+                samples[(uint16_t)(opos + j) ^ S] = out[j];
+        }
+
+        *ipos = pos;
+        *pitch_accu = accu;
+    }
+
+    hle_resample_ref(samples, ipos, opos, count, pitch, pitch_accu);
+}
+
+static inline void hle_adpcm_unpack_4bits(int16_t* dst, const uint8_t* bytes, unsigned rshift)
+{
+#ifdef HLE_SIMD_SSE2
+    const __m128i shift = _mm_cvtsi32_si128(rshift);
+    __m128i b  = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)bytes), _mm_setzero_si128());
+    __m128i hi = _mm_slli_epi16(_mm_and_si128(b, _mm_set1_epi16(0xf0)), 8);
+    __m128i lo = _mm_slli_epi16(b, 12);
+
+    v16_store(dst,     _mm_sra_epi16(_mm_unpacklo_epi16(hi, lo), shift));
+    v16_store(dst + 8, _mm_sra_epi16(_mm_unpackhi_epi16(hi, lo), shift));
+#else
+    v128_t b  = wasm_u16x8_load8x8(bytes);
+    v128_t hi = wasm_i16x8_shl(wasm_v128_and(b, wasm_i16x8_splat(0xf0)), 8);
+    v128_t lo = wasm_i16x8_shl(b, 12);
+
+    v16_store(dst,     wasm_i16x8_shr(wasm_i16x8_shuffle(hi, lo, 0, 8, 1, 9, 2, 10, 3, 11), rshift));
+    v16_store(dst + 8, wasm_i16x8_shr(wasm_i16x8_shuffle(hi, lo, 4, 12, 5, 13, 6, 14, 7, 15), rshift));
+#endif
+}
+
+static inline void hle_adpcm_unpack_2bits(int16_t* dst, const uint8_t* bytes, unsigned rshift)
+{
+#ifdef HLE_SIMD_SSE2
+    const __m128i shift = _mm_cvtsi32_si128(rshift);
+    const __m128i mask  = _mm_set1_epi16((int16_t)0xc000);
+    const __m128i mult  = _mm_setr_epi16(1 << 8, 1 << 10, 1 << 12, 1 << 14, 1 << 8, 1 << 10, 1 << 12, 1 << 14);
+    uint32_t word;
+    __m128i b;
+
+    memcpy(&word, bytes, 4);
+    b = _mm_unpacklo_epi8(_mm_cvtsi32_si128(word), _mm_setzero_si128());
+    b = _mm_unpacklo_epi16(b, b);
+
+    v16_store(dst,     _mm_sra_epi16(_mm_and_si128(_mm_mullo_epi16(_mm_unpacklo_epi32(b, b), mult), mask), shift));
+    v16_store(dst + 8, _mm_sra_epi16(_mm_and_si128(_mm_mullo_epi16(_mm_unpackhi_epi32(b, b), mult), mask), shift));
+#else
+    const v128_t mask = wasm_i16x8_splat((int16_t)0xc000);
+    const v128_t mult = wasm_i16x8_make(1 << 8, 1 << 10, 1 << 12, 1 << 14, 1 << 8, 1 << 10, 1 << 12, 1 << 14);
+    v128_t b = wasm_u16x8_load8x8(bytes);
+    v128_t b0 = wasm_i16x8_shuffle(b, b, 0, 0, 0, 0, 1, 1, 1, 1);
+    v128_t b1 = wasm_i16x8_shuffle(b, b, 2, 2, 2, 2, 3, 3, 3, 3);
+
+    v16_store(dst,     wasm_i16x8_shr(wasm_v128_and(wasm_i16x8_mul(b0, mult), mask), rshift));
+    v16_store(dst + 8, wasm_i16x8_shr(wasm_v128_and(wasm_i16x8_mul(b1, mult), mask), rshift));
+#endif
+}
+
+#else /* HLE_SIMD */
+
+#define hle_mix                 hle_mix_ref
+#define hle_mix_gains           hle_mix_gains_ref
+#define hle_add                 hle_add_ref
+#define hle_mult_q44            hle_mult_q44_ref
+#define hle_interleave          hle_interleave_ref
+#define hle_envmix_nead_block   hle_envmix_nead_block_ref
+#define hle_resample            hle_resample_ref
+#define hle_adpcm_unpack_4bits  hle_adpcm_unpack_4bits_ref
+#define hle_adpcm_unpack_2bits  hle_adpcm_unpack_2bits_ref
+
+#endif /* HLE_SIMD */
+
+#endif
@@ -0,0 +1,387 @@
+/*
+ * Golden output checks for the audio list code (rsp_hle/alist.c and
+ * rsp_hle/alist_simd.h).
+ *
+ * Kernels: every kernel is replayed on a reference copy of DMEM with the
+ * scalar code and on a second copy with the vector code, and both copies
+ * must match bit for bit. The DMEM contents come from the snapshot files
+ * given on the command line (raw 4KB DMEM dumps taken while playing USF
+ * sets), and from a fixed set of pseudo random images when no file is given.
+ *
+ * Audio lists: a fixture (.alst file) holds a DRAM image with a sequence of
+ * audio list tasks in it, with the DMEM and DRAM checksums after each task
+ * as recorded with the scalar per-sample code the vector code replaced.
+ * The tasks are run through the ucode's command table, the way the HLE
+ * runs them while playing, so that the envelope mixer block path and the
+ * commands feeding it are checked on whole command streams. Fixtures start
+ * with "ALST", followed by little endian 32 bit fields:
+ *
+ *   ucode (0: audio, 1: audio_ge, 2: naudio), DRAM image size, task count,
+ *   the DRAM image, then per task: data pointer, data size, the DMEM
+ *   checksum (low, high) and the DRAM image checksum (low, high)
+ *
+ * Checksums are 64 bit FNV-1a. "-r" records the checksums of the given
+ * fixtures with this build instead of checking them.
+ *
+ * usage: alist_golden [-r] [dmem snapshot or fixture...]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../rsp_hle/alist_simd.h"
+#include "../rsp_hle/common.h"
+#include "../rsp_hle/hle_external.h"
+#include "../rsp_hle/hle_internal.h"
+#include "../rsp_hle/memory.h"
+#include "../rsp_hle/ucodes.h"
+
+#define DMEM_SIZE   0x1000
+#define DRAM_SIZE   0x800000
+#define ROUNDS      2000
+
+static uint32_t rng_state = 0x12345678;
+
+static uint32_t rng(void)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+/* sample offset in a 4KB buffer, rounded to the given number of samples */
+static size_t rng_pos(size_t limit, size_t align)
+{
+    return (rng() % limit) & ~(align - 1);
+}
+
+static uint8_t dmem_ref[DMEM_SIZE];
+static uint8_t dmem_vec[DMEM_SIZE];
+
+static unsigned failures = 0;
+
+static void check(const char* kernel, const char* source, unsigned round)
+{
+    if (memcmp(dmem_ref, dmem_vec, DMEM_SIZE) != 0) {
+        fprintf(stderr, "%s: mismatch on %s, round %u\n", kernel, source, round);
+        ++failures;
+    }
+}
+
+static void run_kernels(const uint8_t* image, const char* source)
+{
+    unsigned round;
+
+    for (round = 0; round < ROUNDS; ++round) {
+        int16_t* ref = (int16_t*)dmem_ref;
+        int16_t* vec = (int16_t*)dmem_vec;
+        size_t dst = rng_pos(0x600, 1);
+        size_t src = (rng() & 1) ? dst + rng_pos(0x20, 1) : rng_pos(0x600, 1);
+        size_t n = rng() % 0x100;
+
+        memcpy(dmem_ref, image, DMEM_SIZE);
+        memcpy(dmem_vec, image, DMEM_SIZE);
+
+        switch (round % 8) {
+        case 0: {
+            int16_t gain = (int16_t)rng();
+            hle_mix_ref(ref + dst, ref + src, n, gain);
+            hle_mix(vec + dst, vec + src, n, gain);
+            check("mix", source, round);
+            break;
+        }
+        case 1: {
+            int16_t gains[0x100];
+            size_t i;
+            for (i = 0; i < n; ++i)
+                gains[i] = (int16_t)rng();
+            hle_mix_gains_ref(ref + dst, ref + src, gains, n);
+            hle_mix_gains(vec + dst, vec + src, gains, n);
+            check("mix_gains", source, round);
+            break;
+        }
+        case 2:
+            hle_add_ref(ref + dst, ref + src, n);
+            hle_add(vec + dst, vec + src, n);
+            check("add", source, round);
+            break;
+        case 3: {
+            int8_t gain = (int8_t)rng();
+            hle_mult_q44_ref(ref + dst, n, gain);
+            hle_mult_q44(vec + dst, n, gain);
+            check("mult_q44", source, round);
+            break;
+        }
+        case 4: {
+            size_t left = rng_pos(0x100, 8) + 0x600;
+            size_t right = rng_pos(0x100, 8) + 0x600;
+            size_t out = rng_pos(0x200, 8);
+            size_t count = n / 4;
+            hle_interleave_ref((uint16_t*)ref + out, (uint16_t*)ref + left, (uint16_t*)ref + right, count);
+            hle_interleave((uint16_t*)vec + out, (uint16_t*)vec + left, (uint16_t*)vec + right, count);
+            check("interleave", source, round);
+            break;
+        }
+        case 5: {
+            uint16_t env[2][3];
+            int16_t xors[4];
+            size_t in = rng_pos(0x600, 8);
+            size_t out[4];
+            size_t i, k;
+            for (i = 0; i < 4; ++i) {
+                out[i] = rng_pos(0x600, (rng() & 3) ? 8 : 1);
+                xors[i] = (rng() & 1) ? -1 : 0;
+            }
+            for (i = 0; i < 3; ++i)
+                env[0][i] = env[1][i] = (uint16_t)rng();
+            for (k = 0; k < 4; ++k) {
+                hle_envmix_nead_block_ref(ref + out[0] + 8 * k, ref + out[1] + 8 * k,
+                        ref + out[2] + 8 * k, ref + out[3] + 8 * k, ref + in + 8 * k, env[0], xors);
+                hle_envmix_nead_block(vec + out[0] + 8 * k, vec + out[1] + 8 * k,
+                        vec + out[2] + 8 * k, vec + out[3] + 8 * k, vec + in + 8 * k, env[1], xors);
+            }
+            check("envmix_nead_block", source, round);
+            break;
+        }
+        case 6: {
+            uint16_t ipos[2];
+            uint32_t accu[2];
+            uint32_t pitch = rng() % 0x18000;
+            uint16_t opos = (uint16_t)rng_pos(0x600, 1);
+            ipos[0] = ipos[1] = (uint16_t)((rng() & 1) ? opos : rng_pos(0x300, 1));
+            accu[0] = accu[1] = rng() & 0xffff;
+            hle_resample_ref(ref, &ipos[0], opos, (uint16_t)n, pitch, &accu[0]);
+            hle_resample(vec, &ipos[1], opos, (uint16_t)n, pitch, &accu[1]);
+            check("resample", source, round);
+            if (ipos[0] != ipos[1] || accu[0] != accu[1]) {
+                fprintf(stderr, "resample: state mismatch on %s, round %u\n", source, round);
+                ++failures;
+            }
+            break;
+        }
+        case 7: {
+            uint8_t bytes[8];
+            unsigned rshift = rng() % 15;
+            memcpy(bytes, image + rng_pos(DMEM_SIZE - 8, 1), sizeof(bytes));
+            hle_adpcm_unpack_4bits_ref(ref + dst, bytes, rshift > 12 ? 12 : rshift);
+            hle_adpcm_unpack_4bits(vec + dst, bytes, rshift > 12 ? 12 : rshift);
+            hle_adpcm_unpack_2bits_ref(ref + src, bytes, rshift);
+            hle_adpcm_unpack_2bits(vec + src, bytes, rshift);
+            check("adpcm_unpack", source, round);
+            break;
+        }
+        }
+    }
+}
+
+/* the message callbacks of the HLE, called for unknown commands */
+void HleVerboseMessage(void* UNUSED(user_defined), const char* UNUSED(message), ...)
+{
+}
+
+void HleErrorMessage(void* UNUSED(user_defined), const char* message, ...)
+{
+    fprintf(stderr, "HLE error: %s\n", message);
+}
+
+void HleWarnMessage(void* UNUSED(user_defined), const char* message, ...)
+{
+    fprintf(stderr, "HLE warning: %s\n", message);
+}
+
+static uint64_t fnv1a(const uint8_t* data, size_t size)
+{
+    uint64_t hash = 0xcbf29ce484222325ull;
+    size_t i;
+
+    for (i = 0; i < size; ++i) {
+        hash ^= data[i];
+        hash *= 0x100000001b3ull;
+    }
+
+    return hash;
+}
+
+static uint32_t get_le32(const uint8_t* p)
+{
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void set_le32(uint8_t* p, uint32_t value)
+{
+    p[0] = (uint8_t)value;
+    p[1] = (uint8_t)(value >> 8);
+    p[2] = (uint8_t)(value >> 16);
+    p[3] = (uint8_t)(value >> 24);
+}
+
+static struct hle_t hle;
+static uint8_t fixture_dmem[DMEM_SIZE];
+
+/* Returns 0 if the fixture replays as recorded, 1 if not, -1 on a bad file.
+ * When recording, the checksums in 'data' are replaced. */
+static int run_fixture(uint8_t* data, size_t size, const char* source, int record)
+{
+    static void (* const ucodes[])(struct hle_t*) = {
+        alist_process_audio, alist_process_audio_ge, alist_process_naudio
+    };
+    uint32_t ucode, dram_size, tasks, i;
+    uint8_t* task;
+    int result = 0;
+
+    if (size < 16 || memcmp(data, "ALST", 4) != 0)
+        return -1;
+
+    ucode = get_le32(data + 4);
+    dram_size = get_le32(data + 8);
+    tasks = get_le32(data + 12);
+    if (ucode >= sizeof(ucodes) / sizeof(ucodes[0]) || dram_size > DRAM_SIZE ||
+            size != 16 + (size_t)dram_size + 24 * (size_t)tasks)
+        return -1;
+
+    memset(&hle, 0, sizeof(hle));
+    hle.dram = calloc(1, DRAM_SIZE);
+    hle.dmem = fixture_dmem;
+    if (hle.dram == NULL)
+        return -1;
+    memcpy(hle.dram, data + 16, dram_size);
+
+    task = data + 16 + dram_size;
+    for (i = 0; i < tasks; ++i, task += 24) {
+        uint64_t dmem_hash, dram_hash;
+
+        *dmem_u32(&hle, TASK_DATA_PTR) = get_le32(task);
+        *dmem_u32(&hle, TASK_DATA_SIZE) = get_le32(task + 4);
+        ucodes[ucode](&hle);
+
+        dmem_hash = fnv1a(hle.alist_buffer, sizeof(hle.alist_buffer));
+        dram_hash = fnv1a(hle.dram, dram_size);
+
+        if (record) {
+            set_le32(task + 8, (uint32_t)dmem_hash);
+            set_le32(task + 12, (uint32_t)(dmem_hash >> 32));
+            set_le32(task + 16, (uint32_t)dram_hash);
+            set_le32(task + 20, (uint32_t)(dram_hash >> 32));
+        }
+        else if (dmem_hash != (get_le32(task + 8) | (uint64_t)get_le32(task + 12) << 32) ||
+                dram_hash != (get_le32(task + 16) | (uint64_t)get_le32(task + 20) << 32)) {
+            fprintf(stderr, "audio list: mismatch on %s, task %u\n", source, i);
+            ++failures;
+            result = 1;
+            break;
+        }
+    }
+
+    free(hle.dram);
+    return result;
+}
+
+static uint8_t* read_file(const char* path, size_t* size)
+{
+    FILE* f = fopen(path, "rb");
+    uint8_t* data;
+    long length;
+
+    if (!f)
+        return NULL;
+
+    fseek(f, 0, SEEK_END);
+    length = ftell(f);
+    fseek(f, 0, SEEK_SET);
+
+    data = malloc(length > 0 ? length : 1);
+    if (data == NULL || fread(data, 1, length, f) != (size_t)length) {
+        free(data);
+        fclose(f);
+        return NULL;
+    }
+
+    fclose(f);
+    *size = length;
+    return data;
+}
+
+int main(int argc, char** argv)
+{
+    uint8_t image[DMEM_SIZE];
+    int record = 0;
+    int i;
+
+#ifndef HLE_SIMD
+    printf("alist_golden: no vector kernels in this build, comparing scalar code with itself\n");
+#endif
+
+    if (argc > 1 && strcmp(argv[1], "-r") == 0) {
+        record = 1;
+        --argc;
+        ++argv;
+    }
+
+    if (argc > 1) {
+        for (i = 1; i < argc; ++i) {
+            uint8_t* data;
+            size_t size;
+
+            data = read_file(argv[i], &size);
+            if (data == NULL) {
+                fprintf(stderr, "cannot read %s\n", argv[i]);
+                return 1;
+            }
+
+            if (size == 0) {
+                fprintf(stderr, "%s is empty\n", argv[i]);
+                free(data);
+                return 1;
+            }
+
+            if (size >= 4 && memcmp(data, "ALST", 4) == 0) {
+                FILE* f;
+
+                if (run_fixture(data, size, argv[i], record) < 0) {
+                    fprintf(stderr, "%s is not a valid fixture\n", argv[i]);
+                    free(data);
+                    return 1;
+                }
+
+                if (record) {
+                    f = fopen(argv[i], "wb");
+                    if (!f || fwrite(data, 1, size, f) != size) {
+                        fprintf(stderr, "cannot write %s\n", argv[i]);
+                        return 1;
+                    }
+                    fclose(f);
+                }
+            }
+            else {
+                memset(image, 0, sizeof(image));
+                memcpy(image, data, size < sizeof(image) ? size : sizeof(image));
+                run_kernels(image, argv[i]);
+            }
+
+            free(data);
+        }
+    }
+    else {
+        for (i = 0; i < 8; ++i) {
+            char name[32];
+            size_t k;
+
+            /* mix loud and quiet images to cover both clamping and plain sums */
+            for (k = 0; k < sizeof(image); ++k)
+                image[k] = (i & 1) ? (uint8_t)rng() : (uint8_t)(rng() & 0x0f) | (uint8_t)((rng() & 1) ? 0xf0 : 0);
+
+            sprintf(name, "random image %d", i);
+            run_kernels(image, name);
+        }
+    }
+
+    if (failures != 0) {
+        fprintf(stderr, "alist_golden: %u failures\n", failures);
+        return 1;
+    }
+
+    printf("alist_golden: OK\n");
+    return 0;
+}
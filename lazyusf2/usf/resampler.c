@@ -148,6 +148,45 @@ void resampler_write_sample(void *_r, short ls, short rs)
     }
 }
 
+int resampler_write_samples(void *_r, const short * samples, int count)
+{
+    resampler * r = ( resampler * ) _r;
+    int written = 0;
+
+    if ( r->delay_added < 0 )
+    {
+        r->delay_added = 0;
+        r->write_filled = resampler_input_delay( r );
+    }
+
+    if ( count > resampler_buffer_size - r->write_filled )
+        count = resampler_buffer_size - r->write_filled;
+
+    while ( written < count )
+    {
+        int todo = resampler_buffer_size - r->write_pos;
+        int i;
+        if ( todo > count - written )
+            todo = count - written;
+
+        for ( i = 0; i < todo; ++i )
+        {
+            short ls = samples[ ( written + i ) * 2 + 0 ];
+            short rs = samples[ ( written + i ) * 2 + 1 ];
+            r->buffer_in[ 0 ][ r->write_pos + i ] = ls;
+            r->buffer_in[ 0 ][ r->write_pos + i + resampler_buffer_size ] = ls;
+            r->buffer_in[ 1 ][ r->write_pos + i ] = rs;
+            r->buffer_in[ 1 ][ r->write_pos + i + resampler_buffer_size ] = rs;
+        }
+
+        written += todo;
+        r->write_filled += todo;
+        r->write_pos = ( r->write_pos + todo ) % resampler_buffer_size;
+    }
+
+    return written;
+}
+
 static int resampler_run_cubic(resampler * r, short ** out_, short * out_end)
 {
     int in_size = r->write_filled;
@@ -268,3 +307,35 @@ void resampler_remove_sample(void *_r)
         r->read_pos = ( r->read_pos + 1 ) % resampler_buffer_size;
     }
 }
+
+int resampler_read_samples(void *_r, short * samples, int count)
+{
+    resampler * r = ( resampler * ) _r;
+    int read = 0;
+
+    while ( read < count )
+    {
+        int todo;
+
+        if ( r->read_filled < 1 )
+        {
+            resampler_fill_and_remove_delay( r );
+            if ( r->read_filled < 1 )
+                break;
+        }
+
+        todo = resampler_buffer_size - r->read_pos;
+        if ( todo > r->read_filled )
+            todo = r->read_filled;
+        if ( todo > count - read )
+            todo = count - read;
+
+        memcpy( samples + read * 2, r->buffer_out + r->read_pos * 2, todo * sizeof(short) * 2 );
+
+        read += todo;
+        r->read_filled -= todo;
+        r->read_pos = ( r->read_pos + todo ) % resampler_buffer_size;
+    }
+
+    return read;
+}
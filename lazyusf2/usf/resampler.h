@@ -21,6 +21,8 @@
 #define resampler_get_sample EVALUATE(RESAMPLER_DECORATE,_resampler_get_sample)
 #define resampler_get_sample_float EVALUATE(RESAMPLER_DECORATE,_resampler_get_sample_float)
 #define resampler_remove_sample EVALUATE(RESAMPLER_DECORATE,_resampler_remove_sample)
+#define resampler_write_samples EVALUATE(RESAMPLER_DECORATE,_resampler_write_samples)
+#define resampler_read_samples EVALUATE(RESAMPLER_DECORATE,_resampler_read_samples)
 #endif
 
 void * resampler_create(void);
@@ -37,4 +39,9 @@ int resampler_get_sample_count(void *);
 void resampler_get_sample(void *, short * sample_l, short * sample_r);
 void resampler_remove_sample(void *);
 
+// Block versions of the above, working on interleaved stereo frames.
+// They return the number of frames actually written or read.
+int resampler_write_samples(void *, const short * samples, int count);
+int resampler_read_samples(void *, short * samples, int count);
+
 #endif
@@ -264,19 +264,31 @@ void usf_push_audio_samples(void *opaque, const void * buffer, size_t size)
 
     if (size)
     {
+        size_t writePos = (state->samples_buffer_pos + state->samples_in_buffer) % 8192;
+
         samplesTodo = 8192 - state->samples_in_buffer;
         if (samplesTodo > size)
             samplesTodo = size;
 
-        samplesOut = state->samplebuf + state->samples_in_buffer * 2;
         size -= samplesTodo;
         state->samples_in_buffer += samplesTodo;
 
-        for (i = 0; i < samplesTodo; ++i)
+        while (samplesTodo)
         {
-            *samplesOut++ = samplePtr[1];
-            *samplesOut++ = samplePtr[0];
-            samplePtr += 2;
+            size_t run = 8192 - writePos;
+            if (run > samplesTodo)
+                run = samplesTodo;
+
+            samplesOut = state->samplebuf + writePos * 2;
+            for (i = 0; i < run; ++i)
+            {
+                *samplesOut++ = samplePtr[1];
+                *samplesOut++ = samplePtr[0];
+                samplePtr += 2;
+            }
+
+            samplesTodo -= run;
+            writePos = (writePos + run) % 8192;
         }
 
         state->stop = 1;
@@ -300,22 +312,27 @@ const char * usf_render(void * state, int16_t * buffer, size_t count, int32_t *
     if ( USF_STATE->samples_in_buffer )
     {
         size_t do_max = USF_STATE->samples_in_buffer;
+        size_t pos = USF_STATE->samples_buffer_pos;
         if ( do_max > count )
             do_max = count;
 
         if ( buffer )
-            memcpy( buffer, USF_STATE->samplebuf, sizeof(int16_t) * 2 * do_max );
+        {
+            size_t run = 8192 - pos;
+            if ( run > do_max )
+                run = do_max;
+            memcpy( buffer, USF_STATE->samplebuf + pos * 2, sizeof(int16_t) * 2 * run );
+            memcpy( buffer + run * 2, USF_STATE->samplebuf, sizeof(int16_t) * 2 * (do_max - run) );
+        }
 
         USF_STATE->samples_in_buffer -= do_max;
+        USF_STATE->samples_buffer_pos = (pos + do_max) % 8192;
 
         if ( sample_rate )
             *sample_rate = USF_STATE->SampleRate;
 
         if ( USF_STATE->samples_in_buffer )
-        {
-            memmove( USF_STATE->samplebuf, USF_STATE->samplebuf + do_max * 2, sizeof(int16_t) * 2 * USF_STATE->samples_in_buffer );
             return 0;
-        }
 
         if ( buffer )
             buffer += 2 * do_max;
@@ -347,8 +364,6 @@ const char * usf_render_resampled(void * state, int16_t * buffer, size_t count,
             if (samples_to_remove > count)
                 samples_to_remove = count;
             count -= samples_to_remove;
-            while (samples_to_remove--)
-                resampler_remove_sample(USF_STATE->resampler);
             if (!count)
                 return 0;
         }
@@ -361,7 +376,7 @@ const char * usf_render_resampled(void * state, int16_t * buffer, size_t count,
         else if (count)
         {
             USF_STATE->samples_in_buffer_2 -= count;
-            memmove(USF_STATE->samplebuf2, USF_STATE->samplebuf2 + 8192 - USF_STATE->samples_in_buffer_2 * 2, USF_STATE->samples_in_buffer_2 * sizeof(short) * 2);
+            USF_STATE->samples_buffer_pos_2 += count;
             return 0;
         }
         return usf_render(state, buffer, count, NULL);
@@ -369,32 +384,25 @@ const char * usf_render_resampled(void * state, int16_t * buffer, size_t count,
     while ( count )
     {
         const char * err;
+        int done;
 
-        while ( USF_STATE->samples_in_buffer_2 && resampler_get_free_count(USF_STATE->resampler) )
+        if ( USF_STATE->samples_in_buffer_2 )
         {
-            int i = 0, j = resampler_get_free_count(USF_STATE->resampler);
-            if (j > USF_STATE->samples_in_buffer_2)
-                j = (int)USF_STATE->samples_in_buffer_2;
-            for (i = 0; i < j; ++i)
-            {
-                resampler_write_sample(USF_STATE->resampler, USF_STATE->samplebuf2[i*2], USF_STATE->samplebuf2[i*2+1]);
-            }
-            memmove(USF_STATE->samplebuf2, USF_STATE->samplebuf2 + i * 2, (USF_STATE->samples_in_buffer_2 - i) * sizeof(short) * 2);
-            USF_STATE->samples_in_buffer_2 -= i;
+            done = resampler_write_samples(USF_STATE->resampler,
+                                           USF_STATE->samplebuf2 + USF_STATE->samples_buffer_pos_2 * 2,
+                                           (int)USF_STATE->samples_in_buffer_2);
+            USF_STATE->samples_in_buffer_2 -= done;
+            USF_STATE->samples_buffer_pos_2 += done;
         }
 
-        while ( count && resampler_get_sample_count(USF_STATE->resampler) )
-        {
-            resampler_get_sample(USF_STATE->resampler, buffer, buffer + 1);
-            resampler_remove_sample(USF_STATE->resampler);
-            buffer += 2;
-            --count;
-        }
+        done = resampler_read_samples(USF_STATE->resampler, buffer, (int)(count > 4096 ? 4096 : count));
+        buffer += done * 2;
+        count -= done;
 
         if (!count)
             break;
 
-        if (USF_STATE->samples_in_buffer_2)
+        if (done || USF_STATE->samples_in_buffer_2)
             continue;
 
         err = usf_render(state, USF_STATE->samplebuf2, 4096, 0);
@@ -402,6 +410,7 @@ const char * usf_render_resampled(void * state, int16_t * buffer, size_t count,
             return err;
 
         USF_STATE->samples_in_buffer_2 = 4096;
+        USF_STATE->samples_buffer_pos_2 = 0;
 
         resampler_set_rate(USF_STATE->resampler, (float)USF_STATE->SampleRate / (float)sample_rate);
     }
@@ -427,7 +436,9 @@ void usf_restart(void * state)
     }
 
     USF_STATE->samples_in_buffer = 0;
+    USF_STATE->samples_buffer_pos = 0;
     USF_STATE->samples_in_buffer_2 = 0;
+    USF_STATE->samples_buffer_pos_2 = 0;
 
     resampler_clear(USF_STATE->resampler);
 }
@@ -268,13 +268,20 @@ struct usf_state
     // Audio is rendered in whole Audio Interface DMA transfers, which are
     // then copied directly to the caller's buffer. Any left over samples
     // from the last DMA transfer that fills the caller's buffer will be
-    // stored here until the next call to usf_render()
+    // stored here until the next call to usf_render(). This is a ring of
+    // stereo frames, starting at frame samples_buffer_pos.
     int16_t samplebuf[16384];
     size_t samples_in_buffer;
+    size_t samples_buffer_pos;
     
+    // Staging for usf_render_resampled(): refilled with 4096 frames once
+    // empty, then consumed from frame samples_buffer_pos_2 onward. Since it
+    // is never appended to while frames remain, the cursor never wraps and
+    // this does not need to be a ring like samplebuf.
     void * resampler;
     int16_t samplebuf2[8192];
     size_t samples_in_buffer_2;
+    size_t samples_buffer_pos_2;
     
     // This buffer does not really need to be that large, as it is likely
     // to only accumulate a handlful of error messages, at which point
@@ -225,6 +225,21 @@ extern ADLMIDI_DECLSPEC int adl_getBanksCount();
  */
 extern ADLMIDI_DECLSPEC const char *const *adl_getBankNames();
 
+/**
+ * @brief Sets the compressed embedded banks made by `gen_adldata --blob`
+ *
+ * Only for builds with the ADLMIDI_EMBEDDED_BANKS_BLOB macro defined (the WITH_EMBEDDED_BANKS_BLOB
+ * CMake option): the banks are then not built into the library and only the one set by adl_setBank()
+ * gets decompressed. Call it before adl_init(), or call adl_setBank() again on players made before
+ * it. The data is not copied and must stay valid while the library is in use. The bank names of
+ * adl_getBankNames() are valid until the next call.
+ *
+ * @param mem Pointer to memory block where the compressed bank set is stored
+ * @param size Size of given memory block
+ * @return 0 on success, <0 when the data is invalid or the library doesn't use compressed embedded banks
+ */
+extern ADLMIDI_DECLSPEC int adl_setEmbeddedBanksData(const void *mem, unsigned long size);
+
 /**
  * @brief Reference to dynamic bank
  */
@@ -0,0 +1,251 @@
+/*
+ * libADLMIDI is a free Software MIDI synthesizer library with OPL3 emulation
+ *
+ * Original ADLMIDI code: Copyright (c) 2010-2014 Joel Yliluoma <bisqwit@iki.fi>
+ * ADLMIDI Library API:   Copyright (c) 2015-2020 Vitaly Novichkov <admin@wohlnet.ru>
+ *
+ * Library is based on the ADLMIDI, a MIDI player for Linux and Windows with OPL3 emulation:
+ * http://iki.fi/bisqwit/source/adlmidi.html
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "adlmidi_db.h"
+#include <cstring>
+
+/*
+ * Embedded banks from the compressed bank set made by `gen_adldata --blob`
+ * (see BanksDump::exportBanksBlob() for the format). The blob is kept where
+ * the caller has it, and a bank set is only decompressed when it's selected.
+ */
+
+static const size_t blobHeaderSize = 20;
+static const size_t blobIndexEntrySize = 20;
+
+static const uint8_t *s_blob = NULL;
+static size_t s_blobBanksCount = 0;
+static std::vector<const char *> s_blobNames(1, static_cast<const char *>(NULL));
+
+static inline uint_fast32_t blobU16(const uint8_t *p)
+{
+    return static_cast<uint_fast32_t>(p[0]) | (static_cast<uint_fast32_t>(p[1]) << 8);
+}
+
+static inline uint_fast32_t blobU32(const uint8_t *p)
+{
+    return blobU16(p) | (blobU16(p + 2) << 16);
+}
+
+// Value i of a column of count values, stored low bytes first
+static inline uint_fast32_t blobColumn(const uint8_t *col, size_t count, size_t i, size_t bytes)
+{
+    uint_fast32_t v = 0;
+    for(size_t b = 0; b < bytes; b++)
+        v |= static_cast<uint_fast32_t>(col[(b * count) + i]) << (b * 8);
+    return v;
+}
+
+// Index from how far back it is from the next new one, -1 is none and -2 a broken one
+static long blobFirstUse(uint_fast32_t back, size_t &next, size_t count)
+{
+    if(back == 0xFFFF)
+        return -1;
+    if(back > next)
+        return -2;
+    if(back == 0)
+    {
+        if(next >= count)
+            return -2;
+        return static_cast<long>(next++);
+    }
+    return static_cast<long>(next - back);
+}
+
+static bool blobLength(const uint8_t *&in, const uint8_t *end, size_t &len)
+{
+    uint8_t b;
+    do
+    {
+        if(in >= end)
+            return false;
+        b = *in++;
+        len += b;
+    } while(b == 255);
+    return true;
+}
+
+// LZ77 with LZ4 style sequences, see blobCompress() of gen_adldata
+static bool blobDecompress(const uint8_t *in, size_t inSize, uint8_t *out, size_t outSize)
+{
+    const uint8_t *end = in + inSize;
+    size_t pos = 0;
+
+    while(in < end)
+    {
+        size_t token = *in++;
+        size_t lit = token >> 4;
+        if(lit == 15 && !blobLength(in, end, lit))
+            return false;
+        if(lit > static_cast<size_t>(end - in) || lit > outSize - pos)
+            return false;
+        std::memcpy(out + pos, in, lit);
+        in += lit;
+        pos += lit;
+
+        if(in == end)
+            break;
+
+        if(end - in < 2)
+            return false;
+        size_t offset = blobU16(in);
+        in += 2;
+        size_t len = token & 0x0F;
+        if(len == 15 && !blobLength(in, end, len))
+            return false;
+        len += 4;
+        if(offset == 0 || offset > pos || len > outSize - pos)
+            return false;
+        for(size_t i = 0; i < len; i++, pos++)
+            out[pos] = out[pos - offset];
+    }
+
+    return pos == outSize;
+}
+
+bool adlSetEmbeddedBanksBlob(const void *data, size_t size)
+{
+    const uint8_t *blob = static_cast<const uint8_t *>(data);
+
+    if(!blob || size < blobHeaderSize)
+        return false;
+    if(std::memcmp(blob, "ADLMIDI-BANKSET", 16) != 0 || blobU16(blob + 16) != 1)
+        return false;
+
+    size_t count = blobU16(blob + 18);
+    if(size < blobHeaderSize + (count * blobIndexEntrySize))
+        return false;
+
+    std::vector<const char *> names;
+    for(size_t i = 0; i < count; i++)
+    {
+        const uint8_t *entry = blob + blobHeaderSize + (i * blobIndexEntrySize);
+        size_t title = blobU32(entry + 4);
+        size_t offset = blobU32(entry + 8);
+        size_t packed = blobU32(entry + 12);
+        if(title >= size || !std::memchr(blob + title, 0, size - title))
+            return false;
+        if(offset > size || packed > size - offset)
+            return false;
+        names.push_back(reinterpret_cast<const char *>(blob + title));
+    }
+    names.push_back(NULL);
+
+    s_blob = blob;
+    s_blobBanksCount = count;
+    s_blobNames.swap(names);
+    return true;
+}
+
+size_t adlEmbeddedBanksCount()
+{
+    return s_blobBanksCount;
+}
+
+const char *const *adlEmbeddedBankNames()
+{
+    return &s_blobNames[0];
+}
+
+uint16_t adlEmbeddedBankSetup(size_t bank)
+{
+    if(bank >= s_blobBanksCount)
+        return 0;
+    return static_cast<uint16_t>(blobU16(s_blob + blobHeaderSize + (bank * blobIndexEntrySize)));
+}
+
+bool adlDecodeEmbeddedBank(size_t bank, BanksDump::BankSet &out)
+{
+    if(bank >= s_blobBanksCount)
+        return false;
+
+    const uint8_t *entry = s_blob + blobHeaderSize + (bank * blobIndexEntrySize);
+    size_t rawSize = blobU32(entry + 16);
+    if(rawSize < 8)
+        return false;
+
+    std::vector<uint8_t> raw(rawSize);
+    if(!blobDecompress(s_blob + blobU32(entry + 8), blobU32(entry + 12), &raw[0], rawSize))
+        return false;
+
+    const uint8_t *p = &raw[0];
+    size_t melodic = blobU16(p);
+    size_t midiBanks = melodic + blobU16(p + 2);
+    size_t insts = blobU16(p + 4);
+    size_t ops = blobU16(p + 6);
+    if(rawSize != 8 + (midiBanks * 258) + (insts * 22) + (ops * 5))
+        return false;
+    p += 8;
+
+    out.bankSetup = static_cast<uint16_t>(blobU16(entry));
+    out.banksMelodicCount = static_cast<bank_count_t>(melodic);
+    out.midiBanks.resize(midiBanks);
+    out.instruments.resize(insts);
+    out.operators.resize(ops);
+
+    size_t next = 0;
+    for(size_t m = 0; m < midiBanks; m++, p += 258)
+    {
+        BanksDump::MidiBank &mb = out.midiBanks[m];
+        mb.msb = p[0];
+        mb.lsb = p[1];
+        for(size_t i = 0; i < 128; i++)
+        {
+            long inst = blobFirstUse(blobColumn(p + 2, 128, i, 2), next, insts);
+            if(inst < -1)
+                return false;
+            mb.insts[i] = static_cast<midi_bank_idx_t>(inst);
+        }
+    }
+
+    next = 0;
+    for(size_t i = 0; i < insts; i++)
+    {
+        BanksDump::InstrumentEntry &ie = out.instruments[i];
+        ie.noteOffset1 = static_cast<int16_t>(blobColumn(p, insts, i, 2));
+        ie.noteOffset2 = static_cast<int16_t>(blobColumn(p + (2 * insts), insts, i, 2));
+        ie.midiVelocityOffset = static_cast<int8_t>(p[(4 * insts) + i]);
+        ie.percussionKeyNumber = p[(5 * insts) + i];
+        ie.instFlags = p[(6 * insts) + i];
+        ie.secondVoiceDetune = static_cast<int8_t>(p[(7 * insts) + i]);
+        ie.fbConn = static_cast<uint16_t>(blobColumn(p + (8 * insts), insts, i, 2));
+        ie.delay_on_ms = static_cast<uint16_t>(blobColumn(p + (10 * insts), insts, i, 2));
+        ie.delay_off_ms = static_cast<uint16_t>(blobColumn(p + (12 * insts), insts, i, 2));
+        for(size_t op = 0; op < 4; op++)
+        {
+            long o = blobFirstUse(blobColumn(p + (14 * insts), 4 * insts, (op * insts) + i, 2), next, ops);
+            if(o < -1)
+                return false;
+            ie.ops[op] = static_cast<int16_t>(o);
+        }
+    }
+    p += 22 * insts;
+
+    for(size_t i = 0; i < ops; i++)
+    {
+        out.operators[i].d_E862 = static_cast<uint32_t>(blobColumn(p, ops, i, 4));
+        out.operators[i].d_40 = p[(4 * ops) + i];
+    }
+
+    return true;
+}
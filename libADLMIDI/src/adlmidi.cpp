@@ -194,7 +194,11 @@ ADLMIDI_EXPORT int adl_setBank(ADL_MIDIPlayer *device, int bank)
                          "adl_openBankData() functions instead of adl_setBank().");
     return -1;
 #else
+#   ifdef ADLMIDI_EMBEDDED_BANKS_BLOB
+    const uint32_t NumBanks = static_cast<uint32_t>(adlEmbeddedBanksCount());
+#   else
     const uint32_t NumBanks = static_cast<uint32_t>(g_embeddedBanksCount);
+#   endif
     int32_t bankno = bank;
 
     if(bankno < 0)
@@ -202,6 +206,14 @@ ADLMIDI_EXPORT int adl_setBank(ADL_MIDIPlayer *device, int bank)
 
     MidiPlayer *play = GET_MIDI_PLAYER(device);
     assert(play);
+#   ifdef ADLMIDI_EMBEDDED_BANKS_BLOB
+    if(NumBanks == 0)
+    {
+        play->setErrorString("No embedded banks are loaded. "
+                             "Please set them by using adl_setEmbeddedBanksData() first.");
+        return -1;
+    }
+#   endif
     if(static_cast<uint32_t>(bankno) >= NumBanks)
     {
         char errBuf[150];
@@ -221,19 +233,40 @@ ADLMIDI_EXPORT int adl_setBank(ADL_MIDIPlayer *device, int bank)
 
 ADLMIDI_EXPORT int adl_getBanksCount()
 {
-#ifndef DISABLE_EMBEDDED_BANKS
-    return static_cast<int>(g_embeddedBanksCount);
-#else
+#if defined(DISABLE_EMBEDDED_BANKS)
     return 0;
+#elif defined(ADLMIDI_EMBEDDED_BANKS_BLOB)
+    return static_cast<int>(adlEmbeddedBanksCount());
+#else
+    return static_cast<int>(g_embeddedBanksCount);
 #endif
 }
 
 ADLMIDI_EXPORT const char *const *adl_getBankNames()
 {
-#ifndef DISABLE_EMBEDDED_BANKS
+#if defined(DISABLE_EMBEDDED_BANKS)
+    return NULL;
+#elif defined(ADLMIDI_EMBEDDED_BANKS_BLOB)
+    return adlEmbeddedBankNames();
+#else
     return g_embeddedBankNames;
+#endif
+}
+
+ADLMIDI_EXPORT int adl_setEmbeddedBanksData(const void *mem, unsigned long size)
+{
+#if !defined(DISABLE_EMBEDDED_BANKS) && defined(ADLMIDI_EMBEDDED_BANKS_BLOB)
+    if(!adlSetEmbeddedBanksBlob(mem, static_cast<size_t>(size)))
+    {
+        ADLMIDI_ErrorString = "Invalid or unsupported embedded bank set data";
+        return -1;
+    }
+    return 0;
 #else
-    return NULL;
+    ADL_UNUSED(mem);
+    ADL_UNUSED(size);
+    ADLMIDI_ErrorString = "This build of libADLMIDI has its embedded banks built in or has none.";
+    return -1;
 #endif
 }
 
@@ -392,6 +425,29 @@ ADLMIDI_EXPORT int adl_loadEmbeddedBank(struct ADL_MIDIPlayer *device, ADL_Bank
                          "Please load banks by using adl_openBankFile() or "
                          "adl_openBankData() functions instead of adl_loadEmbeddedBank().");
     return -1;
+#elif defined(ADLMIDI_EMBEDDED_BANKS_BLOB)
+    BanksDump::BankSet bankSet;
+    if(num < 0 || !adlDecodeEmbeddedBank(static_cast<size_t>(num), bankSet))
+        return -1;
+
+    Synth::BankMap::iterator it = Synth::BankMap::iterator::from_ptrs(bank->pointer);
+    size_t id = it->first;
+
+    bool ss = (id & Synth::PercussionTag);
+    size_t midiBank = ss ? bankSet.banksMelodicCount : 0;
+    if(midiBank >= bankSet.midiBanks.size())
+        return -1;
+    const BanksDump::MidiBank &bankData = bankSet.midiBanks[midiBank];
+    const BanksDump::Operator *operators = bankSet.operators.empty() ? NULL : &bankSet.operators[0];
+
+    for (unsigned i = 0; i < 128; ++i)
+    {
+        midi_bank_idx_t instIdx = bankData.insts[i];
+        if(instIdx < 0)
+            continue;
+        adlFromInstrument(bankSet.instruments[instIdx], it->second.ins[i], operators);
+    }
+    return 0;
 #else
     if(num < 0 || num >= static_cast<int>(g_embeddedBanksCount))
         return -1;
@@ -415,7 +471,7 @@ ADLMIDI_EXPORT int adl_loadEmbeddedBank(struct ADL_MIDIPlayer *device, ADL_Bank
         if(instIdx < 0)
             continue;
         BanksDump::InstrumentEntry instIn = g_embeddedBanksInstruments[instIdx];
-        adlFromInstrument(instIn, it->second.ins[i]);
+        adlFromInstrument(instIn, it->second.ins[i], g_embeddedBanksOperators);
     }
     return 0;
 #endif
@@ -1104,6 +1160,29 @@ static void CopySamplesTransformed(ADL_UInt8 *dstLeft, ADL_UInt8 *dstRight, cons
     }
 }
 
+/*
+    Interleaved 16-bit and float output is what most players request, so it
+    is converted in plain loops over contiguous samples which the compiler
+    can vectorize. The results are the same as of adl_cvtS16 and adl_cvtReal.
+*/
+static void CopySamplesInterleavedS16(int16_t *dst, const int32_t *src, size_t sampleCount)
+{
+    for(size_t i = 0; i < sampleCount; ++i)
+    {
+        int32_t x = src[i];
+        x = (x < INT16_MIN) ? INT16_MIN : x;
+        x = (x > INT16_MAX) ? INT16_MAX : x;
+        dst[i] = static_cast<int16_t>(x);
+    }
+}
+
+static void CopySamplesInterleavedF32(float *dst, const int32_t *src, size_t sampleCount)
+{
+    const float scale = 1.0f / static_cast<float>(INT16_MAX);
+    for(size_t i = 0; i < sampleCount; ++i)
+        dst[i] = static_cast<float>(src[i]) * scale;
+}
+
 static int SendStereoAudio(int        samples_requested,
                            ssize_t    in_size,
                            int32_t   *_in,
@@ -1126,6 +1205,18 @@ static int SendStereoAudio(int        samples_requested,
     left  += (outputOffset / 2) * sampleOffset;
     right += (outputOffset / 2) * sampleOffset;
 
+    const bool interleaved = (sampleOffset == 2 * containerSize) && (right == left + containerSize);
+    if(interleaved && sampleType == ADLMIDI_SampleType_S16 && containerSize == sizeof(int16_t))
+    {
+        CopySamplesInterleavedS16(reinterpret_cast<int16_t *>(left), _in, toCopy);
+        return 0;
+    }
+    if(interleaved && sampleType == ADLMIDI_SampleType_F32 && containerSize == sizeof(float))
+    {
+        CopySamplesInterleavedF32(reinterpret_cast<float *>(left), _in, toCopy);
+        return 0;
+    }
+
     typedef int32_t(&pfnConvert)(int32_t);
     typedef float(&ffnConvert)(int32_t);
     typedef double(&dfnConvert)(int32_t);
@@ -1340,19 +1431,14 @@ ADLMIDI_EXPORT int adl_playFormat(ADL_MIDIPlayer *device, int sampleCount,
                 //! Total count of samples
                 ssize_t in_generatedPhys = in_generatedStereo * 2;
                 //! Unsigned total sample count
-                //fill buffer with zeros
                 int32_t *out_buf = player->m_outBuf;
-                std::memset(out_buf, 0, static_cast<size_t>(in_generatedPhys) * sizeof(out_buf[0]));
                 Synth &synth = *player->m_synth;
                 unsigned int chips = synth.m_numChips;
-                if(chips == 1)
+                if(in_generatedStereo > 0)
                 {
+                    /* The first chip fills the buffer, every other one mixes into it */
                     synth.m_chips[0]->generate32(out_buf, (size_t)in_generatedStereo);
-                }
-                else if(n_periodCountStereo > 0)
-                {
-                    /* Generate data from every chip and mix result */
-                    for(size_t card = 0; card < chips; ++card)
+                    for(size_t card = 1; card < chips; ++card)
                         synth.m_chips[card]->generateAndMix32(out_buf, (size_t)in_generatedStereo);
                 }
 
@@ -1431,17 +1517,14 @@ ADLMIDI_EXPORT int adl_generateFormat(struct ADL_MIDIPlayer *device, int sampleC
                 //! Total count of samples
                 ssize_t in_generatedPhys = in_generatedStereo * 2;
                 //! Unsigned total sample count
-                //fill buffer with zeros
                 int32_t *out_buf = player->m_outBuf;
-                std::memset(out_buf, 0, static_cast<size_t>(in_generatedPhys) * sizeof(out_buf[0]));
                 Synth &synth = *player->m_synth;
                 unsigned int chips = synth.m_numChips;
-                if(chips == 1)
-                    synth.m_chips[0]->generate32(out_buf, (size_t)in_generatedStereo);
-                else if(n_periodCountStereo > 0)
+                if(in_generatedStereo > 0)
                 {
-                    /* Generate data from every chip and mix result */
-                    for(unsigned card = 0; card < chips; ++card)
+                    /* The first chip fills the buffer, every other one mixes into it */
+                    synth.m_chips[0]->generate32(out_buf, (size_t)in_generatedStereo);
+                    for(unsigned card = 1; card < chips; ++card)
                         synth.m_chips[card]->generateAndMix32(out_buf, (size_t)in_generatedStereo);
                 }
                 /* Process it */
@@ -40,7 +40,7 @@
 typedef uint16_t bank_count_t;
 typedef int16_t midi_bank_idx_t;
 
-#ifndef DISABLE_EMBEDDED_BANKS
+#if !defined(DISABLE_EMBEDDED_BANKS) && !defined(ADLMIDI_EMBEDDED_BANKS_BLOB)
 extern const size_t g_embeddedBanksCount;
 #endif
 
@@ -86,7 +86,7 @@ struct Operator
 
 } /* namespace BanksDump */
 
-#ifndef DISABLE_EMBEDDED_BANKS
+#if !defined(DISABLE_EMBEDDED_BANKS) && !defined(ADLMIDI_EMBEDDED_BANKS_BLOB)
 extern const char* const g_embeddedBankNames[];
 extern const BanksDump::BankEntry g_embeddedBanks[];
 extern const size_t g_embeddedBanksMidiIndex[];
@@ -95,4 +95,29 @@ extern const BanksDump::InstrumentEntry g_embeddedBanksInstruments[];
 extern const BanksDump::Operator g_embeddedBanksOperators[];
 #endif
 
+#if !defined(DISABLE_EMBEDDED_BANKS) && defined(ADLMIDI_EMBEDDED_BANKS_BLOB)
+namespace BanksDump
+{
+
+/* One bank set of the compressed bank set blob, decoded on demand */
+struct BankSet
+{
+    uint16_t bankSetup;
+    bank_count_t banksMelodicCount;
+    /* Melodic MIDI banks go first, percussion ones after them */
+    std::vector<MidiBank> midiBanks;
+    std::vector<InstrumentEntry> instruments;
+    std::vector<Operator> operators;
+};
+
+} /* namespace BanksDump */
+
+/* Instead of the tables above, the embedded banks come from the blob made by `gen_adldata --blob` */
+extern bool adlSetEmbeddedBanksBlob(const void *data, size_t size);
+extern size_t adlEmbeddedBanksCount();
+extern const char *const *adlEmbeddedBankNames();
+extern uint16_t adlEmbeddedBankSetup(size_t bank);
+extern bool adlDecodeEmbeddedBank(size_t bank, BanksDump::BankSet &out);
+#endif
+
 #endif // ADLDATA_DB_H
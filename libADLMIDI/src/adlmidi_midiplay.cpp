@@ -105,6 +105,7 @@ MIDIplay::MIDIplay(unsigned long sampleRate):
     //m_setup.SkipForward = 0;
     m_setup.scaleModulators     = -1;
     m_setup.fullRangeBrightnessCC74 = false;
+    m_setup.fullChannelScoring = false;
     m_setup.delay = 0.0;
     m_setup.carry = 0.0;
     m_setup.tick_skip_samples_delay = 0;
@@ -137,10 +138,14 @@ void MIDIplay::applySetup()
 #ifndef DISABLE_EMBEDDED_BANKS
     if(synth.m_embeddedBank != Synth::CustomBankTag)
     {
-        const BanksDump::BankEntry &b = g_embeddedBanks[m_setup.bankId];
-        synth.m_insBankSetup.volumeModel = (b.bankSetup & 0x00FF);
-        synth.m_insBankSetup.deepTremolo = (b.bankSetup >> 8 & 0x0001) != 0;
-        synth.m_insBankSetup.deepVibrato = (b.bankSetup >> 8 & 0x0002) != 0;
+#   ifdef ADLMIDI_EMBEDDED_BANKS_BLOB
+        uint16_t bankSetup = adlEmbeddedBankSetup(m_setup.bankId);
+#   else
+        uint16_t bankSetup = g_embeddedBanks[m_setup.bankId].bankSetup;
+#   endif
+        synth.m_insBankSetup.volumeModel = (bankSetup & 0x00FF);
+        synth.m_insBankSetup.deepTremolo = (bankSetup >> 8 & 0x0001) != 0;
+        synth.m_insBankSetup.deepVibrato = (bankSetup >> 8 & 0x0002) != 0;
     }
 #endif
 
@@ -496,6 +501,39 @@ bool MIDIplay::realTime_NoteOn(uint8_t channel, uint8_t note, uint8_t velocity)
     // Allocate AdLib channel (the physical sound channel for the note)
     int32_t adlchannel[MIDIchannel::NoteInfo::MaxNumPhysChans] = { -1, -1 };
 
+    // Only use four-op master channels, or regular ones for two-op voices
+    uint32_t expected_mode = Synth::ChanCat_4op_Master;
+    if(is_2op || pseudo_4op)
+    {
+        expected_mode = OPL3::ChanCat_Regular;
+
+        if(synth.m_rhythmMode)
+        {
+            if(m_cmfPercussionMode)
+            {
+                expected_mode = channel  < 11 ? OPL3::ChanCat_Regular : (OPL3::ChanCat_Rhythm_Bass + (channel  - 11)); // CMF
+            }
+            else
+            {
+                uint32_t rm = (ains->flags & adlinsdata::Mask_RhythmMode);
+                if(rm == adlinsdata::Flag_RM_BassDrum)
+                    expected_mode = OPL3::ChanCat_Rhythm_Bass;
+                else if(rm == adlinsdata::Flag_RM_Snare)
+                    expected_mode = OPL3::ChanCat_Rhythm_Snare;
+                else if(rm == adlinsdata::Flag_RM_TomTom)
+                    expected_mode = OPL3::ChanCat_Rhythm_Tom;
+                else if(rm == adlinsdata::Flag_RM_Cymbal)
+                    expected_mode = OPL3::ChanCat_Rhythm_Cymbal;
+                else if(rm == adlinsdata::Flag_RM_HiHat)
+                    expected_mode = OPL3::ChanCat_Rhythm_HiHat;
+            }
+        }
+    }
+
+    const std::vector<uint32_t> noChannels;
+    const std::vector<uint32_t> &candidates = (expected_mode <= OPL3::ChanCat_Rhythm_Slave) ?
+                                              synth.m_categoryChannels[expected_mode] : noChannels;
+
     for(uint32_t ccount = 0; ccount < MIDIchannel::NoteInfo::MaxNumPhysChans; ++ccount)
     {
         if(ccount == 1)
@@ -507,66 +545,18 @@ bool MIDIplay::realTime_NoteOn(uint8_t channel, uint8_t note, uint8_t velocity)
         }
 
         int32_t c = -1;
-        int32_t bs = -0x7FFFFFFFl;
 
-        for(size_t a = 0; a < (size_t)synth.m_numChannels; ++a)
+        if(ccount == 1 && !is_2op && !pseudo_4op)
         {
-            if(ccount == 1 && static_cast<int32_t>(a) == adlchannel[0]) continue;
-            // ^ Don't use the same channel for primary&secondary
-
-            if(is_2op || pseudo_4op)
-            {
-                // Only use regular channels
-                uint32_t expected_mode = 0;
-
-                if(synth.m_rhythmMode)
-                {
-                    if(m_cmfPercussionMode)
-                    {
-                        expected_mode = channel  < 11 ? OPL3::ChanCat_Regular : (OPL3::ChanCat_Rhythm_Bass + (channel  - 11)); // CMF
-                    }
-                    else
-                    {
-                        expected_mode = OPL3::ChanCat_Regular;
-                        uint32_t rm = (ains->flags & adlinsdata::Mask_RhythmMode);
-                        if(rm == adlinsdata::Flag_RM_BassDrum)
-                            expected_mode = OPL3::ChanCat_Rhythm_Bass;
-                        else if(rm == adlinsdata::Flag_RM_Snare)
-                            expected_mode = OPL3::ChanCat_Rhythm_Snare;
-                        else if(rm == adlinsdata::Flag_RM_TomTom)
-                            expected_mode = OPL3::ChanCat_Rhythm_Tom;
-                        else if(rm == adlinsdata::Flag_RM_Cymbal)
-                            expected_mode = OPL3::ChanCat_Rhythm_Cymbal;
-                        else if(rm == adlinsdata::Flag_RM_HiHat)
-                            expected_mode = OPL3::ChanCat_Rhythm_HiHat;
-                    }
-                }
-
-                if(synth.m_channelCategory[a] != expected_mode)
-                    continue;
-            }
-            else
-            {
-                if(ccount == 0)
-                {
-                    // Only use four-op master channels
-                    if(synth.m_channelCategory[a] != Synth::ChanCat_4op_Master)
-                        continue;
-                }
-                else
-                {
-                    // The secondary must be played on a specific channel.
-                    if(a != static_cast<uint32_t>(adlchannel[0]) + 3)
-                        continue;
-                }
-            }
-
-            int64_t s = calculateChipChannelGoodness(a, voices[ccount]);
-            if(s > bs)
-            {
-                bs = (int32_t)s;    // Best candidate wins
+            // The secondary must be played on a specific channel.
+            size_t a = static_cast<size_t>(adlchannel[0]) + 3;
+            if(calculateChipChannelGoodness(a, voices[ccount]) > -0x7FFFFFFFl)
                 c = static_cast<int32_t>(a);
-            }
+        }
+        else
+        {
+            // Don't use the same channel for primary&secondary
+            c = chooseChipChannel(candidates, ccount == 1 ? adlchannel[0] : -1, voices[ccount]);
         }
 
         if(c < 0)
@@ -1440,6 +1430,81 @@ int64_t MIDIplay::calculateChipChannelGoodness(size_t c, const MIDIchannel::Note
 }
 
 
+int64_t MIDIplay::calculateChipChannelGoodnessLimit(size_t c, size_t categoryUsers) const
+{
+    const AdlChannel &chan = m_chipChannels[c];
+    int64_t s = -(chan.koff_time_until_neglible_us / 1000);
+    int64_t others = static_cast<int64_t>(categoryUsers - chan.users.size());
+
+    // Every user gets all bonuses, and every other user of the category counts as an evacuation station
+    for(AdlChannel::const_users_iterator j = chan.users.begin(); !j.is_end(); ++j)
+    {
+        const AdlChannel::LocationData &jd = j->value;
+        int64_t kon_ms = jd.kon_time_until_neglible_us / 1000;
+        s -= (jd.sustained == AdlChannel::LocationData::Sustain_None) ?
+            (4000000 + kon_ms) : (500000 + (kon_ms / 2));
+        s += 300 + 10 + 50 + (others * 4);
+    }
+
+    return s;
+}
+
+int32_t MIDIplay::chooseChipChannel(const std::vector<uint32_t> &candidates, int32_t exclude,
+                                    const MIDIchannel::NoteInfo::Phys &ins) const
+{
+    int32_t c = -1;
+    int64_t bs = -0x7FFFFFFFl;
+
+    if(m_setup.fullChannelScoring)
+    {
+        for(size_t i = 0; i < candidates.size(); ++i)
+        {
+            size_t a = candidates[i];
+            if(static_cast<int32_t>(a) == exclude) continue;
+            int64_t s = calculateChipChannelGoodness(a, ins);
+            if(s > bs)
+            {
+                bs = s;    // Best candidate wins
+                c = static_cast<int32_t>(a);
+            }
+        }
+        return c;
+    }
+
+    // Free and releasing channels are cheap to rate, go through them first
+    size_t categoryUsers = 0;
+    for(size_t i = 0; i < candidates.size(); ++i)
+    {
+        size_t a = candidates[i];
+        const AdlChannel &chan = m_chipChannels[a];
+        categoryUsers += chan.users.size();
+        if(!chan.users.empty() || static_cast<int32_t>(a) == exclude) continue;
+        int64_t s = calculateChipChannelGoodness(a, ins);
+        if(s > bs)
+        {
+            bs = s;
+            c = static_cast<int32_t>(a);
+        }
+    }
+
+    // Only rate busy channels which may beat the best one so far.
+    // On a tie, the lowest channel wins, like when rating them all in order.
+    for(size_t i = 0; i < candidates.size(); ++i)
+    {
+        size_t a = candidates[i];
+        if(m_chipChannels[a].users.empty() || static_cast<int32_t>(a) == exclude) continue;
+        if(calculateChipChannelGoodnessLimit(a, categoryUsers) < bs) continue;
+        int64_t s = calculateChipChannelGoodness(a, ins);
+        if(s > bs || (s == bs && c >= 0 && static_cast<int32_t>(a) < c))
+        {
+            bs = s;
+            c = static_cast<int32_t>(a);
+        }
+    }
+
+    return c;
+}
+
 void MIDIplay::prepareChipChannelForNewNote(size_t c, const MIDIchannel::NoteInfo::Phys &ins)
 {
     if(m_chipChannels[c].users.empty()) return; // Nothing to do
@@ -526,6 +526,8 @@ public:
         //unsigned int SkipForward;
         int     scaleModulators;
         bool    fullRangeBrightnessCC74;
+        //! Rate every candidate chip channel on note on, as a reference for the channel choices
+        bool    fullChannelScoring;
 
         double delay;
         double carry;
@@ -926,6 +928,24 @@ private:
      */
     int64_t calculateChipChannelGoodness(size_t c, const MIDIchannel::NoteInfo::Phys &ins) const;
 
+    /**
+     * @brief The highest goodness points calculateChipChannelGoodness() may give to a channel with users
+     * @param c Wanted chip channel
+     * @param categoryUsers Count of users of all chip channels in the category of this channel
+     * @return Goodness points limit
+     */
+    int64_t calculateChipChannelGoodnessLimit(size_t c, size_t categoryUsers) const;
+
+    /**
+     * @brief Choose the chip channel with the best goodness for a note, the lowest one on a tie
+     * @param candidates Chip channels of one category in ascending order
+     * @param exclude Chip channel to skip, or -1
+     * @param ins Instrument wanted to be used in the channel
+     * @return Chosen chip channel, or -1 when there is none
+     */
+    int32_t chooseChipChannel(const std::vector<uint32_t> &candidates, int32_t exclude,
+                              const MIDIchannel::NoteInfo::Phys &ins) const;
+
     /**
      * @brief A new note will be played on this channel using this instrument.
      * @param c Wanted chip channel
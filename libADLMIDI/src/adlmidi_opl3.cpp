@@ -328,6 +328,35 @@ void OPL3::setEmbeddedBank(uint32_t bank)
     //Embedded banks are supports 128:128 GM set only
     m_insBanks.clear();
 
+#   ifdef ADLMIDI_EMBEDDED_BANKS_BLOB
+    // Only the selected bank set gets decompressed
+    BanksDump::BankSet bankSet;
+    if(!adlDecodeEmbeddedBank(bank, bankSet))
+        return;
+
+    m_insBankSetup.deepTremolo = ((bankSet.bankSetup >> 8) & 0x01) != 0;
+    m_insBankSetup.deepVibrato = ((bankSet.bankSetup >> 8) & 0x02) != 0;
+    m_insBankSetup.volumeModel = (bankSet.bankSetup & 0xFF);
+    m_insBankSetup.scaleModulators = false;
+
+    const BanksDump::Operator *operators = bankSet.operators.empty() ? NULL : &bankSet.operators[0];
+    for(size_t midiBank = 0; midiBank < bankSet.midiBanks.size(); midiBank++)
+    {
+        bool ss = (midiBank >= bankSet.banksMelodicCount);
+        const BanksDump::MidiBank &bankData = bankSet.midiBanks[midiBank];
+        size_t bankMidiIndex = static_cast<size_t>((bankData.msb * 256) + bankData.lsb) + (ss ? static_cast<size_t>(PercussionTag) : 0);
+        Bank &bankTarget = m_insBanks[bankMidiIndex];
+
+        for(size_t instId = 0; instId < 128; instId++)
+        {
+            midi_bank_idx_t instIndex = bankData.insts[instId];
+            if(instIndex < 0)
+                continue;
+            adlFromInstrument(bankSet.instruments[instIndex], bankTarget.ins[instId], operators);
+        }
+    }
+
+#   else
     if(bank >= static_cast<uint32_t>(g_embeddedBanksCount))
         return;
 
@@ -357,10 +386,11 @@ void OPL3::setEmbeddedBank(uint32_t bank)
                 BanksDump::InstrumentEntry instIn = g_embeddedBanksInstruments[instIndex];
                 adlinsdata2 &instOut = bankTarget.ins[instId];
 
-                adlFromInstrument(instIn, instOut);
+                adlFromInstrument(instIn, instOut, g_embeddedBanksOperators);
             }
         }
     }
+#   endif
 
 #else
     ADL_UNUSED(bank);
@@ -931,6 +961,11 @@ void OPL3::updateChannelCategories()
         }
     }
 
+    for(size_t cat = 0; cat <= ChanCat_Rhythm_Slave; ++cat)
+        m_categoryChannels[cat].clear();
+    for(uint32_t c = 0; c < m_numChannels; ++c)
+        m_categoryChannels[m_channelCategory[c]].push_back(c);
+
 /**/
 /*
     In two-op mode, channels 0..8 go as follows:
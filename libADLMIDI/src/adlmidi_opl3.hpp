@@ -198,6 +198,8 @@ public:
         8 = percussion slave
     */
     std::vector<uint32_t> m_channelCategory;
+    //! Chip channels of every category in ascending order, for the channel allocation
+    std::vector<uint32_t> m_categoryChannels[ChanCat_Rhythm_Slave + 1];
 
 
     /**
@@ -122,7 +122,8 @@ int adlCalculateFourOpChannels(MIDIplay *play, bool silent)
 }
 
 #ifndef DISABLE_EMBEDDED_BANKS
-void adlFromInstrument(const BanksDump::InstrumentEntry &instIn, adlinsdata2 &instOut)
+void adlFromInstrument(const BanksDump::InstrumentEntry &instIn, adlinsdata2 &instOut,
+                       const BanksDump::Operator *operators)
 {
     instOut.voice2_fine_tune = 0.0;
     if(instIn.secondVoiceDetune != 0)
@@ -139,8 +140,8 @@ void adlFromInstrument(const BanksDump::InstrumentEntry &instIn, adlinsdata2 &in
     {
         if((instIn.ops[(op * 2) + 0] < 0) || (instIn.ops[(op * 2) + 1] < 0))
             break;
-        const BanksDump::Operator &op1 = g_embeddedBanksOperators[instIn.ops[(op * 2) + 0]];
-        const BanksDump::Operator &op2 = g_embeddedBanksOperators[instIn.ops[(op * 2) + 1]];
+        const BanksDump::Operator &op1 = operators[instIn.ops[(op * 2) + 0]];
+        const BanksDump::Operator &op2 = operators[instIn.ops[(op * 2) + 1]];
         instOut.adl[op].modulator_E862 = op1.d_E862;
         instOut.adl[op].modulator_40   = op1.d_40;
         instOut.adl[op].carrier_E862 = op2.d_E862;
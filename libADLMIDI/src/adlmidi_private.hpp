@@ -228,7 +228,8 @@ extern void adl_audioTickHandler(void *instance, uint32_t chipId, uint32_t rate)
 extern int adlCalculateFourOpChannels(MIDIplay *play, bool silent = false);
 
 #ifndef DISABLE_EMBEDDED_BANKS
-extern void adlFromInstrument(const BanksDump::InstrumentEntry &instIn, adlinsdata2 &instOut);
+extern void adlFromInstrument(const BanksDump::InstrumentEntry &instIn, adlinsdata2 &instOut,
+                              const BanksDump::Operator *operators);
 #endif
 
 #endif // ADLMIDI_PRIVATE_HPP
@@ -0,0 +1,70 @@
+#include <catch.hpp>
+#include <vector>
+#include "adlmidi.h"
+#include "adlmidi_midiplay.hpp"
+
+static const char *test_files[] = {
+    "projects/watcom/bass.mid",
+    "projects/watcom/nin-hlah.mid",
+    "projects/watcom/onestop.mid",
+    "projects/watcom/ttd10.mid"
+};
+
+struct NoteEvent
+{
+    int adlchn, note, ins, pressure;
+
+    bool operator==(const NoteEvent &o) const
+    {
+        return adlchn == o.adlchn && note == o.note && ins == o.ins && pressure == o.pressure;
+    }
+};
+
+static void noteHook(void *userdata, int adlchn, int note, int ins, int pressure, double)
+{
+    NoteEvent e = {adlchn, note, ins, pressure};
+    static_cast<std::vector<NoteEvent> *>(userdata)->push_back(e);
+}
+
+static std::vector<NoteEvent> playFile(const char *path, int bank, int chips, bool fullScoring)
+{
+    std::vector<NoteEvent> events;
+
+    ADL_MIDIPlayer *device = adl_init(44100);
+    REQUIRE(device);
+    REQUIRE(adl_setNumChips(device, chips) == 0);
+    REQUIRE(adl_setBank(device, bank) == 0);
+    reinterpret_cast<MIDIplay *>(device->adl_midiPlayer)->m_setup.fullChannelScoring = fullScoring;
+    adl_setLoopEnabled(device, 0);
+    adl_setNoteHook(device, noteHook, &events);
+    REQUIRE(adl_openFile(device, path) == 0);
+
+    double delay = 0.0;
+    while(!adl_atEnd(device))
+        delay = adl_tickEvents(device, delay < 0.001 ? 0.001 : delay, 0.001);
+
+    adl_close(device);
+    return events;
+}
+
+TEST_CASE("[ChannelAlloc] Same chip channels as rating all of them")
+{
+    // AIL, Bisqwit's 4op and 2op, HMI, DMX, 4op Fat Man and WOPL 4op banks
+    const int banks[] = {0, 1, 2, 14, 59, 68};
+    const int chips[] = {1, 2, 4};
+
+    for(const char *test_file : test_files)
+    {
+        for(int bank : banks)
+        {
+            for(int numChips : chips)
+            {
+                std::vector<NoteEvent> reference = playFile(test_file, bank, numChips, true);
+                std::vector<NoteEvent> indexed = playFile(test_file, bank, numChips, false);
+                REQUIRE(!reference.empty());
+                REQUIRE(indexed.size() == reference.size());
+                REQUIRE(indexed == reference);
+            }
+        }
+    }
+}
@@ -17,16 +17,21 @@
 
 int main(int argc, char**argv)
 {
-    if(argc == 1)
+    bool asBlob = (argc > 1) && (std::strcmp(argv[1], "--blob") == 0);
+    if(argc != (asBlob ? 3 : 2))
     {
         std::printf("Usage:\n"
                "\n"
                "bin/gen_adldata src/adldata.cpp\n"
+               "bin/gen_adldata --blob adlbanks.bin\n"
+               "\n"
+               "With --blob, write the banks into a compressed bank set to load\n"
+               "at run time by adl_setEmbeddedBanksData() instead.\n"
                "\n");
         return 1;
     }
 
-    const char *outFile_s = argv[1];
+    const char *outFile_s = argv[asBlob ? 2 : 1];
 
     BanksDump db;
 
@@ -228,7 +233,10 @@ int main(int argc, char**argv)
         measureCounter.SaveCache("fm_banks/adldata-cache.dat");
     }
 
-    db.exportBanks(std::string(outFile_s));
+    if(asBlob)
+        db.exportBanksBlob(std::string(outFile_s));
+    else
+        db.exportBanks(std::string(outFile_s));
 
     std::printf("Generation of ADLMIDI data has been completed!\n");
     std::fflush(stdout);
@@ -282,6 +282,294 @@ void BanksDump::exportBanks(const std::string &outPath, const std::string &heade
     std::fclose(out);
 }
 
+static void blobPutU8(std::vector<uint8_t> &out, uint_fast32_t v)
+{
+    out.push_back(static_cast<uint8_t>(v & 0xFF));
+}
+
+static void blobPutU16(std::vector<uint8_t> &out, uint_fast32_t v)
+{
+    out.push_back(static_cast<uint8_t>(v & 0xFF));
+    out.push_back(static_cast<uint8_t>((v >> 8) & 0xFF));
+}
+
+static void blobSetU32(std::vector<uint8_t> &out, size_t at, uint_fast32_t v)
+{
+    for(size_t i = 0; i < 4; i++)
+        out[at + i] = static_cast<uint8_t>((v >> (i * 8)) & 0xFF);
+}
+
+// Puts the low bytes of all values first, then the next ones and so on
+static void blobPutColumn(std::vector<uint8_t> &out, const std::vector<uint_fast32_t> &values, size_t bytes)
+{
+    for(size_t b = 0; b < bytes; b++)
+    {
+        for(uint_fast32_t v : values)
+            out.push_back(static_cast<uint8_t>((v >> (b * 8)) & 0xFF));
+    }
+}
+
+/*
+ * Indices are numbered in the order of their first use, so store how far
+ * back the index is from the next new one: 0 is a new one.
+ */
+static uint_fast32_t blobFirstUse(size_t index, size_t &next)
+{
+    uint_fast32_t back = static_cast<uint_fast32_t>(next - index);
+    if(index == next)
+        next++;
+    return back;
+}
+
+static void blobPutLength(std::vector<uint8_t> &out, size_t len)
+{
+    while(len >= 255)
+    {
+        out.push_back(255);
+        len -= 255;
+    }
+    out.push_back(static_cast<uint8_t>(len));
+}
+
+/*
+ * LZ77 with LZ4 style sequences: a token byte with the literals length in
+ * the high and the match length - 4 in the low nibble (15 means more length
+ * bytes follow, added up until one is below 255), the literals, and a 16-bit
+ * little endian match offset. The last sequence has literals only.
+ * The decoder is blobDecompress() in src/adldata_blob.cpp.
+ */
+static void blobCompress(const std::vector<uint8_t> &in, std::vector<uint8_t> &out)
+{
+    const size_t minMatch = 4;
+    const size_t maxOffset = 0xFFFF;
+    const size_t maxChain = 1024;
+    std::vector<long> head(1 << 16, -1);
+    std::vector<long> prev(in.size(), -1);
+    size_t pos = 0, lit = 0;
+
+    auto hash = [&in](size_t p) -> size_t
+    {
+        uint32_t v = uint32_t(in[p]) | (uint32_t(in[p + 1]) << 8) |
+                     (uint32_t(in[p + 2]) << 16) | (uint32_t(in[p + 3]) << 24);
+        return (v * 2654435761u) >> 16;
+    };
+    auto insert = [&](size_t p)
+    {
+        if(p + minMatch > in.size())
+            return;
+        size_t h = hash(p);
+        prev[p] = head[h];
+        head[h] = static_cast<long>(p);
+    };
+    auto emit = [&](size_t litLen, size_t offset, size_t matchLen)
+    {
+        size_t m = matchLen ? matchLen - minMatch : 0;
+        blobPutU8(out, ((litLen < 15 ? litLen : 15) << 4) | (m < 15 ? m : 15));
+        if(litLen >= 15)
+            blobPutLength(out, litLen - 15);
+        out.insert(out.end(), in.begin() + static_cast<long>(lit), in.begin() + static_cast<long>(lit + litLen));
+        if(!matchLen)
+            return;
+        blobPutU16(out, offset);
+        if(m >= 15)
+            blobPutLength(out, m - 15);
+    };
+
+    while(pos + minMatch <= in.size())
+    {
+        size_t bestLen = 0, bestOffset = 0, chain = 0;
+        for(long c = head[hash(pos)]; c >= 0 && pos - size_t(c) <= maxOffset && chain < maxChain; c = prev[size_t(c)], chain++)
+        {
+            size_t len = 0;
+            while(pos + len < in.size() && in[size_t(c) + len] == in[pos + len])
+                len++;
+            if(len > bestLen)
+            {
+                bestLen = len;
+                bestOffset = pos - size_t(c);
+            }
+        }
+
+        if(bestLen < minMatch)
+        {
+            insert(pos++);
+            continue;
+        }
+
+        emit(pos - lit, bestOffset, bestLen);
+        for(size_t i = 0; i < bestLen; i++)
+            insert(pos + i);
+        pos += bestLen;
+        lit = pos;
+    }
+
+    emit(in.size() - lit, 0, 0);
+}
+
+/*
+ * Compressed bank set, all numbers are little endian:
+ *
+ * Header:  "ADLMIDI-BANKSET\0", u16 version (1), u16 bank sets count
+ * Index:   per bank set: u16 bank setup, u16 reserved, u32 title offset,
+ *          u32 data offset, u32 compressed size, u32 decompressed size
+ * Titles:  null terminated strings
+ * Data:    per bank set, compressed separately so that any of them can be
+ *          decoded alone:
+ *          u16 melodic and u16 percussion MIDI banks count,
+ *          u16 instruments and u16 operators count,
+ *          MIDI banks (melodic first): u8 MSB, u8 LSB, 128 x u16 instrument,
+ *          instruments, by field: i16 note offset 1, i16 note offset 2,
+ *          i8 velocity offset, u8 percussion key, u8 flags, i8 second voice
+ *          detune, u16 feedback/connection, u16 key on and u16 key off
+ *          delay, then the u16 operators 1, 2, 3 and 4 of all of them,
+ *          operators, by field: u32 E862 and u8 40 register values.
+ *          Fields of more than one byte are stored as a column of the low
+ *          bytes followed by a column of the next ones. Instruments and
+ *          operators are numbered within the bank set in the order they are
+ *          first used and stored as blobFirstUse() values, 0xFFFF is none.
+ */
+void BanksDump::exportBanksBlob(const std::string &outPath)
+{
+    std::vector<uint8_t> head, titles, data;
+    const size_t indexEntrySize = 20;
+    const size_t headerSize = 20;
+
+    head.insert(head.end(), "ADLMIDI-BANKSET", "ADLMIDI-BANKSET" + 16);
+    blobPutU16(head, 1);
+    blobPutU16(head, banks.size());
+    head.resize(headerSize + banks.size() * indexEntrySize);
+
+    for(const BankEntry &be : banks)
+    {
+        titles.insert(titles.end(), be.bankTitle.begin(), be.bankTitle.end());
+        titles.push_back(0);
+    }
+
+    // Title and data offsets are from the beginning of the blob
+    size_t titleOffset = head.size();
+    size_t dataOffset = head.size() + titles.size();
+    size_t rawTotal = 0;
+
+    for(size_t b = 0; b < banks.size(); b++)
+    {
+        const BankEntry &be = banks[b];
+        std::vector<size_t> midi(be.melodic);
+        midi.insert(midi.end(), be.percussion.begin(), be.percussion.end());
+
+        std::map<int_fast32_t, size_t> instMap, opMap;
+        std::vector<int_fast32_t> insts, ops;
+        std::vector<uint8_t> raw;
+
+        for(size_t m : midi)
+        {
+            const MidiBank &mb = midiBanks[m];
+            for(size_t i = 0; i < 128; i++)
+            {
+                int_fast32_t inst = mb.instruments[i];
+                if(inst >= 0 && instMap.insert(std::make_pair(inst, insts.size())).second)
+                    insts.push_back(inst);
+            }
+        }
+
+        for(int_fast32_t inst : insts)
+        {
+            for(size_t op = 0; op < 4; op++)
+            {
+                int_fast32_t o = instruments[size_t(inst)].ops[op];
+                if(o >= 0 && opMap.insert(std::make_pair(o, ops.size())).second)
+                    ops.push_back(o);
+            }
+        }
+
+        blobPutU16(raw, be.melodic.size());
+        blobPutU16(raw, be.percussion.size());
+        blobPutU16(raw, insts.size());
+        blobPutU16(raw, ops.size());
+
+        size_t nextInst = 0;
+        for(size_t m : midi)
+        {
+            std::vector<uint_fast32_t> col;
+            for(size_t i = 0; i < 128; i++)
+            {
+                int_fast32_t inst = midiBanks[m].instruments[i];
+                col.push_back(inst < 0 ? 0xFFFF : blobFirstUse(instMap[inst], nextInst));
+            }
+            blobPutU8(raw, midiBanks[m].msb);
+            blobPutU8(raw, midiBanks[m].lsb);
+            blobPutColumn(raw, col, 2);
+        }
+
+        auto putInsts = [&](size_t bytes, uint_fast32_t (*field)(const InstrumentEntry &))
+        {
+            std::vector<uint_fast32_t> col;
+            for(int_fast32_t i : insts)
+                col.push_back(field(instruments[size_t(i)]));
+            blobPutColumn(raw, col, bytes);
+        };
+        putInsts(2, [](const InstrumentEntry &e) { return uint_fast32_t(e.noteOffset1); });
+        putInsts(2, [](const InstrumentEntry &e) { return uint_fast32_t(e.noteOffset2); });
+        putInsts(1, [](const InstrumentEntry &e) { return uint_fast32_t(e.midiVelocityOffset); });
+        putInsts(1, [](const InstrumentEntry &e) { return uint_fast32_t(e.percussionKeyNumber); });
+        putInsts(1, [](const InstrumentEntry &e) { return uint_fast32_t(e.instFlags); });
+        putInsts(1, [](const InstrumentEntry &e) { return uint_fast32_t(e.secondVoiceDetune); });
+        putInsts(2, [](const InstrumentEntry &e) { return uint_fast32_t(e.fbConn); });
+        putInsts(2, [](const InstrumentEntry &e) { return uint_fast32_t(e.delay_on_ms); });
+        putInsts(2, [](const InstrumentEntry &e) { return uint_fast32_t(e.delay_off_ms); });
+
+        std::vector<uint_fast32_t> opCols(insts.size() * 4);
+        size_t nextOp = 0;
+        for(size_t i = 0; i < insts.size(); i++)
+        {
+            for(size_t op = 0; op < 4; op++)
+            {
+                int_fast32_t o = instruments[size_t(insts[i])].ops[op];
+                opCols[op * insts.size() + i] = o < 0 ? 0xFFFF : blobFirstUse(opMap[o], nextOp);
+            }
+        }
+        blobPutColumn(raw, opCols, 2);
+
+        std::vector<uint_fast32_t> e862, d40;
+        for(int_fast32_t o : ops)
+        {
+            e862.push_back(operators[size_t(o)].d_E862);
+            d40.push_back(operators[size_t(o)].d_40);
+        }
+        blobPutColumn(raw, e862, 4);
+        blobPutColumn(raw, d40, 1);
+
+        std::vector<uint8_t> packed;
+        blobCompress(raw, packed);
+
+        size_t at = headerSize + b * indexEntrySize;
+        head[at + 0] = static_cast<uint8_t>(be.bankSetup & 0xFF);
+        head[at + 1] = static_cast<uint8_t>((be.bankSetup >> 8) & 0xFF);
+        blobSetU32(head, at + 4, titleOffset);
+        blobSetU32(head, at + 8, dataOffset + data.size());
+        blobSetU32(head, at + 12, packed.size());
+        blobSetU32(head, at + 16, raw.size());
+
+        titleOffset += be.bankTitle.size() + 1;
+        data.insert(data.end(), packed.begin(), packed.end());
+        rawTotal += raw.size();
+    }
+
+    FILE *out = std::fopen(outPath.c_str(), "wb");
+    if(!out)
+    {
+        std::fprintf(stderr, "Can't open %s for writing!\n", outPath.c_str());
+        return;
+    }
+    std::fwrite(head.data(), 1, head.size(), out);
+    std::fwrite(titles.data(), 1, titles.size(), out);
+    std::fwrite(data.data(), 1, data.size(), out);
+    std::fclose(out);
+
+    std::printf("Written %zu bank sets, %zu bytes (%zu bytes decompressed)\n",
+                banks.size(), head.size() + titles.size() + data.size(),
+                head.size() + titles.size() + rawTotal);
+}
+
 struct OpCheckData
 {
     uint_fast8_t egEn;
@@ -309,6 +309,7 @@ struct BanksDump
     void addMidiBank(size_t bankId, bool percussion, MidiBank b);
     void addInstrument(MidiBank &bank, size_t patchId, InstrumentEntry e, Operator *ops, const std::string &meta = std::string());
     void exportBanks(const std::string &outPath, const std::string &headerName = "adlmidi_db.h");
+    void exportBanksBlob(const std::string &outPath);
 };
 
 
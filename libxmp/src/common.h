@@ -282,6 +282,7 @@ struct module_data {
 	int defpan;			/* default pan setting */
 	struct ord_data xxo_info[XMP_MAX_MOD_LENGTH];
 	int num_sequences;
+	int scan_done;			/* all sequences scanned */
 	struct xmp_sequence seq_data[MAX_SEQUENCES];
 	char *instrument_path;
 	void *extra;			/* format-specific extra fields */
@@ -404,6 +405,9 @@ char	*libxmp_adjust_string	(char *);
 int	libxmp_exclude_match	(const char *);
 int	libxmp_prepare_scan	(struct context_data *);
 int	libxmp_scan_sequences	(struct context_data *);
+void	libxmp_reset_scan	(struct context_data *);
+void	libxmp_scan_main_sequence (struct context_data *);
+void	libxmp_scan_all_sequences (struct context_data *);
 int	libxmp_get_sequence	(struct context_data *, int);
 int	libxmp_set_player_mode	(struct context_data *);
 
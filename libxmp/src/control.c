@@ -70,6 +70,7 @@ static void set_position(struct context_data *ctx, int pos, int dir)
 
 	/* If dir is 0, we can jump to a different sequence */
 	if (dir == 0) {
+		libxmp_scan_all_sequences(ctx);
 		seq = libxmp_get_sequence(ctx, pos);
 	} else {
 		seq = p->sequence;
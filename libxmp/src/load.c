@@ -453,7 +453,8 @@ static int load_module(xmp_context opaque, HIO_HANDLE *h)
 		return ret;
 	}
 
-	libxmp_scan_sequences(ctx);
+	/* Sequences are scanned when they're needed */
+	libxmp_reset_scan(ctx);
 
 	ctx->state = XMP_STATE_LOADED;
 
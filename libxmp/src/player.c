@@ -1489,6 +1489,8 @@ int xmp_start_player(xmp_context opaque, int rate, int format)
 	if (ctx->state > XMP_STATE_LOADED)
 		xmp_end_player(opaque);
 
+	libxmp_scan_main_sequence(ctx);
+
 	if (libxmp_mixer_on(ctx, rate, format, m->c4rate) < 0)
 		return -XMP_ERROR_INTERNAL;
 
@@ -1812,6 +1814,8 @@ void xmp_get_module_info(xmp_context opaque, struct xmp_module_info *info)
 	if (ctx->state < XMP_STATE_LOADED)
 		return;
 
+	libxmp_scan_all_sequences(ctx);
+
 	memcpy(info->md5, m->md5, 16);
 	info->mod = mod;
 	info->comment = m->comment;
@@ -1832,6 +1836,8 @@ void xmp_get_frame_info(xmp_context opaque, struct xmp_frame_info *info)
 	if (ctx->state < XMP_STATE_LOADED)
 		return;
 
+	libxmp_scan_main_sequence(ctx);
+
 	chn = mod->chn;
 
 	if (p->pos >= 0 && p->pos < mod->len) {
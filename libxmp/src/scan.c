@@ -494,56 +494,93 @@ int libxmp_get_sequence(struct context_data *ctx, int ord)
 	return p->sequence_control[ord];
 }
 
-int libxmp_scan_sequences(struct context_data *ctx)
+/* Scans the sequence after the ones scanned so far. Returns 0 once all
+ * sequences are scanned.
+ */
+static int scan_next_sequence(struct context_data *ctx)
 {
 	struct player_data *p = &ctx->p;
 	struct module_data *m = &ctx->m;
 	struct xmp_module *mod = &m->mod;
 	int i, ep;
-	int seq;
-	unsigned char temp_ep[XMP_MAX_MOD_LENGTH];
+	int seq = m->num_sequences;
 
-	/* Initialize order data to prevent overwrite when a position is used
-	 * multiple times at different starting points (see janosik.xm).
-	 */
-	for (i = 0; i < XMP_MAX_MOD_LENGTH; i++) {
-		m->xxo_info[i].gvl = -1;
+	if (m->scan_done) {
+		return 0;
 	}
 
-	ep = 0;
-	memset(p->sequence_control, 0xff, XMP_MAX_MOD_LENGTH);
-	temp_ep[0] = 0;
-	p->scan[0].time = scan_module(ctx, ep, 0);
-	seq = 1;
-
- 	while (1) { 
-		/* Scan song starting at given entry point */
-		/* Check if any patterns left */
-		for (i = 0; i < mod->len; i++) {
-			if (p->sequence_control[i] == 0xff) {
-				break;
-			}
+	if (seq == 0) {
+		/* Initialize order data to prevent overwrite when a position
+		 * is used multiple times at different starting points (see
+		 * janosik.xm).
+		 */
+		for (i = 0; i < XMP_MAX_MOD_LENGTH; i++) {
+			m->xxo_info[i].gvl = -1;
 		}
-		if (i != mod->len && seq < MAX_SEQUENCES) {
-			/* New entry point */
-			ep = i;
-			temp_ep[seq] = ep;
-			p->scan[seq].time = scan_module(ctx, ep, seq);
-			if (p->scan[seq].time > 0)
-				seq++;
-		} else {
+		memset(p->sequence_control, 0xff, XMP_MAX_MOD_LENGTH);
+
+		p->scan[0].time = scan_module(ctx, 0, 0);
+		m->seq_data[0].entry_point = 0;
+		m->seq_data[0].duration = p->scan[0].time;
+		m->num_sequences = 1;
+		return 1;
+	}
+
+	/* Check if any patterns left */
+	for (ep = 0; ep < mod->len; ep++) {
+		if (p->sequence_control[ep] == 0xff) {
 			break;
 		}
 	}
+	if (ep == mod->len || seq >= MAX_SEQUENCES) {
+		m->scan_done = 1;
+		return 0;
+	}
+
+	/* Scan song starting at the new entry point. If it doesn't play
+	 * at all, its positions are taken but it isn't a sequence.
+	 */
+	p->scan[seq].time = scan_module(ctx, ep, seq);
+	if (p->scan[seq].time > 0) {
+		m->seq_data[seq].entry_point = ep;
+		m->seq_data[seq].duration = p->scan[seq].time;
+		m->num_sequences++;
+	}
+
+	return 1;
+}
 
-	m->num_sequences = seq;
+/* Drops the results of earlier scans. The main sequence is scanned again
+ * when the player starts or its duration is asked for, the others when
+ * they're asked for, see libxmp_scan_all_sequences().
+ */
+void libxmp_reset_scan(struct context_data *ctx)
+{
+	struct module_data *m = &ctx->m;
+
+	m->num_sequences = 0;
+	m->scan_done = 0;
+}
+
+void libxmp_scan_main_sequence(struct context_data *ctx)
+{
+	struct module_data *m = &ctx->m;
 
-	/* Now place entry points in the public accessible array */
-	for (i = 0; i < m->num_sequences; i++) {
-		m->seq_data[i].entry_point = temp_ep[i];
-		m->seq_data[i].duration = p->scan[i].time;
+	if (m->num_sequences == 0) {
+		scan_next_sequence(ctx);
 	}
+}
 
+void libxmp_scan_all_sequences(struct context_data *ctx)
+{
+	while (scan_next_sequence(ctx))
+		;
+}
+
+int libxmp_scan_sequences(struct context_data *ctx)
+{
+	libxmp_reset_scan(ctx);
+	libxmp_scan_all_sequences(ctx);
 
 	return 0;
 }
@@ -0,0 +1,44 @@
+#include "test.h"
+
+TEST(test_api_get_module_info)
+{
+	xmp_context opaque;
+	struct context_data *ctx;
+	struct xmp_module_info info;
+	struct xmp_frame_info fi;
+	int ret;
+
+	opaque = xmp_create_context();
+	ctx = (struct context_data *)opaque;
+
+	ret = xmp_load_module(opaque, "data/m/IMS.beast-busters1.st");
+	fail_unless(ret == 0, "can't load module");
+
+	/* sequences are scanned when they're needed */
+	fail_unless(ctx->m.num_sequences == 0, "scanned on load");
+
+	xmp_start_player(opaque, 44100, 0);
+	fail_unless(ctx->m.num_sequences == 1, "main sequence not scanned");
+	xmp_get_frame_info(opaque, &fi);
+	fail_unless(fi.total_time == 26960, "total time error");
+
+	xmp_get_module_info(opaque, &info);
+	fail_unless(info.num_sequences == 7, "number of sequences");
+	fail_unless(info.seq_data[0].entry_point == 0, "entry point error");
+	fail_unless(info.seq_data[0].duration == 26960, "duration error");
+	fail_unless(info.seq_data[3].entry_point == 22, "entry point error");
+	fail_unless(info.seq_data[3].duration == 35840, "duration error");
+	fail_unless(info.seq_data[6].entry_point == 38, "entry point error");
+	fail_unless(info.seq_data[6].duration == 17920, "duration error");
+
+	/* a full rescan gives the same sequences */
+	xmp_scan_module(opaque);
+	fail_unless(ctx->m.num_sequences == 7, "number of sequences");
+	fail_unless(ctx->m.seq_data[3].entry_point == 22, "entry point error");
+	fail_unless(ctx->m.seq_data[3].duration == 35840, "duration error");
+
+	xmp_end_player(opaque);
+	xmp_release_module(opaque);
+	xmp_free_context(opaque);
+}
+END_TEST
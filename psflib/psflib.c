@@ -93,10 +93,14 @@ typedef struct psf_load_state
 	psf_status_callback        status_target;
 	void                     * status_context;
 
+	psf_scan_callback          scan_target;
+	void                     * scan_context;
+
 	char                       lib_name_temp[32];
 } psf_load_state;
 
 static int psf_load_internal(psf_load_state * state, const char * file_name);
+static int psf_scan_internal(psf_load_state * state, const char * file_name);
 
 
 static int psf_want_status(psf_load_state * state);
@@ -126,6 +130,8 @@ int psf_load(const char * uri, const psf_file_callbacks * file_callbacks, uint8_
 	state.info_want_nested_tags = info_want_nested_tags;
 	state.status_target = status_target;
 	state.status_context = status_context;
+	state.scan_target = NULL;
+	state.scan_context = NULL;
 
 	state.base_path = strdup(uri);
 	if (!state.base_path)
@@ -156,6 +162,56 @@ int psf_load(const char * uri, const psf_file_callbacks * file_callbacks, uint8_
 	return rval;
 }
 
+int psf_scan(const char * uri, const psf_file_callbacks * file_callbacks, uint8_t allowed_version,
+	psf_scan_callback scan_target, void * scan_context, psf_status_callback status_target,
+	void * status_context)
+{
+	int rval;
+
+	psf_load_state state;
+
+	const char * file_name;
+
+	if (!uri || !*uri || !file_callbacks || !file_callbacks->path_separators || !*file_callbacks->path_separators || !file_callbacks->fopen ||
+		!file_callbacks->fread || !file_callbacks->fseek || !file_callbacks->fclose || !file_callbacks->ftell) return -1;
+
+	memset(&state, 0, sizeof(state));
+	state.allowed_version = allowed_version;
+	state.file_callbacks = file_callbacks;
+	state.status_target = status_target;
+	state.status_context = status_context;
+	state.scan_target = scan_target;
+	state.scan_context = scan_context;
+
+	state.base_path = strdup(uri);
+	if (!state.base_path)
+	{
+		psf_status(&state, "Out of memory allocating state.base_path\n", 1);
+		return -1;
+	}
+
+	file_name = strrpbrk(uri, file_callbacks->path_separators);
+
+	if (file_name)
+	{
+		++file_name;
+		state.base_path[file_name - uri] = '\0';
+	}
+	else
+	{
+		state.base_path[0] = '\0';
+		file_name = uri;
+	}
+
+	rval = psf_scan_internal(&state, file_name);
+
+	free(state.base_path);
+
+	psf_status(&state, "Done.", 0);
+
+	return rval;
+}
+
 typedef struct psf_tag psf_tag;
 
 struct psf_tag {
@@ -395,42 +451,18 @@ static psf_tag * process_tags(char * buffer)
 	return tags;
 }
 
-static int psf_load_internal(psf_load_state * state, const char * file_name)
-{
-	psf_tag * tags = NULL;
-	psf_tag * tag;
+/* Opens file_name relative to the base path. The full path is handed back through
+ * full_path_out, if given, and must be freed by the caller. */
 
+static void * psf_open_file(psf_load_state * state, const char * file_name, char ** full_path_out)
+{
 	char * full_path;
-
-	void * file;
-
-	long file_size, tag_size;
-
-	int n;
-
-	uint8_t header_buffer[16];
-
-	uint8_t * exe_compressed_buffer = NULL;
-	uint8_t * exe_decompressed_buffer = NULL;
-	uint8_t * reserved_buffer = NULL;
-	char * tag_buffer = NULL;
-
-	uint32_t exe_compressed_size, exe_crc32, reserved_size;
-	uLong exe_decompressed_size, try_exe_decompressed_size;
-
-	int zerr;
-
 	size_t full_path_size;
-
-	if (++state->depth > max_recursion_depth)
-	{
-		psf_status(state, "Exceeded maximum file nesting depth.\n", 1);
-		return -1;
-	}
+	void * file;
 
 	full_path_size = strlen(state->base_path) + strlen(file_name) + 1;
 	full_path = (char *)malloc(full_path_size);
-	if (!full_path) return -1;
+	if (!full_path) return NULL;
 
 #if _MSC_VER >= 1300
 	strcpy_s(full_path, full_path_size, state->base_path);
@@ -442,49 +474,42 @@ static int psf_load_internal(psf_load_state * state, const char * file_name)
 
 	file = state->file_callbacks->fopen(state->file_callbacks->context, full_path);
 
-	free(full_path);
+	if (file && full_path_out)
+		*full_path_out = full_path;
+	else
+		free(full_path);
 
-	if (!file)
-	{
-		if (psf_want_status(state))
-		{
-			psf_status(state, "Error opening file: ", 1);
-			psf_status(state, file_name, 0);
-			psf_status(state, "\n", 0);
-			psf_status(state, "From base path: ", 1);
-			psf_status(state, state->base_path, 0);
-			psf_status(state, "\n", 0);
-		}
-		return -1;
-	}
+	return file;
+}
 
-	if (psf_want_status(state))
-	{
-		psf_status(state, "Opened file: ", 1);
-		psf_status(state, file_name, 0);
-		psf_status(state, "\n", 0);
-		psf_status(state, "From base path: ", 1);
-		psf_status(state, state->base_path, 0);
-		psf_status(state, "\n", 0);
-	}
+/* Reads and validates the header, then parses the tag area, if any. Leaves the file
+ * position undefined. Returns the PSF version, or negative on error. */
+
+static int psf_read_header(psf_load_state * state, void * file, long * file_size_out, uint32_t * reserved_size,
+	uint32_t * exe_compressed_size, uint32_t * exe_crc32, psf_tag ** tags)
+{
+	uint8_t header_buffer[16];
+	char * tag_buffer;
+	long file_size, tag_size;
+
+	*tags = NULL;
 
 	if (state->file_callbacks->fread(header_buffer, 1, 16, file) < 16)
 	{
 		psf_status(state, "File too small to contain a valid header.\n", 1);
-		goto error_close_file;
+		return -1;
 	}
 
 	if (memcmp(header_buffer, "PSF", 3))
 	{
 		psf_status(state, "File does not contain a valid PSF signature.\n", 1);
-		goto error_close_file;
+		return -1;
 	}
 
 	if (state->allowed_version && (header_buffer[3] != state->allowed_version))
 	{
 		if (psf_want_status(state))
 		{
-			char *end;
 			char temp[8];
 			psf_status(state, "Expected PSF version ", 1);
 			snprintf(temp, 7, "%d", (int)state->allowed_version);
@@ -496,17 +521,17 @@ static int psf_load_internal(psf_load_state * state, const char * file_name)
 			psf_status(state, temp, 0);
 			psf_status(state, "\n", 0);
 		}
-		goto error_close_file;
+		return -1;
 	}
 
-	reserved_size = header_buffer[4] | (header_buffer[5] << 8) | (header_buffer[6] << 16) | (header_buffer[7] << 24);
-	exe_compressed_size = header_buffer[8] | (header_buffer[9] << 8) | (header_buffer[10] << 16) | (header_buffer[11] << 24);
-	exe_crc32 = header_buffer[12] | (header_buffer[13] << 8) | (header_buffer[14] << 16) | (header_buffer[15] << 24);
+	*reserved_size = header_buffer[4] | (header_buffer[5] << 8) | (header_buffer[6] << 16) | (header_buffer[7] << 24);
+	*exe_compressed_size = header_buffer[8] | (header_buffer[9] << 8) | (header_buffer[10] << 16) | (header_buffer[11] << 24);
+	*exe_crc32 = header_buffer[12] | (header_buffer[13] << 8) | (header_buffer[14] << 16) | (header_buffer[15] << 24);
 
 	if (state->file_callbacks->fseek(file, 0, SEEK_END))
 	{
 		psf_status(state, "Could not seek to end of file to determine file size.\n", 1);
-		goto error_close_file;
+		return -1;
 	}
 
 	file_size = state->file_callbacks->ftell(file);
@@ -514,188 +539,541 @@ static int psf_load_internal(psf_load_state * state, const char * file_name)
 	if (file_size <= 0)
 	{
 		psf_status(state, "Could not determine file size.\n", 1);
-		goto error_close_file;
+		return -1;
 	}
 
-	if ((unsigned long)file_size >= 16 + reserved_size + exe_compressed_size + 5)
+	*file_size_out = file_size;
+
+	if ((unsigned long)file_size >= 16 + *reserved_size + *exe_compressed_size + 5)
 	{
 		psf_status(state, "Tag detected, attempting to read it.\n", 1);
 
-		tag_size = file_size - (16 + reserved_size + exe_compressed_size);
+		tag_size = file_size - (16 + *reserved_size + *exe_compressed_size);
 		if (state->file_callbacks->fseek(file, -tag_size, SEEK_CUR))
 		{
 			psf_status(state, "Could not seek back to read tag.\n", 1);
-			goto error_close_file;
+			return -1;
 		}
 		tag_buffer = (char *)malloc(tag_size + 1);
 		if (!tag_buffer)
 		{
 			psf_status(state, "Out of memory allocating tag buffer.\n", 1);
-			goto error_close_file;
+			return -1;
 		}
 		if (state->file_callbacks->fread(tag_buffer, 1, tag_size, file) < (size_t)tag_size)
 		{
 			psf_status(state, "Could not read tag.\n", 1);
-			goto error_free_buffers;
+			free(tag_buffer);
+			return -1;
 		}
 		tag_buffer[tag_size] = 0;
-		if (!memcmp(tag_buffer, "[TAG]", 5)) tags = process_tags(tag_buffer + 5);
+		if (!memcmp(tag_buffer, "[TAG]", 5)) *tags = process_tags(tag_buffer + 5);
 		free(tag_buffer);
-		tag_buffer = NULL;
+	}
+
+	return header_buffer[3];
+}
+
+enum { inflate_chunk_size = 64 * 1024 };
+
+/* Streams the compressed exe section from the current file position through inflate,
+ * checking the CRC of the compressed data on the way. The output buffer only grows
+ * when inflate runs out of room, and is trimmed to the exact size at the end. */
+
+static int psf_inflate_exe(psf_load_state * state, void * file, uint32_t exe_compressed_size,
+	uint32_t exe_crc32, uint8_t ** exe_buffer, size_t * exe_size)
+{
+	z_stream stream;
+	uint8_t * chunk;
+	uint8_t * buffer;
+	size_t buffer_size;
+	uint32_t remain = exe_compressed_size;
+	uint32_t got_crc32 = crc32(0L, Z_NULL, 0);
+	int zerr = Z_OK;
+
+	*exe_buffer = NULL;
+	*exe_size = 0;
+
+	chunk = (uint8_t *)malloc(inflate_chunk_size);
+	if (!chunk)
+	{
+		psf_status(state, "Out of memory allocating buffer for compressed exe section.\n", 1);
+		return -1;
+	}
+
+	buffer_size = (size_t)exe_compressed_size * 3;
+	buffer = (uint8_t *)malloc(buffer_size);
+	if (!buffer)
+	{
+		psf_status(state, "Out of memory allocating buffer for decompressed exe section.\n", 1);
+		goto error_free_chunk;
+	}
 
-		if (tags && state->info_target && (state->depth == 1 || state->info_want_nested_tags))
+	memset(&stream, 0, sizeof(stream));
+	if (inflateInit(&stream) != Z_OK)
+	{
+		psf_status(state, "Could not initialize decompressor.\n", 1);
+		goto error_free_buffer;
+	}
+
+	stream.next_out = buffer;
+	stream.avail_out = (uInt)buffer_size;
+
+	while (zerr != Z_STREAM_END)
+	{
+		if (!stream.avail_in && remain)
 		{
-			tag = tags;
-			while (tag->next) tag = tag->next;
-			while (tag)
+			uint32_t todo = remain < inflate_chunk_size ? remain : inflate_chunk_size;
+			if (state->file_callbacks->fread(chunk, 1, todo, file) < todo)
 			{
-				if (state->info_target(state->info_context, tag->name, tag->value))
-				{
-					if (psf_want_status(state))
-					{
-						psf_status(state, "Caller rejected tag: ", 1);
-						psf_status(state, tag->name, 0);
-						psf_status(state, "=", 0);
-						psf_status(state, tag->value, 0);
-						psf_status(state, "\n", 0);
-					}
-					goto error_free_tags;
-				}
-				tag = tag->prev;
+				psf_status(state, "Could not read compressed exe section.\n", 1);
+				goto error_end_stream;
 			}
+			got_crc32 = crc32(got_crc32, chunk, todo);
+			stream.next_in = chunk;
+			stream.avail_in = todo;
+			remain -= todo;
+		}
+
+		if (!stream.avail_out)
+		{
+			size_t try_buffer_size;
+			void * try_buffer;
+
+			if (buffer_size < 1 * 1024 * 1024)
+				try_buffer_size = buffer_size + 1 * 1024 * 1024;
+			else
+				try_buffer_size = buffer_size + buffer_size;
+
+			try_buffer = realloc(buffer, try_buffer_size);
+			if (!try_buffer)
+			{
+				psf_status(state, "Out of memory reallocating buffer for decompressed exe section.\n", 1);
+				goto error_end_stream;
+			}
+
+			buffer = (uint8_t *)try_buffer;
+			stream.next_out = buffer + buffer_size;
+			stream.avail_out = (uInt)(try_buffer_size - buffer_size);
+			buffer_size = try_buffer_size;
+		}
+
+		zerr = inflate(&stream, Z_NO_FLUSH);
+		if (zerr == Z_BUF_ERROR && (stream.avail_in || remain || !stream.avail_out))
+			continue;
+		if (zerr != Z_OK && zerr != Z_STREAM_END)
+		{
+			psf_status(state, "Could not decompress exe section.\n", 1);
+			goto error_end_stream;
 		}
 	}
 
-	if (!state->load_target) goto done;
+	/* trailing bytes after the end of the stream still count towards the CRC */
+	while (remain)
+	{
+		uint32_t todo = remain < inflate_chunk_size ? remain : inflate_chunk_size;
+		if (state->file_callbacks->fread(chunk, 1, todo, file) < todo)
+		{
+			psf_status(state, "Could not read compressed exe section.\n", 1);
+			goto error_end_stream;
+		}
+		got_crc32 = crc32(got_crc32, chunk, todo);
+		remain -= todo;
+	}
 
-	tag = find_tag(tags, "_lib");
-	if (tag)
+	if (exe_crc32 != got_crc32)
 	{
 		if (psf_want_status(state))
 		{
-			psf_status(state, "Found _lib: ", 1);
-			psf_status(state, tag->value, 0);
+			char temp[16];
+			psf_status(state, "CRC mismatch on compressed exe section.\nWanted: 0x", 1);
+			snprintf(temp, 15, "%X", exe_crc32);
+			temp[15] = '\0';
+			psf_status(state, temp, 0);
+			psf_status(state, ", got 0x", 0);
+			snprintf(temp, 15, "%X", got_crc32);
+			temp[15] = '\0';
+			psf_status(state, temp, 0);
 			psf_status(state, "\n", 0);
 		}
-		if (psf_load_internal(state, tag->value) < 0) goto error_free_tags;
+		goto error_end_stream;
 	}
 
-	reserved_buffer = (uint8_t *)malloc(reserved_size);
-	if (!reserved_buffer)
+	*exe_size = stream.total_out;
+	inflateEnd(&stream);
+	free(chunk);
+
+	if (*exe_size && *exe_size < buffer_size)
 	{
-		psf_status(state, "Out of memory allocating buffer for reserved section.\n", 1);
-		goto error_free_tags;
+		void * exact_buffer = realloc(buffer, *exe_size);
+		if (exact_buffer) buffer = (uint8_t *)exact_buffer;
 	}
-	exe_compressed_buffer = (uint8_t *)malloc(exe_compressed_size);
-	if (!exe_compressed_buffer)
+
+	*exe_buffer = buffer;
+
+	return 0;
+
+error_end_stream:
+	inflateEnd(&stream);
+error_free_buffer:
+	free(buffer);
+error_free_chunk:
+	free(chunk);
+	return -1;
+}
+
+/* Decompressed library sections, shared by all loads in the process, most recently
+ * used first. Only nested files are kept, since those are what the tracks of a set
+ * have in common. An entry is matched on its path, file size, section sizes and exe
+ * CRC from the header. The header has no CRC for the reserved section, where USF
+ * keeps all of its data, so a matching entry is only used once the reserved section
+ * on disk has the same CRC as the cached one. A library replaced on disk is thus
+ * read again; for an unchanged one the reserved section is still read, but not
+ * allocated and copied. Not thread safe. */
+
+typedef struct psf_cache_entry psf_cache_entry;
+
+struct psf_cache_entry {
+	char * path;
+	long file_size;
+	uint32_t exe_compressed_size, exe_crc32, reserved_crc32;
+	uint8_t * exe;
+	size_t exe_size;
+	uint8_t * reserved;
+	uint32_t reserved_size;
+	psf_cache_entry * next, *prev;
+};
+
+enum { default_cache_size = 32 * 1024 * 1024 };
+
+static psf_cache_entry * cache_head = NULL;
+static size_t cache_used = 0;
+static size_t cache_limit = default_cache_size;
+
+static size_t psf_cache_entry_size(const psf_cache_entry * entry)
+{
+	return entry->exe_size + entry->reserved_size;
+}
+
+static void psf_cache_unlink(psf_cache_entry * entry)
+{
+	if (entry->prev) entry->prev->next = entry->next;
+	else cache_head = entry->next;
+	if (entry->next) entry->next->prev = entry->prev;
+	entry->next = entry->prev = NULL;
+}
+
+static void psf_cache_free(psf_cache_entry * entry)
+{
+	psf_cache_unlink(entry);
+	cache_used -= psf_cache_entry_size(entry);
+	free(entry->path);
+	free(entry->exe);
+	free(entry->reserved);
+	free(entry);
+}
+
+static void psf_cache_trim(size_t limit)
+{
+	psf_cache_entry * entry = cache_head;
+	if (!entry) return;
+	while (entry->next) entry = entry->next;
+	while (entry && cache_used > limit)
 	{
-		psf_status(state, "Out of memory allocating buffer for compressed exe section.\n", 1);
-		goto error_free_tags;
+		psf_cache_entry * prev = entry->prev;
+		psf_cache_free(entry);
+		entry = prev;
 	}
+}
 
-	if (state->file_callbacks->fseek(file, 16, SEEK_SET))
+static psf_cache_entry * psf_cache_find(const char * path, long file_size, uint32_t reserved_size,
+	uint32_t exe_compressed_size, uint32_t exe_crc32)
+{
+	psf_cache_entry * entry;
+	for (entry = cache_head; entry; entry = entry->next)
 	{
-		psf_status(state, "Could not seek back to main data section of file.", 1);
-		goto error_free_tags;
+		if (entry->file_size == file_size && entry->reserved_size == reserved_size &&
+			entry->exe_compressed_size == exe_compressed_size && entry->exe_crc32 == exe_crc32 &&
+			!strcmp(entry->path, path))
+		{
+			if (entry != cache_head)
+			{
+				psf_cache_unlink(entry);
+				entry->next = cache_head;
+				cache_head->prev = entry;
+				cache_head = entry;
+			}
+			return entry;
+		}
 	}
-	if (reserved_size && state->file_callbacks->fread(reserved_buffer, 1, reserved_size, file) < reserved_size)
+	return NULL;
+}
+
+/* Streams the reserved section of the file through crc32, without keeping it. Returns
+ * negative on error. */
+
+static int psf_crc_reserved(psf_load_state * state, void * file, uint32_t reserved_size, uint32_t * reserved_crc32)
+{
+	uint8_t * chunk;
+	uint32_t remain = reserved_size;
+	uint32_t got_crc32 = crc32(0L, Z_NULL, 0);
+
+	if (state->file_callbacks->fseek(file, 16, SEEK_SET))
 	{
-		psf_status(state, "Could not read reserved section.\n", 1);
-		goto error_free_tags;
+		psf_status(state, "Could not seek to reserved section of file.\n", 1);
+		return -1;
 	}
-	if (exe_compressed_size && state->file_callbacks->fread(exe_compressed_buffer, 1, exe_compressed_size, file) < exe_compressed_size)
+
+	chunk = (uint8_t *)malloc(inflate_chunk_size);
+	if (!chunk)
 	{
-		psf_status(state, "Could not read compressed exe section.\n", 1);
-		goto error_free_tags;
+		psf_status(state, "Out of memory allocating buffer for reserved section.\n", 1);
+		return -1;
 	}
-	state->file_callbacks->fclose(file);
-	file = NULL;
 
-	psf_status(state, "File closed.\n", 1);
-
-	if (exe_compressed_size)
+	while (remain)
 	{
-		uint32_t got_crc32 = crc32(crc32(0L, Z_NULL, 0), exe_compressed_buffer, exe_compressed_size);
-		if (exe_crc32 != got_crc32)
+		uint32_t todo = remain < inflate_chunk_size ? remain : inflate_chunk_size;
+		if (state->file_callbacks->fread(chunk, 1, todo, file) < todo)
 		{
-			if (psf_want_status(state))
-			{
-				char temp[16];
-				psf_status(state, "CRC mismatch on compressed exe section.\nWanted: 0x", 1);
-				snprintf(temp, 15, "%X", exe_crc32);
-				temp[15] = '\0';
-				psf_status(state, temp, 0);
-				psf_status(state, ", got 0x", 0);
-				snprintf(temp, 15, "%X", got_crc32);
-				temp[15] = '\0';
-				psf_status(state, temp, 0);
-				psf_status(state, "\n", 0);
-			}
-			goto error_free_tags;
+			psf_status(state, "Could not read reserved section.\n", 1);
+			free(chunk);
+			return -1;
 		}
+		got_crc32 = crc32(got_crc32, chunk, todo);
+		remain -= todo;
+	}
+
+	free(chunk);
+	*reserved_crc32 = got_crc32;
+	return 0;
+}
+
+/* Takes ownership of path, exe and reserved on success. Returns zero if the sections
+ * were not cached and still belong to the caller. */
+
+static int psf_cache_insert(char * path, long file_size, uint32_t exe_compressed_size, uint32_t exe_crc32,
+	uint8_t * exe, size_t exe_size, uint8_t * reserved, uint32_t reserved_size, uint32_t reserved_crc32)
+{
+	psf_cache_entry * entry;
+
+	if (exe_size + reserved_size > cache_limit) return 0;
+
+	entry = (psf_cache_entry *)calloc(1, sizeof(psf_cache_entry));
+	if (!entry) return 0;
+
+	psf_cache_trim(cache_limit - (exe_size + reserved_size));
+
+	entry->path = path;
+	entry->file_size = file_size;
+	entry->exe_compressed_size = exe_compressed_size;
+	entry->exe_crc32 = exe_crc32;
+	entry->reserved_crc32 = reserved_crc32;
+	entry->exe = exe;
+	entry->exe_size = exe_size;
+	entry->reserved = reserved;
+	entry->reserved_size = reserved_size;
+
+	entry->next = cache_head;
+	if (cache_head) cache_head->prev = entry;
+	cache_head = entry;
+	cache_used += psf_cache_entry_size(entry);
+
+	return 1;
+}
+
+void psf_set_cache_size(size_t max_bytes)
+{
+	cache_limit = max_bytes;
+	psf_cache_trim(cache_limit);
+}
 
-		exe_decompressed_size = try_exe_decompressed_size = exe_compressed_size * 3;
-		exe_decompressed_buffer = (uint8_t *)malloc(exe_decompressed_size);
-		if (!exe_decompressed_buffer)
+void psf_cache_clear(void)
+{
+	psf_cache_trim(0);
+}
+
+static int psf_load_internal(psf_load_state * state, const char * file_name)
+{
+	psf_tag * tags = NULL;
+	psf_tag * tag;
+
+	void * file;
+
+	char * full_path = NULL;
+
+	int n;
+
+	int version;
+
+	long file_size;
+
+	uint8_t * exe_decompressed_buffer = NULL;
+	uint8_t * reserved_buffer = NULL;
+
+	psf_cache_entry * cached;
+
+	uint32_t exe_compressed_size, exe_crc32, reserved_size, reserved_crc32;
+	size_t exe_decompressed_size;
+
+	if (++state->depth > max_recursion_depth)
+	{
+		psf_status(state, "Exceeded maximum file nesting depth.\n", 1);
+		return -1;
+	}
+
+	file = psf_open_file(state, file_name, &full_path);
+
+	if (!file)
+	{
+		if (psf_want_status(state))
 		{
-			psf_status(state, "Out of memory allocating buffer for decompressed exe section.\n", 1);
-			goto error_free_tags;
+			psf_status(state, "Error opening file: ", 1);
+			psf_status(state, file_name, 0);
+			psf_status(state, "\n", 0);
+			psf_status(state, "From base path: ", 1);
+			psf_status(state, state->base_path, 0);
+			psf_status(state, "\n", 0);
 		}
+		return -1;
+	}
 
-		while (Z_OK != (zerr = uncompress(exe_decompressed_buffer, &exe_decompressed_size, exe_compressed_buffer, exe_compressed_size)))
-		{
-			void * try_exe_decompressed_buffer;
+	if (psf_want_status(state))
+	{
+		psf_status(state, "Opened file: ", 1);
+		psf_status(state, file_name, 0);
+		psf_status(state, "\n", 0);
+		psf_status(state, "From base path: ", 1);
+		psf_status(state, state->base_path, 0);
+		psf_status(state, "\n", 0);
+	}
+
+	version = psf_read_header(state, file, &file_size, &reserved_size, &exe_compressed_size, &exe_crc32, &tags);
+	if (version < 0) goto error_free_tags;
 
-			if (Z_MEM_ERROR != zerr && Z_BUF_ERROR != zerr)
+	if (tags && state->info_target && (state->depth == 1 || state->info_want_nested_tags))
+	{
+		tag = tags;
+		while (tag->next) tag = tag->next;
+		while (tag)
+		{
+			if (state->info_target(state->info_context, tag->name, tag->value))
 			{
-				psf_status(state, "Could not decompress exe section.\n", 1);
+				if (psf_want_status(state))
+				{
+					psf_status(state, "Caller rejected tag: ", 1);
+					psf_status(state, tag->name, 0);
+					psf_status(state, "=", 0);
+					psf_status(state, tag->value, 0);
+					psf_status(state, "\n", 0);
+				}
 				goto error_free_tags;
 			}
+			tag = tag->prev;
+		}
+	}
 
-			if (try_exe_decompressed_size < 1 * 1024 * 1024)
-				try_exe_decompressed_size += 1 * 1024 * 1024;
-			else
-				try_exe_decompressed_size += try_exe_decompressed_size;
+	if (!state->load_target) goto done;
 
-			exe_decompressed_size = try_exe_decompressed_size;
+	tag = find_tag(tags, "_lib");
+	if (tag)
+	{
+		if (psf_want_status(state))
+		{
+			psf_status(state, "Found _lib: ", 1);
+			psf_status(state, tag->value, 0);
+			psf_status(state, "\n", 0);
+		}
+		if (psf_load_internal(state, tag->value) < 0) goto error_free_tags;
+	}
 
-			try_exe_decompressed_buffer = realloc(exe_decompressed_buffer, exe_decompressed_size);
-			if (!try_exe_decompressed_buffer)
-			{
-				psf_status(state, "Out of memory reallocating buffer for decompressed exe section.\n", 1);
-				goto error_free_tags;
-			}
+	cached = state->depth > 1 ? psf_cache_find(full_path, file_size, reserved_size, exe_compressed_size, exe_crc32) : NULL;
+	if (cached && reserved_size)
+	{
+		if (psf_crc_reserved(state, file, reserved_size, &reserved_crc32) < 0) goto error_free_tags;
+		if (reserved_crc32 != cached->reserved_crc32)
+		{
+			psf_status(state, "Reserved section changed, dropping cached library.\n", 1);
+			psf_cache_free(cached);
+			cached = NULL;
+		}
+	}
+	if (cached)
+	{
+		state->file_callbacks->fclose(file);
+		file = NULL;
 
-			exe_decompressed_buffer = (uint8_t *)try_exe_decompressed_buffer;
+		psf_status(state, "Using cached library, file closed.\n", 1);
+
+		if (state->load_target(state->load_context, cached->exe, cached->exe_size, cached->reserved, cached->reserved_size))
+		{
+			psf_status(state, "Data handler returned an error.\n", 1);
+			goto error_free_tags;
 		}
 	}
 	else
 	{
-		exe_decompressed_size = 0;
-		exe_decompressed_buffer = (uint8_t *)malloc(exe_decompressed_size);
-		if (!exe_decompressed_buffer)
+		reserved_buffer = (uint8_t *)malloc(reserved_size);
+		if (!reserved_buffer)
 		{
-			psf_status(state, "Out of memory allocating dummy buffer for exe section.\n", 1);
+			psf_status(state, "Out of memory allocating buffer for reserved section.\n", 1);
 			goto error_free_tags;
 		}
-	}
 
-	free(exe_compressed_buffer);
-	exe_compressed_buffer = NULL;
+		if (state->file_callbacks->fseek(file, 16, SEEK_SET))
+		{
+			psf_status(state, "Could not seek back to main data section of file.", 1);
+			goto error_free_tags;
+		}
+		if (reserved_size && state->file_callbacks->fread(reserved_buffer, 1, reserved_size, file) < reserved_size)
+		{
+			psf_status(state, "Could not read reserved section.\n", 1);
+			goto error_free_tags;
+		}
+		reserved_crc32 = crc32(crc32(0L, Z_NULL, 0), reserved_buffer, reserved_size);
+
+		if (exe_compressed_size)
+		{
+			if (psf_inflate_exe(state, file, exe_compressed_size, exe_crc32, &exe_decompressed_buffer, &exe_decompressed_size) < 0)
+				goto error_free_tags;
+		}
+		else
+		{
+			exe_decompressed_size = 0;
+			exe_decompressed_buffer = (uint8_t *)malloc(exe_decompressed_size);
+			if (!exe_decompressed_buffer)
+			{
+				psf_status(state, "Out of memory allocating dummy buffer for exe section.\n", 1);
+				goto error_free_tags;
+			}
+		}
 
-	psf_status(state, "Passing exe and reserved back out.\n", 1);
+		state->file_callbacks->fclose(file);
+		file = NULL;
 
-	if (state->load_target(state->load_context, exe_decompressed_buffer, exe_decompressed_size, reserved_buffer, reserved_size))
-	{
-		psf_status(state, "Data handler returned an error.\n", 1);
-		goto error_free_tags;
-	}
+		psf_status(state, "File closed.\n", 1);
 
-	free(reserved_buffer);
-	reserved_buffer = NULL;
+		psf_status(state, "Passing exe and reserved back out.\n", 1);
 
-	free(exe_decompressed_buffer);
-	exe_decompressed_buffer = NULL;
+		if (state->load_target(state->load_context, exe_decompressed_buffer, exe_decompressed_size, reserved_buffer, reserved_size))
+		{
+			psf_status(state, "Data handler returned an error.\n", 1);
+			goto error_free_tags;
+		}
+
+		if (state->depth > 1 && psf_cache_insert(full_path, file_size, exe_compressed_size, exe_crc32,
+			exe_decompressed_buffer, exe_decompressed_size, reserved_buffer, reserved_size, reserved_crc32))
+		{
+			full_path = NULL;
+		}
+		else
+		{
+			free(reserved_buffer);
+			free(exe_decompressed_buffer);
+		}
+		reserved_buffer = NULL;
+		exe_decompressed_buffer = NULL;
+	}
 
 	n = 2;
 	snprintf(state->lib_name_temp, 31, "_lib%u", n);
@@ -723,17 +1101,97 @@ done:
 
 	free_tags(tags);
 
+	if (full_path) free(full_path);
+
 	--state->depth;
 
-	return header_buffer[3];
+	return version;
 
 error_free_tags:
 	free_tags(tags);
-error_free_buffers:
-	if (exe_compressed_buffer) free(exe_compressed_buffer);
 	if (exe_decompressed_buffer) free(exe_decompressed_buffer);
 	if (reserved_buffer) free(reserved_buffer);
-	if (tag_buffer) free(tag_buffer);
+	if (full_path) free(full_path);
+	if (file) state->file_callbacks->fclose(file);
+	return -1;
+}
+
+static int psf_scan_internal(psf_load_state * state, const char * file_name)
+{
+	psf_tag * tags = NULL;
+	psf_tag * tag;
+
+	void * file;
+
+	int n;
+
+	int missing = 0, rval;
+
+	long file_size;
+
+	uint32_t exe_compressed_size, exe_crc32, reserved_size;
+
+	if (++state->depth > max_recursion_depth)
+	{
+		psf_status(state, "Exceeded maximum file nesting depth.\n", 1);
+		return -1;
+	}
+
+	file = psf_open_file(state, file_name, NULL);
+
+	if (!file)
+	{
+		if (psf_want_status(state))
+		{
+			psf_status(state, "Missing file: ", 1);
+			psf_status(state, file_name, 0);
+			psf_status(state, "\n", 0);
+		}
+		--state->depth;
+		if (state->scan_target && state->scan_target(state->scan_context, file_name, 0)) return -1;
+		return 1;
+	}
+
+	if (state->scan_target && state->scan_target(state->scan_context, file_name, 1))
+		goto error_close_file;
+
+	if (psf_read_header(state, file, &file_size, &reserved_size, &exe_compressed_size, &exe_crc32, &tags) < 0)
+		goto error_close_file;
+
+	state->file_callbacks->fclose(file);
+	file = NULL;
+
+	tag = find_tag(tags, "_lib");
+	if (tag)
+	{
+		rval = psf_scan_internal(state, tag->value);
+		if (rval < 0) goto error_free_tags;
+		missing += rval;
+	}
+
+	n = 2;
+	snprintf(state->lib_name_temp, 31, "_lib%u", n);
+	state->lib_name_temp[31] = '\0';
+	tag = find_tag(tags, state->lib_name_temp);
+	while (tag)
+	{
+		rval = psf_scan_internal(state, tag->value);
+		if (rval < 0) goto error_free_tags;
+		missing += rval;
+		++n;
+		snprintf(state->lib_name_temp, 31, "_lib%u", n);
+		state->lib_name_temp[31] = '\0';
+		tag = find_tag(tags, state->lib_name_temp);
+	}
+
+	free_tags(tags);
+
+	--state->depth;
+
+	return missing;
+
+error_free_tags:
+	free_tags(tags);
 error_close_file:
 	if (file) state->file_callbacks->fclose(file);
 	return -1;
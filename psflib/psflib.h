@@ -97,6 +97,37 @@ int psf_load( const char * uri, const psf_file_callbacks * file_callbacks, uint8
               void * info_context, int info_want_nested_tags, psf_status_callback status_target,
               void * status_context);
 
+/* Libraries loaded through psf_load, that is every file of the chain but the outermost one,
+ * stay decompressed in a process wide cache, so loading another file of the same set only
+ * reads the file itself, and the reserved sections of its libraries to check that they
+ * did not change. The least recently used libraries are dropped once the cache holds
+ * more than max_bytes, 32MB by default; zero disables caching.
+ *
+ * Neither the cache nor these functions are thread safe.
+ */
+void psf_set_cache_size( size_t max_bytes );
+
+/* Drops every cached library. */
+void psf_cache_clear( void );
+
+/* Receives the name of every file in the chain, as written in the _lib tags and relative to
+ * the directory of the outermost file, in the same order psf_load would open them. present
+ * is zero for files which could not be opened; their own libraries can not be known yet.
+ *
+ * Returning non-zero indicates an error.
+ */
+typedef int (* psf_scan_callback)(void * context, const char * file_name, int present);
+
+/* Walks the PSF chain starting with uri like psf_load, but only reads headers and tags, so
+ * a caller which fetches files on demand can request every missing library at once before
+ * loading. Scanning again after fetching reveals the libraries of those files, if any.
+ *
+ * Returns negative on error, otherwise the number of files which could not be opened.
+ */
+int psf_scan( const char * uri, const psf_file_callbacks * file_callbacks, uint8_t allowed_version,
+              psf_scan_callback scan_target, void * scan_context, psf_status_callback status_target,
+              void * status_context);
+
 #ifdef __cplusplus
 }
 #endif
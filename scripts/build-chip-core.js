@@ -19,6 +19,7 @@ const chipModules = [
       // ---- Visualizer functions: ----
       '_cqt_init',
       '_cqt_calc',
+      '_cqt_swap',
       '_cqt_render_line',
       '_cqt_bin_to_freq',
     ],
@@ -163,6 +164,9 @@ const chipModules = [
       'Sgc_Impl.cpp',
       'Sms_Apu.cpp',
       'Sms_Fm_Apu.cpp',
+      'Snes_Spc.cpp',
+      'Spc_Cpu.cpp',
+      'Spc_Dsp.cpp',
       'Spc_Emu.cpp',
       'Spc_Filter.cpp',
       'Spc_Sfm.cpp',
@@ -178,8 +182,8 @@ const chipModules = [
       'Ym2608_Emu.cpp',
       'Ym2610b_Emu.cpp',
       'Ym2612_Emu.cpp',
-      // 'Ym2612_Emu_MAME.cpp',
-      // 'Ym2612_Emu_Gens.cpp',
+      'Ym2612_GENS.cpp',
+      'Ym2612_Nuked.cpp',
       'Ym3812_Emu.cpp',
       'ymdeltat.cpp',
       'Ymf262_Emu.cpp',
@@ -189,7 +193,9 @@ const chipModules = [
     ].map(file => 'game-music-emu/gme/' + file),
     exportedFunctions: [
       '_gme_open_data',
+      '_gme_open_info_data',
       '_gme_play',
+      '_gme_play_float_planar',
       '_gme_delete',
       '_gme_mute_voices',
       '_gme_track_count',
@@ -200,15 +206,14 @@ const chipModules = [
       '_gme_open_data',
       '_gme_ignore_silence',
       '_gme_set_tempo',
+      '_gme_set_spc_engine',
+      '_gme_set_ym2612_core',
       '_gme_seek_scaled',
       '_gme_tell_scaled',
       '_gme_set_fade',
       '_gme_voice_name',
     ],
     flags: [
-      '-DVGM_YM2612_MAME=1',     // fast and accurate, but suffers on some GYM files
-      // '-DVGM_YM2612_NUKED=1', // slow but very accurate
-      // '-DVGM_YM2612_GENS=1',  // very fast but inaccurate
       '-DHAVE_ZLIB_H',           // used by game_music_emu for vgz and lazyusf2 for psf
       '-DHAVE_STDINT_H',
     ],
@@ -267,7 +272,10 @@ const chipModules = [
       'chips/dosbox_opl3.cpp',
       'chips/dosbox/dbopl.cpp',
       'wopl/wopl_file.c',
-      'adldata.cpp',
+      // The banks are loaded at run time from public/adlbanks.bin, which is
+      // made by gen_adldata --blob (cmake -DWITH_GENADLDATA=ON
+      // -DWITH_EMBEDDED_BANKS_BLOB=ON in libADLMIDI, target gen-adldata-blob-run)
+      'adldata_blob.cpp',
       'adlmidi.cpp',
       'adlmidi_load.cpp',
       'adlmidi_midiplay.cpp',
@@ -281,6 +289,7 @@ const chipModules = [
       '_adl_getBankNames',
       '_adl_getBanksCount',
       '_adl_setBank',
+      '_adl_setEmbeddedBanksData',
       '_adl_getNumChips',
       '_adl_setNumChips',
       '_adl_setSoftPanEnabled',
@@ -300,6 +309,7 @@ const chipModules = [
       '-DADLMIDI_DISABLE_NUKED_EMULATOR',
       '-DADLMIDI_DISABLE_JAVA_EMULATOR',
       '-DADLMIDI_DISABLE_OPAL_EMULATOR',
+      '-DADLMIDI_EMBEDDED_BANKS_BLOB',
       // '-DADLMIDI_DISABLE_DOSBOX_EMULATOR', // DOSBOX is recommended OPL3 core
     ],
   },
@@ -344,6 +354,7 @@ const chipModules = [
     ],
     exportedFunctions: [
       '_n64_load_file',
+      '_n64_scan_file',
       '_n64_get_duration_ms',
       '_n64_get_position_ms',
       '_n64_seek_ms',
@@ -360,6 +371,37 @@ const chipModules = [
       '-fno-strict-aliasing',
     ],
   },
+  {
+    // One interface over the engines above. Without pthreads there is no
+    // producer thread: call _cp_fill outside of the audio callback.
+    name: 'chipplayer',
+    enabled: true,
+    sourceFiles: [
+      'chipplayer/chipplayer.cpp',
+    ],
+    exportedFunctions: [
+      '_cp_create',
+      '_cp_destroy',
+      '_cp_identify',
+      '_cp_engine_name',
+      '_cp_load_soundfont',
+      '_cp_open',
+      '_cp_close',
+      '_cp_get_error',
+      '_cp_get_engine',
+      '_cp_render',
+      '_cp_fill',
+      '_cp_seek_ms',
+      '_cp_get_position_ms',
+      '_cp_get_duration_ms',
+      '_cp_track_ended',
+      '_cp_get_underruns',
+    ],
+    flags: [
+      '-Igame-music-emu/gme',
+      '-Ilibxmp/include',
+    ],
+  },
 ];
 
 const compiler = process.env.EMPP_BIN || 'em++';
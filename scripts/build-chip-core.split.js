@@ -24,6 +24,7 @@ emccModules = [
       // From showcqtbar.c
       '_cqt_init',
       '_cqt_calc',
+      '_cqt_swap',
       '_cqt_render_line',
       '_cqt_bin_to_freq',
       '_calloc',
@@ -142,6 +143,9 @@ emccModules = [
       'Sgc_Impl.cpp',
       'Sms_Apu.cpp',
       'Sms_Fm_Apu.cpp',
+      'Snes_Spc.cpp',
+      'Spc_Cpu.cpp',
+      'Spc_Dsp.cpp',
       'Spc_Emu.cpp',
       'Spc_Filter.cpp',
       'Spc_Sfm.cpp',
@@ -157,8 +161,8 @@ emccModules = [
       'Ym2608_Emu.cpp',
       'Ym2610b_Emu.cpp',
       'Ym2612_Emu.cpp',
-      // 'Ym2612_Emu_MAME.cpp',
-      // 'Ym2612_Emu_Gens.cpp',
+      'Ym2612_GENS.cpp',
+      'Ym2612_Nuked.cpp',
       'Ym3812_Emu.cpp',
       'ymdeltat.cpp',
       'Ymf262_Emu.cpp',
@@ -169,6 +173,7 @@ emccModules = [
     exportedFunctions: [
       '_gme_open_data',
       '_gme_play',
+      '_gme_play_float_planar',
       '_gme_delete',
       '_gme_mute_voices',
       '_gme_track_count',
@@ -179,6 +184,8 @@ emccModules = [
       '_gme_open_data',
       '_gme_ignore_silence',
       '_gme_set_tempo',
+      '_gme_set_spc_engine',
+      '_gme_set_ym2612_core',
       '_gme_seek_scaled',
       '_gme_tell_scaled',
       '_gme_set_fade',
@@ -186,9 +193,6 @@ emccModules = [
     ],
     flags: [
       '-s', 'USE_ZLIB=1',
-      // '-DVGM_YM2612_NUKED=1', // slow but very accurate
-      // '-DVGM_YM2612_GENS=1',  // very fast but inaccurate
-      '-DVGM_YM2612_MAME=1',     // fast and accurate, but suffers on some GYM files
       '-DHAVE_ZLIB_H',
       '-DHAVE_STDINT_H',
     ],
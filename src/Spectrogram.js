@@ -154,6 +154,7 @@ export default class Spectrogram {
       analyserNode.getFloatTimeDomainData(dataHeap);
       if (!dataHeap.every(n => n === 0)) {
         this.lib._cqt_calc(this.dataPtr, this.dataPtr);
+        this.lib._cqt_swap();
         this.lib._cqt_render_line(this.dataPtr);
         // copy output to canvas
         for (let x = 0; x < canvasWidth; x++) {
@@ -4,7 +4,6 @@ import {allOrNone} from '../util';
 
 let emu = null;
 let libgme = null;
-const INT16_MAX = 65535;
 const fileExtensions = [
   'nsf',
   'nsfe',
@@ -31,7 +30,8 @@ export default class GMEPlayer extends Player {
     this.tempo = 1.0;
     this.params = { subbass: 1 };
 
-    this.buffer = libgme.allocate(this.bufferSize * 16, 'i16', libgme.ALLOC_NORMAL);
+    // Planar float output: left channel, then right channel
+    this.buffer = libgme.allocate(this.bufferSize * 2, 'float', libgme.ALLOC_NORMAL);
     this.emuPtr = libgme.allocate(1, 'i32', libgme.ALLOC_NORMAL);
 
     this.subBass = new SubBass(audioCtx.sampleRate);
@@ -60,15 +60,17 @@ export default class GMEPlayer extends Player {
     }
 
     if (libgme._gme_track_ended(emu) !== 1) {
-      libgme._gme_play(emu, this.bufferSize * 2, this.buffer);
+      libgme._gme_play_float_planar(emu, this.bufferSize, this.buffer, this.buffer + this.bufferSize * 4);
 
+      // HEAPF32 may be replaced when memory grows, so look it up on every call.
+      // Samples come back at full scale; halve them to keep the level of the
+      // old int16 / 65535 conversion.
+      const heap = libgme.HEAPF32;
+      const offset = this.buffer >> 2;
       for (channel = 0; channel < channels.length; channel++) {
+        const start = offset + Math.min(channel, 1) * this.bufferSize;
         for (i = 0; i < this.bufferSize; i++) {
-          channels[channel][i] = libgme.getValue(this.buffer +
-            // Interleaved channel format
-            i * 2 * 2 +             // frame offset   * bytes per sample * num channels +
-            channel * 2,            // channel offset * bytes per sample
-            'i16') / INT16_MAX;     // convert int16 to float
+          channels[channel][i] = heap[start + i] * 0.5;
         }
       }
 
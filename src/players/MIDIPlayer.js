@@ -199,18 +199,33 @@ export default class MIDIPlayer extends Player {
       },
     });
 
-    // Populate OPL3 banks
-    const numBanks = lib._adl_getBanksCount();
-    const ptr = lib._adl_getBankNames();
-    const oplBanks = [];
-    for (let i = 0; i < numBanks; i++) {
-      oplBanks.push({
-        label: lib.UTF8ToString(lib.getValue(ptr + i * 4, '*')),
-        value: i,
-      });
-    }
-    this.paramDefs.find(def => def.id === 'opl3bank').options =
-      [{ label: 'OPL3 Bank', items: oplBanks }];
+    // The OPL3 banks aren't built into chip-core: load the compressed bank set
+    // made by gen_adldata --blob, then list its banks
+    fetch(process.env.PUBLIC_URL + '/adlbanks.bin')
+      .then(response => response.arrayBuffer())
+      .then(buffer => {
+        // libADLMIDI decompresses banks out of this memory, so it is never freed
+        const data = new Uint8Array(buffer);
+        const ptr = lib._malloc(data.length);
+        lib.HEAPU8.set(data, ptr);
+        if (lib._adl_setEmbeddedBanksData(ptr, data.length) !== 0) {
+          throw Error('Invalid OPL3 bank set');
+        }
+
+        const numBanks = lib._adl_getBanksCount();
+        const namesPtr = lib._adl_getBankNames();
+        const oplBanks = [];
+        for (let i = 0; i < numBanks; i++) {
+          oplBanks.push({
+            label: lib.UTF8ToString(lib.getValue(namesPtr + i * 4, '*')),
+            value: i,
+          });
+        }
+        this.paramDefs.find(def => def.id === 'opl3bank').options =
+          [{ label: 'OPL3 Bank', items: oplBanks }];
+        this.setParameter('opl3bank', this.params['opl3bank']);
+      })
+      .catch(err => console.error('Unable to load OPL3 banks.', err));
 
     // Initialize MIDI output devices
     if (typeof navigator.requestMIDIAccess === 'function') {
@@ -337,8 +352,9 @@ export default class MIDIPlayer extends Player {
     }
 
     // Crude bank matching for a few specific games. :D
+    // The banks are missing until adlbanks.bin has been loaded
     const opl3def = this.paramDefs.find(def => def.id === 'opl3bank');
-    if (opl3def) {
+    if (opl3def && opl3def.options.length > 0) {
       const opl3banks = opl3def.options[0].items;
       const findBank = (str) => opl3banks.findIndex(bank => bank.label.indexOf(str) > -1);
       let bankId = 0;
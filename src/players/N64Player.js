@@ -34,24 +34,38 @@ export default class N64Player extends Player {
     this.filepathMeta = Player.metadataFromFilepath(filename);
 
     const miniusfStr = String.fromCharCode.apply(null, data);
-    const usflibs = miniusfStr.match(/_lib=([^\s]+)/).slice(1);
-    if (usflibs.length === 0) {
+    if (!/_lib=[^\s]+/.test(miniusfStr)) {
       throw new Error(`No .usflib references found in ${filename}`);
     }
 
     const dir = path.dirname(filename);
     const fsFilename = path.join(MOUNTPOINT, filename);
-    const promises = [
-      ensureEmscFileWithData(this.lib, fsFilename, data),
-      ...usflibs.map(usflib => {
+
+    // Every scan reports all libraries missing so far; fetch them together
+    // and scan again, since a library may reference further libraries.
+    // A library that is still missing after being fetched can't be used.
+    const fetched = new Set();
+    const fetchMissingLibs = () => {
+      const missing = this.lib.ccall('n64_scan_file', 'string', ['string'], [fsFilename]);
+      const usflibs = missing.split('\n').filter(usflib => usflib);
+      if (usflibs.length === 0) {
+        return fsFilename;
+      }
+      const unusable = usflibs.find(usflib => fetched.has(usflib));
+      if (unusable) {
+        return Promise.reject(new Error(`Unable to load ${unusable} referenced by ${filename}`));
+      }
+      return Promise.all(usflibs.map(usflib => {
         const fsFilename = path.join(MOUNTPOINT, dir, usflib);
         const url = CATALOG_PREFIX + path.join(dir, usflib);
+        fetched.add(usflib);
         return ensureEmscFileWithUrl(this.lib, fsFilename, url);
-      }),
-    ];
+      })).then(fetchMissingLibs);
+    };
 
-    Promise.all(promises)
-      .then(([fsFilename]) => {
+    ensureEmscFileWithData(this.lib, fsFilename, data)
+      .then(fetchMissingLibs)
+      .then((fsFilename) => {
         this.muteAudioDuringCall(this.audioNode, () => {
           err = this.lib.ccall(
             'n64_load_file', 'number',
@@ -35,6 +35,14 @@
 #include <math.h>
 #include <stdint.h>
 
+#if !defined(CQT_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#include <emmintrin.h>
+#define CQT_SSE2
+#elif !defined(CQT_NO_SIMD) && defined(__wasm_simd128__)
+#include <wasm_simd128.h>
+#define CQT_WASM_SIMD
+#endif
+
 #define MAX_FFT_SIZE 32768
 #define MAX_WIDTH 1920
 #define MAX_KERNEL_SIZE 200000
@@ -61,13 +69,17 @@ typedef struct ShowCQT {
 
   /* buffers */
   Complex fft_buf[MAX_FFT_SIZE];
-  float color_buf[MAX_WIDTH * 2];
+  // cqt_calc() writes the back buffer, cqt_render_line() reads the front one
+  float color_buf[2][MAX_WIDTH * 2];
+  int color_front;
 
   /* props */
   int width;
   int fft_size;
   int out_bins; // kernel table size?
   int attack_size; // num samples in 1/30th of a second
+  int bin_lo; // range of fft bins read by the kernel
+  int bin_hi;
   float volume;
   float basefreq;
   float endfreq;
@@ -124,6 +136,74 @@ static void gen_exp_tbl(int n) {
 #define C_AIM(a, b) (Complex){ (a).re - (b).im, (a).im + (b).re }
 #define C_SIM(a, b) (Complex){ (a).re + (b).im, (a).im - (b).re }
 
+#if defined(CQT_SSE2) || defined(CQT_WASM_SIMD)
+// Two complex numbers per vector, as {re, im, re, im}
+#ifdef CQT_SSE2
+typedef __m128 cqt_v2c;
+#define V_LOAD(p) _mm_loadu_ps((const float *)(p))
+#define V_STORE(p, a) _mm_storeu_ps((float *)(p), a)
+#define V_ADD(a, b) _mm_add_ps(a, b)
+#define V_SUB(a, b) _mm_sub_ps(a, b)
+#define V_MUL(a, b) _mm_mul_ps(a, b)
+#define V_XOR(a, b) _mm_xor_ps(a, b)
+#define V_SIGNS(re, im) _mm_setr_ps(re, im, re, im)
+#define V_DUP_RE(a) _mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 2, 0, 0))
+#define V_DUP_IM(a) _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 3, 1, 1))
+#define V_SWAP(a) _mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 3, 0, 1))
+#else
+typedef v128_t cqt_v2c;
+#define V_LOAD(p) wasm_v128_load(p)
+#define V_STORE(p, a) wasm_v128_store(p, a)
+#define V_ADD(a, b) wasm_f32x4_add(a, b)
+#define V_SUB(a, b) wasm_f32x4_sub(a, b)
+#define V_MUL(a, b) wasm_f32x4_mul(a, b)
+#define V_XOR(a, b) wasm_v128_xor(a, b)
+#define V_SIGNS(re, im) wasm_f32x4_make(re, im, re, im)
+#define V_DUP_RE(a) wasm_i32x4_shuffle(a, a, 0, 0, 2, 2)
+#define V_DUP_IM(a) wasm_i32x4_shuffle(a, a, 1, 1, 3, 3)
+#define V_SWAP(a) wasm_i32x4_shuffle(a, a, 1, 0, 3, 2)
+#endif
+
+// The same operations as C_MUL, C_SIM and C_AIM, so the results are the same
+// bit for bit: negating with the sign bit and then adding is subtracting.
+static inline cqt_v2c v_mul(cqt_v2c a, cqt_v2c b) {
+  return V_ADD(V_MUL(V_DUP_RE(a), b), V_XOR(V_MUL(V_DUP_IM(a), V_SWAP(b)), V_SIGNS(-0.0f, 0.0f)));
+}
+
+static inline cqt_v2c v_sim(cqt_v2c a, cqt_v2c b) {
+  return V_ADD(a, V_XOR(V_SWAP(b), V_SIGNS(0.0f, -0.0f)));
+}
+
+static inline cqt_v2c v_aim(cqt_v2c a, cqt_v2c b) {
+  return V_ADD(a, V_XOR(V_SWAP(b), V_SIGNS(-0.0f, 0.0f)));
+}
+
+// The butterflies of FFT_CALC_FUNC for x and x + 1 at once. The twiddles for
+// x = 0 are 1, so that pair needs no special case.
+#define FFT_PAIRS(q) ((q) >= 2)
+static inline void fft_butterfly_pairs(Complex *v, int q, const Complex *e1,
+                                       const Complex *e2, const Complex *e3) {
+  for (int x = 0; x < q; x += 2) {
+    cqt_v2c v0 = V_LOAD(v + x);
+    cqt_v2c v2 = v_mul(V_LOAD(e2 + x), V_LOAD(v + q + x)); /* bit reversed */
+    cqt_v2c v1 = v_mul(V_LOAD(e1 + x), V_LOAD(v + 2 * q + x));
+    cqt_v2c v3 = v_mul(V_LOAD(e3 + x), V_LOAD(v + 3 * q + x));
+    cqt_v2c a02 = V_ADD(v0, v2);
+    cqt_v2c s02 = V_SUB(v0, v2);
+    cqt_v2c a13 = V_ADD(v1, v3);
+    cqt_v2c s13 = V_SUB(v1, v3);
+    V_STORE(v + x, V_ADD(a02, a13));
+    V_STORE(v + q + x, v_sim(s02, s13));
+    V_STORE(v + 2 * q + x, V_SUB(a02, a13));
+    V_STORE(v + 3 * q + x, v_aim(s02, s13));
+  }
+}
+#else
+#define FFT_PAIRS(q) 0
+static inline void fft_butterfly_pairs(Complex *v, int q, const Complex *e1,
+                                       const Complex *e2, const Complex *e3) {}
+#endif
+
 #define FFT_CALC_FUNC(n, q)                                                     \
 static void fft_calc_ ## n(Complex * v)                                 \
 {                                                                               \
@@ -137,6 +217,10 @@ static void fft_calc_ ## n(Complex * v)                                 \
     fft_calc_ ## q(q+v);                                                        \
     fft_calc_ ## q(2*q+v);                                                      \
     fft_calc_ ## q(3*q+v);                                                      \
+    if (FFT_PAIRS(q)) {                                                         \
+        fft_butterfly_pairs(v, q, e1, e2, e3);                                  \
+        return;                                                                 \
+    }                                                                           \
                                                                                 \
     v0 = v[0];                                                                  \
     v2 = v[q]; /* bit reversed */                                               \
@@ -245,6 +329,8 @@ int cqt_init(int rate, int width, float volume, float freq_min, float freq_max,
   }
 
   cqt.out_bins = cqt.width * (1 + !!super);
+  cqt.bin_lo = 0;
+  cqt.bin_hi = 0;
   double log_base = log(cqt.basefreq);
   double log_end = log(cqt.endfreq);
   for (int f = 0, idx = 0; f < cqt.out_bins; f++) {
@@ -272,6 +358,8 @@ int cqt_init(int rate, int width, float volume, float freq_min, float freq_max,
       return 0;
     cqt.kernel[idx].i = len;
     cqt.kernel[idx + 1].i = start;
+    if (start < cqt.bin_lo) cqt.bin_lo = start;
+    if (end > cqt.bin_hi) cqt.bin_hi = end;
 
     for (int x = start; x <= end; x++) {
       int sign = (x & 1) ? (-1) : 1;
@@ -286,7 +374,69 @@ int cqt_init(int rate, int width, float volume, float freq_min, float freq_max,
   return cqt.fft_size;
 }
 
-void cqt_calc(const float *input_L, const float *input_R) {
+// Bin k of the fft_size point transform of real input, from the fft_size/2 point
+// transform of the same input packed as {even, odd} sample pairs.
+// Only valid for -fft_size/4 < k < fft_size/4, like the twiddles in exp_tbl.
+static inline Complex real_fft_bin(const Complex *z, int k) {
+  int m = cqt.fft_size >> 1;
+  int neg = k < 0;
+  if (neg) k = -k;
+  Complex zk = z[k];
+  Complex zc = z[(m - k) & (m - 1)];
+  Complex e = cqt.exp_tbl[cqt.fft_size + k];
+  Complex even = {0.5f * (zk.re + zc.re), 0.5f * (zk.im - zc.im)};
+  Complex odd = {0.5f * (zk.im + zc.im), 0.5f * (zc.re - zk.re)};
+  Complex x = C_ADD(even, C_MUL(e, odd));
+  if (neg) x.im = -x.im;
+  return x;
+}
+
+// Mono input is real, so its spectrum is conjugate symmetric. Run a half size
+// complex FFT of the samples packed in pairs, then untangle only the bins the
+// kernel reads, into the upper half of fft_buf which that FFT leaves unused.
+// The mirrored sum of the stereo case is just the conjugate here.
+static void cqt_calc_mono(const float *input, float *out) {
+  int fft_size_h = cqt.fft_size >> 1;
+  int fft_size_q = cqt.fft_size >> 2;
+  int shift = fft_size_h - cqt.attack_size;
+  Complex *spec = cqt.fft_buf + fft_size_h + (cqt.fft_size >> 3);
+
+  for (int x = 0; x < fft_size_q; x++) {
+    int i = 2 * cqt.reversed_bit_tbl[x];
+    int t = 2 * x;
+    cqt.fft_buf[i] = (Complex) {input[shift + t], input[shift + t + 1]};
+    cqt.fft_buf[i + 1] = (Complex) {
+        t < cqt.attack_size ? cqt.attack_tbl[t] * input[fft_size_h + shift + t] : 0,
+        t + 1 < cqt.attack_size ? cqt.attack_tbl[t + 1] * input[fft_size_h + shift + t + 1] : 0
+    };
+  }
+
+  fft_calc(cqt.fft_buf, fft_size_h);
+
+  for (int k = cqt.bin_lo; k <= cqt.bin_hi; k++)
+    spec[k] = real_fft_bin(cqt.fft_buf, k);
+
+  for (int x = 0, m = 0; x < cqt.out_bins; x++) {
+    int len = cqt.kernel[m].i;
+    int start = cqt.kernel[m + 1].i;
+    if (!len) {
+      out[x] = 0;
+      continue;
+    }
+    const Complex *v = spec + start;
+    const Kernel *u = cqt.kernel + m + 2;
+    float re = 0, im = 0;
+    for (int y = 0; y < len; y++) {
+      re += u[y].f * v[y].re;
+      im += u[y].f * v[y].im;
+    }
+    out[x] = sqrtf(cqt.volume * sqrtf(2.0f * (re * re + im * im)));
+
+    m += len + 2;
+  }
+}
+
+static void cqt_calc_complex(const float *input_L, const float *input_R, float *out) {
   int fft_size_h = cqt.fft_size >> 1;
   int fft_size_q = cqt.fft_size >> 2;
   int shift = fft_size_h - cqt.attack_size;
@@ -333,7 +483,7 @@ void cqt_calc(const float *input_L, const float *input_R) {
     int len = cqt.kernel[m].i;
     int start = cqt.kernel[m + 1].i;
     if (!len) {
-      cqt.color_buf[x] = 0;
+      out[x] = 0;
       continue;
     }
     Complex a = {0, 0}, b = {0, 0};
@@ -354,22 +504,40 @@ void cqt_calc(const float *input_L, const float *input_R) {
     Complex v1 = {b.im + a.im, b.re - a.re};
     float r1 = v1.re * v1.re + v1.im * v1.im;
 
-    cqt.color_buf[x] = sqrtf(cqt.volume * sqrtf(0.5f * (r0 + r1)));
+    out[x] = sqrtf(cqt.volume * sqrtf(0.5f * (r0 + r1)));
 
     m += len + 2;
   }
+}
+
+// Analyzes a frame into the back buffer. The line returned by
+// cqt_render_line() stays the same until cqt_swap().
+void cqt_calc(const float *input_L, const float *input_R) {
+  float *out = cqt.color_buf[!cqt.color_front];
+
+  if ((!input_R || input_L == input_R) &&
+      cqt.bin_lo > -(cqt.fft_size >> 3) && cqt.bin_hi < (cqt.fft_size >> 2))
+    cqt_calc_mono(input_L, out);
+  else
+    cqt_calc_complex(input_L, input_R, out);
 
   // supersampling case
   if (cqt.out_bins != cqt.width) {
     for (int x = 0; x < cqt.width; x++) {
-      cqt.color_buf[x] = 0.5f * (cqt.color_buf[2 * x] + cqt.color_buf[2 * x + 1]);
+      out[x] = 0.5f * (out[2 * x] + out[2 * x + 1]);
     }
   }
 }
 
+// Makes the frame of the last cqt_calc() the one cqt_render_line() returns
+void cqt_swap(void) {
+  cqt.color_front = !cqt.color_front;
+}
+
 void cqt_render_line(float *out) {
+  const float *front = cqt.color_buf[cqt.color_front];
   for (int x = 0; x < cqt.width; x++)
-    out[x] = cqt.color_buf[x];
+    out[x] = front[x];
 }
 
 void cqt_set_volume(float volume) {
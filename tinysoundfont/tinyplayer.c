@@ -5,11 +5,19 @@
 // Uses synth engines from libFluidSynth and libADLMIDI.
 // Created by Matt Montag on 9/4/18.
 //
+// All playback state lives in a TinyPlayer context, so several streams can be
+// rendered side by side (one context per thread). The tp_* functions without a
+// context argument drive the default context created by tp_init and are what
+// the JavaScript player uses.
+//
 #define TML_NO_STDIO
 #define TML_IMPLEMENTATION
 
 #include <math.h>
+#include <stdlib.h>
+#ifdef __EMSCRIPTEN__
 #include <emscripten.h>
+#endif
 #include "tml.h"
 #include "../fluidlite/include/fluidlite.h"
 #include "../libADLMIDI/include/adlmidi.h"
@@ -19,225 +27,251 @@ extern "C" {
 #endif
 
 //TODO: Remove debug logging (EM_ASM_)
-fluid_synth_t *g_FluidSynth; // instance of FluidSynth
-struct ADL_MIDIPlayer *g_adlSynth;
-struct ADLMIDI_AudioFormat adl_AudioFormat = {
+static const struct ADLMIDI_AudioFormat adl_AudioFormat = {
         ADLMIDI_SampleType_F32,
         sizeof(float_t),
         2 * sizeof(float_t),
 };
-tml_message *g_MidiEvt;      // next message to be played
-tml_message *g_FirstEvt;     // first event in current file
-double g_MidiTimeMs;         // current playback time
-double g_Speed = 1.0;
-int g_SampleRate;
-unsigned int g_DurationMs = 0;
-char g_ChannelsInUse[16];
-char g_ChannelsMuted[16];
-int g_ChannelProgramNums[16];
-short g_shortBuffer[4096];
-int tp_set_synth_engine(int);
+
+typedef struct TinyPlayer TinyPlayer;
 
 typedef struct Synth {
-  void (*noteOn)(int channel, int key, int velocity);
-  void (*noteOff)(int channel, int key);
-  void (*programChange)(int channel, int program);
-  void (*pitchBend)(int channel, int value);
-  void (*controlChange)(int channel, int control, int value);
-  void (*channelPressure)(int channel, int value);
-  void (*render)(float *buffer, int samples);
-  void (*panic)();
-  void (*panicChannel)(int channel);
-  void (*reset)();
+  void (*noteOn)(TinyPlayer *tp, int channel, int key, int velocity);
+  void (*noteOff)(TinyPlayer *tp, int channel, int key);
+  void (*programChange)(TinyPlayer *tp, int channel, int program);
+  void (*pitchBend)(TinyPlayer *tp, int channel, int value);
+  void (*controlChange)(TinyPlayer *tp, int channel, int control, int value);
+  void (*channelPressure)(TinyPlayer *tp, int channel, int value);
+  void (*render)(TinyPlayer *tp, float *buffer, int samples);
+  void (*panic)(TinyPlayer *tp);
+  void (*panicChannel)(TinyPlayer *tp, int channel);
+  void (*reset)(TinyPlayer *tp);
 } Synth;
 
-int g_synthId = 0;
-static const int NUM_SYNTHS = 2;
-Synth g_Synths[NUM_SYNTHS];
-Synth g_synth;
+#define NUM_SYNTHS 2
+
+struct TinyPlayer {
+  fluid_settings_t *fluidSettings;
+  fluid_synth_t *fluidSynth;   // instance of FluidSynth
+  struct ADL_MIDIPlayer *adlSynth;
+  tml_events *events;          // messages of the current file ordered by time
+  unsigned int nextEvt;        // index of the next message to be played
+  double midiTimeMs;           // current playback time
+  double speed;
+  int sampleRate;
+  unsigned int durationMs;
+  char channelsInUse[16];
+  char channelsMuted[16];
+  int channelProgramNums[16];
+  int synthId;
+  Synth synth;
+};
+
+static TinyPlayer *g_Player; // default context used by the context-free API
+
+// Returns the next message to be played, or NULL if there are none left.
+static const tml_event *next_event(TinyPlayer *tp) {
+  return tp->events && tp->nextEvt < tp->events->count ? &tp->events->events[tp->nextEvt] : NULL;
+}
 
 // Fluid Synth *********************************************
 
-void fluidNoteOn(int channel, int key, int velocity) {
-  fluid_synth_noteon(g_FluidSynth, channel, key, velocity);
+static void fluidNoteOn(TinyPlayer *tp, int channel, int key, int velocity) {
+  fluid_synth_noteon(tp->fluidSynth, channel, key, velocity);
 }
-void fluidNoteOff(int channel, int key) {
-  fluid_synth_noteoff(g_FluidSynth, channel, key);
+static void fluidNoteOff(TinyPlayer *tp, int channel, int key) {
+  fluid_synth_noteoff(tp->fluidSynth, channel, key);
 }
-void fluidProgramChange(int channel, int program) {
-  fluid_synth_program_change(g_FluidSynth, channel, program);
+static void fluidProgramChange(TinyPlayer *tp, int channel, int program) {
+  fluid_synth_program_change(tp->fluidSynth, channel, program);
 }
-void fluidPitchBend(int channel, int pitch) {
-  fluid_synth_pitch_bend(g_FluidSynth, channel, pitch);
+static void fluidPitchBend(TinyPlayer *tp, int channel, int pitch) {
+  fluid_synth_pitch_bend(tp->fluidSynth, channel, pitch);
 }
-void fluidControlChange(int channel, int control, int value) {
-  fluid_synth_cc(g_FluidSynth, channel, control, value);
+static void fluidControlChange(TinyPlayer *tp, int channel, int control, int value) {
+  fluid_synth_cc(tp->fluidSynth, channel, control, value);
 }
-void fluidChannelPressure(int channel, int value) {
-  fluid_synth_channel_pressure(g_FluidSynth, channel, value);
+static void fluidChannelPressure(TinyPlayer *tp, int channel, int value) {
+  fluid_synth_channel_pressure(tp->fluidSynth, channel, value);
 }
-void fluidRender(float *buffer, int samples) {
+static void fluidRender(TinyPlayer *tp, float *buffer, int samples) {
   int frames = samples / 2;
-  fluid_synth_write_float(g_FluidSynth, frames, buffer, 0, 2, buffer, 1, 2); // interleaved stereo
+  fluid_synth_write_float(tp->fluidSynth, frames, buffer, 0, 2, buffer, 1, 2); // interleaved stereo
 }
-void fluidPanic() {
+static void fluidPanic(TinyPlayer *tp) {
   for (int i = 0; i < 16; i++)
-    fluid_synth_all_notes_off(g_FluidSynth, i);
+    fluid_synth_all_notes_off(tp->fluidSynth, i);
 }
-void fluidPanicChannel(int channel) {
-  fluid_synth_all_notes_off(g_FluidSynth, channel);
+static void fluidPanicChannel(TinyPlayer *tp, int channel) {
+  fluid_synth_all_notes_off(tp->fluidSynth, channel);
 }
-void fluidReset() {
-  fluid_synth_system_reset(g_FluidSynth);
-  fluid_synth_program_reset(g_FluidSynth);
+static void fluidReset(TinyPlayer *tp) {
+  fluid_synth_system_reset(tp->fluidSynth);
+  fluid_synth_program_reset(tp->fluidSynth);
 }
-Synth fluidSynth = {fluidNoteOn, fluidNoteOff, fluidProgramChange, fluidPitchBend, fluidControlChange,
-                    fluidChannelPressure, fluidRender, fluidPanic, fluidPanicChannel, fluidReset};
+static const Synth fluidSynth = {fluidNoteOn, fluidNoteOff, fluidProgramChange, fluidPitchBend, fluidControlChange,
+                                 fluidChannelPressure, fluidRender, fluidPanic, fluidPanicChannel, fluidReset};
 
 // ADL OPL3 Synth *********************************************
 
-void adlNoteOn(int channel, int key, int velocity) {
-  adl_rt_noteOn(g_adlSynth, channel, key, velocity);
+static void adlNoteOn(TinyPlayer *tp, int channel, int key, int velocity) {
+  adl_rt_noteOn(tp->adlSynth, channel, key, velocity);
 }
-void adlNoteOff(int channel, int key) {
-  adl_rt_noteOff(g_adlSynth, channel, key);
+static void adlNoteOff(TinyPlayer *tp, int channel, int key) {
+  adl_rt_noteOff(tp->adlSynth, channel, key);
 }
-void adlProgramChange(int channel, int program) {
-  adl_rt_patchChange(g_adlSynth, channel, program);
+static void adlProgramChange(TinyPlayer *tp, int channel, int program) {
+  adl_rt_patchChange(tp->adlSynth, channel, program);
 }
-void adlPitchBend(int channel, int pitch) {
-  adl_rt_pitchBend(g_adlSynth, channel, pitch);
+static void adlPitchBend(TinyPlayer *tp, int channel, int pitch) {
+  adl_rt_pitchBend(tp->adlSynth, channel, pitch);
 }
-void adlControlChange(int channel, int control, int value) {
-  adl_rt_controllerChange(g_adlSynth, channel, control, value);
+static void adlControlChange(TinyPlayer *tp, int channel, int control, int value) {
+  adl_rt_controllerChange(tp->adlSynth, channel, control, value);
 }
-void adlChannelPressure(int channel, int value) {
-  adl_rt_channelAfterTouch(g_adlSynth, channel, value);
+static void adlChannelPressure(TinyPlayer *tp, int channel, int value) {
+  adl_rt_channelAfterTouch(tp->adlSynth, channel, value);
 }
-void adlRender(float *buffer, int samples) {
-  adl_generateFormat(g_adlSynth, samples, (ADL_UInt8 *)buffer, (ADL_UInt8 *)(buffer + 1), &adl_AudioFormat);
+static void adlRender(TinyPlayer *tp, float *buffer, int samples) {
+  adl_generateFormat(tp->adlSynth, samples, (ADL_UInt8 *)buffer, (ADL_UInt8 *)(buffer + 1), &adl_AudioFormat);
 }
-void adlPanic() {
-  adl_panic(g_adlSynth);
+static void adlPanic(TinyPlayer *tp) {
+  adl_panic(tp->adlSynth);
 }
-void adlPanicChannel(int channel) {
+static void adlPanicChannel(TinyPlayer *tp, int channel) {
   // Hack: ADLMIDI doesn't have a channel notes-off method
   for (int i = 0; i < 128; i++)
-    adl_rt_noteOff(g_adlSynth, channel, i);
+    adl_rt_noteOff(tp->adlSynth, channel, i);
 }
-void adlReset() {
-  adl_rt_resetState(g_adlSynth);
+static void adlReset(TinyPlayer *tp) {
+  adl_rt_resetState(tp->adlSynth);
 };
-Synth adlSynth = {adlNoteOn, adlNoteOff, adlProgramChange, adlPitchBend, adlControlChange,
-                  adlChannelPressure, adlRender, adlPanic, adlPanicChannel, adlReset};
+static const Synth adlSynth = {adlNoteOn, adlNoteOff, adlProgramChange, adlPitchBend, adlControlChange,
+                               adlChannelPressure, adlRender, adlPanic, adlPanicChannel, adlReset};
 
-// TODO: separate wrapper for each synth?
-// Don't want multiple synth C APIs exposed to JavaScript
-extern void tp_note_on(int channel, int key, int velocity) {
-  g_synth.noteOn(channel, key, velocity);
+static const Synth *g_Synths[NUM_SYNTHS] = {&fluidSynth, &adlSynth};
+
+// Context API *********************************************
+
+extern TinyPlayer *tp_create(int sampleRate) {
+  TinyPlayer *tp = (TinyPlayer *)calloc(1, sizeof(TinyPlayer));
+  if (!tp) return NULL;
+
+  tp->sampleRate = sampleRate;
+  tp->speed = 1.0;
+
+  tp->fluidSettings = new_fluid_settings();
+  fluid_settings_setstr(tp->fluidSettings, "synth.reverb.active", "yes");
+  fluid_settings_setstr(tp->fluidSettings, "synth.chorus.active", "no");
+  fluid_settings_setint(tp->fluidSettings, "synth.threadsafe-api", 0);
+  fluid_settings_setnum(tp->fluidSettings, "synth.gain", 0.5);
+  fluid_settings_setnum(tp->fluidSettings, "synth.sample-rate", sampleRate);
+  tp->fluidSynth = new_fluid_synth(tp->fluidSettings);
+  fluid_synth_set_interp_method(tp->fluidSynth, -1, FLUID_INTERP_LINEAR);
+
+  tp->adlSynth = adl_init(sampleRate);
+  adl_setSoftPanEnabled(tp->adlSynth, 1);
+  adl_setVolumeRangeModel(tp->adlSynth, ADLMIDI_VolumeModel_AUTO);
+  adl_setNumChips(tp->adlSynth, 4);
+
+  tp->synthId = 0;
+  tp->synth = *g_Synths[0];
+  return tp;
 }
-extern void tp_note_off(int channel, int key) {
-  g_synth.noteOff(channel, key);
+
+extern void tp_destroy(TinyPlayer *tp) {
+  if (!tp) return;
+  if (tp->events) tml_free_events(tp->events);
+  if (tp->fluidSynth) delete_fluid_synth(tp->fluidSynth);
+  if (tp->fluidSettings) delete_fluid_settings(tp->fluidSettings);
+  if (tp->adlSynth) adl_close(tp->adlSynth);
+  if (g_Player == tp) g_Player = NULL;
+  free(tp);
 }
-extern void tp_program_change(int channel, int program) {
-  g_synth.programChange(channel, program);
+
+extern void tp_ctx_note_on(TinyPlayer *tp, int channel, int key, int velocity) {
+  tp->synth.noteOn(tp, channel, key, velocity);
 }
-extern void tp_pitch_bend(int channel, int pitch) {
-  g_synth.pitchBend(channel, pitch);
+extern void tp_ctx_note_off(TinyPlayer *tp, int channel, int key) {
+  tp->synth.noteOff(tp, channel, key);
 }
-extern void tp_control_change(int channel, int control, int value) {
-  g_synth.controlChange(channel, control, value);
+extern void tp_ctx_program_change(TinyPlayer *tp, int channel, int program) {
+  tp->synth.programChange(tp, channel, program);
 }
-extern void tp_channel_pressure(int channel, int value) {
-  g_synth.channelPressure(channel, value);
+extern void tp_ctx_pitch_bend(TinyPlayer *tp, int channel, int pitch) {
+  tp->synth.pitchBend(tp, channel, pitch);
 }
-extern void tp_render(float *buffer, int samples) {
-  g_synth.render(buffer, samples);
+extern void tp_ctx_control_change(TinyPlayer *tp, int channel, int control, int value) {
+  tp->synth.controlChange(tp, channel, control, value);
 }
-extern void tp_panic() {
-  g_synth.panic();
+extern void tp_ctx_channel_pressure(TinyPlayer *tp, int channel, int value) {
+  tp->synth.channelPressure(tp, channel, value);
 }
-extern void tp_panic_channel(int channel) {
-  g_synth.panicChannel(channel);
+extern void tp_ctx_render(TinyPlayer *tp, float *buffer, int samples) {
+  tp->synth.render(tp, buffer, samples);
 }
-extern void tp_reset() {
-  g_synth.reset();
-};
-
-// TODO: this will be midi_synth_init
-extern void tp_init(int sampleRate) {
-  g_SampleRate = sampleRate;
-
-  fluid_settings_t *settings = new_fluid_settings();
-  fluid_settings_setstr(settings, "synth.reverb.active", "yes");
-  fluid_settings_setstr(settings, "synth.chorus.active", "no");
-  fluid_settings_setint(settings, "synth.threadsafe-api", 0);
-  fluid_settings_setnum(settings, "synth.gain", 0.5);
-  fluid_settings_setnum(settings, "synth.sample-rate", sampleRate);
-  g_FluidSynth = new_fluid_synth(settings);
-    fluid_synth_set_interp_method(g_FluidSynth, -1, FLUID_INTERP_LINEAR);
-
-  g_adlSynth = adl_init(sampleRate);
-  adl_setSoftPanEnabled(g_adlSynth, 1);
-  adl_setVolumeRangeModel(g_adlSynth, ADLMIDI_VolumeModel_AUTO);
-  adl_setNumChips(g_adlSynth, 4);
-
-  g_Synths[0] = fluidSynth;
-  g_Synths[1] = adlSynth;
-  g_synth = g_Synths[0];
+extern void tp_ctx_panic(TinyPlayer *tp) {
+  tp->synth.panic(tp);
+}
+extern void tp_ctx_panic_channel(TinyPlayer *tp, int channel) {
+  tp->synth.panicChannel(tp, channel);
+}
+extern void tp_ctx_reset(TinyPlayer *tp) {
+  tp->synth.reset(tp);
 }
-
 
 // Returns the number of bytes written. Value of 0 means the song has ended.
-extern int tp_write_audio(float *buffer, int bufferSize) {
+extern int tp_ctx_write_audio(TinyPlayer *tp, float *buffer, int bufferSize) {
+  float *const out = buffer;
   int bytesWritten = 0;
   int batchSize = 128; // Timing of MIDI events will be quantized by the sample batch size.
 
-  double msPerBatch = g_Speed * 1000.0 * (batchSize / (float) g_SampleRate) / 2;
+  double msPerBatch = tp->speed * 1000.0 * (batchSize / (float) tp->sampleRate) / 2;
   for (int samplesRemaining = bufferSize * 2; samplesRemaining > 0; samplesRemaining -= batchSize) {
     //We progress the MIDI playback and then process `batchSize` samples at once
     if (batchSize > samplesRemaining) batchSize = samplesRemaining;
 
     //Loop through all MIDI messages which need to be played up until the current playback time
-    for (g_MidiTimeMs += msPerBatch;
-         g_MidiEvt && g_MidiTimeMs >= g_MidiEvt->time;
-         g_MidiEvt = g_MidiEvt->next) {
-      switch (g_MidiEvt->type) {
+    const tml_event *evt;
+    for (tp->midiTimeMs += msPerBatch;
+         (evt = next_event(tp)) && tp->midiTimeMs >= evt->time;
+         tp->nextEvt++) {
+      switch (evt->type) {
         case TML_NOTE_ON:
-          if (g_ChannelsMuted[g_MidiEvt->channel]) break;
-          if (g_MidiEvt->velocity == 0)
-            g_synth.noteOff(g_MidiEvt->channel, g_MidiEvt->key);
+          if (tp->channelsMuted[evt->channel]) break;
+          if (evt->velocity == 0)
+            tp->synth.noteOff(tp, evt->channel, evt->key);
           else
-            g_synth.noteOn(g_MidiEvt->channel, g_MidiEvt->key, g_MidiEvt->velocity);
+            tp->synth.noteOn(tp, evt->channel, evt->key, evt->velocity);
           break;
         case TML_NOTE_OFF:
-          if (g_ChannelsMuted[g_MidiEvt->channel]) break;
-          g_synth.noteOff(g_MidiEvt->channel, g_MidiEvt->key);
+          if (tp->channelsMuted[evt->channel]) break;
+          tp->synth.noteOff(tp, evt->channel, evt->key);
           break;
         case TML_PROGRAM_CHANGE:
-          g_synth.programChange(g_MidiEvt->channel, g_MidiEvt->program);
+          tp->synth.programChange(tp, evt->channel, evt->program);
           break;
         case TML_PITCH_BEND:
-          g_synth.pitchBend(g_MidiEvt->channel, g_MidiEvt->pitch_bend);
+          tp->synth.pitchBend(tp, evt->channel, evt->pitch_bend);
           break;
         case TML_CONTROL_CHANGE:
-          g_synth.controlChange(g_MidiEvt->channel, g_MidiEvt->control, g_MidiEvt->control_value);
+          tp->synth.controlChange(tp, evt->channel, evt->control, evt->control_value);
           break;
         case TML_CHANNEL_PRESSURE:
-          g_synth.channelPressure(g_MidiEvt->channel, g_MidiEvt->channel_pressure);
+          tp->synth.channelPressure(tp, evt->channel, evt->channel_pressure);
         default:
           break;
       }
 
     }
     // Render the block of audio samples in float format
-    g_synth.render(buffer, batchSize);
+    tp->synth.render(tp, buffer, batchSize);
 
     buffer += batchSize;
     bytesWritten += batchSize;
   }
 
-  if (g_MidiEvt == NULL) {
+  if (next_event(tp) == NULL) {
     // Last MIDI event has been processed.
     // Continue synthesis until silence is detected.
     // This allows voices with a long release tail to complete.
@@ -245,7 +279,7 @@ extern int tp_write_audio(float *buffer, int bufferSize) {
     int synthStillActive = 0;
     float threshold = 0.05;
     for (int i = 0; i < bufferSize; i++) {
-      if (buffer[i * 2] > threshold) { // Check left channel only
+      if (out[i * 2] > threshold) { // Check left channel only
         synthStillActive = 1;          // Exit early
         break;
       }
@@ -256,142 +290,255 @@ extern int tp_write_audio(float *buffer, int bufferSize) {
   return bytesWritten;
 }
 
-extern unsigned int tp_get_duration_ms() {
-  if (g_DurationMs == 0 && g_FirstEvt) {
-    tml_get_info(g_FirstEvt, NULL, NULL, NULL, NULL, &g_DurationMs);
+extern unsigned int tp_ctx_get_duration_ms(TinyPlayer *tp) {
+  if (tp->durationMs == 0 && tp->events) {
+    tp->durationMs = tp->events->time_length;
   }
-  return g_DurationMs;
+  return tp->durationMs;
 }
 
-extern void tp_seek(int ms) {
+extern void tp_ctx_seek(TinyPlayer *tp, int ms) {
   // It's only possible to seek forward due to the statefulness of the synth.
   // If we need to seek backward, reset to the first event and seek forward from there.
-  if (ms < g_MidiTimeMs) {
-    g_MidiEvt = g_FirstEvt;
+  if (ms < tp->midiTimeMs) {
+    tp->nextEvt = 0;
   }
 
-  g_synth.panic();
+  tp->synth.panic(tp);
 
-  while (g_MidiEvt && g_MidiEvt->time < ms) {
-    switch (g_MidiEvt->type) {
+  const tml_event *evt;
+  for (; (evt = next_event(tp)) && evt->time < ms; tp->nextEvt++) {
+    switch (evt->type) {
       // Ignore note on/note off events during seek
       case TML_PROGRAM_CHANGE:
-        g_synth.programChange(g_MidiEvt->channel, g_MidiEvt->program);
+        tp->synth.programChange(tp, evt->channel, evt->program);
         break;
       case TML_PITCH_BEND:
-        g_synth.pitchBend(g_MidiEvt->channel, g_MidiEvt->pitch_bend);
+        tp->synth.pitchBend(tp, evt->channel, evt->pitch_bend);
         break;
       case TML_CONTROL_CHANGE:
-        if (g_MidiEvt->control == 91) break; // ignore reverb CC from MIDI files
-        g_synth.controlChange(g_MidiEvt->channel, g_MidiEvt->control, g_MidiEvt->control_value);
+        if (evt->control == 91) break; // ignore reverb CC from MIDI files
+        tp->synth.controlChange(tp, evt->channel, evt->control, evt->control_value);
         break;
       default:
         break;
     }
-    g_MidiEvt = g_MidiEvt->next;
   }
 
-  g_MidiTimeMs = ms;
+  tp->midiTimeMs = ms;
 }
 
-extern double tp_get_position_ms() {
-  return g_MidiTimeMs;
+extern double tp_ctx_get_position_ms(TinyPlayer *tp) {
+  return tp->midiTimeMs;
 }
 
-extern void tp_set_speed(float speed) {
-  g_Speed = fmax(fmin(speed, 10.0), 0.1);
+extern void tp_ctx_set_speed(TinyPlayer *tp, float speed) {
+  tp->speed = fmax(fmin(speed, 10.0), 0.1);
 }
 
-extern void tp_stop() {
-  g_synth.panic();
-  g_MidiEvt = NULL;
+extern void tp_ctx_stop(TinyPlayer *tp) {
+  tp->synth.panic(tp);
+  tp->nextEvt = tp->events ? tp->events->count : 0;
 }
 
-extern void tp_restart() {
-  g_synth.panic();
-  g_MidiEvt = g_FirstEvt;
+extern void tp_ctx_restart(TinyPlayer *tp) {
+  tp->synth.panic(tp);
+  tp->nextEvt = 0;
 }
 
-extern void tp_open(const void *data, int length) {
-  g_synth.reset();
-  g_MidiTimeMs = 0;
-  g_DurationMs = 0;
-  g_MidiEvt = tml_load_memory(data, length);
-  g_FirstEvt = g_MidiEvt;
-  memset(g_ChannelsInUse, 0, sizeof g_ChannelsInUse);
-  memset(g_ChannelsMuted, 0, sizeof g_ChannelsMuted);
-  tml_get_channels_in_use_and_initial_programs(g_MidiEvt, g_ChannelsInUse, g_ChannelProgramNums);
-
-  // Skip to first note to eliminate silence
-  unsigned int firstNoteTimeMs;
-  tml_get_info(g_FirstEvt, NULL, NULL, NULL, &firstNoteTimeMs, NULL);
-  g_MidiTimeMs = (double) firstNoteTimeMs;
+extern void tp_ctx_open(TinyPlayer *tp, const void *data, int length) {
+  tp->synth.reset(tp);
+  if (tp->events) tml_free_events(tp->events);
+  tp->midiTimeMs = 0;
+  tp->durationMs = 0;
+  tp->events = tml_load_events_memory(data, length);
+  tp->nextEvt = 0;
+  memset(tp->channelsInUse, 0, sizeof tp->channelsInUse);
+  memset(tp->channelsMuted, 0, sizeof tp->channelsMuted);
+  memset(tp->channelProgramNums, 0, sizeof tp->channelProgramNums);
+  if (tp->events) {
+    memcpy(tp->channelsInUse, tp->events->channels, sizeof tp->channelsInUse);
+    memcpy(tp->channelProgramNums, tp->events->programs, sizeof tp->channelProgramNums);
+    // Skip to first note to eliminate silence
+    tp->midiTimeMs = (double) tp->events->time_first_note;
+  }
 
+#ifdef __EMSCRIPTEN__
   EM_ASM_({ console.log('Tiny MIDI Player loaded %d bytes.', $0); }, length);
-  EM_ASM_({ console.log('First note appears at %d ms.', $0); }, g_MidiTimeMs);
+  EM_ASM_({ console.log('First note appears at %d ms.', $0); }, tp->midiTimeMs);
+#endif
 }
 
-extern void tp_unload_soundfont() {
-  if (fluid_synth_sfcount(g_FluidSynth) > 0) {
-    fluid_sfont_t *sfont = fluid_synth_get_sfont(g_FluidSynth, 0);
-    fluid_synth_remove_sfont(g_FluidSynth, sfont);
+extern void tp_ctx_unload_soundfont(TinyPlayer *tp) {
+  if (fluid_synth_sfcount(tp->fluidSynth) > 0) {
+    fluid_sfont_t *sfont = fluid_synth_get_sfont(tp->fluidSynth, 0);
+    fluid_synth_remove_sfont(tp->fluidSynth, sfont);
     // Causes a crash related to pthreads in Emscripten.
-    // fluid_synth_sfunload(g_FluidSynth, (unsigned)g_SoundFontID, 1);
+    // fluid_synth_sfunload(tp->fluidSynth, (unsigned)g_SoundFontID, 1);
   }
 }
 
-extern int tp_load_soundfont(const char *filename) {
-  tp_unload_soundfont();
-  return fluid_synth_sfload(g_FluidSynth, filename, 1);
+extern int tp_ctx_load_soundfont(TinyPlayer *tp, const char *filename) {
+  tp_ctx_unload_soundfont(tp);
+  return fluid_synth_sfload(tp->fluidSynth, filename, 1);
 }
 
-extern int tp_add_soundfont(const char *filename) {
-  return fluid_synth_sfload(g_FluidSynth, filename, 1);
+extern int tp_ctx_add_soundfont(TinyPlayer *tp, const char *filename) {
+  return fluid_synth_sfload(tp->fluidSynth, filename, 1);
 }
 
-extern void tp_set_reverb(double level) {
+extern void tp_ctx_set_reverb(TinyPlayer *tp, double level) {
   // Completely disable reverb at very low levels to improve performance
-  fluid_synth_set_reverb_on(g_FluidSynth, level > 0.01);
+  fluid_synth_set_reverb_on(tp->fluidSynth, level > 0.01);
   fluid_synth_set_reverb(
-          g_FluidSynth,
+          tp->fluidSynth,
           0.2 + level * 0.8, // roomsize (default: 0.2) 0.2 to 1.0
           0.0 + level * 0.4, // damp     (default: 0.0) 0.0 to 0.4
           1.0,               // width    (default: 0.5) 1.0
           1.0);              // level    (default: 0.9) 1.0
   // Override MIDI channel reverb levels
   for (int i = 0; i < 16; i++)
-    fluid_synth_cc(g_FluidSynth, i, 91, 64);
+    fluid_synth_cc(tp->fluidSynth, i, 91, 64);
+}
+
+extern char tp_ctx_get_channel_in_use(TinyPlayer *tp, int chan) {
+  return tp->channelsInUse[chan] != 0;
+}
+
+extern int tp_ctx_get_channel_program(TinyPlayer *tp, int chan) {
+  return tp->channelProgramNums[chan];
+}
+
+extern void tp_ctx_set_channel_mute(TinyPlayer *tp, int chan, char isMuted) {
+  tp->channelsMuted[chan] = isMuted;
+  if (isMuted) {
+    tp->synth.panicChannel(tp, chan);
+  }
+}
+
+extern int tp_ctx_set_bank(TinyPlayer *tp, int bank) {
+  return adl_setBank(tp->adlSynth, bank);
+}
+
+extern int tp_ctx_set_synth_engine(TinyPlayer *tp, int synthId) {
+  if (tp->synthId == synthId) return 0;
+  if (synthId < 0 || synthId >= NUM_SYNTHS) return -1;
+  tp->synth.panic(tp);
+  tp->synthId = synthId;
+  tp->synth = *g_Synths[synthId];
+  // restore state
+  if (next_event(tp) != NULL && tp->nextEvt != 0)
+    tp_ctx_seek(tp, (int)tp_ctx_get_position_ms(tp) - 1);
+  return 0;
+}
+
+// Default context API *********************************************
+
+// TODO: separate wrapper for each synth?
+// Don't want multiple synth C APIs exposed to JavaScript
+extern void tp_note_on(int channel, int key, int velocity) {
+  tp_ctx_note_on(g_Player, channel, key, velocity);
+}
+extern void tp_note_off(int channel, int key) {
+  tp_ctx_note_off(g_Player, channel, key);
+}
+extern void tp_program_change(int channel, int program) {
+  tp_ctx_program_change(g_Player, channel, program);
+}
+extern void tp_pitch_bend(int channel, int pitch) {
+  tp_ctx_pitch_bend(g_Player, channel, pitch);
+}
+extern void tp_control_change(int channel, int control, int value) {
+  tp_ctx_control_change(g_Player, channel, control, value);
+}
+extern void tp_channel_pressure(int channel, int value) {
+  tp_ctx_channel_pressure(g_Player, channel, value);
+}
+extern void tp_render(float *buffer, int samples) {
+  tp_ctx_render(g_Player, buffer, samples);
+}
+extern void tp_panic() {
+  tp_ctx_panic(g_Player);
+}
+extern void tp_panic_channel(int channel) {
+  tp_ctx_panic_channel(g_Player, channel);
+}
+extern void tp_reset() {
+  tp_ctx_reset(g_Player);
+};
+
+// TODO: this will be midi_synth_init
+extern void tp_init(int sampleRate) {
+  tp_destroy(g_Player);
+  g_Player = tp_create(sampleRate);
+}
+
+extern int tp_write_audio(float *buffer, int bufferSize) {
+  return tp_ctx_write_audio(g_Player, buffer, bufferSize);
+}
+
+extern unsigned int tp_get_duration_ms() {
+  return tp_ctx_get_duration_ms(g_Player);
+}
+
+extern void tp_seek(int ms) {
+  tp_ctx_seek(g_Player, ms);
+}
+
+extern double tp_get_position_ms() {
+  return tp_ctx_get_position_ms(g_Player);
+}
+
+extern void tp_set_speed(float speed) {
+  tp_ctx_set_speed(g_Player, speed);
+}
+
+extern void tp_stop() {
+  tp_ctx_stop(g_Player);
+}
+
+extern void tp_restart() {
+  tp_ctx_restart(g_Player);
+}
+
+extern void tp_open(const void *data, int length) {
+  tp_ctx_open(g_Player, data, length);
+}
+
+extern void tp_unload_soundfont() {
+  tp_ctx_unload_soundfont(g_Player);
+}
+
+extern int tp_load_soundfont(const char *filename) {
+  return tp_ctx_load_soundfont(g_Player, filename);
+}
+
+extern int tp_add_soundfont(const char *filename) {
+  return tp_ctx_add_soundfont(g_Player, filename);
+}
+
+extern void tp_set_reverb(double level) {
+  tp_ctx_set_reverb(g_Player, level);
 }
 
 extern char tp_get_channel_in_use(int chan) {
-  return g_ChannelsInUse[chan] != 0;
+  return tp_ctx_get_channel_in_use(g_Player, chan);
 }
 
 extern int tp_get_channel_program(int chan) {
-  return g_ChannelProgramNums[chan];
+  return tp_ctx_get_channel_program(g_Player, chan);
 }
 
 extern void tp_set_channel_mute(int chan, char isMuted) {
-  g_ChannelsMuted[chan] = isMuted;
-  if (isMuted) {
-    g_synth.panicChannel(chan);
-  }
+  tp_ctx_set_channel_mute(g_Player, chan, isMuted);
 }
 
 extern int tp_set_bank(int bank) {
-  return adl_setBank(g_adlSynth, bank);
+  return tp_ctx_set_bank(g_Player, bank);
 }
 
 extern int tp_set_synth_engine(int synthId) {
-  if (g_synthId == synthId) return 0;
-  if (synthId < 0 || synthId > NUM_SYNTHS) return -1;
-  g_synth.panic();
-  g_synthId = synthId;
-  g_synth = g_Synths[g_synthId];
-  // restore state
-  if (g_MidiEvt != NULL && g_MidiEvt != g_FirstEvt)
-    tp_seek((int)tp_get_position_ms() - 1);
-  return 0;
+  return tp_ctx_set_synth_engine(g_Player, synthId);
 }
 
 #ifdef __cplusplus
@@ -129,6 +129,58 @@ TMLDEF int tml_get_tempo_value(tml_message* set_tempo_message);
 // Free all the memory of the linked message list (can also call free() manually)
 TMLDEF void tml_free(tml_message* f);
 
+// A single MIDI message like tml_message, but without the next pointer. The
+// tml_load_events* functions return all messages of a file in one array of
+// these, ordered by time, which is half the size of the linked list on 64-bit
+// targets and faster to walk.
+typedef struct tml_event
+{
+	// Time of the message in milliseconds
+	unsigned int time;
+
+	// Type (see TMLMessageType) and channel number
+	unsigned char type, channel;
+
+	// 2 byte of parameter data, same as in tml_message
+	union
+	{
+		struct { union { char key, control, program, channel_pressure; }; union { char velocity, key_pressure, control_value; }; };
+		struct { unsigned short pitch_bend; };
+	};
+} tml_event;
+
+// The result of the tml_load_events* functions, a single allocation holding
+// the message array and the infos otherwise gathered with tml_get_info and
+// tml_get_channels_in_use_and_initial_programs.
+typedef struct tml_events
+{
+	// All messages ordered by time
+	tml_event* events;
+	unsigned int count;
+
+	// Same as the tml_get_info values
+	int used_channels, used_programs, total_notes;
+	unsigned int time_first_note, time_length;
+
+	// Same as the tml_get_channels_in_use_and_initial_programs values
+	char channels[16];
+	int programs[16];
+} tml_events;
+
+#ifndef TML_NO_STDIO
+// Directly load a MIDI file from a .mid file path into a message array
+TMLDEF tml_events* tml_load_events_filename(const char* filename);
+#endif
+
+// Load a MIDI file from a block of memory into a message array
+TMLDEF tml_events* tml_load_events_memory(const void* buffer, int size);
+
+// Read the tempo (microseconds per quarter note) value from an event with the type TML_SET_TEMPO
+TMLDEF int tml_get_event_tempo_value(const tml_event* set_tempo_event);
+
+// Free a message array returned by the tml_load_events* functions (can also call free() manually)
+TMLDEF void tml_free_events(tml_events* f);
+
 // Stream structure for the generic loading
 struct tml_stream
 {
@@ -141,6 +193,7 @@ struct tml_stream
 
 // Generic Midi loading method using the stream structure above
 TMLDEF tml_message* tml_load(struct tml_stream* stream);
+TMLDEF tml_events* tml_load_events(struct tml_stream* stream);
 TMLDEF tml_message* tml_load_tsf_stream(struct tsf_stream* stream);
 
 #ifdef __cplusplus
@@ -210,6 +263,24 @@ TMLDEF tml_message* tml_load_filename(const char* filename)
 }
 #endif
 
+#ifndef TML_NO_STDIO
+TMLDEF tml_events* tml_load_events_filename(const char* filename)
+{
+	tml_events* res;
+	struct tml_stream stream = { TML_NULL, (int(*)(void*,void*,unsigned int))&tml_stream_stdio_read };
+	#if __STDC_WANT_SECURE_LIB__
+	FILE* f = TML_NULL; fopen_s(&f, filename, "rb");
+	#else
+	FILE* f = fopen(filename, "rb");
+	#endif
+	if (!f) { TML_ERROR("File not found"); return 0; }
+	stream.data = f;
+	res = tml_load_events(&stream);
+	fclose(f);
+	return res;
+}
+#endif
+
 struct tml_stream_memory { const char* buffer; unsigned int total, pos; };
 static int tml_stream_memory_read(struct tml_stream_memory* m, void* ptr, unsigned int size) { if (size > m->total - m->pos) size = m->total - m->pos; TML_MEMCPY(ptr, m->buffer+m->pos, size); m->pos += size; return size; }
 TMLDEF struct tml_message* tml_load_memory(const void* buffer, int size)
@@ -222,6 +293,16 @@ TMLDEF struct tml_message* tml_load_memory(const void* buffer, int size)
 	return tml_load(&stream);
 }
 
+TMLDEF tml_events* tml_load_events_memory(const void* buffer, int size)
+{
+	struct tml_stream stream = { TML_NULL, (int(*)(void*,void*,unsigned int))&tml_stream_memory_read };
+	struct tml_stream_memory f = { 0, 0, 0 };
+	f.buffer = (const char*)buffer;
+	f.total = size;
+	stream.data = &f;
+	return tml_load_events(&stream);
+}
+
 struct tml_track
 {
 	unsigned int Idx, End, Ticks;
@@ -267,10 +348,11 @@ static int tml_readvariablelength(struct tml_parser* p)
 	TML_WARN("Invalid variable length byte count"); return -1;
 }
 
-static int tml_parsemessage(tml_message** f, struct tml_parser* p)
+//reads the next message into evt with its delta time, returns its type or -1 on error
+//(an end of track without delay returns TML_EOT but leaves evt as an empty message)
+static int tml_readmessage(tml_message* evt, struct tml_parser* p)
 {
 	int deltatime = tml_readvariablelength(p), status = tml_readbyte(p);
-	tml_message* evt;
 
 	if (deltatime & 0xFFF00000) deltatime = 0; //throw away delays that are insanely high for malformatted midis
 	if (status < 0) { TML_WARN("Unexpected end of file"); return -1; }
@@ -283,15 +365,6 @@ static int tml_parsemessage(tml_message** f, struct tml_parser* p)
 	}
 	else p->last_status = status;
 
-	if (p->message_array_size == p->message_count)
-	{
-		//start allocated memory size of message array at 64, double each time until 8192, then add 1024 entries until done
-		p->message_array_size += (!p->message_array_size ? 64 : (p->message_array_size > 4096 ? 1024 : p->message_array_size));
-		*f = (tml_message*)TML_REALLOC(*f, p->message_array_size * sizeof(tml_message));
-		if (!*f) { TML_ERROR("Out of memory"); return -1; }
-	}
-	evt = *f + p->message_count;
-
 	//check what message we have
 	if ((status == TML_SYSEX) || (status == TML_EOX)) //sysex
 	{
@@ -306,12 +379,14 @@ static int tml_parsemessage(tml_message** f, struct tml_parser* p)
 		unsigned char* metadata = p->buf;
 		if (meta_type < 0) { TML_WARN("Unexpected end of file"); return -1; }
 		if (buflen > 0 && (p->buf += buflen) > p->buf_end) { TML_WARN("Unexpected end of file"); p->buf = p->buf_end; return -1; }
+		evt->channel = 0;
+		evt->pitch_bend = 0;
 
 		switch (meta_type)
 		{
 			case TML_EOT:
 				if (buflen != 0) { TML_WARN("Invalid length for EndOfTrack event"); return -1; }
-				if (!deltatime) return TML_EOT; //no need to store this message
+				if (!deltatime) { evt->time = evt->type = 0; return TML_EOT; } //no need to store this message
 				evt->type = TML_EOT;
 				break;
 
@@ -359,12 +434,28 @@ static int tml_parsemessage(tml_message** f, struct tml_parser* p)
 		}
 	}
 
-	if (deltatime || evt->type)
+	evt->time = deltatime;
+	return evt->type;
+}
+
+static int tml_parsemessage(tml_message** f, struct tml_parser* p)
+{
+	tml_message* evt;
+	int type;
+
+	if (p->message_array_size == p->message_count)
 	{
-		evt->time = deltatime;
-		p->message_count++;
+		//start allocated memory size of message array at 64, double each time until 8192, then add 1024 entries until done
+		p->message_array_size += (!p->message_array_size ? 64 : (p->message_array_size > 4096 ? 1024 : p->message_array_size));
+		*f = (tml_message*)TML_REALLOC(*f, p->message_array_size * sizeof(tml_message));
+		if (!*f) { TML_ERROR("Out of memory"); return -1; }
 	}
-	return evt->type;
+	evt = *f + p->message_count;
+
+	type = tml_readmessage(evt, p);
+	if (type >= 0 && (evt->time || evt->type))
+		p->message_count++;
+	return type;
 }
 
 TMLDEF tml_message* tml_load(struct tml_stream* stream)
@@ -469,6 +560,179 @@ TMLDEF tml_message* tml_load(struct tml_stream* stream)
 	return messages;
 }
 
+struct tml_eventtrack
+{
+	struct tml_parser p;
+	unsigned int ticks;
+	tml_message next;
+	int done;
+};
+
+struct tml_tempoevent
+{
+	unsigned int time;
+	unsigned char type, Tempo[3];
+};
+
+//reads the next message of a track that needs storing into next, skipping the others (but not their delays)
+static void tml_eventtrack_advance(struct tml_eventtrack* t)
+{
+	while (!t->done)
+	{
+		int type;
+		if (t->p.buf == t->p.buf_end || t->next.type == TML_EOT) { t->done = 1; break; } //file end or end of track already stored
+		type = tml_readmessage(&t->next, &t->p);
+		if (type < 0 || (type == TML_EOT && !t->next.type)) { t->done = 1; break; } //illegal data or end of track
+		t->ticks += t->next.time;
+		if (t->next.type) break;
+	}
+}
+
+static void tml_eventtrack_start(struct tml_eventtrack* t, unsigned char* buf, unsigned char* buf_end, int last_status)
+{
+	t->p.buf = buf;
+	t->p.buf_end = buf_end;
+	t->p.last_status = last_status;
+	t->ticks = 0;
+	t->next.type = 0;
+	t->done = 0;
+	tml_eventtrack_advance(t);
+}
+
+//the track with the earliest next message comes first, the one read first from the file if they are at the same time
+#define TML_EVENTTRACK_BEFORE(a, b) ((a)->ticks < (b)->ticks || ((a)->ticks == (b)->ticks && (a) < (b)))
+
+static void tml_eventtrack_siftdown(struct tml_eventtrack** heap, int heap_size, int i)
+{
+	for (;;)
+	{
+		struct tml_eventtrack* swap;
+		int child = 2 * i + 1;
+		if (child >= heap_size) break;
+		if (child + 1 < heap_size && TML_EVENTTRACK_BEFORE(heap[child + 1], heap[child])) child++;
+		if (!TML_EVENTTRACK_BEFORE(heap[child], heap[i])) break;
+		swap = heap[i]; heap[i] = heap[child]; heap[child] = swap;
+		i = child;
+	}
+}
+
+TMLDEF tml_events* tml_load_events(struct tml_stream* stream)
+{
+	int num_tracks, division, heap_size = 0, last_status = 0, i;
+	unsigned int data_size = 0, count = 0;
+	unsigned char midi_header[14], *data = TML_NULL;
+	struct tml_track *tracks, *t, *tracksEnd;
+	struct tml_eventtrack *evtracks, **heap;
+	tml_events* res = TML_NULL;
+
+	// Parse MIDI header
+	if (stream->read(stream->data, midi_header, 14) != 14) { TML_ERROR("Unexpected end of file"); return res; }
+	if (midi_header[0] != 'M' || midi_header[1] != 'T' || midi_header[2] != 'h' || midi_header[3] != 'd' ||
+	    midi_header[7] != 6   || midi_header[9] >  2) { TML_ERROR("Doesn't look like a MIDI file: invalid MThd header"); return res; }
+	if (midi_header[12] & 0x80) { TML_ERROR("File uses unsupported SMPTE timing"); return res; }
+	num_tracks = (int)(midi_header[10] << 8) | midi_header[11];
+	division = (int)(midi_header[12] << 8) | midi_header[13]; //division is ticks per beat (quarter-note)
+	if (num_tracks <= 0 && division <= 0) { TML_ERROR("Doesn't look like a MIDI file: invalid track or division values"); return res; }
+
+	// Read the data of all tracks into one buffer, Idx and End are the offsets of each track's data
+	tracks = (struct tml_track*)TML_MALLOC(sizeof(struct tml_track) * num_tracks);
+	tracksEnd = &tracks[num_tracks];
+	for (t = tracks; t != tracksEnd; t++) t->Idx = t->End = t->Ticks = 0;
+	for (t = tracks; t != tracksEnd; t++)
+	{
+		unsigned char track_header[8], *grown;
+		int track_length;
+		if (stream->read(stream->data, track_header, 8) != 8) { TML_WARN("Unexpected end of file"); break; }
+		if (track_header[0] != 'M' || track_header[1] != 'T' || track_header[2] != 'r' || track_header[3] != 'k')
+			{ TML_WARN("Invalid MTrk header"); break; }
+
+		track_length = track_header[7] | (track_header[6] << 8) | (track_header[5] << 16) | (track_header[4] << 24);
+		if (track_length < 0) { TML_WARN("Invalid MTrk header"); break; }
+		grown = (unsigned char*)TML_REALLOC(data, data_size + track_length);
+		if (!grown && track_length) { TML_ERROR("Out of memory"); break; }
+		data = grown;
+		if (stream->read(stream->data, data + data_size, track_length) != track_length) { TML_WARN("Unexpected end of file"); break; }
+		t->Idx = data_size;
+		t->End = data_size += track_length;
+	}
+
+	// Count the messages to store, then merge them from all tracks ordered by time straight into the result
+	// (like tml_load, a track starts with the running status the previous track ended with)
+	evtracks = (struct tml_eventtrack*)TML_MALLOC((sizeof(struct tml_eventtrack) + sizeof(struct tml_eventtrack*)) * num_tracks);
+	heap = (struct tml_eventtrack**)(evtracks + num_tracks);
+	for (i = 0; i != num_tracks; i++)
+	{
+		struct tml_eventtrack* et = &evtracks[i];
+		int first_status = last_status;
+		for (tml_eventtrack_start(et, data + tracks[i].Idx, data + tracks[i].End, first_status); !et->done; tml_eventtrack_advance(et)) count++;
+		last_status = et->p.last_status;
+		tml_eventtrack_start(et, data + tracks[i].Idx, data + tracks[i].End, first_status);
+		if (!et->done) heap[heap_size++] = et;
+	}
+	for (i = heap_size / 2 - 1; i >= 0; i--) tml_eventtrack_siftdown(heap, heap_size, i);
+
+	if (count) res = (tml_events*)TML_MALLOC(sizeof(tml_events) + sizeof(tml_event) * count);
+	if (res)
+	{
+		unsigned int tempo_ticks = 0; //tick value at last tempo change
+		int msec, tempo_msec = 0; //msec value at last tempo change
+		double ticks2time = 500000 / (1000.0 * division); //milliseconds per tick
+		unsigned char programs[128] = { 0 };
+		tml_event* evt;
+
+		res->events = evt = (tml_event*)(res + 1);
+		res->count = count;
+		res->used_channels = res->used_programs = res->total_notes = 0;
+		res->time_first_note = 0xffffffff;
+		for (i = 0; i != 16; i++) { res->channels[i] = 0; res->programs[i] = 0; }
+
+		while (heap_size)
+		{
+			struct tml_eventtrack* et = heap[0];
+			tml_message* Msg = &et->next;
+
+			msec = tempo_msec + (int)((et->ticks - tempo_ticks) * ticks2time);
+			if (Msg->type == TML_SET_TEMPO)
+			{
+				unsigned char* Tempo = ((struct tml_tempomsg*)Msg)->Tempo;
+				ticks2time = ((Tempo[0]<<16)|(Tempo[1]<<8)|Tempo[2])/(1000.0 * division);
+				tempo_msec = msec;
+				tempo_ticks = et->ticks;
+			}
+
+			evt->time = msec;
+			evt->type = Msg->type;
+			evt->channel = Msg->channel;
+			evt->pitch_bend = Msg->pitch_bend; //both parameter bytes (or the last two tempo bytes)
+
+			// Gather what tml_get_info and tml_get_channels_in_use_and_initial_programs would
+			if (evt->type == TML_PROGRAM_CHANGE)
+			{
+				if (!programs[(int)evt->program]) { programs[(int)evt->program] = 1; res->used_programs++; }
+				if (!res->programs[evt->channel]) res->programs[evt->channel] = (int)evt->program;
+			}
+			else if (evt->type == TML_NOTE_ON)
+			{
+				if (res->time_first_note == 0xffffffff) res->time_first_note = evt->time;
+				if (!res->channels[evt->channel]) { res->channels[evt->channel] = 1; res->used_channels++; }
+				res->total_notes++;
+			}
+			evt++;
+
+			tml_eventtrack_advance(et);
+			if (et->done) heap[0] = heap[--heap_size];
+			tml_eventtrack_siftdown(heap, heap_size, 0);
+		}
+		res->time_length = res->events[count - 1].time;
+		if (res->time_first_note == 0xffffffff) res->time_first_note = 0;
+	}
+
+	TML_FREE(evtracks);
+	TML_FREE(tracks);
+	TML_FREE(data);
+	return res;
+}
+
 TMLDEF tml_message* tml_load_tsf_stream(struct tsf_stream* stream)
 {
 	return tml_load((struct tml_stream*)stream);
@@ -526,6 +790,19 @@ TMLDEF void tml_free(tml_message* f)
 	TML_FREE(f);
 }
 
+TMLDEF int tml_get_event_tempo_value(const tml_event* evt)
+{
+	const unsigned char* Tempo;
+	if (!evt || evt->type != TML_SET_TEMPO) return 0;
+	Tempo = ((const struct tml_tempoevent*)evt)->Tempo;
+	return ((Tempo[0]<<16)|(Tempo[1]<<8)|Tempo[2]);
+}
+
+TMLDEF void tml_free_events(tml_events* f)
+{
+	TML_FREE(f);
+}
+
 #ifdef __cplusplus
 }
 #endif
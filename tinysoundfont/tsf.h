@@ -13,6 +13,8 @@
    [OPTIONAL] #define TSF_MALLOC, TSF_REALLOC, and TSF_FREE to avoid stdlib.h
    [OPTIONAL] #define TSF_MEMCPY, TSF_MEMSET to avoid string.h
    [OPTIONAL] #define TSF_POW, TSF_POWF, TSF_EXPF, TSF_LOG, TSF_TAN, TSF_LOG10, TSF_SQRT to avoid math.h
+   [OPTIONAL] #define TSF_NO_SIMD to mix voices with plain C even where SSE2 or WebAssembly SIMD is available
+   [OPTIONAL] #define TSF_THREADS to be able to render voices on multiple threads (requires pthreads), see tsf_set_threads
 
    NOT YET IMPLEMENTED
      - Support for ChorusEffectsSend and ReverbEffectsSend generators
@@ -160,6 +162,11 @@ TSFDEF int tsf_active_voice_count(tsf* f);
 TSFDEF void tsf_render_short(tsf* f, short* buffer, int samples, int flag_mixing CPP_DEFAULT0);
 TSFDEF void tsf_render_float(tsf* f, float* buffer, int samples, int flag_mixing CPP_DEFAULT0);
 
+// Render the voices on up to 'threads' threads, the calling one included, if compiled with TSF_THREADS.
+// Each voice renders into its own buffer and the buffers get mixed in voice order, so the output is
+// the same as when rendering on one thread (the default). Without TSF_THREADS this does nothing.
+TSFDEF void tsf_set_threads(tsf* f, int threads);
+
 // Higher level channel based functions, set up channel parameters
 //   channel: channel number
 //   preset_index: preset index >= 0 and < tsf_get_presetcount()
@@ -258,6 +265,18 @@ TSFDEF float tsf_channel_get_tuning(tsf* f, int channel);
 #  include <stdio.h>
 #endif
 
+#ifdef TSF_THREADS
+#  include <pthread.h>
+#endif
+
+#if !defined(TSF_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#  include <emmintrin.h>
+#  define TSF_SSE2
+#elif !defined(TSF_NO_SIMD) && defined(__wasm_simd128__)
+#  include <wasm_simd128.h>
+#  define TSF_WASM_SIMD
+#endif
+
 #define TSF_TRUE 1
 #define TSF_FALSE 0
 #define TSF_BOOL char
@@ -285,6 +304,7 @@ struct tsf
 	struct tsf_voice* voices;
 	struct tsf_channels* channels;
 	float* outputSamples;
+	struct tsf_workers* workers;
 
 	int presetNum;
 	int voiceNum;
@@ -899,9 +919,24 @@ static void tsf_voice_lowpass_setup(struct tsf_voice_lowpass* e, float Fc)
 	e->b2 = (1 - K * e->QInv + KK) * norm;
 }
 
-static float tsf_voice_lowpass_process(struct tsf_voice_lowpass* e, double In)
+// Filters numSamples (> 0) samples in place. Out = In * a0 + z1, z1 = In * a1 + z2 - b1 * Out, z2 = In * a0 - b2 * Out
+// with the additions grouped so only one multiplication and one subtraction wait for the previous output.
+static void tsf_voice_lowpass_block(struct tsf_voice_lowpass* e, float* samples, int numSamples)
 {
-	double Out = In * e->a0 + e->z1; e->z1 = In * e->a1 + e->z2 - e->b1 * Out; e->z2 = In * e->a0 - e->b2 * Out; return (float)Out;
+	double a0 = e->a0, a1 = e->a1, b1 = e->b1, b2 = e->b2, z2 = e->z2;
+	double In = samples[0], Out = In * a0 + e->z1;
+	int i;
+	samples[0] = (float)Out;
+	for (i = 1; i != numSamples; i++)
+	{
+		double InPrev = In, z2Next = InPrev * a0 - b2 * Out;
+		In = samples[i];
+		Out = ((In * a0 + InPrev * a1) + z2) - b1 * Out;
+		z2 = z2Next;
+		samples[i] = (float)Out;
+	}
+	e->z1 = In * a1 + z2 - b1 * Out;
+	e->z2 = In * a0 - b2 * Out;
 }
 
 static void tsf_voice_lfo_setup(struct tsf_voice_lfo* e, float delay, int freqCents, float outSampleRate)
@@ -950,6 +985,75 @@ static void tsf_voice_calcpitchratio(struct tsf_voice* v, float pitchShift, floa
 	v->pitchOutputFactor = v->region->sample_rate / (tsf_timecents2Secsd(v->region->pitch_keycenter * 100.0) * outSampleRate);
 }
 
+// Linearly interpolates numSamples samples from input starting at position and advancing by step,
+// without loop or end checks. Positions are start + i * step so the samples are independent of each other.
+static void tsf_voice_interpolate(float* out, const float* input, double position, double step, int numSamples)
+{
+	int i = 0;
+#if defined(TSF_SSE2)
+	__m128d start = _mm_set1_pd(position), steps = _mm_set1_pd(step), k = _mm_set_pd(1.0, 0.0), two = _mm_set1_pd(2.0);
+	for (; i + 4 <= numSamples; i += 4, out += 4)
+	{
+		__m128d posLo = _mm_add_pd(start, _mm_mul_pd(k, steps)), posHi = _mm_add_pd(start, _mm_mul_pd(_mm_add_pd(k, two), steps));
+		__m128i idxLo = _mm_cvttpd_epi32(posLo), idxHi = _mm_cvttpd_epi32(posHi);
+		__m128 alpha = _mm_movelh_ps(_mm_cvtpd_ps(_mm_sub_pd(posLo, _mm_cvtepi32_pd(idxLo))), _mm_cvtpd_ps(_mm_sub_pd(posHi, _mm_cvtepi32_pd(idxHi))));
+		int i0 = _mm_cvtsi128_si32(idxLo), i1 = _mm_cvtsi128_si32(_mm_shuffle_epi32(idxLo, 1));
+		int i2 = _mm_cvtsi128_si32(idxHi), i3 = _mm_cvtsi128_si32(_mm_shuffle_epi32(idxHi, 1));
+		__m128 a = _mm_setr_ps(input[i0], input[i1], input[i2], input[i3]);
+		__m128 b = _mm_setr_ps(input[i0 + 1], input[i1 + 1], input[i2 + 1], input[i3 + 1]);
+		_mm_storeu_ps(out, _mm_add_ps(_mm_mul_ps(a, _mm_sub_ps(_mm_set1_ps(1.0f), alpha)), _mm_mul_ps(b, alpha)));
+		k = _mm_add_pd(k, _mm_add_pd(two, two));
+	}
+#endif
+	for (; i < numSamples; i++)
+	{
+		double p = position + i * step;
+		unsigned int pos = (unsigned int)p;
+		float alpha = (float)(p - pos);
+		*out++ = input[pos] * (1.0f - alpha) + input[pos + 1] * alpha;
+	}
+}
+
+// Adds numSamples mono samples multiplied by gain to out
+static void tsf_voice_mix(float* out, const float* in, int numSamples, float gain)
+{
+	int i = 0;
+#if defined(TSF_SSE2)
+	__m128 g = _mm_set1_ps(gain);
+	for (; i + 4 <= numSamples; i += 4)
+		_mm_storeu_ps(out + i, _mm_add_ps(_mm_loadu_ps(out + i), _mm_mul_ps(_mm_loadu_ps(in + i), g)));
+#elif defined(TSF_WASM_SIMD)
+	v128_t g = wasm_f32x4_splat(gain);
+	for (; i + 4 <= numSamples; i += 4)
+		wasm_v128_store(out + i, wasm_f32x4_add(wasm_v128_load(out + i), wasm_f32x4_mul(wasm_v128_load(in + i), g)));
+#endif
+	for (; i < numSamples; i++) out[i] += in[i] * gain;
+}
+
+// Adds numSamples mono samples multiplied by the left and right gain to interleaved stereo out
+static void tsf_voice_mix_interleaved(float* out, const float* in, int numSamples, float gainLeft, float gainRight)
+{
+	int i = 0;
+#if defined(TSF_SSE2)
+	__m128 gl = _mm_set1_ps(gainLeft), gr = _mm_set1_ps(gainRight);
+	for (; i + 4 <= numSamples; i += 4, out += 8)
+	{
+		__m128 val = _mm_loadu_ps(in + i), l = _mm_mul_ps(val, gl), r = _mm_mul_ps(val, gr);
+		_mm_storeu_ps(out,     _mm_add_ps(_mm_loadu_ps(out),     _mm_unpacklo_ps(l, r)));
+		_mm_storeu_ps(out + 4, _mm_add_ps(_mm_loadu_ps(out + 4), _mm_unpackhi_ps(l, r)));
+	}
+#elif defined(TSF_WASM_SIMD)
+	v128_t gl = wasm_f32x4_splat(gainLeft), gr = wasm_f32x4_splat(gainRight);
+	for (; i + 4 <= numSamples; i += 4, out += 8)
+	{
+		v128_t val = wasm_v128_load(in + i), l = wasm_f32x4_mul(val, gl), r = wasm_f32x4_mul(val, gr);
+		wasm_v128_store(out,     wasm_f32x4_add(wasm_v128_load(out),     wasm_i32x4_shuffle(l, r, 0, 4, 1, 5)));
+		wasm_v128_store(out + 4, wasm_f32x4_add(wasm_v128_load(out + 4), wasm_i32x4_shuffle(l, r, 2, 6, 3, 7)));
+	}
+#endif
+	for (; i < numSamples; i++, out += 2) { out[0] += in[i] * gainLeft; out[1] += in[i] * gainRight; }
+}
+
 static void tsf_voice_render(tsf* f, struct tsf_voice* v, float* outputBuffer, int numSamples)
 {
 	struct tsf_region* region = v->region;
@@ -964,6 +1068,7 @@ static void tsf_voice_render(tsf* f, struct tsf_voice* v, float* outputBuffer, i
 	TSF_BOOL isLooping    = (v->loopStart < v->loopEnd);
 	unsigned int tmpLoopStart = v->loopStart, tmpLoopEnd = v->loopEnd;
 	double tmpSampleEndDbl = (double)region->end, tmpLoopEndDbl = (double)tmpLoopEnd + 1.0;
+	double tmpSafeEndDbl = (isLooping && tmpLoopEnd < region->end ? (double)tmpLoopEnd : tmpSampleEndDbl);
 	double tmpSourceSamplePosition = v->sourceSamplePosition;
 	struct tsf_voice_lowpass tmpLowpass = v->lowpass;
 
@@ -988,8 +1093,8 @@ static void tsf_voice_render(tsf* f, struct tsf_voice* v, float* outputBuffer, i
 
 	while (numSamples)
 	{
-		float gainMono, gainLeft, gainRight;
-		int blockSamples = (numSamples > TSF_RENDER_EFFECTSAMPLEBLOCK ? TSF_RENDER_EFFECTSAMPLEBLOCK : numSamples);
+		float gainMono, block[TSF_RENDER_EFFECTSAMPLEBLOCK];
+		int blockFilled, blockSamples = (numSamples > TSF_RENDER_EFFECTSAMPLEBLOCK ? TSF_RENDER_EFFECTSAMPLEBLOCK : numSamples);
 		numSamples -= blockSamples;
 
 		if (dynamicLowpass)
@@ -1015,67 +1120,50 @@ static void tsf_voice_render(tsf* f, struct tsf_voice* v, float* outputBuffer, i
 		if (updateModLFO) tsf_voice_lfo_process(&v->modlfo, blockSamples);
 		if (updateVibLFO) tsf_voice_lfo_process(&v->viblfo, blockSamples);
 
-		switch (f->outputmode)
+		// Interpolate the block of samples, stopping early if the end of the sample is reached.
+		// Far enough from the loop end and the sample end none of the samples need these checks.
+		if (tmpSourceSamplePosition + blockSamples * pitchRatio + 1.0 < tmpSafeEndDbl)
 		{
-			case TSF_STEREO_INTERLEAVED:
-				gainLeft = gainMono * v->panFactorLeft, gainRight = gainMono * v->panFactorRight;
-				while (blockSamples-- && tmpSourceSamplePosition < tmpSampleEndDbl)
-				{
-					unsigned int pos = (unsigned int)tmpSourceSamplePosition, nextPos = (pos >= tmpLoopEnd && isLooping ? tmpLoopStart : pos + 1);
+			tsf_voice_interpolate(block, input, tmpSourceSamplePosition, pitchRatio, blockSamples);
+			tmpSourceSamplePosition += blockSamples * pitchRatio;
+			blockFilled = blockSamples;
+		}
+		else
+		{
+			for (blockFilled = 0; blockFilled != blockSamples && tmpSourceSamplePosition < tmpSampleEndDbl; blockFilled++)
+			{
+				unsigned int pos = (unsigned int)tmpSourceSamplePosition, nextPos = (pos >= tmpLoopEnd && isLooping ? tmpLoopStart : pos + 1);
 
-					// Simple linear interpolation.
-					float alpha = (float)(tmpSourceSamplePosition - pos), val = (input[pos] * (1.0f - alpha) + input[nextPos] * alpha);
+				// Simple linear interpolation.
+				float alpha = (float)(tmpSourceSamplePosition - pos);
+				block[blockFilled] = input[pos] * (1.0f - alpha) + input[nextPos] * alpha;
 
-					// Low-pass filter.
-					if (tmpLowpass.active) val = tsf_voice_lowpass_process(&tmpLowpass, val);
+				// Next sample.
+				tmpSourceSamplePosition += pitchRatio;
+				if (tmpSourceSamplePosition >= tmpLoopEndDbl && isLooping) tmpSourceSamplePosition -= (tmpLoopEnd - tmpLoopStart + 1.0);
+			}
+		}
 
-					*outL++ += val * gainLeft;
-					*outL++ += val * gainRight;
+		// Low-pass filter.
+		if (tmpLowpass.active && blockFilled) tsf_voice_lowpass_block(&tmpLowpass, block, blockFilled);
 
-					// Next sample.
-					tmpSourceSamplePosition += pitchRatio;
-					if (tmpSourceSamplePosition >= tmpLoopEndDbl && isLooping) tmpSourceSamplePosition -= (tmpLoopEnd - tmpLoopStart + 1.0);
-				}
+		switch (f->outputmode)
+		{
+			case TSF_STEREO_INTERLEAVED:
+				tsf_voice_mix_interleaved(outL, block, blockFilled, gainMono * v->panFactorLeft, gainMono * v->panFactorRight);
+				outL += blockFilled * 2;
 				break;
 
 			case TSF_STEREO_UNWEAVED:
-				gainLeft = gainMono * v->panFactorLeft, gainRight = gainMono * v->panFactorRight;
-				while (blockSamples-- && tmpSourceSamplePosition < tmpSampleEndDbl)
-				{
-					unsigned int pos = (unsigned int)tmpSourceSamplePosition, nextPos = (pos >= tmpLoopEnd && isLooping ? tmpLoopStart : pos + 1);
-
-					// Simple linear interpolation.
-					float alpha = (float)(tmpSourceSamplePosition - pos), val = (input[pos] * (1.0f - alpha) + input[nextPos] * alpha);
-
-					// Low-pass filter.
-					if (tmpLowpass.active) val = tsf_voice_lowpass_process(&tmpLowpass, val);
-
-					*outL++ += val * gainLeft;
-					*outR++ += val * gainRight;
-
-					// Next sample.
-					tmpSourceSamplePosition += pitchRatio;
-					if (tmpSourceSamplePosition >= tmpLoopEndDbl && isLooping) tmpSourceSamplePosition -= (tmpLoopEnd - tmpLoopStart + 1.0);
-				}
+				tsf_voice_mix(outL, block, blockFilled, gainMono * v->panFactorLeft);
+				tsf_voice_mix(outR, block, blockFilled, gainMono * v->panFactorRight);
+				outL += blockFilled;
+				outR += blockFilled;
 				break;
 
 			case TSF_MONO:
-				while (blockSamples-- && tmpSourceSamplePosition < tmpSampleEndDbl)
-				{
-					unsigned int pos = (unsigned int)tmpSourceSamplePosition, nextPos = (pos >= tmpLoopEnd && isLooping ? tmpLoopStart : pos + 1);
-
-					// Simple linear interpolation.
-					float alpha = (float)(tmpSourceSamplePosition - pos), val = (input[pos] * (1.0f - alpha) + input[nextPos] * alpha);
-
-					// Low-pass filter.
-					if (tmpLowpass.active) val = tsf_voice_lowpass_process(&tmpLowpass, val);
-
-					*outL++ += val * gainMono;
-
-					// Next sample.
-					tmpSourceSamplePosition += pitchRatio;
-					if (tmpSourceSamplePosition >= tmpLoopEndDbl && isLooping) tmpSourceSamplePosition -= (tmpLoopEnd - tmpLoopStart + 1.0);
-				}
+				tsf_voice_mix(outL, block, blockFilled, gainMono);
+				outL += blockFilled;
 				break;
 		}
 
@@ -1184,6 +1272,7 @@ TSFDEF void tsf_close(tsf* f)
 	TSF_FREE(f->voices);
 	if (f->channels) { TSF_FREE(f->channels->channels); TSF_FREE(f->channels); }
 	TSF_FREE(f->outputSamples);
+	tsf_set_threads(f, 1);
 	TSF_FREE(f);
 }
 
@@ -1355,6 +1444,108 @@ TSFDEF int tsf_active_voice_count(tsf* f)
 	return count;
 }
 
+#ifdef TSF_THREADS
+// Voices get rendered in chunks of this many samples. It needs to be a multiple of TSF_RENDER_EFFECTSAMPLEBLOCK
+// so the effect blocks of a voice are the same as when rendering all samples at once.
+#define TSF_THREADS_CHUNKSAMPLES (16 * TSF_RENDER_EFFECTSAMPLEBLOCK)
+
+struct tsf_workers
+{
+	pthread_t* threads;
+	pthread_mutex_t lock;
+	pthread_cond_t wake, done;
+	int threadNum, generation, quit;
+
+	// Current job, each active voice renders numSamples samples into its own part of scratch
+	tsf* f;
+	struct tsf_voice** active;
+	float* scratch;
+	int activeSize, scratchSize, activeNum, numSamples, next, finished;
+};
+
+// Renders voices of the current job until there are none left, called and returns with the lock held
+static void tsf_workers_run(struct tsf_workers* w)
+{
+	while (w->next != w->activeNum)
+	{
+		int i = w->next++, channelSamples = (w->f->outputmode == TSF_MONO ? 1 : 2) * w->numSamples;
+		float* out = w->scratch + i * channelSamples;
+		pthread_mutex_unlock(&w->lock);
+		TSF_MEMSET(out, 0, channelSamples * sizeof(float));
+		tsf_voice_render(w->f, w->active[i], out, w->numSamples);
+		pthread_mutex_lock(&w->lock);
+		if (++w->finished == w->activeNum) pthread_cond_signal(&w->done);
+	}
+}
+
+static void* tsf_worker_main(void* arg)
+{
+	struct tsf_workers* w = (struct tsf_workers*)arg;
+	int generation = 0;
+	pthread_mutex_lock(&w->lock);
+	for (;;)
+	{
+		while (w->generation == generation && !w->quit) pthread_cond_wait(&w->wake, &w->lock);
+		if (w->quit) break;
+		generation = w->generation;
+		tsf_workers_run(w);
+	}
+	pthread_mutex_unlock(&w->lock);
+	return TSF_NULL;
+}
+
+// Renders the active voices on the workers and mixes them into buffer, returns 0 if there are too few to bother
+static int tsf_workers_render(tsf* f, float* buffer, int samples)
+{
+	struct tsf_workers* w = f->workers;
+	struct tsf_voice *v = f->voices, *vEnd = v + f->voiceNum;
+	int i, offset, activeNum = 0, channels = (f->outputmode == TSF_MONO ? 1 : 2);
+	int chunkSamples = (samples > TSF_THREADS_CHUNKSAMPLES ? TSF_THREADS_CHUNKSAMPLES : samples);
+
+	for (; v != vEnd; v++) if (v->playingPreset != -1) activeNum++;
+	if (activeNum < 2 || !w->threadNum) return 0;
+	if (w->activeSize < f->voiceNum)
+	{
+		TSF_FREE(w->active);
+		w->active = (struct tsf_voice**)TSF_MALLOC((w->activeSize = f->voiceNum) * sizeof(struct tsf_voice*));
+	}
+	if (w->scratchSize < activeNum * chunkSamples * channels)
+	{
+		TSF_FREE(w->scratch);
+		w->scratch = (float*)TSF_MALLOC((w->scratchSize = activeNum * chunkSamples * channels) * sizeof(float));
+	}
+	for (offset = 0; offset != samples; offset += chunkSamples)
+	{
+		if (chunkSamples > samples - offset) chunkSamples = samples - offset;
+		// Voices that finished in the last chunk are gone now and must not be rendered again
+		for (v = f->voices, activeNum = 0; v != vEnd; v++) if (v->playingPreset != -1) w->active[activeNum++] = v;
+		pthread_mutex_lock(&w->lock);
+		w->f = f;
+		w->activeNum = activeNum;
+		w->numSamples = chunkSamples;
+		w->next = w->finished = 0;
+		w->generation++;
+		pthread_cond_broadcast(&w->wake);
+		tsf_workers_run(w);
+		while (w->finished != activeNum) pthread_cond_wait(&w->done, &w->lock);
+		pthread_mutex_unlock(&w->lock);
+
+		// Mix the voices in order, adding each sample exactly like tsf_voice_render does
+		for (i = 0; i != activeNum; i++)
+		{
+			float* in = w->scratch + i * chunkSamples * channels;
+			switch (f->outputmode)
+			{
+				case TSF_STEREO_INTERLEAVED: tsf_voice_mix(buffer + offset * 2, in, chunkSamples * 2, 1.0f); break;
+				case TSF_STEREO_UNWEAVED: tsf_voice_mix(buffer + offset, in, chunkSamples, 1.0f); tsf_voice_mix(buffer + samples + offset, in + chunkSamples, chunkSamples, 1.0f); break;
+				case TSF_MONO: tsf_voice_mix(buffer + offset, in, chunkSamples, 1.0f); break;
+			}
+		}
+	}
+	return 1;
+}
+#endif
+
 TSFDEF void tsf_render_short(tsf* f, short* buffer, int samples, int flag_mixing)
 {
 	float *floatSamples;
@@ -1389,11 +1580,55 @@ TSFDEF void tsf_render_float(tsf* f, float* buffer, int samples, int flag_mixing
 {
 	struct tsf_voice *v = f->voices, *vEnd = v + f->voiceNum;
 	if (!flag_mixing) TSF_MEMSET(buffer, 0, (f->outputmode == TSF_MONO ? 1 : 2) * sizeof(float) * samples);
+#ifdef TSF_THREADS
+	if (f->workers && tsf_workers_render(f, buffer, samples)) return;
+#endif
 	for (; v != vEnd; v++)
 		if (v->playingPreset != -1)
 			tsf_voice_render(f, v, buffer, samples);
 }
 
+#ifdef TSF_THREADS
+TSFDEF void tsf_set_threads(tsf* f, int threads)
+{
+	struct tsf_workers* w = f->workers;
+	int i;
+	if (w && w->threadNum == threads - 1) return;
+	if (w)
+	{
+		pthread_mutex_lock(&w->lock);
+		w->quit = 1;
+		pthread_cond_broadcast(&w->wake);
+		pthread_mutex_unlock(&w->lock);
+		for (i = 0; i != w->threadNum; i++) pthread_join(w->threads[i], TSF_NULL);
+		pthread_mutex_destroy(&w->lock);
+		pthread_cond_destroy(&w->wake);
+		pthread_cond_destroy(&w->done);
+		TSF_FREE(w->threads);
+		TSF_FREE(w->active);
+		TSF_FREE(w->scratch);
+		TSF_FREE(w);
+		f->workers = TSF_NULL;
+	}
+	if (threads <= 1) return;
+
+	w = (struct tsf_workers*)TSF_MALLOC(sizeof(struct tsf_workers));
+	TSF_MEMSET(w, 0, sizeof(struct tsf_workers));
+	w->threads = (pthread_t*)TSF_MALLOC((threads - 1) * sizeof(pthread_t));
+	pthread_mutex_init(&w->lock, TSF_NULL);
+	pthread_cond_init(&w->wake, TSF_NULL);
+	pthread_cond_init(&w->done, TSF_NULL);
+	for (; w->threadNum != threads - 1; w->threadNum++)
+		if (pthread_create(&w->threads[w->threadNum], TSF_NULL, tsf_worker_main, w)) break;
+	f->workers = w;
+}
+#else
+TSFDEF void tsf_set_threads(tsf* f, int threads)
+{
+	(void)f, (void)threads;
+}
+#endif
+
 static void tsf_channel_setup_voice(tsf* f, struct tsf_voice* v)
 {
 	struct tsf_channel* c = &f->channels->channels[f->channels->activeChannel];